@@ -126,7 +126,8 @@ SOURCES += main.cpp \
     ModelValidation.cpp \
     core_cli.cpp \
     ModelUtilities.cpp \
-    BuildUtilities.cpp
+    BuildUtilities.cpp \
+    ProcessFarm.cpp
 
 HEADERS += \
     version_cli.h \
@@ -134,4 +135,5 @@ HEADERS += \
     ModelValidation.h \
     core_cli.h \
     ModelUtilities.h \
-    BuildUtilities.h
+    BuildUtilities.h \
+    ProcessFarm.h
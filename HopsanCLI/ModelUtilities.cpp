@@ -30,6 +30,8 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <cstdio>
+#include <map>
 
 #include "ModelUtilities.h"
 #include "version_cli.h"
@@ -37,6 +39,7 @@
 
 #include "HopsanEssentials.h"
 #include "HopsanTypes.h"
+#include "CoreUtilities/LogSink.h"
 
 #ifdef USEHDF5
 #include "hopsanhdf5exporter.h"
@@ -232,16 +235,16 @@ void saveResults(ComponentSystem *pSys, const string &rFileName, const SaveResul
                                     continue;
                                 }
 
-                                // Only write something if data has been logged (skip ports that are not logged)
+                                // Only write something if data has been logged (skip ports and variables that are not logged)
                                 // We assume that the data vector has been cleared
-                                if (pPort->getLogDataVectorPtr()->size() > 0)
+                                if (pPort->getLogDataVectorPtr()->size() > 0 && pPort->getLogDataVectorPtr()->isVariableStored(v))
                                 {
                                     *pFile << fullVarName.c_str() << "," << pPort->getVariableAlias(v).c_str() << "," << pVars->at(v).unit.c_str();
                                     //! @todo what about time vector
-                                    vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
+                                    LogDataStorage *pLogData = pPort->getLogDataVectorPtr();
                                     for (size_t t=0; t<pSys->getNumActuallyLoggedSamples(); ++t)
                                     {
-                                        *pFile << "," << std::scientific << (*pLogData)[t][v];
+                                        *pFile << "," << std::scientific << pLogData->value(t, v);
                                     }
                                     *pFile << endl;
                                 }
@@ -614,8 +617,8 @@ void saveResultsToHDF5(ComponentSystem *pSys, const string &rFileName, const Sav
                         }
 
                         //Create data vector
-                        vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-                        if(pLogData == nullptr || pLogData->empty()) {
+                        LogDataStorage *pLogData = pPort->getLogDataVectorPtr();
+                        if(pLogData == nullptr || pLogData->empty() || !pLogData->isVariableStored(v)) {
                             continue;
                         }
                         HVector<double> dataVector;
@@ -623,11 +626,11 @@ void saveResultsToHDF5(ComponentSystem *pSys, const string &rFileName, const Sav
                             dataVector.resize(pSys->getNumActuallyLoggedSamples());
                             for (size_t t=0; t<pSys->getNumActuallyLoggedSamples(); ++t)
                             {
-                                dataVector[t] = (*pLogData)[t][v];
+                                dataVector[t] = pLogData->value(t, v);
                             }
                         }
                         else {
-                            dataVector.append(pLogData->back()[v]);
+                            dataVector.append(pLogData->value(pLogData->size()-1, v));
                         }
 
                         //Add variable to exporter
@@ -644,3 +647,266 @@ void saveResultsToHDF5(ComponentSystem *pSys, const string &rFileName, const Sav
     printErrorMessage("HopsanCLI was built without HDF5 support");
 #endif
 }
+
+//! @brief Attach a binary file log sink to a system and all its subsystems, the log data is then written during simulation
+//! @param [in] pSys Pointer to component system
+//! @param [in] rDirectory Directory for the temporary log files (with trailing slash, or empty for current directory)
+//! @param [out] rStreams The attached streams, one per system
+//! @param [in] prefix The full name prefix of the system (used when saving to CSV)
+void attachResultStreams(ComponentSystem *pSys, const string &rDirectory, std::vector<ResultStream> &rStreams, const string &prefix)
+{
+    if (!pSys)
+    {
+        return;
+    }
+
+    ResultStream stream;
+    stream.pSystem = pSys;
+    stream.prefix = prefix;
+    stream.pSink = new BinaryFileLogSink((rDirectory+"hopsancli_stream_"+to_string(rStreams.size())+".hlog").c_str());
+    pSys->setLogSink(stream.pSink);
+    rStreams.push_back(stream);
+
+    vector<HString> names = pSys->getSubComponentNames();
+    for (size_t c=0; c<names.size(); ++c)
+    {
+        Component *pComp = pSys->getSubComponent(names[c]);
+        if (pComp && pComp->isComponentSystem())
+        {
+            attachResultStreams(static_cast<ComponentSystem*>(pComp), rDirectory, rStreams, prefix+pComp->getName().c_str()+"$");
+        }
+    }
+}
+
+//! @brief Detach the log sinks from the systems and remove the temporary log files
+void detachResultStreams(std::vector<ResultStream> &rStreams)
+{
+    for (size_t i=0; i<rStreams.size(); ++i)
+    {
+        rStreams[i].pSystem->setLogSink(0);
+        const HString filePath = rStreams[i].pSink->getFilePath();
+        delete rStreams[i].pSink;
+        std::remove(filePath.c_str());
+    }
+    rStreams.clear();
+}
+
+namespace {
+
+//! @brief Finds the streamed log data of port variables, each node variable is stored once in the stream of its system
+class StreamedResultsReader
+{
+public:
+    StreamedResultsReader(const std::vector<ResultStream> &rStreams)
+    {
+        for (size_t i=0; i<rStreams.size(); ++i)
+        {
+            BinaryLogFileReader *pReader = new BinaryLogFileReader();
+            if (!pReader->open(rStreams[i].pSink->getFilePath()))
+            {
+                printErrorMessage("Could not read streamed results from: " + string(rStreams[i].pSink->getFilePath().c_str()));
+            }
+            mReaders.push_back(pReader);
+            mSystemStreams[rStreams[i].pSystem] = i;
+
+            const vector<LogSinkVariable> &rVariables = pReader->getVariables();
+            for (size_t v=0; v<rVariables.size(); ++v)
+            {
+                Component *pComp = rStreams[i].pSystem->getSubComponent(rVariables[v].mComponent);
+                if (!pComp)
+                {
+                    pComp = rStreams[i].pSystem;
+                }
+                Port *pPort = pComp->getPort(rVariables[v].mPort);
+                // Variables named after a multiport can not be mapped to a node, they are not exported from memory either
+                if (pPort && !pPort->isMultiPort() && pPort->getNodePtr())
+                {
+                    const int dataId = pPort->getNodeDataIdFromName(rVariables[v].mName);
+                    if (dataId >= 0)
+                    {
+                        mVariables[std::make_pair(pPort->getNodePtr(), size_t(dataId))] = std::make_pair(i, v);
+                    }
+                }
+            }
+        }
+    }
+
+    ~StreamedResultsReader()
+    {
+        for (size_t i=0; i<mReaders.size(); ++i)
+        {
+            delete mReaders[i];
+        }
+    }
+
+    bool readTime(const ComponentSystem *pSys, vector<double> &rTime)
+    {
+        std::map<const ComponentSystem*, size_t>::iterator it = mSystemStreams.find(pSys);
+        return (it != mSystemStreams.end()) && (mReaders[it->second]->getNumSamples() > 0) && mReaders[it->second]->readTime(rTime);
+    }
+
+    //! @brief Read the streamed data of a port variable
+    //! @returns False if the variable was not logged
+    bool readVariable(Port *pPort, const size_t dataId, vector<double> &rValues)
+    {
+        std::map<std::pair<const Node*, size_t>, std::pair<size_t, size_t> >::iterator it = mVariables.find(std::make_pair(pPort->getNodePtr(), dataId));
+        return (it != mVariables.end()) && mReaders[it->second.first]->readVariable(it->second.second, rValues);
+    }
+
+private:
+    std::vector<BinaryLogFileReader*> mReaders;
+    std::map<const ComponentSystem*, size_t> mSystemStreams;
+    std::map<std::pair<const Node*, size_t>, std::pair<size_t, size_t> > mVariables;
+};
+
+void saveStreamedResults(ComponentSystem *pSys, StreamedResultsReader &rReader, const std::vector<string>& includeFilter,
+                         const std::string &prefix, ofstream &rFile)
+{
+    // First save time vector for this system
+    vector<double> values;
+    if (rReader.readTime(pSys, values))
+    {
+        rFile << prefix.c_str() << "Time,,s";
+        for (size_t t=0; t<values.size(); ++t)
+        {
+            rFile << "," << std::scientific << values[t];
+        }
+        rFile << endl;
+    }
+
+    // Now save log data for all subcomponents, in the same order as saveResults()
+    vector<HString> names = pSys->getSubComponentNames();
+    for (size_t c=0; c<names.size(); ++c)
+    {
+        Component *pComp = pSys->getSubComponent(names[c]);
+        if (pComp)
+        {
+            vector<Port*> ports = pComp->getPortPtrVector();
+            for (size_t p=0; p<ports.size(); ++p)
+            {
+                Port *pPort = ports[p];
+                if (!pPort->isLoggingEnabled())
+                {
+                    continue;
+                }
+
+                HString fullPortName = prefix.c_str() + pComp->getName() + "#" + pPort->getName();
+                const bool includeAllVariablesInThisPort = includeFilter.empty() || contains(includeFilter, fullPortName.c_str());
+                const vector<NodeDataDescription> *pVars = pPort->getNodeDataDescriptions();
+                for (size_t v=0; pVars && v<pVars->size(); ++v)
+                {
+                    HString fullVarName = fullPortName + "#" + pVars->at(v).name;
+                    if (!(includeAllVariablesInThisPort || contains(includeFilter, fullVarName.c_str())))
+                    {
+                        continue;
+                    }
+                    if (rReader.readVariable(pPort, v, values))
+                    {
+                        rFile << fullVarName.c_str() << "," << pPort->getVariableAlias(v).c_str() << "," << pVars->at(v).unit.c_str();
+                        for (size_t t=0; t<values.size(); ++t)
+                        {
+                            rFile << "," << std::scientific << values[t];
+                        }
+                        rFile << endl;
+                    }
+                }
+            }
+
+            // Recurse into subsystems
+            if (pComp->isComponentSystem())
+            {
+                saveStreamedResults(static_cast<ComponentSystem*>(pComp), rReader, includeFilter, prefix+pComp->getName().c_str()+"$", rFile);
+            }
+        }
+    }
+}
+
+}
+
+//! @brief Save streamed results to CSV (all logged data), the output is the same as from saveResults() with Full
+//! @details Only one variable at a time is read from the streamed files
+//! @param [in] rStreams The streams from attachResultStreams(), the systems must have been finalized
+//! @param [in] rFileName File name for output file
+//! @param [in] includeFilter Full port or variable names to include, empty means all
+void saveStreamedResults(const std::vector<ResultStream> &rStreams, const string &rFileName, const std::vector<string> &includeFilter)
+{
+    if (rStreams.empty())
+    {
+        return;
+    }
+    ofstream file(rFileName.c_str());
+    if (!file.good())
+    {
+        printErrorMessage("Could not open: " + rFileName + " for writing!");
+        return;
+    }
+    StreamedResultsReader reader(rStreams);
+    saveStreamedResults(rStreams.front().pSystem, reader, includeFilter, rStreams.front().prefix, file);
+}
+
+//! @brief Save streamed results to HDF5 (all logged data), the output is the same as from saveResultsToHDF5() with Full
+//! @param [in] rStreams The streams from attachResultStreams(), the systems must have been finalized
+//! @param [in] rFileName File name for output file
+void saveStreamedResultsToHDF5(const std::vector<ResultStream> &rStreams, const string &rFileName)
+{
+#ifdef USEHDF5
+    if (rStreams.empty()) {
+        return;
+    }
+    ComponentSystem *pSys = rStreams.front().pSystem;
+    HopsanHDF5Exporter *pExporter = new HopsanHDF5Exporter(rFileName.c_str(), pSys->getName().c_str(), std::string("HopsanCLI "+std::string(HOPSANCLIVERSION)).c_str());
+    StreamedResultsReader reader(rStreams);
+
+    //Store time vetor
+    vector<double> values;
+    if (reader.readTime(pSys, values))
+    {
+        HString s,c,p;
+        HVector<double> timeVector(values);
+        pExporter->addVariable(s,c,p,"Time","","s","Time",timeVector);
+    }
+
+    //Store data vectors
+    vector<Component*> components;
+    pSys->getSubComponentsRecursively(components);
+    for (const auto pComp : components) {
+        if (pComp) {
+            vector<Port*> ports = pComp->getPortPtrVector();
+            for (size_t p=0; p<ports.size(); ++p)
+            {
+                Port *pPort = ports[p];
+                if (!pPort->isLoggingEnabled())
+                {
+                    continue;
+                }
+                const vector<NodeDataDescription> *pVars = pPort->getNodeDataDescriptions();
+                for (size_t v=0; pVars && v<pVars->size(); ++v)
+                {
+                    if (!reader.readVariable(pPort, v, values)) {
+                        continue;
+                    }
+
+                    //Generate system hierarchy string (point separated)
+                    HString systemHierarchy;
+                    ComponentSystem *pParentSystem = pComp->getSystemParent();
+                    while(pParentSystem != nullptr && pParentSystem->getSystemParent() != nullptr) {
+                        systemHierarchy = pParentSystem->getName()+"."+systemHierarchy;
+                        pParentSystem = pParentSystem->getSystemParent();
+                    }
+                    if(!systemHierarchy.empty()) {
+                        systemHierarchy.erase(systemHierarchy.size()-1,1);
+                    }
+
+                    HVector<double> dataVector(values);
+                    pExporter->addVariable(systemHierarchy, pComp->getName(), pPort->getName(), pVars->at(v).name, pPort->getVariableAlias(v).c_str(), pVars->at(v).unit, pVars->at(v).quantity, dataVector);
+                }
+            }
+        }
+    }
+
+    pExporter->writeToFile();
+    delete pExporter;
+#else
+    printErrorMessage("HopsanCLI was built without HDF5 support");
+#endif
+}
@@ -48,6 +48,23 @@ void saveResults(hopsan::ComponentSystem *pSys, const std::string &rFileName, co
                  std::string prefix="", std::ofstream *pFile=0);
 void saveResultsToHDF5(hopsan::ComponentSystem *pSys, const std::string &rFileName, const SaveResults howMany);
 void transposeCSVresults(const std::string &rFileName);
+
+// ===== Streamed results =====
+namespace hopsan {
+class BinaryFileLogSink;
+}
+//! @brief A system whose log data is streamed to a temporary file during simulation
+struct ResultStream
+{
+    hopsan::ComponentSystem *pSystem;
+    std::string prefix;
+    hopsan::BinaryFileLogSink *pSink;
+};
+void attachResultStreams(hopsan::ComponentSystem *pSys, const std::string &rDirectory, std::vector<ResultStream> &rStreams,
+                         const std::string &prefix="");
+void detachResultStreams(std::vector<ResultStream> &rStreams);
+void saveStreamedResults(const std::vector<ResultStream> &rStreams, const std::string &rFileName, const std::vector<std::string> &includeFilter);
+void saveStreamedResultsToHDF5(const std::vector<ResultStream> &rStreams, const std::string &rFileName);
 void exportParameterValuesToCSV(const std::string &rFileName, hopsan::ComponentSystem* pSystem, std::string prefix="", std::ofstream *pFile=0);
 
 // ===== Load Functions =====
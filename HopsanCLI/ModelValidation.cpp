@@ -141,19 +141,19 @@ bool exportHVCData(const string modelpath, const string baseFilePath, const std:
             appendValueNode(pVariableNode, "tolerance", to_string(tol));
 
             // Write data line to csv
-            std::vector< std::vector<double> > *pLogData = rPorts[p]->getLogDataVectorPtr();
+            LogDataStorage *pLogData = rPorts[p]->getLogDataVectorPtr();
             if (pLogData &&  pLogData->size() > 0)
             {
                 size_t nRows = pLogData->size();
-                size_t nCols = pLogData->front().size();
+                size_t nCols = pLogData->getNumVariables();
                 const size_t c = rDataIds[p];
                 if (rDataIds[p] < nCols)
                 {
                     for (size_t r=0; r<nRows-1; ++r)
                     {
-                        csvFile << std::scientific << (*pLogData)[r][c] << ", ";
+                        csvFile << std::scientific << pLogData->value(r, c) << ", ";
                     }
-                    csvFile << std::scientific << (*pLogData)[nRows-1][c] << std::endl;
+                    csvFile << std::scientific << pLogData->value(nRows-1, c) << std::endl;
                     ++csvRow;
                 }
             }
@@ -305,11 +305,11 @@ bool extractTestData(ComponentSystem *pRootSystem, string fullVarName, std::vect
         printErrorMessage("No such varaiable name: " + varName + " in: " + pPort->getNodeType().c_str());
         return false;
     }
-    vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
+    LogDataStorage *pLogData = pPort->getLogDataVectorPtr();
     rvSim.reserve(rvTime.size());
     for(size_t i=0; i<rvTime.size(); ++i)
     {
-        rvSim.push_back(pLogData->at(i).at(dataId));
+        rvSim.push_back(pLogData->value(i, dataId));
     }
     return true;
 }
@@ -491,9 +491,11 @@ bool performModelTest(const std::string hvcFilePath)
                                     return false;
                                 }
 
+                                LogDataStorage *pLogData = pPort->getLogDataVectorPtr();
+                                vSim1.reserve(vTime.size());
                                 for(size_t i=0; i<vTime.size(); ++i)
                                 {
-                                    vSim1.push_back(pRootSystem->getSubComponent(compName.c_str())->getPort(portName.c_str())->getLogDataVectorPtr()->at(i).at(dataId));
+                                    vSim1.push_back(pLogData->value(i, dataId));
                                 }
 
                                 //Second simulation
@@ -509,9 +511,10 @@ bool performModelTest(const std::string hvcFilePath)
                                 }
                                 pRootSystem->finalize();
 
+                                vSim2.reserve(vTime.size());
                                 for(size_t i=0; i<vTime.size(); ++i)
                                 {
-                                    vSim2.push_back(pRootSystem->getSubComponent(compName.c_str())->getPort(portName.c_str())->getLogDataVectorPtr()->at(i).at(dataId));
+                                    vSim2.push_back(pLogData->value(i, dataId));
                                 }
 
                                 // Print the messages if there were any errors or warnings
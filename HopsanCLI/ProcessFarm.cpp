@@ -0,0 +1,484 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   HopsanCLI/ProcessFarm.cpp
+//! @date   2026-10-18
+//!
+//! @brief Contains a farm of local worker processes for evaluating optimization candidates
+//!
+//$Id$
+
+#include "ProcessFarm.h"
+#include "CliUtilities.h"
+
+#include <cstdio>
+#include <iostream>
+#include <stdint.h>
+
+#if !defined(_WIN32)
+  #include <errno.h>
+  #include <poll.h>
+  #include <signal.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
+
+namespace {
+
+struct RequestHeader
+{
+    uint64_t id;
+    uint64_t numParameters;
+};
+
+struct Result
+{
+    uint64_t id;
+    double value;
+};
+
+#if !defined(_WIN32)
+bool writeAll(int fd, const void *pData, size_t size)
+{
+    const char *pBytes = static_cast<const char*>(pData);
+    while(size > 0)
+    {
+        const ssize_t n = write(fd, pBytes, size);
+        if(n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n <= 0)
+        {
+            return false;
+        }
+        pBytes += n;
+        size -= size_t(n);
+    }
+    return true;
+}
+
+bool readAll(int fd, void *pData, size_t size)
+{
+    char *pBytes = static_cast<char*>(pData);
+    while(size > 0)
+    {
+        const ssize_t n = read(fd, pBytes, size);
+        if(n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n <= 0)
+        {
+            return false;
+        }
+        pBytes += n;
+        size -= size_t(n);
+    }
+    return true;
+}
+
+//! @brief Wait for a child process to exit
+//! @returns False if the process had not exited within the timeout
+bool waitForExit(pid_t pid, int timeoutMs)
+{
+    for(int t=0; t<timeoutMs; t+=10)
+    {
+        const pid_t rc = waitpid(pid, 0, WNOHANG);
+        if(rc == pid || (rc < 0 && errno != EINTR))
+        {
+            return true;
+        }
+        usleep(10000);
+    }
+    return false;
+}
+#endif
+
+//! @brief Time in ms that a worker process gets to exit before it is killed
+const int gStopProcessTimeoutMs = 1000;
+
+}
+
+
+ProcessFarm::ProcessFarm()
+{
+    mNumPendingTasks = 0;
+}
+
+
+ProcessFarm::~ProcessFarm()
+{
+    stop();
+}
+
+
+//! @brief Check if worker processes can be used on this platform
+bool ProcessFarm::isSupported()
+{
+#if defined(_WIN32)
+    return false;
+#else
+    return true;
+#endif
+}
+
+
+//! @brief Fork the worker processes
+//! @param[in] nProcesses Number of worker processes
+//! @param[in] evaluate Function that evaluates a parameter vector, it is called in the worker processes
+//! @returns False if the worker processes could not be started
+bool ProcessFarm::start(size_t nProcesses, EvaluateFunctionT evaluate)
+{
+    stop();
+    if(!isSupported() || nProcesses == 0)
+    {
+        return false;
+    }
+
+#if !defined(_WIN32)
+    // A worker process that has terminated must not terminate the parent when its request pipe is written to
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    mEvaluate = evaluate;
+    mProcesses.resize(nProcesses);
+    for(size_t p=0; p<mProcesses.size(); ++p)
+    {
+        mProcesses[p].pid = -1;
+        mProcesses[p].requestFd = -1;
+        mProcesses[p].resultFd = -1;
+        mProcesses[p].busy = false;
+        mProcesses[p].taskId = 0;
+    }
+    for(size_t p=0; p<mProcesses.size(); ++p)
+    {
+        if(!startProcess(mProcesses[p]))
+        {
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! @brief Stop all worker processes, pending tasks are discarded
+void ProcessFarm::stop()
+{
+    for(size_t p=0; p<mProcesses.size(); ++p)
+    {
+        stopProcess(mProcesses[p]);
+    }
+    mProcesses.clear();
+    mQueuedTasks.clear();
+    mFailedTasks.clear();
+    mNumPendingTasks = 0;
+}
+
+
+size_t ProcessFarm::getNumberOfProcesses() const
+{
+    return mProcesses.size();
+}
+
+
+//! @brief Returns the number of submitted tasks whose results have not been returned by waitForResult()
+size_t ProcessFarm::getNumberOfPendingTasks() const
+{
+    return mNumPendingTasks;
+}
+
+
+//! @brief Submit a parameter vector for evaluation by the first idle worker process
+//! @param[in] id Identifier that is returned together with the result
+//! @param[in] rParameters Parameter values, they are copied
+void ProcessFarm::submit(size_t id, const std::vector<double> &rParameters)
+{
+    mQueuedTasks.push_back(std::make_pair(id, rParameters));
+    ++mNumPendingTasks;
+    dispatchTasks();
+}
+
+
+//! @brief Wait for any submitted task to finish
+//! @param[out] rId Identifier of the finished task
+//! @param[out] rResult The evaluated value, only valid if the task did not fail
+//! @param[out] rFailed True if the worker process terminated while evaluating the task
+//! @returns False if there are no pending tasks
+bool ProcessFarm::waitForResult(size_t &rId, double &rResult, bool &rFailed)
+{
+    if(!mFailedTasks.empty())
+    {
+        rId = mFailedTasks.front().first;
+        rResult = mFailedTasks.front().second;
+        rFailed = true;
+        mFailedTasks.pop_front();
+        --mNumPendingTasks;
+        return true;
+    }
+    if(mNumPendingTasks == 0)
+    {
+        return false;
+    }
+
+#if !defined(_WIN32)
+    while(true)
+    {
+        std::vector<pollfd> pollFds;
+        std::vector<size_t> processIds;
+        for(size_t p=0; p<mProcesses.size(); ++p)
+        {
+            if(mProcesses[p].busy)
+            {
+                pollfd pfd;
+                pfd.fd = mProcesses[p].resultFd;
+                pfd.events = POLLIN;
+                pfd.revents = 0;
+                pollFds.push_back(pfd);
+                processIds.push_back(p);
+            }
+        }
+        if(pollFds.empty())
+        {
+            return false;
+        }
+        if(poll(&pollFds[0], pollFds.size(), -1) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        for(size_t i=0; i<pollFds.size(); ++i)
+        {
+            if(pollFds[i].revents == 0)
+            {
+                continue;
+            }
+            Process &rProcess = mProcesses[processIds[i]];
+            Result result;
+            rId = rProcess.taskId;
+            rProcess.busy = false;
+            --mNumPendingTasks;
+            if(readAll(rProcess.resultFd, &result, sizeof(result)) && result.id == rId)
+            {
+                rResult = result.value;
+                rFailed = false;
+            }
+            else
+            {
+                printWarningMessage("Evaluation process " + std::to_string(rProcess.pid) + " terminated unexpectedly, starting a new one");
+                stopProcess(rProcess, true);
+                startProcess(rProcess);
+                rResult = 0;
+                rFailed = true;
+            }
+            dispatchTasks();
+            return true;
+        }
+    }
+#else
+    return false;
+#endif
+}
+
+
+bool ProcessFarm::startProcess(Process &rProcess)
+{
+#if !defined(_WIN32)
+    int requestPipe[2], resultPipe[2];
+    if(pipe(requestPipe) != 0)
+    {
+        return false;
+    }
+    if(pipe(resultPipe) != 0)
+    {
+        close(requestPipe[0]);
+        close(requestPipe[1]);
+        return false;
+    }
+
+    // Buffered output would otherwise be written by both processes
+    std::cout.flush();
+    fflush(stdout);
+
+    const pid_t pid = fork();
+    if(pid < 0)
+    {
+        close(requestPipe[0]);
+        close(requestPipe[1]);
+        close(resultPipe[0]);
+        close(resultPipe[1]);
+        return false;
+    }
+    if(pid == 0)
+    {
+        // The worker process must not keep the pipes of the other worker processes open, or they would not detect when the
+        // parent stops them
+        for(size_t p=0; p<mProcesses.size(); ++p)
+        {
+            if(mProcesses[p].requestFd >= 0) close(mProcesses[p].requestFd);
+            if(mProcesses[p].resultFd >= 0) close(mProcesses[p].resultFd);
+        }
+        close(requestPipe[1]);
+        close(resultPipe[0]);
+        runWorkerLoop(requestPipe[0], resultPipe[1]);
+        std::cout.flush();
+        fflush(stdout);
+        _exit(0);
+    }
+
+    close(requestPipe[0]);
+    close(resultPipe[1]);
+    rProcess.pid = pid;
+    rProcess.requestFd = requestPipe[1];
+    rProcess.resultFd = resultPipe[0];
+    rProcess.busy = false;
+    return true;
+#else
+    (void)rProcess;
+    return false;
+#endif
+}
+
+
+//! @brief Stop a worker process and close its pipes
+//! @param[in] terminate Terminate the process even if it is idle, used when it has failed
+void ProcessFarm::stopProcess(Process &rProcess, bool terminate)
+{
+#if !defined(_WIN32)
+    // Closing the request pipe makes the worker process exit when it is idle
+    if(rProcess.requestFd >= 0)
+    {
+        close(rProcess.requestFd);
+    }
+    if(rProcess.resultFd >= 0)
+    {
+        close(rProcess.resultFd);
+    }
+    if(rProcess.pid > 0)
+    {
+        // A busy or failed worker process may never read the closed pipe, so it is asked to terminate, and killed if it does not
+        if(terminate || rProcess.busy)
+        {
+            kill(rProcess.pid, SIGTERM);
+        }
+        if(!waitForExit(rProcess.pid, gStopProcessTimeoutMs))
+        {
+            kill(rProcess.pid, SIGKILL);
+            waitpid(rProcess.pid, 0, 0);
+        }
+    }
+#endif
+    rProcess.pid = -1;
+    rProcess.requestFd = -1;
+    rProcess.resultFd = -1;
+    rProcess.busy = false;
+}
+
+
+//! @brief Send queued tasks to idle worker processes
+void ProcessFarm::dispatchTasks()
+{
+#if !defined(_WIN32)
+    // A task that could not be sent is sent again to the new worker process, it has not been evaluated
+    bool isRetry = false;
+    for(size_t p=0; p<mProcesses.size() && !mQueuedTasks.empty(); ++p)
+    {
+        Process &rProcess = mProcesses[p];
+        if(rProcess.busy || rProcess.pid < 0)
+        {
+            continue;
+        }
+
+        const size_t id = mQueuedTasks.front().first;
+        const std::vector<double> &rParameters = mQueuedTasks.front().second;
+
+        RequestHeader header;
+        header.id = id;
+        header.numParameters = rParameters.size();
+        if(writeAll(rProcess.requestFd, &header, sizeof(header)) &&
+           (rParameters.empty() || writeAll(rProcess.requestFd, &rParameters[0], rParameters.size()*sizeof(double))))
+        {
+            rProcess.busy = true;
+            rProcess.taskId = id;
+            mQueuedTasks.pop_front();
+            isRetry = false;
+        }
+        else
+        {
+            printWarningMessage("Evaluation process " + std::to_string(rProcess.pid) + " terminated unexpectedly, starting a new one");
+            stopProcess(rProcess, true);
+            startProcess(rProcess);
+            // Only retry once, so that a task that can never be sent does not restart worker processes forever
+            if(isRetry)
+            {
+                mFailedTasks.push_back(std::make_pair(id, 0.0));
+                mQueuedTasks.pop_front();
+                isRetry = false;
+            }
+            else
+            {
+                isRetry = true;
+            }
+            --p;
+        }
+    }
+#endif
+}
+
+
+//! @brief Evaluates requests until the request pipe is closed, runs in the worker processes
+void ProcessFarm::runWorkerLoop(int requestFd, int resultFd)
+{
+#if !defined(_WIN32)
+    RequestHeader header;
+    while(readAll(requestFd, &header, sizeof(header)))
+    {
+        std::vector<double> parameters(header.numParameters);
+        if(!parameters.empty() && !readAll(requestFd, &parameters[0], parameters.size()*sizeof(double)))
+        {
+            break;
+        }
+
+        Result result;
+        result.id = header.id;
+        result.value = mEvaluate(parameters);
+        if(!writeAll(resultFd, &result, sizeof(result)))
+        {
+            break;
+        }
+    }
+    close(requestFd);
+    close(resultFd);
+#else
+    (void)requestFd;
+    (void)resultFd;
+#endif
+}
@@ -0,0 +1,87 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   HopsanCLI/ProcessFarm.h
+//! @date   2026-10-18
+//!
+//! @brief Contains a farm of local worker processes for evaluating optimization candidates
+//!
+//$Id$
+
+#ifndef PROCESSFARM_H
+#define PROCESSFARM_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <vector>
+
+//! @brief Evaluates parameter vectors in forked worker processes, that communicate with the parent through pipes
+//! @details Each worker process is forked from the parent after the model has been loaded, so the model is only loaded once
+//! and every process has its own copy of it. A task that makes a worker process terminate (for example a crashing FMU) is
+//! reported as failed, and a new worker process is forked in its place. Only available on POSIX systems.
+class ProcessFarm
+{
+public:
+    typedef std::function<double(const std::vector<double> &)> EvaluateFunctionT;
+
+    ProcessFarm();
+    ~ProcessFarm();
+
+    static bool isSupported();
+
+    bool start(size_t nProcesses, EvaluateFunctionT evaluate);
+    void stop();
+
+    size_t getNumberOfProcesses() const;
+    size_t getNumberOfPendingTasks() const;
+
+    void submit(size_t id, const std::vector<double> &rParameters);
+    bool waitForResult(size_t &rId, double &rResult, bool &rFailed);
+
+private:
+    struct Process
+    {
+        int pid;
+        int requestFd;
+        int resultFd;
+        bool busy;
+        size_t taskId;
+    };
+
+    bool startProcess(Process &rProcess);
+    void stopProcess(Process &rProcess, bool terminate=false);
+    void dispatchTasks();
+    void runWorkerLoop(int requestFd, int resultFd);
+
+    EvaluateFunctionT mEvaluate;
+    std::vector<Process> mProcesses;
+    std::deque<std::pair<size_t, std::vector<double> > > mQueuedTasks;
+    std::deque<std::pair<size_t, double> > mFailedTasks;
+    size_t mNumPendingTasks;
+};
+
+#endif // PROCESSFARM_H
@@ -40,12 +40,22 @@
 #include "TicToc.hpp"
 #include "version_cli.h"
 #include "CoreUtilities/SaveRestoreSimulationPoint.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
 
 #include "CliUtilities.h"
 #include "ModelValidation.h"
 #include "BuildUtilities.h"
 
 #ifdef USEOPS
+#include <deque>
+#include <limits>
+#if defined(HOPSANCORE_USEMULTITHREADING)
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+#include "ProcessFarm.h"
 #include "OpsWorker.h"
 #include "OpsEvaluator.h"
 #include "OpsMessageHandler.h"
@@ -58,6 +68,7 @@
 #include "OpsWorkerParticleSwarm.h"
 #include "OpsWorkerParameterSweep.h"
 #include "OpsWorkerGenetic.h"
+#include "OpsWorkerSurrogate.h"
 #endif
 
 #ifndef DEFAULT_LIBRARY_ROOT
@@ -101,18 +112,34 @@ public:
         if(mSilent) return;
         double best = mpWorker->getObjectiveValue(mpWorker->getBestId());
         double worst = mpWorker->getObjectiveValue(mpWorker->getWorstId());
-        cout << "Step: " << step << "/" << mMaxEvals << " Best: " << best << " Worst: " << worst << endl;
+        cout << "Step: " << step << "/" << mMaxEvals << " Best: " << best << " Worst: " << worst;
+        if(mNumCacheLookups > 0)
+        {
+            cout << " Cache hits: " << mNumCacheHits << "/" << mNumCacheLookups;
+        }
+        cout << endl;
+    }
+    void cacheStatisticsChanged(size_t nHits, size_t nLookups)
+    {
+        mNumCacheHits = nHits;
+        mNumCacheLookups = nLookups;
     }
 
 private:
     Ops::Worker *mpWorker;
     size_t mMaxEvals;
     bool mSilent;
+    size_t mNumCacheHits = 0;
+    size_t mNumCacheLookups = 0;
 };
 
+//! @brief Objective value of candidates that made an evaluation process terminate
+static const double gFailedEvaluationObjective = std::numeric_limits<double>::max();
+
 class OptimizationEvaluator : public Ops::Evaluator
 {
 public:
+    //! @param rootSystemPtrs One copy of the model per evaluation thread
     OptimizationEvaluator(vector<ComponentSystem *> rootSystemPtrs,
                           vector<string> parNames,
                           vector<string> objComps,
@@ -133,82 +160,365 @@ public:
         mEvaulationCounter = 0;
         mStartTime = startTime;
         mStopTime = stopTime;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        mNumSubmitted = 0;
+        mStopThreads = false;
+#endif
     }
 
-    //! @todo Make evaluateAll... work in parallel
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    ~OptimizationEvaluator()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mTaskMutex);
+            mStopThreads = true;
+        }
+        mTaskAdded.notify_all();
+        for(size_t t=0; t<mEvaluationThreads.size(); ++t)
+        {
+            mEvaluationThreads[t].join();
+        }
+    }
+#endif
+
+    void evaluateAllPoints()
+    {
+        Ops::Worker *pWorker = mpWorker;
+        vector<vector<double> > &rPoints = pWorker->getPoints();
+        vector<double> &rObjectives = pWorker->getObjectiveValues();
+        evaluatePoints(rPoints, [&rObjectives](size_t p, double obj) { rObjectives[p] = obj; });
+
+        // Leave the candidates the same way as the default implementation does, some workers depend on it
+        vector<vector<double> > &rCandidatePoints = pWorker->getCandidatePoints();
+        if(pWorker->getNumberOfCandidates() == pWorker->getNumberOfPoints())
+        {
+            rCandidatePoints = rPoints;
+            for(size_t c=0; c<rObjectives.size(); ++c)
+            {
+                pWorker->setCandidateObjectiveValue(c, rObjectives[c]);
+            }
+        }
+        else if(!rPoints.empty())
+        {
+            rCandidatePoints[0] = rPoints.back();
+            pWorker->setCandidateObjectiveValue(0, rObjectives.back());
+        }
+    }
 
-    //void evaluateAllPoints();
     void evaluateCandidate(size_t idx)
     {
-        for(size_t i=0; i<mpWorker->getNumberOfParameters(); ++i)
+        Ops::Worker *pWorker = mpWorker;
+        const vector<vector<double> > candidate(1, pWorker->getCandidatePoints().at(idx));
+        evaluatePoints(candidate, [pWorker, idx](size_t, double obj) { pWorker->setCandidateObjectiveValue(idx, obj); });
+    }
+
+    void evaluateAllCandidates()
+    {
+        Ops::Worker *pWorker = mpWorker;
+        evaluatePoints(pWorker->getCandidatePoints(), [pWorker](size_t c, double obj) { pWorker->setCandidateObjectiveValue(c, obj); });
+    }
+
+    //! @brief Evaluate candidates in worker processes forked from this process, instead of in threads
+    //! @details Each worker process gets its own copy of the first model copy, as it is when this is called
+    //! @param[in] nProcesses Number of worker processes
+    //! @returns False if the worker processes could not be started
+    bool startProcessFarm(size_t nProcesses)
+    {
+        ComponentSystem *pSystem = mRootSystemPtrs.at(0);
+        return mProcessFarm.start(nProcesses, [this, pSystem](const vector<double> &rParameters) { return evaluate(pSystem, rParameters); });
+    }
+
+    //! @brief Add a copy of the model for an additional evaluation thread, must not be called while candidates are evaluated
+    void addModelCopy(ComponentSystem *pSystem)
+    {
+        mRootSystemPtrs.push_back(pSystem);
+    }
+
+    //! @brief Returns the number of worker processes or model copies, which is the number of candidates that can be evaluated at the same time
+    size_t getMaxNumberOfPendingCandidates()
+    {
+        if(mProcessFarm.getNumberOfProcesses() > 0)
+        {
+            return mProcessFarm.getNumberOfProcesses();
+        }
+        return mRootSystemPtrs.size();
+    }
+
+    //! @brief Queue a candidate for evaluation by the first idle worker process or model copy
+    //! @details The candidate parameters are copied, so the worker may change other candidates while this one is evaluated.
+    //! The synchronous evaluate functions must not be used while there are submitted candidates that have not been waited for.
+    void submitCandidate(size_t idx)
+    {
+        if(mProcessFarm.getNumberOfProcesses() == 0 && mRootSystemPtrs.size() < 2)
+        {
+            Ops::Evaluator::submitCandidate(idx);
+            return;
+        }
+
+        // Cached candidates are returned directly by waitForCandidate()
+        const vector<double> &rCandidate = mpWorker->getCandidatePoints().at(idx);
+        double obj;
+        if(findCachedObjective(rCandidate, obj))
+        {
+            mCachedTasks.push_back(std::make_pair(idx, obj));
+            return;
+        }
+
+        if(mProcessFarm.getNumberOfProcesses() > 0)
         {
-            double par = mpWorker->getCandidateParameter(idx, i);
-            if(!mRootSystemPtrs.at(0)->setParameterValue(HString(mParNames[i].c_str()), HString(std::to_string(par).c_str())))
+            mProcessFarm.submit(idx, rCandidate);
+            return;
+        }
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        {
+            std::lock_guard<std::mutex> lock(mTaskMutex);
+            if(mEvaluationThreads.empty())
             {
-                cout << "Error: Parameter " << mParNames[i] << " not found in model." << endl;
+                for(size_t t=0; t<mRootSystemPtrs.size(); ++t)
+                {
+                    mEvaluationThreads.push_back(std::thread(&OptimizationEvaluator::evaluationThreadLoop, this, mRootSystemPtrs[t]));
+                }
             }
+            mPendingTasks.push_back(std::make_pair(idx, rCandidate));
+            ++mNumSubmitted;
+            mTaskAdded.notify_one();
         }
+#endif
+    }
 
-        mRootSystemPtrs.at(0)->initialize(mStartTime,mStopTime);
-        mRootSystemPtrs.at(0)->simulate(mStopTime);
+    //! @brief Wait for any submitted candidate to finish, its objective value is set from the calling thread
+    bool waitForCandidate(size_t &rIdx)
+    {
+        if(mProcessFarm.getNumberOfProcesses() == 0 && mRootSystemPtrs.size() < 2)
+        {
+            return Ops::Evaluator::waitForCandidate(rIdx);
+        }
+
+        if(!mCachedTasks.empty())
+        {
+            rIdx = mCachedTasks.front().first;
+            mpWorker->setCandidateObjectiveValue(rIdx, mCachedTasks.front().second);
+            mCachedTasks.pop_front();
+            return true;
+        }
+
+        double obj;
+        bool failed = false;
+        if(mProcessFarm.getNumberOfProcesses() > 0)
+        {
+            if(!mProcessFarm.waitForResult(rIdx, obj, failed))
+            {
+                return false;
+            }
+        }
+        else if(!waitForEvaluationThread(rIdx, obj))
+        {
+            return false;
+        }
+
+        if(failed)
+        {
+            obj = gFailedEvaluationObjective;
+        }
+        else
+        {
+            addCachedObjective(mpWorker->getCandidatePoints().at(rIdx), obj);
+        }
+        mpWorker->setCandidateObjectiveValue(rIdx, obj);
+        ++mEvaulationCounter;
+        return true;
+    }
+
+    size_t getNumberOfEvaluations() { return mEvaulationCounter; }
+
+private:
+    //! @brief Set the parameters in one model copy, simulate it and return the objective value
+    double evaluate(ComponentSystem *pSystem, const vector<double> &rParameters)
+    {
+        for(size_t i=0; i<rParameters.size() && i<mParNames.size(); ++i)
+        {
+            if(!pSystem->setParameterValue(HString(mParNames[i].c_str()), HString(std::to_string(rParameters[i]).c_str())))
+            {
+                printErrorMessage("Parameter " + mParNames[i] + " not found in model.");
+            }
+        }
+
+        pSystem->initialize(mStartTime,mStopTime);
+        pSystem->simulate(mStopTime);
 
         double obj = 0.0;
         for(size_t i=0; i<mObjComps.size(); ++i)
         {
             int portId = 0;
-            Component *pComp = mRootSystemPtrs.at(0)->getSubComponent(mObjComps[i].c_str());
+            Component *pComp = pSystem->getSubComponent(mObjComps[i].c_str());
             Port *pPort = pComp->getPort(mObjPorts[i].c_str());
             double data = *pPort->getNodeDataPtr(portId);
             obj += mObjWeights[i]*data;
         }
-        mpWorker->setCandidateObjectiveValue(idx, obj);
-
-        ++mEvaulationCounter;
+        return obj;
     }
 
-    void evaluateAllCandidates()
+    //! @brief Evaluate points concurrently, each worker process or thread simulates its own model copy
+    //! @details Points found in the cache are not simulated. The other points are handed out one at a time, so processes or
+    //! threads that finish early take more points. The objective of each evaluated point is passed to setObjective, from the
+    //! calling thread. Points are skipped if the optimization is aborted.
+    template<typename SetObjectiveT>
+    void evaluatePoints(const vector<vector<double> > &rPoints, SetObjectiveT setObjective)
     {
-        for(size_t c=0; c<mpWorker->getNumberOfCandidates(); ++c)
+        vector<size_t> uncachedPoints;
+        for(size_t p=0; p<rPoints.size(); ++p)
+        {
+            double obj;
+            if(findCachedObjective(rPoints[p], obj))
+            {
+                setObjective(p, obj);
+            }
+            else
+            {
+                uncachedPoints.push_back(p);
+            }
+        }
+
+        if(mProcessFarm.getNumberOfProcesses() > 0)
         {
-            for(size_t i=0; i<mpWorker->getNumberOfParameters(); ++i)
+            size_t nSubmitted = 0;
+            for(; nSubmitted<uncachedPoints.size() && nSubmitted<mProcessFarm.getNumberOfProcesses(); ++nSubmitted)
             {
-                double par = mpWorker->getCandidateParameter(c, i);
-                if(!mRootSystemPtrs.at(c)->setParameterValue(HString(mParNames[i].c_str()), HString(std::to_string(par).c_str())))
+                mProcessFarm.submit(nSubmitted, rPoints[uncachedPoints[nSubmitted]]);
+            }
+            size_t u;
+            double obj;
+            bool failed;
+            while(mProcessFarm.waitForResult(u, obj, failed))
+            {
+                if(failed)
                 {
-                    cout << "Error: Parameter " << mParNames[i] << " not found in model." << endl;
+                    obj = gFailedEvaluationObjective;
+                }
+                else
+                {
+                    addCachedObjective(rPoints[uncachedPoints[u]], obj);
+                }
+                setObjective(uncachedPoints[u], obj);
+                ++mEvaulationCounter;
+                if(nSubmitted < uncachedPoints.size() && !mpWorker->aborted())
+                {
+                    mProcessFarm.submit(nSubmitted, rPoints[uncachedPoints[nSubmitted]]);
+                    ++nSubmitted;
                 }
             }
+            return;
         }
 
-        int  threads = mpWorker->getNumberOfCandidates();
-        if(threads == 1)
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        const size_t nThreads = std::min(mRootSystemPtrs.size(), uncachedPoints.size());
+        if(nThreads > 1)
+        {
+            vector<double> objectives(uncachedPoints.size());
+            vector<char> evaluated(uncachedPoints.size(), false);
+            std::atomic<size_t> nextPoint(0);
+            auto evaluateLoop = [&](ComponentSystem *pSystem)
+            {
+                for(size_t u=nextPoint++; u<uncachedPoints.size() && !mpWorker->aborted(); u=nextPoint++)
+                {
+                    objectives[u] = evaluate(pSystem, rPoints[uncachedPoints[u]]);
+                    evaluated[u] = true;
+                }
+            };
+
+            // The calling thread takes part in the evaluation, using the first model copy
+            vector<std::thread> threads;
+            for(size_t t=1; t<nThreads; ++t)
+            {
+                threads.push_back(std::thread(evaluateLoop, mRootSystemPtrs[t]));
+            }
+            evaluateLoop(mRootSystemPtrs[0]);
+            for(size_t t=0; t<threads.size(); ++t)
+            {
+                threads[t].join();
+            }
+            for(size_t u=0; u<uncachedPoints.size(); ++u)
+            {
+                if(evaluated[u])
+                {
+                    addCachedObjective(rPoints[uncachedPoints[u]], objectives[u]);
+                    setObjective(uncachedPoints[u], objectives[u]);
+                    ++mEvaulationCounter;
+                }
+            }
+            return;
+        }
+#endif
+        for(size_t u=0; u<uncachedPoints.size() && !mpWorker->aborted(); ++u)
         {
-            threads = -1;
+            const size_t p = uncachedPoints[u];
+            const double obj = evaluate(mRootSystemPtrs.at(0), rPoints[p]);
+            addCachedObjective(rPoints[p], obj);
+            setObjective(p, obj);
+            ++mEvaulationCounter;
         }
+    }
 
-        gHopsanCore.getSimulationHandler()->initializeSystem(mStartTime,mStopTime,mRootSystemPtrs);
-        gHopsanCore.getSimulationHandler()->simulateSystem(mStartTime,mStopTime,threads,mRootSystemPtrs);
+    //! @brief Wait for a candidate submitted to the evaluation threads
+    //! @returns False if there are no submitted candidates
+    bool waitForEvaluationThread(size_t &rIdx, double &rObjective)
+    {
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        std::unique_lock<std::mutex> lock(mTaskMutex);
+        if(mNumSubmitted == 0)
+        {
+            return false;
+        }
+        mTaskFinished.wait(lock, [this](){ return !mFinishedTasks.empty(); });
+        rIdx = mFinishedTasks.front().first;
+        rObjective = mFinishedTasks.front().second;
+        mFinishedTasks.pop_front();
+        --mNumSubmitted;
+        return true;
+#else
+        HOPSAN_UNUSED(rIdx)
+        HOPSAN_UNUSED(rObjective)
+        return false;
+#endif
+    }
 
-        for(size_t c=0; c<mpWorker->getNumberOfCandidates(); ++c)
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    //! @brief Evaluates submitted candidates on one model copy, until the evaluator is destroyed
+    void evaluationThreadLoop(ComponentSystem *pSystem)
+    {
+        std::unique_lock<std::mutex> lock(mTaskMutex);
+        while(true)
         {
-            double obj = 0.0;
-            for(size_t i=0; i<mObjComps.size(); ++i)
+            mTaskAdded.wait(lock, [this](){ return mStopThreads || !mPendingTasks.empty(); });
+            if(mPendingTasks.empty())
             {
-                int portId = 0;
-                Component *pComp = mRootSystemPtrs.at(c)->getSubComponent(mObjComps[i].c_str());
-                Port *pPort = pComp->getPort(mObjPorts[i].c_str());
-                double data = *pPort->getNodeDataPtr(portId);
-                obj += mObjWeights[i]*data;
+                return;
             }
-            mpWorker->setCandidateObjectiveValue(c, obj);
-            ++mEvaulationCounter;
+            const std::pair<size_t, vector<double> > task = mPendingTasks.front();
+            mPendingTasks.pop_front();
+            lock.unlock();
+
+            const double obj = evaluate(pSystem, task.second);
+
+            lock.lock();
+            mFinishedTasks.push_back(std::make_pair(task.first, obj));
+            mTaskFinished.notify_one();
         }
     }
 
-    size_t getNumberOfEvaluations() { return mEvaulationCounter; }
+    std::vector<std::thread> mEvaluationThreads;
+    std::mutex mTaskMutex;
+    std::condition_variable mTaskAdded;
+    std::condition_variable mTaskFinished;
+    std::deque<std::pair<size_t, vector<double> > > mPendingTasks;
+    std::deque<std::pair<size_t, double> > mFinishedTasks;
+    size_t mNumSubmitted;
+    bool mStopThreads;
+#endif
+
+    ProcessFarm mProcessFarm;
+    std::deque<std::pair<size_t, double> > mCachedTasks;
 
-    //void evaluateAllCandidates();
-private:
     vector<ComponentSystem *> mRootSystemPtrs;
     vector<string> mParNames;
     vector<string> mObjComps;
@@ -236,6 +546,7 @@ int main(int argc, char *argv[])
         TCLAP::SwitchArg silentOption("", "silent", "Disable all output messages", cmd);
         TCLAP::SwitchArg createHvcTestOption("", "createValidationData","Create a model validation data set based on the variables connected to scopes in the model given by option -m", cmd);
         TCLAP::SwitchArg prefixRootLevelName("", "prefixRootSystemName", "Prefix the root-level system name to exported results and parameters", cmd);
+        TCLAP::SwitchArg streamResultsOption("", "streamResults", "Stream logged data to temporary files in the destination directory during simulation, for --resultsFullCSV and --resultsFullHDF5. Keeps memory usage constant regardless of the number of log samples", cmd);
 
         TCLAP::ValueArg<std::string> coreLogFileOption("", "log.corelogfile", "The simulation core log file destination", false, "", "Filepath", cmd);
         TCLAP::ValueArg<std::string> buildCompLibOption("", "buildComponentLibrary", "Build the specified component library (point to the library xml)", false, "", "string", cmd);
@@ -419,6 +730,13 @@ int main(int argc, char *argv[])
             size_t nParams = 0;
             size_t maxEvals = 0;
             size_t nModels = 1;
+            size_t nThreads = 0;
+            bool steadyState = false;
+            bool useProcesses = false;
+            size_t nProcesses = 0;
+            bool useCache = false;
+            double cacheResolution = 1e-9;
+            string cacheFile;
             double tolerance = 1e-3;
             double alpha = 1.3;
             double beta = 0.3;
@@ -439,6 +757,8 @@ int main(int argc, char *argv[])
             size_t nRetractions = 1;
             double F = 1.0;
             double CR = 0.5;
+            size_t nTrialPoints = 500;
+            double perturbation = 0.2;
             bool printDebugFile = false;
             bool silent = false;
 
@@ -494,6 +814,33 @@ int main(int argc, char *argv[])
                 {
                     nModels = std::stoi(words[1]);
                 }
+                else if(words.size() == 2 && words[0] == "nthreads")
+                {
+                    nThreads = std::stoi(words[1]);
+                }
+                else if(words.size() == 2 && words[0] == "nprocesses")
+                {
+                    useProcesses = true;
+                    nProcesses = std::stoi(words[1]);
+                }
+                else if(words.size() == 1 && words[0] == "steadystate")
+                {
+                    steadyState = true;
+                }
+                else if(words.size() == 1 && words[0] == "cache")
+                {
+                    useCache = true;
+                }
+                else if(words.size() == 2 && words[0] == "cacheresolution")
+                {
+                    useCache = true;
+                    cacheResolution = std::stod(words[1]);
+                }
+                else if(words.size() == 2 && words[0] == "cachefile")
+                {
+                    useCache = true;
+                    cacheFile = words[1];
+                }
                 else if(words.size() == 4 && words[0] == "objective")
                 {
                     objComps.push_back(words[1]);
@@ -571,6 +918,14 @@ int main(int argc, char *argv[])
                 {
                     nPredictions = std::stoi(words[1]);
                 }
+                else if(words.size() == 2 && words[0] == "ntrialpoints")
+                {
+                    nTrialPoints = std::stoi(words[1]);
+                }
+                else if(words.size() == 2 && words[0] == "perturbation")
+                {
+                    perturbation = std::stod(words[1]);
+                }
                 else if(words.size() == 2 && words[0] == "nretractions")
                 {
                     nRetractions = std::stoi(words[1]);
@@ -599,12 +954,37 @@ int main(int argc, char *argv[])
 
             if(scriptFilesOk)
             {
+                // Each evaluation thread simulates its own copy of the model, use one thread per core unless specified,
+                // but there is no point in having more copies than candidates or points evaluated at the same time.
+                // Worker processes get their own copy of the model when they are forked, so then one copy is enough.
+                size_t nThreadModelCopies = 1;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+                nThreadModelCopies = determineActualNumberOfThreads(nThreads);
+                nThreadModelCopies = std::max(size_t(1), std::min(nThreadModelCopies, std::max(nModels, nPoints)));
+#else
+                HOPSAN_UNUSED(nThreads)
+#endif
+                const size_t nModelCopies = useProcesses ? 1 : nThreadModelCopies;
+
                 cout << "Loading Hopsan Model File: " << hmfPathOption.getValue() << endl;
                 double startTime=0, stopTime=2;
                 bool modelFileOk=true;
                 std::vector<ComponentSystem*> rootSystemPtrs;
-                for(size_t m=0; m<nModels; ++m)
+                for(size_t m=0; m<nModelCopies; ++m)
                 {
+                    // Only parse the model file once, the other models are copies of the first one (including imported parameters)
+                    if(m > 0)
+                    {
+                        rootSystemPtrs.push_back(rootSystemPtrs.front()->clone());
+                        if(!rootSystemPtrs.at(m))
+                        {
+                            printErrorMessage("Could not copy model: " + hmfPathOption.getValue());
+                            modelFileOk=false;
+                            returnSuccess=false;
+                            break;
+                        }
+                        continue;
+                    }
                     rootSystemPtrs.push_back(gHopsanCore.loadHMFModelFile(hmfPathOption.getValue().c_str(), startTime, stopTime));
                     if(rootSystemPtrs.at(m))
                     {
@@ -629,6 +1009,55 @@ int main(int argc, char *argv[])
                 {
                     OptimizationEvaluator *pEvaluator = new OptimizationEvaluator(rootSystemPtrs, parNames, objComps, objPorts,
                                                                                   objWeights, parMin, parMax, startTime, stopTime);
+                    bool processFarmStarted = false;
+                    if(useProcesses)
+                    {
+                        if(nProcesses == 0)
+                        {
+                            nProcesses = getNumAvailibleCores();
+                        }
+                        nProcesses = std::max(size_t(1), std::min(nProcesses, std::max(nModels, nPoints)));
+                        processFarmStarted = pEvaluator->startProcessFarm(nProcesses);
+                        if(!processFarmStarted)
+                        {
+                            printErrorMessage("Could not start evaluation processes, evaluating candidates in this process instead", silentOption.getValue());
+
+                            // Only one model was loaded for the worker processes, copy it for the evaluation threads instead
+                            while(rootSystemPtrs.size() < nThreadModelCopies)
+                            {
+                                ComponentSystem *pCopy = rootSystemPtrs.front()->clone();
+                                if(!pCopy)
+                                {
+                                    printErrorMessage("Could not copy model: " + hmfPathOption.getValue(), silentOption.getValue());
+                                    break;
+                                }
+                                rootSystemPtrs.push_back(pCopy);
+                                pEvaluator->addModelCopy(pCopy);
+                            }
+                        }
+                    }
+                    if(processFarmStarted)
+                    {
+                        cout << "Evaluating candidates using " << nProcesses << " process(es)" << endl;
+                    }
+                    else
+                    {
+                        cout << "Evaluating candidates using " << rootSystemPtrs.size() << " thread(s)" << endl;
+                    }
+                    if(useCache)
+                    {
+                        pEvaluator->setCacheEnabled(true);
+                        pEvaluator->getCache()->setResolution(cacheResolution);
+                        if(!cacheFile.empty())
+                        {
+                            const size_t nEntriesBefore = pEvaluator->getCache()->getNumberOfEntries();
+                            if(!pEvaluator->getCache()->setFile(cacheFile))
+                            {
+                                printErrorMessage("Could not open objective cache file: " + cacheFile, silentOption.getValue());
+                            }
+                            cout << "Loaded " << pEvaluator->getCache()->getNumberOfEntries()-nEntriesBefore << " cached objective values from: " << cacheFile << endl;
+                        }
+                    }
 
                     //Initialize base worker
                     Ops::Worker *pBaseWorker;
@@ -659,6 +1088,8 @@ int main(int argc, char *argv[])
                         pBaseWorker = new Ops::WorkerParameterSweep(pEvaluator, pOpsMessages);
                     else if(algorithm == "genetic")
                         pBaseWorker = new Ops::WorkerGenetic(pEvaluator, pOpsMessages);
+                    else if(algorithm == "surrogate")
+                        pBaseWorker = new Ops::WorkerSurrogate(pEvaluator, pOpsMessages);
                     else
                         pBaseWorker = new Ops::Worker(pEvaluator, pOpsMessages);
 
@@ -678,6 +1109,7 @@ int main(int argc, char *argv[])
                     }
                     pBaseWorker->setTolerance(tolerance);
                     pBaseWorker->setSamplingMethod(Ops::SamplingLatinHypercube);
+                    pBaseWorker->setSteadyState(steadyState);
 
                     //Set algorithm-specific parameters
                     if(algorithm == "neldermead")
@@ -746,6 +1178,12 @@ int main(int argc, char *argv[])
                         pWorker->setCrossoverProbability(CP);
                         pWorker->setMutationProbability(MP);
                     }
+                    else if(algorithm == "surrogate")
+                    {
+                        Ops::WorkerSurrogate *pWorker = dynamic_cast<Ops::WorkerSurrogate*>(pBaseWorker);
+                        pWorker->setNumberOfTrialPoints(nTrialPoints);
+                        pWorker->setPerturbation(perturbation);
+                    }
 
                     //Error checking
                     //! @todo Also check that optimization parameters and objective ports exist in model
@@ -762,6 +1200,12 @@ int main(int argc, char *argv[])
                     pBaseWorker->initialize();
                     pBaseWorker->run();
 
+                    if(useCache)
+                    {
+                        cout << "Objective cache hits: " << pEvaluator->getCache()->getNumberOfHits() << " of "
+                             << pEvaluator->getCache()->getNumberOfLookups() << " lookups" << endl;
+                    }
+
                     //Print results
                     if(printDebugFile)
                     {
@@ -793,6 +1237,15 @@ int main(int argc, char *argv[])
                         }
                     }
 
+                    // Removing the evaluator stops the evaluation threads and worker processes, it must be done before the models are removed
+                    delete pBaseWorker;
+                    delete pOpsMessages;
+                    delete pEvaluator;
+                    for(ComponentSystem *pRootSystem : rootSystemPtrs)
+                    {
+                        delete pRootSystem;
+                    }
+
                     returnSuccess=true;
                 }
             }
@@ -838,6 +1291,7 @@ int main(int argc, char *argv[])
                 cout << endl;
 
                 std::vector<std::string> logOnlyPortsOrVariables;
+                std::vector<ResultStream> resultStreams;
                 if (pRootSystem && simulateOption.isSet())
                 {
                     bool doSimulate=true;
@@ -904,19 +1358,55 @@ int main(int argc, char *argv[])
                         }
 
                         // Now disable all nodes and then enable the requested ones
+                        // If variables are given, only those are logged, the others in the port are excluded from the log in the core
                         forEachPort(pRootSystem, [](hopsan::Port& port){port.setEnableLogging(false);});
+                        std::vector<hopsan::Port*> fullyLoggedPorts;
                         for (const auto& port_name : logOnlyPortsOrVariables)
                         {
                             hopsan::Port* pPort = getPortWithFullName(pRootSystem, port_name);
                             if (pPort)
                             {
-                                pPort->setEnableLogging(true);
+                                std::vector<std::string> nameParts;
+                                splitStringOnDelimiter(port_name, '#', nameParts);
+                                const std::vector<hopsan::NodeDataDescription> *pVars = pPort->getNodeDataDescriptions();
+                                if (nameParts.size() == 3 && pVars)
+                                {
+                                    const int dataId = pPort->getNodeDataIdFromName(nameParts[2].c_str());
+                                    if (dataId < 0)
+                                    {
+                                        printWarningMessage("Could not find variable: '"+port_name+"' when processing logonly input");
+                                        continue;
+                                    }
+                                    if (!pPort->isLoggingEnabled())
+                                    {
+                                        for (size_t v=0; v<pVars->size(); ++v)
+                                        {
+                                            pPort->setEnableVariableLogging(v, false);
+                                        }
+                                        pPort->setEnableLogging(true);
+                                    }
+                                    pPort->setEnableVariableLogging(size_t(dataId), true);
+                                }
+                                else
+                                {
+                                    fullyLoggedPorts.push_back(pPort);
+                                }
                             }
                             else
                             {
                                 printWarningMessage("Could not find port: '"+port_name+"' when processing logonly input");
                             }
                         }
+                        // Ports given by name log all variables, regardless of the order in the list
+                        for (hopsan::Port* pPort : fullyLoggedPorts)
+                        {
+                            pPort->setEnableLogging(true);
+                            const std::vector<hopsan::NodeDataDescription> *pVars = pPort->getNodeDataDescriptions();
+                            for (size_t v=0; pVars && v<pVars->size(); ++v)
+                            {
+                                pPort->setEnableVariableLogging(v, true);
+                            }
+                        }
                     }
 
                     // Apply loaded simulation states or only load start values
@@ -939,6 +1429,16 @@ int main(int argc, char *argv[])
                     TicToc isoktimer("IsOkTime");
                     doSimulate = doSimulate && pRootSystem->checkModelBeforeSimulation();
                     isoktimer.TocPrint();
+                    // Write the log data to file during simulation instead of keeping it in memory
+                    if (doSimulate && streamResultsOption.getValue() && resultsFinalHDF5Option.isSet())
+                    {
+                        printWarningMessage("--streamResults can not be combined with --resultsFinalHDF5, log data will be kept in memory", silentOption.getValue());
+                    }
+                    else if (doSimulate && streamResultsOption.getValue() && (resultsFullCSVOption.isSet() || resultsFullHDF5Option.isSet()))
+                    {
+                        attachResultStreams(pRootSystem, destinationPath, resultStreams, prefixRootLevelName.getValue() ? pRootSystem->getName().c_str()+string("$") : "");
+                    }
+
                     if (doSimulate)
                     {
                         TicToc initTimer("InitializeTime");
@@ -1002,7 +1502,14 @@ int main(int argc, char *argv[])
                     {
                         prefix = pRootSystem->getName().c_str()+string("$");
                     }
-                    saveResults(pRootSystem, destinationPath+resultsFullCSVOption.getValue(), Full, logOnlyPortsOrVariables, prefix);
+                    if (!resultStreams.empty())
+                    {
+                        saveStreamedResults(resultStreams, destinationPath+resultsFullCSVOption.getValue(), logOnlyPortsOrVariables);
+                    }
+                    else
+                    {
+                        saveResults(pRootSystem, destinationPath+resultsFullCSVOption.getValue(), Full, logOnlyPortsOrVariables, prefix);
+                    }
                     // Should we transpose the result
                     if (resultsCSVSortOption.getValue() == "cols")
                     {
@@ -1018,7 +1525,14 @@ int main(int argc, char *argv[])
 
                 if(resultsFullHDF5Option.isSet()) {
                     cout << "Saving full results to file: " << destinationPath+resultsFullHDF5Option.getValue() << endl;
-                    saveResultsToHDF5(pRootSystem, destinationPath+resultsFullHDF5Option.getValue(), Full);
+                    if (!resultStreams.empty())
+                    {
+                        saveStreamedResultsToHDF5(resultStreams, destinationPath+resultsFullHDF5Option.getValue());
+                    }
+                    else
+                    {
+                        saveResultsToHDF5(pRootSystem, destinationPath+resultsFullHDF5Option.getValue(), Full);
+                    }
                 }
 
                 if(resultsFinalHDF5Option.isSet()) {
@@ -1032,6 +1546,9 @@ int main(int argc, char *argv[])
                     saveSimulationPoint(saveSimulationStateOption.getValue().c_str(), pRootSystem);
                 }
 
+                // Remove the temporary streamed result files
+                detachResultStreams(resultStreams);
+
                 // Now remove the rootsystem
                 delete pRootSystem;
                 pRootSystem = 0;
@@ -169,11 +169,15 @@ SOURCES += \
     $${PWD}/dependencies/indexingcsvparser/src/indexingcsvparser.cpp \
     src/Quantities.cpp \
     src/CoreUtilities/NumHopHelper.cpp \
+    src/CoreUtilities/CompiledNumHopScript.cpp \
     src/CoreUtilities/AliasHandler.cpp \
     src/CoreUtilities/ConnectionAssistant.cpp \
     src/CoreUtilities/SimulationHandler.cpp \
+    src/CoreUtilities/SimulationEnsemble.cpp \
     src/CoreUtilities/MultiThreadingUtilities.cpp \
     src/CoreUtilities/StringUtilities.cpp \
+    src/CoreUtilities/LogDataStorage.cpp \
+    src/CoreUtilities/LogSink.cpp \
     src/CoreUtilities/SaveRestoreSimulationPoint.cpp
 HEADERS += \
     include/win32dll.h \
@@ -199,6 +203,7 @@ HEADERS += \
     include/ComponentUtilities/SecondOrderTransferFunction.h \
     include/ComponentUtilities/num2string.hpp \
     include/ComponentUtilities/matrix.h \
+    include/ComponentUtilities/FixedSizeMatrix.h \
     include/ComponentUtilities/ludcmp.h \
     include/ComponentUtilities/IntegratorLimited.h \
     include/ComponentUtilities/Integrator.h \
@@ -215,6 +220,8 @@ HEADERS += \
     $${PWD}/dependencies/rapidxml/hopsan_rapidxml.hpp \
     include/CoreUtilities/MultiThreadingUtilities.h \
     include/CoreUtilities/StringUtilities.h \
+    include/CoreUtilities/LogDataStorage.h \
+    include/CoreUtilities/LogSink.h \
     include/HopsanTypes.h \
     include/ComponentUtilities/HopsanPowerUser.h \
     include/HopsanCoreMacros.h \
@@ -227,7 +234,10 @@ HEADERS += \
     include/HopsanCoreVersion.h \
     include/HopsanCoreGitVersion.h \
     include/CoreUtilities/NumHopHelper.h \
+    include/CoreUtilities/CompiledNumHopScript.h \
     include/CoreUtilities/ConnectionAssistant.h \
     include/CoreUtilities/AliasHandler.h \
     include/CoreUtilities/SimulationHandler.h \
-    include/CoreUtilities/SaveRestoreSimulationPoint.h
+    include/CoreUtilities/SimulationEnsemble.h \
+    include/CoreUtilities/SaveRestoreSimulationPoint.h \
+    include/CoreUtilities/SimulationState.h
@@ -37,6 +37,7 @@
 #include "Node.h"
 #include "Port.h"
 #include "Parameters.h"
+#include "CoreUtilities/SimulationState.h"
 #include "win32dll.h"
 #include <map>
 #include <list>
@@ -231,6 +232,11 @@ public:
     virtual void getResiduals(double * /*y*/, double* /*res*/);
     virtual void getJacobian(double * /*y*/, double* /*f*/, double* /*J*/);
 
+    // Simulation state snapshots, components with internal state (integrators, delays, filters) can override these
+    virtual void saveSimulationState(SimulationStateWriter &rWriter);
+    virtual bool restoreSimulationState(SimulationStateReader &rReader);
+    virtual bool hasCompleteSimulationState() const;
+
 protected:
     //==========Protected member functions==========
     // Constructor - Destructor
@@ -285,6 +291,11 @@ private:
     void setTypeName(const HString &rTypeName);
     double *getNodeDataPtr(Port* pPort, const int dataId);
 
+    // Parameter change tracking (used by warm start)
+    bool hasChangedParameters() const;
+    const std::vector<HString> &getChangedParameterNames() const;
+    void resetChangedParameters();
+
     // Parameter registration
     void registerParameter(const HString &rName, const HString &rDescription, const HString &rQuantity, const HString &rUnit, double &rValue);
     void registerParameter(const HString &rName, const HString &rDescription, const HString &rUnit, int &rValue);
@@ -40,6 +40,7 @@
 #include <ctime>
 #endif
 
+#include <set>
 #include "Component.h"
 #include "CoreUtilities/SimulationHandler.h"
 #include "CoreUtilities/AliasHandler.h"
@@ -47,14 +48,19 @@
 namespace hopsan {
     class NumHopHelper;
     class ComponentSystemMultiThreadPrivates;
+    class LogSink;
 
     class HOPSANCORE_DLLAPI ComponentSystem :public Component
     {
+        friend class Component;
         friend class ConnectionAssistant;
         friend class AliasHandler;
+        friend class SimulationEnsemble;
 
     public:
         enum UniqeNameEnumT {UniqueComponentNameType, UniqueSysportNameTyp, UniqueSysparamNameType, UniqueAliasNameType, UniqueReservedNameType};
+        //! @brief What each log sample contains, SampleLogMode: the values at the log time step, MeanLogMode: the mean of all time steps since the previous log sample
+        enum LogModeEnumT {SampleLogMode, MeanLogMode};
         typedef std::map<HString, std::pair<std::vector<HString>, std::vector<HString> > > SetParametersMapT;
 
         //==========Public functions==========
@@ -73,6 +79,9 @@ namespace hopsan {
         void setExternalModelFilePath(const HString &rPath);
         HString getExternalModelFilePath() const;
 
+        // Copying
+        ComponentSystem *clone();
+
         // Adding removing and renaming components
         void addComponents(std::vector<Component*> &rComponents);
         void addComponent(Component *pComponent);
@@ -141,7 +150,32 @@ namespace hopsan {
         void distributeQcomponents(std::vector< std::vector<Component*> > &rSplitQVector, size_t nThreads);
         void distributeSignalcomponents(std::vector< std::vector<Component*> > &rSplitSignalVector, size_t nThreads);
         void distributeNodePointers(std::vector< std::vector<Node*> > &rSplitNodeVector, size_t nThreads);
+        void distributeByGraphPartitioning(std::vector< std::vector<Component*> > &rSplitCVector, std::vector< std::vector<Component*> > &rSplitQVector,
+                                           std::vector< std::vector<Node*> > &rSplitNodeVector, size_t nThreads);
+        void relocateNodeData(const std::vector< std::vector<Node*> > &rSplitNodeVector);
         void reschedule(size_t nThreads);
+        void setBarrierAlgorithm(const BarrierAlgorithmT algorithm, const size_t spinCount=2000);
+        BarrierAlgorithmT getBarrierAlgorithm() const;
+        size_t getBarrierSpinCount() const;
+        void setAdaptiveRescheduling(const bool enabled, const double imbalanceThreshold=0.2, const size_t sampleInterval=1000);
+        bool isAdaptiveReschedulingEnabled() const;
+        size_t getNumAdaptiveReschedules() const;
+        bool rescheduleIfImbalanced(const double time);
+        std::vector<Component*> getThreadComponents(const size_t thread, const CQSEnumT type) const;
+        void setSignalWavefront(const bool enabled, const size_t minLevelSize=32);
+        bool isSignalWavefrontEnabled() const;
+        size_t getSignalWavefrontMinLevelSize() const;
+        size_t getNumSignalLevels() const;
+        std::vector<Component*> getSignalLevel(const size_t level) const;
+
+        // Node data storage
+        void setUseNodeDataArena(const bool useArena);
+        bool usesNodeDataArena() const;
+
+        // Warm start, incremental re-initialization
+        void setWarmStart(const bool warmStart);
+        bool isWarmStartEnabled() const;
+        size_t getNumWarmStartedComponents() const;
 
         // Set and get desired timestep
         void setDesiredTimestep(const double timestep);
@@ -159,6 +193,19 @@ namespace hopsan {
         void setLogStartTime(const double logStartTime);
         size_t getNumLogSamples() const;
         size_t getNumActuallyLoggedSamples() const;
+        bool setEnableVariableLogging(const HString &rComponentName, const HString &rPortName, const HString &rVariableName, const bool enableLog);
+        size_t getNumLoggedVariables() const;
+        void setLogSink(LogSink *pLogSink);
+        LogSink *getLogSink() const;
+        void setLogMode(const LogModeEnumT mode);
+        LogModeEnumT getLogMode() const;
+        void setLogEnvelope(const bool logEnvelope);
+        bool isLogEnvelopeEnabled() const;
+        bool addLogTrigger(const HString &rComponentName, const HString &rPortName, const HString &rVariableName, const double threshold, const size_t numCaptureSteps);
+        void clearLogTriggers();
+        size_t getNumLogTriggers() const;
+        void setNumTriggeredLogSamples(const size_t nSamples);
+        size_t getNumTriggeredLogSamples() const;
 
         // Stop a running initialization or simulation
         void stopSimulation(const HString &rReason);
@@ -206,6 +253,27 @@ namespace hopsan {
 //        void setLogSettingsSkipFactor(double factor, double start, double stop, double sampletime);
         void setupLogSlotsAndTs(const double simStartT, const double simStopT, const double simTs);
         void preAllocateLogSpace();
+        void setupLogTriggers();
+        void updateLogTriggers();
+        void openLogSink(const size_t nLogSlots);
+
+        // Node data arena functions
+        void buildNodeDataArena();
+        void releaseNodeDataArena();
+
+        // Warm start functions
+        void markTopologyChanged();
+        bool hasChangesRecursively() const;
+        bool checkChangedParameters();
+        bool evaluateChangedParametersRecursively();
+        void findAffectedComponents(std::set<Component*> &rAffected) const;
+        void restoreWarmStartStates(const std::set<Component*> &rAffected, std::set<Component*> &rRestored);
+        void saveWarmStartStates();
+
+        // Parameter dependency functions
+        void getChangedParameterScope(std::set<HString> &rChangedNames);
+        void findParameterDependents(const std::set<HString> &rChangedNames, std::set<Component*> &rDependents);
+        void updateParameterDependents();
 
         // Add and Remove subcomponent ptrs from storage vectors
         void addSubComponentPtrToStorage(Component* pComponent);
@@ -214,7 +282,10 @@ namespace hopsan {
         // Clear all contents of the system (use in destructor)
         void clear();
 
-        bool sortComponentVector(std::vector<Component*> &rOldSignalVector);
+        // Copy all contents into an empty system (used by clone)
+        bool copyContentsTo(ComponentSystem *pCopy);
+
+        bool sortComponentVector(std::vector<Component*> &rComponentVector, std::vector<size_t> *pLevelOffsets=0);
 
         // UniqueName specific functions
         HString determineUniquePortName(const HString &rPortname);
@@ -230,6 +301,7 @@ namespace hopsan {
         std::vector<Component*> mComponentCptrs;
         std::vector<Component*> mComponentUndefinedptrs;
         std::vector<Node*> mSubNodePtrs;
+        std::vector<size_t> mSignalLevelOffsets;
 
         std::vector<Component*> mDisabledSptrs;
         std::vector<Component*> mDisabledQptrs;
@@ -258,13 +330,56 @@ namespace hopsan {
 
         bool mKeepValuesAsStartValues;
 
+        // Node data arena, contiguous storage for the data values of all sub nodes
+        bool mUseNodeDataArena;
+        std::vector<double> mNodeDataArenaStorage;
+        std::vector<Node*> mNodeDataArenaNodes;
+
+        // Warm start, the parameters and topology are tracked so that only affected components are initialized again
+        bool mWarmStart, mTopologyChanged, mTopologyChecked, mForceFullInitialize;
+        double mWarmStartStartT, mWarmStartStopT;
+        std::map<Component*, size_t> mWarmStartOffsets;
+        std::vector<char> mWarmStartStates;
+        size_t mNumWarmStartedComponents;
+
+        // Parameter dependencies, the sub components that refer to each system parameter name
+        std::map<HString, std::vector<Component*> > mParameterDependents;
+        std::set<Component*> mParameterDependentComponents;
+        bool mParameterDependentsValid;
+
         AliasHandler mAliasHandler;
 
         // Log related variables
-        size_t mRequestedNumLogSamples, mnLogSlots, mLogCtr;
+        size_t mRequestedNumLogSamples, mnLogSlots, mLogCtr, mLogStepCtr;
         double mRequestedLogStartTime, mLogTimeDt;
         bool mEnableLogData;
+        LogModeEnumT mLogMode;
+        bool mLogEnvelope, mLogAccumulate;
+
+        // Event triggered log capture, log every time step for a while when a variable crosses a threshold
+        class LogTrigger
+        {
+        public:
+            HString mComponentName, mPortName, mVariableName;
+            double mThreshold;
+            size_t mNumCaptureSteps;
+            Node *mpNode;
+            size_t mDataId;
+            double mPreviousValue;
+        };
+        std::vector<LogTrigger> mLogTriggers;
+        size_t mnTriggeredLogSlots, mnTriggeredLogSamples, mLogCaptureStepsLeft;
         std::vector<double> mTimeStorage;
+        std::vector<Node*> mLoggedSubNodePtrs;
+
+        // Streaming log sink (not owned), replaces the node log storage when set
+        LogSink *mpLogSink;
+        bool mLogSinkIsOpen;
+        std::vector<Node*> mLogSinkNodePtrs; // 0 for variables of nodes that were removed while the sink was open
+        std::vector<size_t> mLogSinkDataIds;
+        std::vector<double> mLogSinkValues;
+        std::vector<double> mLogSinkSums;
+        size_t mLogSinkNumSummed;
     };
 
 
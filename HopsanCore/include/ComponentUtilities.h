@@ -39,6 +39,7 @@
 #include "ComponentUtilities/ValveHysteresis.h"
 #include "ComponentUtilities/ludcmp.h"
 #include "ComponentUtilities/matrix.h"
+#include "ComponentUtilities/FixedSizeMatrix.h"
 #include "ComponentUtilities/CSVParser.h"
 #include "ComponentUtilities/PLOParser.h"
 #include "ComponentUtilities/AuxiliarySimulationFunctions.h"
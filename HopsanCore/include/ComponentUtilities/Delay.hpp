@@ -35,6 +35,7 @@
 #define DELAY_HPP_INCLUDED
 
 #include "stddef.h"
+#include "CoreUtilities/SimulationState.h"
 
 namespace hopsan {
 
@@ -172,6 +173,36 @@ public:
         return mSize;
     }
 
+    //! @brief Save the buffer contents (from oldest to newest) to a simulation state
+    //! @param [in] rWriter The simulation state writer
+    void saveState(SimulationStateWriter &rWriter) const
+    {
+        rWriter.write(mSize);
+        for (size_t i=0; i<mSize; ++i)
+        {
+            rWriter.write(getOldIdx(i));
+        }
+    }
+
+    //! @brief Restore the buffer contents from a simulation state, the buffer must already have the same size
+    //! @param [in] rReader The simulation state reader
+    //! @return False if the state could not be read or if the size does not match
+    bool restoreState(SimulationStateReader &rReader)
+    {
+        size_t size=0;
+        if (!rReader.read(size) || size != mSize)
+        {
+            return false;
+        }
+        if (mSize > 0)
+        {
+            rReader.read(mpArray, mSize);
+            mOldest = 0;
+            mNewest = mSize-1;
+        }
+        return rReader.isOk();
+    }
+
     //! @brief Clear the delay buffer, deleting all data
     void clear()
     {
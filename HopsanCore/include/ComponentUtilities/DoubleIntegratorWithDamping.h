@@ -35,6 +35,7 @@
 #define DOUBLEINTEGRATORWITHDAMPING_H_INCLUDED
 
 #include "win32dll.h"
+#include "CoreUtilities/SimulationState.h"
 
 namespace hopsan {
 
@@ -50,6 +51,8 @@ namespace hopsan {
         void redoIntegrate(double u);
         double valueFirst();
         double valueSecond();
+        void saveState(SimulationStateWriter &rWriter) const;
+        bool restoreState(SimulationStateReader &rReader);
 
     private:
         double mDelayU, mDelayY, mDelaySY;
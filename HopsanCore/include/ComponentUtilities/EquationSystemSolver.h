@@ -37,6 +37,7 @@
 #include "Component.h"
 #include "matrix.h"
 #include "ludcmp.h"
+#include "FixedSizeMatrix.h"
 
 #include <vector>
 
@@ -67,6 +68,81 @@ private:
 };
 
 
+//! @ingroup ComponentUtilityClasses
+//! @brief An equation system solver for N equations, with N known at compile time
+//! @details Works like EquationSystemSolver but on FixedMatrix and FixedVec, so that solving never allocates memory
+//! and the loops can be unrolled by the compiler. Use EquationSystemSolver when the size is not known at compile time.
+template<int N>
+class FixedEquationSystemSolver
+{
+public:
+    FixedEquationSystemSolver(Component *pParentComponent) : mpParentComponent(pParentComponent)
+    {
+        // Weights for equations, used when running several iterations
+        mSystemEquationWeight[0]=1;
+        mSystemEquationWeight[1]=0.67;
+        mSystemEquationWeight[2]=0.5;
+        mSystemEquationWeight[3]=0.5;
+    }
+
+    //! @brief Solves a system of equations
+    //! @param jacobian Jacobian matrix, replaced by its LU decomposition
+    //! @param equations Vector of system equations
+    //! @param variables Vector of state variables
+    //! @param iteration How many times the solver has been executed before in the same time step
+    void solve(FixedMatrix<N,N> &jacobian, const FixedVec<N> &equations, FixedVec<N> &variables, const int iteration)
+    {
+        if (luSolve(jacobian, equations))
+        {
+            const double weight = mSystemEquationWeight[iteration - 1];
+            for (int i=0; i<N; ++i)
+            {
+                variables[i] -= weight*mDeltaStateVar[i];
+            }
+        }
+    }
+
+    //! @brief Solves a system of equations with just one iteration (slightly faster)
+    //! @param jacobian Jacobian matrix, replaced by its LU decomposition
+    //! @param equations Vector of system equations
+    //! @param variables Vector of state variables
+    void solve(FixedMatrix<N,N> &jacobian, const FixedVec<N> &equations, FixedVec<N> &variables)
+    {
+        if (luSolve(jacobian, equations))
+        {
+            for (int i=0; i<N; ++i)
+            {
+                variables[i] -= mDeltaStateVar[i];
+            }
+        }
+    }
+
+private:
+    bool luSolve(FixedMatrix<N,N> &jacobian, const FixedVec<N> &equations)
+    {
+        //Stop simulation if LU decomposition failed due to singularity
+        if (!ludcmp(jacobian, mOrder))
+        {
+            if (mpParentComponent)
+            {
+                mpParentComponent->addErrorMessage("Unable to perform LU-decomposition: Jacobian matrix is probably singular.");
+                mpParentComponent->stopSimulation();
+            }
+            return false;
+        }
+
+        //Solve system using L and U matrices
+        solvlu(jacobian, equations, mDeltaStateVar, mOrder);
+        return true;
+    }
+
+    Component *mpParentComponent;
+    double mSystemEquationWeight[4];
+    int mOrder[N];
+    FixedVec<N> mDeltaStateVar;
+};
+
+
 //! @ingroup ComponentUtilityClasses
 class HOPSANCORE_DLLAPI NumericalIntegrationSolver
 {
@@ -57,6 +57,8 @@ namespace hopsan {
         double delayedU() const;
         double delayedY() const;
         bool isSaturated() const;
+        void saveState(SimulationStateWriter &rWriter) const;
+        bool restoreState(SimulationStateReader &rReader);
 
     protected:
         double mValue;
@@ -0,0 +1,318 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   FixedSizeMatrix.h
+//! @date   2026-10-18
+//!
+//! @brief Contains fixed size matrix and vector classes and LU-decomposition, for small equation systems
+//!
+//$Id$
+
+#ifndef FIXEDSIZEMATRIX_H
+#define FIXEDSIZEMATRIX_H
+
+#include <cmath>
+
+namespace hopsan {
+
+//! @brief A vector of doubles with size known at compile time, the elements are stored inside the object
+//! @details Unlike Vec, it never allocates memory, so it can be created and copied in simulateOneTimestep
+//! @ingroup ComponentUtilityClasses
+template<int N>
+class FixedVec
+{
+public:
+    FixedVec() { set(0.0); }
+
+    //! @brief Returns the length (number of elements) of the vector
+    int length() const { return N; }
+
+    //! @brief Set all elements to a constant value
+    FixedVec &set(const double v)
+    {
+        for (int i=0; i<N; ++i)
+        {
+            mBody[i] = v;
+        }
+        return *this;
+    }
+
+    double &operator[](const int i) { return mBody[i]; }
+    const double &operator[](const int i) const { return mBody[i]; }
+
+    FixedVec operator+(const FixedVec &rOther) const
+    {
+        FixedVec result;
+        for (int i=0; i<N; ++i)
+        {
+            result.mBody[i] = mBody[i] + rOther.mBody[i];
+        }
+        return result;
+    }
+
+    FixedVec operator-(const FixedVec &rOther) const
+    {
+        FixedVec result;
+        for (int i=0; i<N; ++i)
+        {
+            result.mBody[i] = mBody[i] - rOther.mBody[i];
+        }
+        return result;
+    }
+
+    FixedVec operator*(const double c) const
+    {
+        FixedVec result;
+        for (int i=0; i<N; ++i)
+        {
+            result.mBody[i] = mBody[i]*c;
+        }
+        return result;
+    }
+
+private:
+    double mBody[N];
+};
+
+//! @brief A two-dimensional matrix of doubles with size known at compile time, the elements are stored inside the object
+//! @details Rows are accessed as m[r][c], the same way as for Matrix, but the matrix never allocates memory
+//! @ingroup ComponentUtilityClasses
+template<int R, int C>
+class FixedMatrix
+{
+public:
+    FixedMatrix() { set(0.0); }
+
+    int rows() const { return R; }
+    int cols() const { return C; }
+
+    //! @brief Set all elements to a constant value
+    FixedMatrix &set(const double v)
+    {
+        for (int r=0; r<R; ++r)
+        {
+            for (int c=0; c<C; ++c)
+            {
+                mBody[r][c] = v;
+            }
+        }
+        return *this;
+    }
+
+    //! @brief Returns a pointer to a matrix row
+    double *operator[](const int r) { return mBody[r]; }
+    const double *operator[](const int r) const { return mBody[r]; }
+
+    void swaprows(const int i, const int j)
+    {
+        for (int c=0; c<C; ++c)
+        {
+            const double tmp = mBody[i][c];
+            mBody[i][c] = mBody[j][c];
+            mBody[j][c] = tmp;
+        }
+    }
+
+    template<int K>
+    FixedMatrix<R,K> operator*(const FixedMatrix<C,K> &rOther) const
+    {
+        FixedMatrix<R,K> result;
+        for (int r=0; r<R; ++r)
+        {
+            for (int k=0; k<K; ++k)
+            {
+                double sum = 0.0;
+                for (int c=0; c<C; ++c)
+                {
+                    sum += mBody[r][c]*rOther[c][k];
+                }
+                result[r][k] = sum;
+            }
+        }
+        return result;
+    }
+
+    FixedVec<R> operator*(const FixedVec<C> &rVec) const
+    {
+        FixedVec<R> result;
+        for (int r=0; r<R; ++r)
+        {
+            double sum = 0.0;
+            for (int c=0; c<C; ++c)
+            {
+                sum += mBody[r][c]*rVec[c];
+            }
+            result[r] = sum;
+        }
+        return result;
+    }
+
+private:
+    double mBody[R][C];
+};
+
+//! @brief Find pivot element in column jcol, and interchange rows in a and order
+//! @details Same algorithm as pivot() for Matrix
+//! @returns False if the matrix is singular
+template<int N>
+bool pivot(FixedMatrix<N,N> &a, int order[], const int jcol)
+{
+    // Find biggest element on or below diagonal, this will be the pivot row
+    int ipvt = jcol;
+    double big = std::fabs(a[ipvt][ipvt]);
+    for (int i=ipvt+1; i<N; ++i)
+    {
+        const double anext = std::fabs(a[i][jcol]);
+        if (anext > big)
+        {
+            big = anext;
+            ipvt = i;
+        }
+    }
+
+    if (!(big > 0))
+    {
+        return false;
+    }
+
+    // Interchange pivot row (ipvt) with current row (jcol)
+    if (ipvt != jcol)
+    {
+        a.swaprows(jcol, ipvt);
+        const int i = order[jcol];
+        order[jcol] = order[ipvt];
+        order[ipvt] = i;
+    }
+    return true;
+}
+
+//! @brief Finds the LU decomposition of a fixed size matrix, in place
+//! @details Same algorithm as ludcmp() for Matrix. The U matrix has ones on its diagonal, and the row order after
+//! pivoting is returned in order, it should be used to reorder the right-hand-side in solvlu().
+//! @param[in,out] a The n by n matrix of coefficients, replaced by L and U in compact form
+//! @param[out] order Row order after pivoting, must have N elements
+//! @returns False if the matrix is singular
+template<int N>
+bool ludcmp(FixedMatrix<N,N> &a, int order[])
+{
+    for (int i=0; i<N; ++i)
+    {
+        order[i] = i;
+    }
+
+    // Do pivoting for first column and check for singularity
+    if (!pivot(a, order, 0))
+    {
+        return false;
+    }
+
+    double diag = 1.0/a[0][0];
+    for (int i=1; i<N; ++i)
+    {
+        a[0][i] *= diag;
+    }
+
+    // Compute a column of L's, then pivot to interchange rows, and then compute a row of U's
+    const int nm1 = N-1;
+    for (int j=1; j<nm1; ++j)
+    {
+        for (int i=j; i<N; ++i)
+        {
+            double sum = 0.0;
+            for (int k=0; k<j; ++k)
+            {
+                sum += a[i][k]*a[k][j];
+            }
+            a[i][j] -= sum;
+        }
+        if (!pivot(a, order, j))
+        {
+            return false;
+        }
+        diag = 1.0/a[j][j];
+        for (int k=j+1; k<N; ++k)
+        {
+            double sum = 0.0;
+            for (int i=0; i<j; ++i)
+            {
+                sum += a[j][i]*a[i][k];
+            }
+            a[j][k] = (a[j][k]-sum)*diag;
+        }
+    }
+
+    // Still need to get last element in L matrix
+    double sum = 0.0;
+    for (int k=0; k<nm1; ++k)
+    {
+        sum += a[nm1][k]*a[k][nm1];
+    }
+    a[nm1][nm1] -= sum;
+
+    return true;
+}
+
+//! @brief Solves A x = b, after the LU decomposition of A has been found by ludcmp()
+//! @param[in] a The LU decomposition of the original coefficient matrix
+//! @param[in] b The right-hand side
+//! @param[out] x The solution
+//! @param[in] order The row order from ludcmp()
+template<int N>
+void solvlu(const FixedMatrix<N,N> &a, const FixedVec<N> &b, FixedVec<N> &x, const int order[])
+{
+    // Rearrange the elements of b, x is used to hold them
+    for (int i=0; i<N; ++i)
+    {
+        x[i] = b[order[i]];
+    }
+
+    // Forward substitution
+    x[0] /= a[0][0];
+    for (int i=1; i<N; ++i)
+    {
+        double sum = 0.0;
+        for (int j=0; j<i; ++j)
+        {
+            sum += a[i][j]*x[j];
+        }
+        x[i] = (x[i]-sum)/a[i][i];
+    }
+
+    // Back substitution, x[N-1] is already done
+    for (int i=N-2; i>=0; --i)
+    {
+        double sum = 0.0;
+        for (int j=i+1; j<N; ++j)
+        {
+            sum += a[i][j]*x[j];
+        }
+        x[i] -= sum;
+    }
+}
+
+}
+
+#endif // FIXEDSIZEMATRIX_H
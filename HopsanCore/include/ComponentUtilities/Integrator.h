@@ -74,6 +74,21 @@ public:
         return mDelayY;
     }
 
+    //! @brief Save the integrator state to a simulation state
+    inline void saveState(SimulationStateWriter &rWriter) const
+    {
+        rWriter.write(mDelayU);
+        rWriter.write(mDelayY);
+    }
+
+    //! @brief Restore the integrator state from a simulation state
+    //! @returns False if the state could not be read
+    inline bool restoreState(SimulationStateReader &rReader)
+    {
+        rReader.read(mDelayU);
+        return rReader.read(mDelayY);
+    }
+
 protected:
     double mDelayU, mDelayY;
     double mTimeStep;
@@ -48,6 +48,8 @@ namespace hopsan {
         void setMinMax(double min, double max);
         double update(double u);
 	double value();
+        void saveState(SimulationStateWriter &rWriter) const;
+        bool restoreState(SimulationStateReader &rReader);
 
     private:
         double mDelayU, mDelayY;
@@ -36,6 +36,7 @@
 
 #include <vector>
 #include <cstring>
+#include <cmath>
 
 inline double interp1(const double x, const double i1, const double i2, const double v1, const double v2)
 {
@@ -60,6 +61,7 @@ public:
         mIndexData.clear(); mIndexData.resize(mNumDims);
         mNumSubDimDataElements.clear(); mNumSubDimDataElements.resize(mNumDims, 0);
         mIndexIncreasingOrDecreasing.clear(); mIndexIncreasingOrDecreasing.resize(mNumDims, Unknown);
+        mLastIntervalIdx.clear(); mLastIntervalIdx.resize(mNumDims, 0);
         resetFirstLast();
     }
 
@@ -124,6 +126,17 @@ public:
 
                 isStrictlyInc = isStrictlyInc && (mIndexIncreasingOrDecreasing[d] == StrictlyIncreasing);
             }
+
+            // The data may have changed, so the cell coefficients must be recalculated if they are wanted
+            mCellCoefficients.clear();
+            if (isStrictlyInc)
+            {
+                calcUniformIndexSteps();
+            }
+            else
+            {
+                resetUniformIndexSteps();
+            }
             return isStrictlyInc;
         }
         else
@@ -322,10 +335,57 @@ public:
         return mIndexData[dim].size();
     }
 
+    //! @brief Check if the index data along a dimension is equidistant, so that intervals can be found without searching
+    bool isIndexUniform(const size_t dim) const
+    {
+        return mInvUniformIndexStep[dim] > 0;
+    }
+
+    //! @brief Find the interval (the lower index) containing x along a dimension
+    //! @details For uniform index data the interval is calculated directly, otherwise the search starts in the interval found
+    //! in the previous call, as consecutive lookups are usually close to each other. Bisection is only used when x has moved
+    //! further than to a neighbouring interval. A value exactly on an index point belongs to the lower interval.
     //! @note Assumes that x is within index range
     size_t findIndexAlongDim(const size_t dim, const double x) const
     {
-        return intervalHalfSubDiv(x, 0, mIndexData[dim].size()-1, dim);
+        const std::vector<double> &rIndex = mIndexData[dim];
+        const size_t lastInterval = rIndex.size()-2;
+
+        size_t idx;
+        if (mInvUniformIndexStep[dim] > 0)
+        {
+            const double f = (x - rIndex[0])*mInvUniformIndexStep[dim];
+            idx = (f > 0) ? size_t(f) : 0;
+        }
+        else
+        {
+            idx = mLastIntervalIdx[dim];
+        }
+        if (idx > lastInterval)
+        {
+            idx = lastInterval;
+        }
+
+        // Check the guessed interval and its neighbours, the guess is never off by more than one for uniform data
+        if ( (idx > 0) && !(rIndex[idx] < x) )
+        {
+            --idx;
+            if ( (idx > 0) && !(rIndex[idx] < x) )
+            {
+                idx = intervalHalfSubDiv(x, 0, idx, dim);
+            }
+        }
+        else if ( (idx < lastInterval) && (rIndex[idx+1] < x) )
+        {
+            ++idx;
+            if ( (idx < lastInterval) && (rIndex[idx+1] < x) )
+            {
+                idx = intervalHalfSubDiv(x, idx+1, lastInterval+1, dim);
+            }
+        }
+
+        mLastIntervalIdx[dim] = idx;
+        return idx;
     }
 
 protected:
@@ -464,6 +524,56 @@ protected:
     {
         mIndexFirst.clear(); mIndexFirst.resize(mNumDims, 0);
         mIndexLast.clear(); mIndexLast.resize(mNumDims, 1);
+        resetUniformIndexSteps();
+        mCellCoefficients.clear();
+    }
+
+    void resetUniformIndexSteps()
+    {
+        mInvUniformIndexStep.clear(); mInvUniformIndexStep.resize(mNumDims, 0);
+    }
+
+    //! @brief Remember the inverted index step for dimensions where the index data is equidistant, 0 otherwise
+    //! @note Assumes that index data is strictly increasing
+    void calcUniformIndexSteps()
+    {
+        resetUniformIndexSteps();
+        for (size_t d=0; d<mNumDims; ++d)
+        {
+            const std::vector<double> &rIndex = mIndexData[d];
+            const size_t nIntervals = rIndex.size()-1;
+            const double step = (rIndex[nIntervals] - rIndex[0])/double(nIntervals);
+            // The tolerance only decides if the direct calculation is worth trying, findIndexAlongDim always checks the result
+            const double tol = 1e-9*step;
+            bool isUniform = true;
+            for (size_t i=0; i<nIntervals; ++i)
+            {
+                if (std::fabs(rIndex[0] + double(i)*step - rIndex[i]) > tol)
+                {
+                    isUniform = false;
+                    break;
+                }
+            }
+            if (isUniform)
+            {
+                mInvUniformIndexStep[d] = 1.0/step;
+            }
+        }
+    }
+
+    //! @brief Calculate the inverted width of each interval in each dimension, used by the cell coefficient form
+    void calcInvIntervalWidths()
+    {
+        mInvIntervalWidths.resize(mNumDims);
+        for (size_t d=0; d<mNumDims; ++d)
+        {
+            const std::vector<double> &rIndex = mIndexData[d];
+            mInvIntervalWidths[d].resize(rIndex.size()-1);
+            for (size_t i=0; i+1<rIndex.size(); ++i)
+            {
+                mInvIntervalWidths[d][i] = 1.0/(rIndex[i+1]-rIndex[i]);
+            }
+        }
     }
 
     inline double limitToRange(const size_t dim, const double val) const
@@ -499,6 +609,12 @@ protected:
 
     std::vector< std::vector<double> > mIndexData;
     std::vector<double> mValueData;
+
+    // Lookup acceleration, the last found interval is remembered even though lookup is const
+    mutable std::vector<size_t> mLastIntervalIdx;
+    std::vector<double> mInvUniformIndexStep;
+    std::vector< std::vector<double> > mInvIntervalWidths;
+    std::vector<double> mCellCoefficients;
 };
 
 class LookupTable1D : public LookupTableNDBase
@@ -550,6 +666,45 @@ public:
         return r*mNumSubDimDataElements[0] + c;
     }
 
+    //! @brief Pre-calculate the bilinear coefficients of each cell, trading memory (four values per cell) for faster interpolation
+    //! @details The coefficients are discarded by isDataOK(), so this must be called again if the data is changed
+    //! @returns False if the data is not OK
+    bool calcCellCoefficients()
+    {
+        mCellCoefficients.clear();
+        if (!isDataSizeOK() || !allIndexStrictlyIncreasing())
+        {
+            return false;
+        }
+        calcInvIntervalWidths();
+
+        const size_t nR = mIndexData[0].size()-1;
+        const size_t nC = mIndexData[1].size()-1;
+        mCellCoefficients.resize(4*nR*nC);
+        double *pCoeff = &mCellCoefficients[0];
+        for (size_t r=0; r<nR; ++r)
+        {
+            for (size_t c=0; c<nC; ++c)
+            {
+                const double v00 = mValueData[calcDataIndex(r, c)];
+                const double v10 = mValueData[calcDataIndex(r+1, c)];
+                const double v01 = mValueData[calcDataIndex(r, c+1)];
+                const double v11 = mValueData[calcDataIndex(r+1, c+1)];
+                pCoeff[0] = v00;
+                pCoeff[1] = v10 - v00;
+                pCoeff[2] = v01 - v00;
+                pCoeff[3] = v11 - v10 - v01 + v00;
+                pCoeff += 4;
+            }
+        }
+        return true;
+    }
+
+    bool hasCellCoefficients() const
+    {
+        return !mCellCoefficients.empty();
+    }
+
     double interpolate(double r, double c) const
     {
         // Handle outside index range
@@ -557,8 +712,17 @@ public:
         c = limitToRange(1, c);
 
         const size_t tl_r = findIndexAlongDim(0, r);
-        const size_t tr_r = tl_r;
         const size_t tl_c = findIndexAlongDim(1, c);
+
+        if (!mCellCoefficients.empty())
+        {
+            const double fr = (r - mIndexData[0][tl_r])*mInvIntervalWidths[0][tl_r];
+            const double fc = (c - mIndexData[1][tl_c])*mInvIntervalWidths[1][tl_c];
+            const double *pCoeff = &mCellCoefficients[4*(tl_r*(mIndexData[1].size()-1) + tl_c)];
+            return pCoeff[0] + fr*(pCoeff[1] + fc*pCoeff[3]) + fc*pCoeff[2];
+        }
+
+        const size_t tr_r = tl_r;
         const size_t bl_c = tl_c;
 
         const size_t tr_c = tl_c+1;
@@ -590,6 +754,57 @@ public:
         return r*mNumSubDimDataElements[0] + c*mNumSubDimDataElements[1] + p;
     }
 
+    //! @brief Pre-calculate the trilinear coefficients of each cell, trading memory (eight values per cell) for faster interpolation
+    //! @details The coefficients are discarded by isDataOK(), so this must be called again if the data is changed
+    //! @returns False if the data is not OK
+    bool calcCellCoefficients()
+    {
+        mCellCoefficients.clear();
+        if (!isDataSizeOK() || !allIndexStrictlyIncreasing())
+        {
+            return false;
+        }
+        calcInvIntervalWidths();
+
+        const size_t nR = mIndexData[0].size()-1;
+        const size_t nC = mIndexData[1].size()-1;
+        const size_t nP = mIndexData[2].size()-1;
+        mCellCoefficients.resize(8*nR*nC*nP);
+        double *pCoeff = &mCellCoefficients[0];
+        for (size_t r=0; r<nR; ++r)
+        {
+            for (size_t c=0; c<nC; ++c)
+            {
+                for (size_t p=0; p<nP; ++p)
+                {
+                    const double v000 = mValueData[calcDataIndex(r, c, p)];
+                    const double v100 = mValueData[calcDataIndex(r+1, c, p)];
+                    const double v010 = mValueData[calcDataIndex(r, c+1, p)];
+                    const double v001 = mValueData[calcDataIndex(r, c, p+1)];
+                    const double v110 = mValueData[calcDataIndex(r+1, c+1, p)];
+                    const double v101 = mValueData[calcDataIndex(r+1, c, p+1)];
+                    const double v011 = mValueData[calcDataIndex(r, c+1, p+1)];
+                    const double v111 = mValueData[calcDataIndex(r+1, c+1, p+1)];
+                    pCoeff[0] = v000;
+                    pCoeff[1] = v100 - v000;
+                    pCoeff[2] = v010 - v000;
+                    pCoeff[3] = v001 - v000;
+                    pCoeff[4] = v110 - v100 - v010 + v000;
+                    pCoeff[5] = v101 - v100 - v001 + v000;
+                    pCoeff[6] = v011 - v010 - v001 + v000;
+                    pCoeff[7] = v111 - v110 - v101 - v011 + v100 + v010 + v001 - v000;
+                    pCoeff += 8;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool hasCellCoefficients() const
+    {
+        return !mCellCoefficients.empty();
+    }
+
     double interpolate(double r, double c, double p) const
     {
         // Handle outside index range
@@ -603,6 +818,17 @@ public:
         // Now do 2d interpolation in each plane
         const size_t tl_r = findIndexAlongDim(0, r);
         const size_t tl_c = findIndexAlongDim(1, c);
+
+        if (!mCellCoefficients.empty())
+        {
+            const double fr = (r - mIndexData[0][tl_r])*mInvIntervalWidths[0][tl_r];
+            const double fc = (c - mIndexData[1][tl_c])*mInvIntervalWidths[1][tl_c];
+            const double fp = (p - mIndexData[2][pl])*mInvIntervalWidths[2][pl];
+            const size_t cell = (tl_r*(mIndexData[1].size()-1) + tl_c)*(mIndexData[2].size()-1) + pl;
+            const double *pCoeff = &mCellCoefficients[8*cell];
+            return pCoeff[0] + fr*(pCoeff[1] + fc*pCoeff[4] + fp*pCoeff[5]) + fc*(pCoeff[2] + fp*pCoeff[6]) + fp*(pCoeff[3] + fr*fc*pCoeff[7]);
+        }
+
         const double vpl = interp2d(tl_r, tl_c, pl, r, c);
         const double vph = interp2d(tl_r, tl_c, pl+1, r, c);
 
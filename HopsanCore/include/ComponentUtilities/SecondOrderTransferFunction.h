@@ -59,6 +59,8 @@ namespace hopsan {
         double delayedY() const;
         double delayed2Y() const;
         bool isSaturated() const;
+        void saveState(SimulationStateWriter &rWriter) const;
+        bool restoreState(SimulationStateReader &rReader);
 
     private:
         double mValue;
@@ -0,0 +1,144 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   CompiledNumHopScript.h
+//! @date   2026-10-18
+//!
+//! @brief Contains a compiled form of numhop scripts, for fast repeated evaluation
+//!
+//$Id$
+
+#ifndef COMPILEDNUMHOPSCRIPT_H
+#define COMPILEDNUMHOPSCRIPT_H
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include "HopsanTypes.h"
+#include "win32dll.h"
+
+namespace hopsan {
+
+//! @brief A numhop script compiled into a flat list of instructions with resolved operands
+//! @details Each instruction reads one or two values through pointers and writes the result through a pointer, so evaluation
+//! does no name lookup and no memory allocation. Names are resolved once when compiling, either to a data pointer that is read
+//! and written on every evaluation, to a constant value, or to an internal variable that keeps its value between evaluations.
+//! Only numbers, names, parentheses, the operators + - * / ^ and assignment to a name are supported. Anything else, including
+//! chained powers and a sign directly before a power, makes compile() fail so that the script can be interpreted instead.
+class HOPSANCORE_DLLAPI CompiledNumHopScript
+{
+public:
+    //! @brief Resolves the names used in a script, when it is compiled
+    class Resolver
+    {
+    public:
+        virtual ~Resolver() {}
+        //! @brief Returns a pointer to data that is read and written on every evaluation, or 0 if there is none for this name
+        virtual double *getDataPtr(const HString &rName) = 0;
+        //! @brief Get a value that is constant while the compiled script is used, returns false if there is none for this name
+        virtual bool getConstantValue(const HString &rName, double &rValue) = 0;
+    };
+
+    CompiledNumHopScript();
+
+    bool compile(const std::vector<HString> &rExpressions, Resolver &rResolver, HString &rError);
+    void clear();
+    bool isCompiled() const;
+    size_t getNumInstructions() const;
+
+    double evaluate();
+
+private:
+    // The compiled instructions point into the object itself, so it must not be copied
+    CompiledNumHopScript(const CompiledNumHopScript &rOther);
+    CompiledNumHopScript &operator=(const CompiledNumHopScript &rOther);
+
+    enum OperatorT {Copy, Add, Subtract, Multiply, Divide, Power, Negate};
+    enum OperandKindT {ConstantOperand, RegisterOperand, VariableOperand, DataPtrOperand, NoOperand};
+
+    //! @brief An operand while compiling, the index refers to the storage of the kind
+    struct Operand
+    {
+        Operand() : kind(NoOperand), index(0) {}
+        Operand(OperandKindT k, size_t i) : kind(k), index(i) {}
+        OperandKindT kind;
+        size_t index;
+    };
+
+    struct Instruction
+    {
+        OperatorT op;
+        double *pDst;
+        const double *pA;
+        const double *pB;
+    };
+
+    struct CompileInstruction
+    {
+        OperatorT op;
+        Operand dst, a, b;
+    };
+
+    // Parser, one expression at a time
+    bool compileExpression(const HString &rExpression, Operand &rResult);
+    bool parseSum(Operand &rResult);
+    bool parseProduct(Operand &rResult);
+    bool parseSigned(Operand &rResult);
+    bool parsePower(Operand &rResult, bool &rHadPower);
+    bool parsePrimary(Operand &rResult);
+    bool parseName(HString &rName);
+    bool readName(const HString &rName, Operand &rResult);
+    bool findDataPtr(const HString &rName, Operand &rResult);
+    bool writeName(const HString &rName, Operand &rTarget);
+    Operand emit(const OperatorT op, const Operand &rA, const Operand &rB);
+    Operand addConstant(const double value);
+    double constantValue(const Operand &rOperand) const;
+    void skipSpace();
+    bool fail(const HString &rError);
+
+    static double apply(const OperatorT op, const double a, const double b);
+    double *storagePtr(const Operand &rOperand);
+
+    // Compile state
+    Resolver *mpResolver;
+    HString mExpression;
+    size_t mPos;
+    HString mError;
+    std::vector<CompileInstruction> mCompileInstructions;
+    std::map<HString, size_t> mVariableNames;
+    std::vector<double*> mDataPtrs;
+    std::map<HString, size_t> mDataPtrNames;
+
+    // The compiled program
+    std::vector<Instruction> mInstructions;
+    std::vector<double> mConstants;
+    std::vector<double> mRegisters;
+    std::vector<double> mVariables;
+    const double *mpResult;
+};
+
+}
+
+#endif // COMPILEDNUMHOPSCRIPT_H
@@ -0,0 +1,127 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   LogDataStorage.h
+//! @date   2026-10-18
+//!
+//! @brief Contains the columnar, chunked log data storage used by nodes
+//!
+//$Id$
+
+#ifndef LOGDATASTORAGE_H
+#define LOGDATASTORAGE_H
+
+#include <cstddef>
+#include <vector>
+#include "win32dll.h"
+
+namespace hopsan {
+
+//! @brief Columnar log data storage, the samples of each variable are stored contiguously in fixed size chunks
+//! @details All chunks are allocated in resize(), so writing samples during simulation never allocates memory.
+//! Within a chunk, stored variable number c occupies the range [c*chunkLength, (c+1)*chunkLength).
+//! A log mask can be given to only store some of the variables, the others take no memory and are not copied.
+//! Read single values with value(), whole variables with copyVariable() or getVariableChunk(), and whole samples
+//! with copySample() or getSample(). Prefer the variable accessors when reading large amounts of data.
+class HOPSANCORE_DLLAPI LogDataStorage
+{
+public:
+    //! @brief The maximum number of samples in one chunk (must be a power of two)
+    static const size_t ChunkSize = 1024;
+
+    LogDataStorage();
+
+    void resize(const size_t nSamples, const size_t nVariables, const std::vector<bool> &rLogMask=std::vector<bool>());
+    void truncate(const size_t nSamples);
+    void clear();
+
+    //! @brief Check if the storage is empty (has no samples)
+    bool empty() const { return mNumSamples == 0; }
+    //! @brief Returns the number of samples (rows)
+    size_t size() const { return mNumSamples; }
+    //! @brief Returns the number of variables (columns), including those that are not stored
+    size_t getNumVariables() const { return mNumVariables; }
+    //! @brief Returns the number of variables that are actually stored
+    size_t getNumStoredVariables() const { return mStoredVariables.size(); }
+    //! @brief Check if a variable is stored (not masked out)
+    bool isVariableStored(const size_t variable) const { return (variable < mNumVariables) && (mColumns[variable] != NotStored); }
+    size_t getNumChunks() const { return mChunks.size(); }
+
+    //! @brief Write one sample
+    //! @param[in] sample The sample index
+    //! @param[in] pValues Pointer to getNumVariables() values, only the stored ones are read
+    //! @warning No bounds check is done
+    inline void write(const size_t sample, const double *pValues)
+    {
+        const size_t c = sample/ChunkSize;
+        const size_t stride = chunkLength(c);
+        double *pDst = mChunks[c].data() + (sample - c*ChunkSize);
+        const size_t nStored = mStoredVariables.size();
+        for (size_t col=0; col<nStored; ++col)
+        {
+            pDst[col*stride] = pValues[mStoredVariables[col]];
+        }
+    }
+
+    //! @brief Read the value of one variable at one sample
+    //! @returns The value, or NaN if the variable is not stored
+    //! @warning No bounds check is done
+    inline double value(const size_t sample, const size_t variable) const
+    {
+        const size_t col = mColumns[variable];
+        if (col == NotStored)
+        {
+            return notStoredValue();
+        }
+        const size_t c = sample/ChunkSize;
+        return mChunks[c][col*chunkLength(c) + (sample - c*ChunkSize)];
+    }
+
+    const double *getVariableChunk(const size_t variable, const size_t chunk, size_t &rLength) const;
+    void copyVariable(const size_t variable, double *pDst) const;
+    std::vector<double> getVariable(const size_t variable) const;
+    void copySample(const size_t sample, double *pDst) const;
+    std::vector<double> getSample(const size_t sample) const;
+
+private:
+    static const size_t NotStored = static_cast<size_t>(-1);
+    static double notStoredValue();
+
+    //! @brief Returns the number of samples held by chunk c, all but the last chunk are full
+    inline size_t chunkLength(const size_t c) const
+    {
+        return (c+1 < mChunks.size()) ? ChunkSize : mNumSamples - c*ChunkSize;
+    }
+
+    std::vector< std::vector<double> > mChunks;
+    std::vector<size_t> mStoredVariables;
+    std::vector<size_t> mColumns;
+    size_t mNumSamples;
+    size_t mNumVariables;
+};
+
+}
+
+#endif // LOGDATASTORAGE_H
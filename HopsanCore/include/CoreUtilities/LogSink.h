@@ -0,0 +1,171 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   LogSink.h
+//! @date   2026-10-18
+//!
+//! @brief Contains the log sink interface used to stream log data out of a system during simulation
+//!
+//$Id$
+
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include "HopsanTypes.h"
+#include "win32dll.h"
+
+namespace hopsan {
+
+//! @brief Describes one variable sent to a log sink
+class LogSinkVariable
+{
+public:
+    HString mComponent;
+    HString mPort;
+    HString mName;
+    HString mAlias;
+    HString mUnit;
+    HString mQuantity;
+};
+
+//! @brief Interface for receivers of log data, a system with a log sink streams its samples to the sink instead of storing them in the nodes
+class HOPSANCORE_DLLAPI LogSink
+{
+public:
+    virtual ~LogSink();
+
+    //! @brief Called during initialize, before the first sample
+    //! @param[in] rVariables The variables in each sample
+    //! @param[in] nExpectedSamples The number of samples that will be written if the simulation runs to the end
+    //! @returns True on success
+    virtual bool open(const std::vector<LogSinkVariable> &rVariables, const size_t nExpectedSamples) = 0;
+
+    //! @brief Called from the simulation loop for each log sample, should be fast and must not block for long
+    //! @param[in] time The simulation time of the sample
+    //! @param[in] pValues The values of all variables, in the same order as given to open()
+    virtual void write(const double time, const double *pValues) = 0;
+
+    //! @brief Called during finalize, after the last sample
+    //! @returns True if all samples were written successfully
+    virtual bool close() = 0;
+
+    virtual HString getErrorMessage() const;
+};
+
+class BufferedLogSinkPrivates;
+
+//! @brief A log sink with a ring buffer of sample blocks, full blocks are written by a background thread
+//! @details The simulation thread only copies values into the current block. When a block is full it is handed over to the
+//! writer thread and the next free block is used. The simulation only waits if all blocks are waiting to be written.
+//! In builds without multi-threading the blocks are written directly when full.
+//! Each block is column major, column 0 holds the time and column v+1 variable v, each column is blockSize long.
+class HOPSANCORE_DLLAPI BufferedLogSink : public LogSink
+{
+public:
+    BufferedLogSink(const size_t blockSize=1024, const size_t numBlocks=4);
+    ~BufferedLogSink();
+
+    bool open(const std::vector<LogSinkVariable> &rVariables, const size_t nExpectedSamples);
+    void write(const double time, const double *pValues);
+    bool close();
+    HString getErrorMessage() const;
+
+    size_t getNumWrittenSamples() const;
+
+protected:
+    //! @brief Open the underlying storage
+    virtual bool openStorage(const std::vector<LogSinkVariable> &rVariables, const size_t nExpectedSamples) = 0;
+    //! @brief Write one block of samples, column c starts at pBlock+c*stride
+    virtual bool writeBlock(const double *pBlock, const size_t nSamples, const size_t stride) = 0;
+    //! @brief Close the underlying storage
+    virtual bool closeStorage() = 0;
+
+    void setErrorMessage(const HString &rMessage);
+    size_t getNumVariables() const;
+
+private:
+    void submitBlock();
+    void writeBlockChecked(const size_t block);
+    friend class BufferedLogSinkPrivates;
+
+    BufferedLogSinkPrivates *mpPrivates;
+    double *mpCurrentBlock;
+    size_t mCurrentSample;
+    size_t mBlockSize;
+    size_t mNumVariables;
+};
+
+//! @brief A buffered log sink that streams to a binary file
+//! @details File layout (native byte order): the 8 byte identifier "HOPSLOG1", the number of variables (uint64) and for each variable
+//! the component, port, name, alias, unit and quantity strings (uint32 length followed by the characters).
+//! Then follows blocks with the number of samples n (uint64), n time values and n values for each variable (doubles).
+class HOPSANCORE_DLLAPI BinaryFileLogSink : public BufferedLogSink
+{
+public:
+    BinaryFileLogSink(const HString &rFilePath, const size_t blockSize=1024, const size_t numBlocks=4);
+    ~BinaryFileLogSink();
+    const HString &getFilePath() const;
+
+protected:
+    bool openStorage(const std::vector<LogSinkVariable> &rVariables, const size_t nExpectedSamples);
+    bool writeBlock(const double *pBlock, const size_t nSamples, const size_t stride);
+    bool closeStorage();
+
+private:
+    HString mFilePath;
+    FILE *mpFile;
+};
+
+//! @brief Reads files written by BinaryFileLogSink, one variable at a time without loading the entire file
+class HOPSANCORE_DLLAPI BinaryLogFileReader
+{
+public:
+    BinaryLogFileReader();
+    ~BinaryLogFileReader();
+
+    bool open(const HString &rFilePath);
+    void close();
+
+    const std::vector<LogSinkVariable> &getVariables() const;
+    size_t getNumSamples() const;
+    bool readTime(std::vector<double> &rTime);
+    bool readVariable(const size_t variable, std::vector<double> &rValues);
+
+private:
+    bool readColumn(const size_t column, std::vector<double> &rValues);
+
+    FILE *mpFile;
+    std::vector<LogSinkVariable> mVariables;
+    std::vector<long long> mBlockOffsets;
+    std::vector<size_t> mBlockSamples;
+    size_t mNumSamples;
+};
+
+}
+
+#endif // LOGSINK_H
@@ -41,6 +41,12 @@
 #define HOPSANCORE_USEMULTITHREADING
 #endif
 
+//! @brief Assumed cache line size, used to pad shared synchronization variables and align node data
+#define HOPSAN_CACHE_LINE_SIZE 64
+
+//! @brief Default minimum number of signal components in a dependency level for it to be simulated in parallel
+#define HOPSAN_DEFAULT_WAVEFRONT_MIN_LEVEL_SIZE 32
+
 
 namespace hopsan {
 
@@ -52,6 +58,7 @@ size_t HOPSANCORE_DLLAPI determineActualNumberOfThreads(const size_t nDesiredThr
 
 #include <atomic>
 #include <mutex>
+#include <thread>
 
 namespace hopsan {
 
@@ -95,16 +102,59 @@ private:
     std::atomic<bool> mLock;
 };
 
+//! @brief Default number of spin iterations before a waiting thread goes to sleep in a SpinFutexBarrier
+#define HOPSAN_DEFAULT_BARRIER_SPIN_COUNT 2000
+
+//! @brief Sense-reversing barrier where all threads (including the master) wait in the same way
+//! @details A waiting thread first spins for a configurable number of iterations, then it sleeps on a futex (Linux) or yields (other platforms).
+//! The last thread to arrive also publishes whether any thread requested the simulation to stop, so that all threads agree on when to stop.
+class HOPSANCORE_DLLAPI SpinFutexBarrier
+{
+public:
+    SpinFutexBarrier(size_t nThreads, size_t spinCount=HOPSAN_DEFAULT_BARRIER_SPIN_COUNT);
+
+    bool wait(int &rLocalSense, bool requestStop=false);
+
+    size_t getNumThreads() const;
+    size_t getSpinCount() const;
+
+private:
+    void sleepWhileState(int state);
+    void wakeAll();
+
+    char mPad0[HOPSAN_CACHE_LINE_SIZE];
+    std::atomic<int> mCounter;
+    char mPad1[HOPSAN_CACHE_LINE_SIZE-sizeof(std::atomic<int>)];
+    std::atomic<int> mState;                //!< Bit 0 is the global sense, bit 1 is set if a stop was requested
+    char mPad2[HOPSAN_CACHE_LINE_SIZE-sizeof(std::atomic<int>)];
+    std::atomic<int> mnSleepers;
+    std::atomic<bool> mStopRequested;
+    char mPad3[HOPSAN_CACHE_LINE_SIZE];
+    int mnThreads;
+    size_t mSpinCount;
+};
+
 
 void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std::vector<Component *> &cVector,
                std::vector<Component *> &qVector, std::vector<Node *> &nVector, std::vector<double *> &pSimTimes,
                double startTime, double timeStep, size_t numSimSteps, BarrierLock *pBarrier_S,
-               BarrierLock *pBarrier_C, BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N);
+               BarrierLock *pBarrier_C, BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N, size_t sampleInterval=0);
 
 void simSlave(ComponentSystem *pSystem, std::vector<Component*> &sVector, std::vector<Component*> &cVector,
               std::vector<Component*> &qVector, std::vector<Node*> &nVector, double startTime,
               double timeStep, size_t numSimSteps, BarrierLock *pBarrier_S,
-              BarrierLock *pBarrier_C, BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N);
+              BarrierLock *pBarrier_C, BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N, size_t sampleInterval=0);
+
+void simSpinFutexMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std::vector<Component *> &cVector,
+                        std::vector<Component *> &qVector, std::vector<double *> &pSimTimes,
+                        double startTime, double timeStep, size_t numSimSteps, SpinFutexBarrier *pBarrier, size_t sampleInterval=0,
+                        std::vector<std::vector<Component *> > *pSignalStages=0);
+
+void simSpinFutexSlave(ComponentSystem *pSystem, std::vector<Component *> &sVector, std::vector<Component *> &cVector,
+                       std::vector<Component *> &qVector, double startTime, double timeStep, size_t numSimSteps,
+                       SpinFutexBarrier *pBarrier, size_t sampleInterval=0, std::vector<std::vector<Component *> > *pSignalStages=0);
+
+void simulateAndSampleTime(std::vector<Component*> &rComponents, double stopTime, bool firstSample);
 
 void simWholeSystems(std::vector<ComponentSystem *> systemPtrs, double stopTime);
 
@@ -183,6 +233,8 @@ void simPoolSlave(TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ, std::atomic<double
 /////////////////////////////
 
 
+//! @brief Mutex protected vector of components
+//! @note No longer used by the task-stealing algorithm (see WorkStealingDeque), kept for comparison benchmarks
 class ThreadSafeVector
 {
 public:
@@ -288,10 +340,115 @@ private:
 };
 
 
+//! @brief Lock-free work-stealing deque (Chase-Lev) with fixed capacity
+//! @details The owning thread pushes and pops at the bottom using only plain loads and stores (and one fence),
+//! other threads steal from the top with a single compare-and-swap. Only the last element needs a CAS by the owner.
+//! @note The capacity is never grown, the total number of components that can be in the deque must not exceed maxSize
+class WorkStealingDeque
+{
+public:
+    WorkStealingDeque(const std::vector<Component*> &rData, size_t maxSize)
+    {
+        size_t capacity=1;
+        while(capacity < maxSize)
+        {
+            capacity *= 2;
+        }
+        mMask = capacity-1;
+        mpBuffer = new std::atomic<Component*>[capacity];
+        mTop.store(0);
+        mBottom.store(0);
+        for(size_t i=0; i<rData.size(); ++i)
+        {
+            pushBottom(rData[i]);
+        }
+    }
+
+    ~WorkStealingDeque()
+    {
+        delete[] mpBuffer;
+    }
+
+    //! @brief Push a component to the bottom of the deque
+    //! @note Must only be called by the owning thread
+    inline void pushBottom(Component *pComp)
+    {
+        const long b = mBottom.load(std::memory_order_relaxed);
+        mpBuffer[b & mMask].store(pComp, std::memory_order_relaxed);
+        mBottom.store(b+1, std::memory_order_release);
+    }
+
+    //! @brief Pop a component from the bottom of the deque
+    //! @note Must only be called by the owning thread
+    //! @returns Pointer to the component or 0 if the deque was empty
+    inline Component *popBottom()
+    {
+        const long b = mBottom.load(std::memory_order_relaxed) - 1;
+        mBottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long t = mTop.load(std::memory_order_relaxed);
+        if(t > b)
+        {
+            // Deque was empty
+            mBottom.store(b+1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        Component *pComp = mpBuffer[b & mMask].load(std::memory_order_relaxed);
+        if(t == b)
+        {
+            // Last element, race against thieves
+            if(!mTop.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                pComp = 0;
+            }
+            mBottom.store(b+1, std::memory_order_relaxed);
+        }
+        return pComp;
+    }
+
+    //! @brief Try to steal a component from the top of the deque, can be called by any thread
+    //! @returns Pointer to the component or 0 if the deque was empty or if another thread won the race
+    inline Component *steal()
+    {
+        long t = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const long b = mBottom.load(std::memory_order_acquire);
+        if(t >= b)
+        {
+            return 0;
+        }
+
+        Component *pComp = mpBuffer[t & mMask].load(std::memory_order_relaxed);
+        if(!mTop.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return 0;
+        }
+        return pComp;
+    }
+
+    //! @note Only reliable if no other thread is modifying the deque
+    size_t size() const
+    {
+        return size_t(mBottom.load()-mTop.load());
+    }
+
+private:
+    // Top is written by thieves and bottom by the owner, keep them on separate cache lines
+    char mPad0[HOPSAN_CACHE_LINE_SIZE];
+    std::atomic<long> mTop;
+    char mPad1[HOPSAN_CACHE_LINE_SIZE-sizeof(std::atomic<long>)];
+    std::atomic<long> mBottom;
+    char mPad2[HOPSAN_CACHE_LINE_SIZE-sizeof(std::atomic<long>)];
+    std::atomic<Component*> *mpBuffer;
+    long mMask;
+};
+
+
 void simStealingMaster(ComponentSystem *pSystem,
                        std::vector<Component*> &sVector,
-                       std::vector<ThreadSafeVector*> *cVectors,
-                       std::vector<ThreadSafeVector*> *qVectors,
+                       std::vector<WorkStealingDeque*> *cVectors,
+                       std::vector<WorkStealingDeque*> *qVectors,
                        std::vector<double *> &pSimTimes,
                        double startTime,
                        double timeStep,
@@ -308,8 +465,8 @@ void simStealingMaster(ComponentSystem *pSystem,
 
 
 void simStealingSlave(ComponentSystem *pSystem,
-                      std::vector<ThreadSafeVector*> *cVectors,
-                      std::vector<ThreadSafeVector*> *qVectors,
+                      std::vector<WorkStealingDeque*> *cVectors,
+                      std::vector<WorkStealingDeque*> *qVectors,
                       double startTime,
                       double timeStep,
                       size_t numSimSteps,
@@ -335,6 +492,74 @@ void simOneComponentOneStep(Component * pComp, double stopTime);
 
 void simOneStep(std::vector<Component *> *pComponentPtrs, double stopTime);
 
+
+///////////////////////////////////////////////////
+// Persistent worker thread pool for parallel for //
+///////////////////////////////////////////////////
+
+//! @brief Pool of worker threads that are kept alive during an entire multi-threaded simulation
+//! @details The calling (master) thread dispatches one component vector (or one vector of component groups) per step,
+//! takes part in the work itself and returns when all tasks in the step are finished. No threads are created or joined per step.
+//! Idle worker threads spin for a while and then sleep on a futex (Linux) or yield (other platforms) until the next step.
+class HOPSANCORE_DLLAPI WorkerThreadPool
+{
+public:
+    WorkerThreadPool(size_t nThreads, size_t spinCount=HOPSAN_DEFAULT_BARRIER_SPIN_COUNT);
+    ~WorkerThreadPool();
+
+    size_t getNumThreads() const;
+
+    void simulateComponents(std::vector<Component*> &rComponentPtrs, double stopTime);
+    void simulateComponentGroups(std::vector< std::vector<Component*> > &rComponentGroups, double stopTime);
+
+private:
+    void dispatch(std::vector<Component*> *pComponentPtrs, std::vector< std::vector<Component*> > *pComponentGroups, size_t nTasks, double stopTime);
+    void runTasks();
+    void workerLoop();
+
+    std::vector<std::thread> mWorkers;
+
+    // The current step job, written by the master before the generation counter is incremented
+    std::vector<Component*> *mpComponentPtrs;
+    std::vector< std::vector<Component*> > *mpComponentGroups;
+    size_t mnTasks;
+    double mStopTime;
+    size_t mSpinCount;
+
+    std::atomic<int> mGeneration;
+    std::atomic<int> mnSleepers;
+    std::atomic<size_t> mNextTask;
+    std::atomic<size_t> mnFinishedWorkers;
+    std::atomic<bool> mStop;
+};
+
+
+////////////////////////////////////////////////
+// Wavefront scheduling of signal components //
+////////////////////////////////////////////////
+
+//! @brief Schedule for simulating signal components one dependency level (wavefront) at a time
+//! @details Components in the same level do not depend on each other and can be simulated in parallel. Levels with fewer than
+//! the minimum number of components are simulated serially by the master thread, and consecutive serial levels are merged
+//! into one stage. All threads must synchronize between stages.
+class HOPSANCORE_DLLAPI SignalWavefront
+{
+public:
+    void build(const std::vector< std::vector<Component*> > &rLevels, const size_t nThreads, const size_t minLevelSize);
+    void clear();
+
+    size_t getNumStages() const;
+    size_t getNumParallelStages() const;
+    bool isParallelStage(const size_t stage) const;
+    std::vector<Component*> &getStageComponents(const size_t stage);
+    std::vector< std::vector<Component*> > &getThreadStages(const size_t thread);
+
+private:
+    std::vector< std::vector<Component*> > mStages;
+    std::vector<bool> mParallelStages;
+    std::vector< std::vector< std::vector<Component*> > > mThreadStages;      //!< [thread][stage]
+};
+
 }
 
 #endif //C++11 and threading
@@ -50,6 +50,8 @@ public:
     bool evalNumHopScript(const HString &script, double &rValue, bool doPrintOutput, HString &rOutput);
     bool interpretNumHopScript(const HString &script, bool doPrintOutput, HString &rOutput);
     bool eval(double &rValue, bool doPrintOutput, HString &rOutput);
+    bool compile(HString &rError);
+    bool isCompiled() const;
 
     HVector<HString> extractVariableNames(const HString &expression) const;
     static HVector<HString> extractNamedValues(const HString &expression);
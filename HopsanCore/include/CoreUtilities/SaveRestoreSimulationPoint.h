@@ -27,6 +27,7 @@
 #ifndef SAVERESTORESIMULATIONPOINT_H
 #define SAVERESTORESIMULATIONPOINT_H
 
+#include <vector>
 #include "win32dll.h"
 #include "HopsanTypes.h"
 
@@ -37,6 +38,12 @@ class ComponentSystem;
 void HOPSANCORE_DLLAPI saveSimulationPoint(HString fileName, ComponentSystem* pRootSystem);
 void HOPSANCORE_DLLAPI restoreSimulationPoint(HString fileName, ComponentSystem* pRootSystem, double &rTimeOffset);
 
+bool HOPSANCORE_DLLAPI saveSimulationSnapshot(ComponentSystem* pRootSystem, std::vector<char> &rBuffer);
+bool HOPSANCORE_DLLAPI restoreSimulationSnapshot(const std::vector<char> &rBuffer, ComponentSystem* pRootSystem);
+bool HOPSANCORE_DLLAPI getSimulationSnapshotTime(const std::vector<char> &rBuffer, double &rTime);
+bool HOPSANCORE_DLLAPI saveSimulationSnapshot(const HString &rFileName, ComponentSystem* pRootSystem);
+bool HOPSANCORE_DLLAPI loadSimulationSnapshot(const HString &rFileName, std::vector<char> &rBuffer);
+
 }
 
 #endif // SAVERESTORESIMULATIONPOINT_H
@@ -0,0 +1,99 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   SimulationEnsemble.h
+//! @date   2026-10-18
+//!
+//! @brief Contains the simulation ensemble class, used to simulate many parameter variants of one model together
+//!
+//$Id$
+
+#ifndef SIMULATIONENSEMBLE_H
+#define SIMULATIONENSEMBLE_H
+
+#include <cstddef>
+#include <vector>
+#include "HopsanTypes.h"
+#include "win32dll.h"
+
+namespace hopsan {
+
+// Forward declaration
+class ComponentSystem;
+class HopsanEssentials;
+class Node;
+
+//! @brief An ensemble of variants of the same model, that are simulated together
+//! @details All variants share the same topology, but each variant is an independent system with its own parameters and results.
+//! The node data of all variants is stored in one block, where the data of each node is followed by the same node in the next
+//! variant. The variants are stepped in lockstep, each component is simulated for all variants before the next component, so
+//! that the same component code and neighbouring node data is used repeatedly. The variants can be split over several threads.
+//! If a parameter change makes the variants differ in topology or time step, each variant is simulated on its own instead.
+class HOPSANCORE_DLLAPI SimulationEnsemble
+{
+public:
+    SimulationEnsemble(HopsanEssentials *pHopsanEssentials);
+    ~SimulationEnsemble();
+
+    bool loadModel(const char *xmlString, const size_t nVariants);
+    void clear();
+
+    size_t getNumVariants() const;
+    ComponentSystem *getVariant(const size_t variant) const;
+    double getModelStartTime() const;
+    double getModelStopTime() const;
+    bool setParameterValue(const size_t variant, const HString &rComponentName, const HString &rParameterName, const HString &rValue);
+
+    void setNumThreads(const size_t nDesiredThreads);
+    size_t getNumThreads() const;
+
+    bool initialize(const double startT, const double stopT);
+    bool simulate(const double stopT);
+    void finalize();
+
+    bool isLockstep() const;
+
+private:
+    static void collectNodes(ComponentSystem *pSystem, std::vector<Node*> &rNodes);
+    void buildNodeDataLayout();
+    void releaseNodeDataLayout();
+    bool determineLockstep() const;
+    void simulateVariants(const size_t firstVariant, const size_t endVariant, const double stopT);
+
+    HopsanEssentials *mpHopsanEssentials;
+    std::vector<ComponentSystem*> mVariants;
+    double mModelStartTime;
+    double mModelStopTime;
+    size_t mnThreads;
+    bool mLockstep;
+
+    std::vector<size_t> mThreadFirstVariants;
+    std::vector<double> mNodeDataStorage;
+    std::vector<Node*> mNodeDataNodes;
+};
+
+}
+
+#endif // SIMULATIONENSEMBLE_H
@@ -44,7 +44,11 @@ enum ParallelAlgorithmT {OfflineSchedulingAlgorithm,
                          TaskPoolAlgorithm,
                          TaskStealingAlgorithm,
                          ParallelForAlgorithm,
-                         GroupedParallelForAlgorithm};
+                         GroupedParallelForAlgorithm,
+                         GraphPartitioningAlgorithm};
+
+enum BarrierAlgorithmT {BusyWaitBarrierAlgorithm,
+                        SpinFutexBarrierAlgorithm};
 
 // Forward declaration
 class ComponentSystem;
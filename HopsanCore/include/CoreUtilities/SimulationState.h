@@ -0,0 +1,139 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   SimulationState.h
+//! @date   2026-10-18
+//!
+//! @brief Contains the binary writer and reader used to save and restore the internal simulation state of components
+//!
+//$Id$
+
+#ifndef SIMULATIONSTATE_H
+#define SIMULATIONSTATE_H
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace hopsan {
+
+//! @brief Appends raw binary values to a simulation state buffer
+//! @details Values are written in native byte order, only plain values (double, size_t, bool and so on) may be written
+//! @ingroup ComponentUtilityClasses
+class SimulationStateWriter
+{
+public:
+    SimulationStateWriter(std::vector<char> &rBuffer) : mrBuffer(rBuffer) {}
+
+    //! @brief Write one value
+    template<typename T>
+    inline void write(const T &rValue)
+    {
+        write(&rValue, 1);
+    }
+
+    //! @brief Write an array of values
+    //! @param[in] pValues Pointer to the first value
+    //! @param[in] n The number of values
+    template<typename T>
+    inline void write(const T *pValues, const size_t n)
+    {
+        const size_t offset = mrBuffer.size();
+        mrBuffer.resize(offset + n*sizeof(T));
+        if (n > 0)
+        {
+            std::memcpy(&mrBuffer[offset], pValues, n*sizeof(T));
+        }
+    }
+
+private:
+    std::vector<char> &mrBuffer;
+};
+
+//! @brief Reads raw binary values from a simulation state buffer
+//! @details Reading past the end of the buffer fails and marks the reader as bad, so that several values can be read before checking
+//! @ingroup ComponentUtilityClasses
+class SimulationStateReader
+{
+public:
+    SimulationStateReader(const char *pData, const size_t size) : mpData(pData), mSize(size), mPos(0), mIsOk(true) {}
+
+    //! @brief Read one value
+    //! @returns False if there was not enough data left
+    template<typename T>
+    inline bool read(T &rValue)
+    {
+        return read(&rValue, 1);
+    }
+
+    //! @brief Read an array of values
+    //! @param[out] pValues Pointer to where the values should be written
+    //! @param[in] n The number of values
+    //! @returns False if there was not enough data left
+    template<typename T>
+    inline bool read(T *pValues, const size_t n)
+    {
+        if (!mIsOk || n*sizeof(T) > mSize-mPos)
+        {
+            mIsOk = false;
+            return false;
+        }
+        if (n > 0)
+        {
+            std::memcpy(pValues, mpData+mPos, n*sizeof(T));
+        }
+        mPos += n*sizeof(T);
+        return true;
+    }
+
+    //! @brief Skip a number of bytes
+    //! @returns False if there was not enough data left
+    inline bool skip(const size_t nBytes)
+    {
+        if (!mIsOk || nBytes > mSize-mPos)
+        {
+            mIsOk = false;
+            return false;
+        }
+        mPos += nBytes;
+        return true;
+    }
+
+    //! @brief Returns a pointer to the current read position
+    inline const char *data() const { return mpData+mPos; }
+    //! @brief Returns the number of bytes that have not been read
+    inline size_t remaining() const { return mSize-mPos; }
+    //! @brief Returns false if any read has failed
+    inline bool isOk() const { return mIsOk; }
+
+private:
+    const char *mpData;
+    size_t mSize, mPos;
+    bool mIsOk;
+};
+
+}
+
+#endif // SIMULATIONSTATE_H
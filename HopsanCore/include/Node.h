@@ -35,6 +35,7 @@
 #include <vector>
 #include "HopsanTypes.h"
 #include "CoreUtilities/ClassFactory.hpp"
+#include "CoreUtilities/LogDataStorage.h"
 #include "win32dll.h"
 
 namespace hopsan {
@@ -72,6 +73,7 @@ class HOPSANCORE_DLLAPI Node
     friend class ComponentSystem;
     friend class ConnectionAssistant;
     friend class HopsanEssentials;
+    friend class SimulationEnsemble;
 
 public:
     Node(const size_t datalength);
@@ -89,14 +91,14 @@ public:
     //! @return The data value
     inline double getDataValue(const size_t dataId) const
     {
-        return mDataValues[dataId];
+        return mpDataValues[dataId];
     }
     //! @brief set data in node
     //! @param [in] dataId Identifier for the type of node data to set, (no bounds check is performed)
     //! @param [in] data The data value
     inline void setDataValue(const size_t dataId, const double data)
     {
-        mDataValues[dataId] = data;
+        mpDataValues[dataId] = data;
     }
 
     const std::vector<NodeDataDescription>* getDataDescriptions() const;
@@ -127,14 +129,23 @@ protected:
     virtual void copySignalQuantityAndUnitTo(Node *pOtherNode) const;
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const;
 
-    void preAllocateLogSpace(const size_t nLogSlots);
+    void preAllocateLogSpace(const size_t nLogSlots, const bool logEnvelope=false);
+    void accumulateLogData();
+    void logAccumulatedData(const size_t logSlot, const bool logMean);
+    void truncateLogData(const size_t nLogSlots);
 
     double *getDataPtr(const size_t data_type);
 
+    void setDataStorage(double *pStorage);
+    bool hasExternalDataStorage() const;
+    void copyDataValuesToDataVector();
+
     // Protected member variables
     HString mNiceName;
     std::vector<NodeDataDescription> mDataDescriptions;
     std::vector<double> mDataValues;
+    //! @brief Points to the current data values, either the data in mDataValues or in external storage (such as a system node data arena)
+    double *mpDataValues;
 
 private:
     // Private member functions
@@ -149,8 +160,15 @@ private:
     ComponentSystem *mpOwnerSystem;
 
     // Log specific variables
-    std::vector<std::vector<double> > mDataStorage;
+    LogDataStorage mDataStorage;
+    LogDataStorage mMinDataStorage;
+    LogDataStorage mMaxDataStorage;
+    std::vector<bool> mLogMask;
     bool mDoLog;
+
+    // Accumulated values since the last log sample, used for interval mean and envelope logging
+    std::vector<double> mLogIntervalMin, mLogIntervalMax, mLogIntervalSum;
+    size_t mLogIntervalCount;
 };
 
 typedef ClassFactory<HString, Node> NodeFactory;
@@ -198,14 +198,14 @@ private:
         setDataCharacteristics(HeatFlow, "HeatFlow", "Qdot", "?", HiddenType);
 
         // Set default initial startvales to reasonable (non-zero) values
-        mDataValues[Pressure] = 100000;
-        mDataValues[WaveVariable] = 100000;
-        mDataValues[Temperature] = 293;
+        mpDataValues[Pressure] = 100000;
+        mpDataValues[WaveVariable] = 100000;
+        mpDataValues[Temperature] = 293;
     }
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Pressure]);
+        pOtherNode->setDataValue(WaveVariable, mpDataValues[Pressure]);
         //! todo Maybe also write CHARIMP?
     }
 };
@@ -231,13 +231,13 @@ private:
 //        setDataCharacteristics(CharImpedance, "CharImpedance", "Zc", "Pa s/m^3", TLMType);
 
 //        // Set default initial startvales to reasonable (non-zero) values
-//        mDataValues[Pressure] = 100000;
-//        mDataValues[WaveVariable] = 100000;
+//        mpDataValues[Pressure] = 100000;
+//        mpDataValues[WaveVariable] = 100000;
 //    }
 
 //    virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
 //    {
-//        pOtherNode->setDataValue(WaveVariable, mDataValues[Pressure]);
+//        pOtherNode->setDataValue(WaveVariable, mpDataValues[Pressure]);
 //        //! todo Maybe also write CHARIMP?
 //    }
 //};
@@ -264,14 +264,14 @@ private:
         setDataCharacteristics(HeatFlow, "HeatFlow", "Qdot", "?", HiddenType);
 
         // Set default initial startvales to reasonable (non-zero) values
-        mDataValues[Pressure] = 100000;
-        mDataValues[WaveVariable] = 100000;
-        mDataValues[Temperature] = 293;
+        mpDataValues[Pressure] = 100000;
+        mpDataValues[WaveVariable] = 100000;
+        mpDataValues[Temperature] = 293;
     }
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Pressure]);
+        pOtherNode->setDataValue(WaveVariable, mpDataValues[Pressure]);
         //! todo Maybe also write CHARIMP?
     }
 };
@@ -299,14 +299,14 @@ private:
         setDataCharacteristics(EnergyFlow, "EnergyFlow", "Qdot", "J/s", DefaultType);
 
         // Set default initial startvales to reasonable (non-zero) values
-        mDataValues[Pressure] = 100000;
-        mDataValues[WaveVariable] = 100000;
-        mDataValues[Temperature] = 293;
+        mpDataValues[Pressure] = 100000;
+        mpDataValues[WaveVariable] = 100000;
+        mpDataValues[Temperature] = 293;
     }
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Pressure]);
+        pOtherNode->setDataValue(WaveVariable, mpDataValues[Pressure]);
         //! todo Maybe also write CharImpedance?
     }
 };
@@ -333,12 +333,12 @@ private:
         setDataCharacteristics(CharImpedance, "CharImpedance", "Zc", "N s/m", TLMType);
         setDataCharacteristics(EquivalentMass, "EquivalentMass", "me", "kg", DefaultType);
 
-        mDataValues[EquivalentMass]=1;
+        mpDataValues[EquivalentMass]=1;
     }
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Force]);
+        pOtherNode->setDataValue(WaveVariable, mpDataValues[Force]);
         //! todo Maybe also write CharImpedance?
     }
 };
@@ -368,7 +368,7 @@ private:
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Torque]);
+        pOtherNode->setDataValue(WaveVariable, mpDataValues[Torque]);
         //! todo Maybe also write CharImpedance?
     }
 };
@@ -398,7 +398,7 @@ private:
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Voltage]);
+        pOtherNode->setDataValue(WaveVariable, mpDataValues[Voltage]);
         //! todo Maybe also write CharImpedance?
     }
 };
@@ -440,16 +440,16 @@ private:
         setDataCharacteristics(EquivalentMassX, "EquivalentMassX", "mex", "kg", DefaultType);
         setDataCharacteristics(EquivalentMassY, "EquivalentMassY", "mey", "kg", DefaultType);
 
-        mDataValues[EquivalentInertiaR]=1;
-        mDataValues[EquivalentMassX]=1;
-        mDataValues[EquivalentMassY]=1;
+        mpDataValues[EquivalentInertiaR]=1;
+        mpDataValues[EquivalentMassX]=1;
+        mpDataValues[EquivalentMassY]=1;
     }
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariableR, mDataValues[TorqueR]);
-        pOtherNode->setDataValue(WaveVariableX, mDataValues[ForceX]);
-        pOtherNode->setDataValue(WaveVariableY, mDataValues[ForceY]);
+        pOtherNode->setDataValue(WaveVariableR, mpDataValues[TorqueR]);
+        pOtherNode->setDataValue(WaveVariableX, mpDataValues[ForceX]);
+        pOtherNode->setDataValue(WaveVariableY, mpDataValues[ForceY]);
         //! todo Maybe also write CharImpedance?
     }
 };
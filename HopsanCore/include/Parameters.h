@@ -42,6 +42,7 @@ namespace hopsan {
 //Forward declaration
 class Component;
 class ParameterEvaluatorHandler;
+class NumHopHelper;
 
 class HOPSANCORE_DLLAPI ParameterEvaluator
 {
@@ -49,6 +50,7 @@ class HOPSANCORE_DLLAPI ParameterEvaluator
 public:
     ParameterEvaluator(const HString &rName, const HString &rValue, const HString &rDescription, const HString &rQuantity, const HString &rUnit,
                        const HString &rType, void* pDataPtr=0, ParameterEvaluatorHandler* pParameterEvalHandler=0);
+    ~ParameterEvaluator();
 
     bool setParameterValue(const HString &rValue, ParameterEvaluator **ppNeedEvaluation=0, bool force=false);
     bool setParameter(const HString &rValue, const HString &rDescription, const HString &rQuantity, const HString &rUnit,
@@ -67,10 +69,13 @@ public:
     const HString &getDescription() const;
     const HString &getQuantity() const;
     const std::vector<HString> &getConditions() const;
+    const std::vector<HString> &getReferencedNames();
 
 protected:
     void resolveSignPrefix(HString &rSignPrefix) const;
     void splitSignPrefix(const HString &rString, HString &rPrefix, HString &rValue);
+    bool evaluateExpression(HString &rEvaluatedParameterValue);
+    void clearExpression();
 
     HString mParameterName;
     HString mParameterValue;
@@ -82,6 +87,15 @@ protected:
     size_t mDepthCounter;
     ParameterEvaluatorHandler* mpParameterEvaluatorHandler;
     std::vector<HString> mConditions;
+    std::vector<HString> mReferencedNames;
+    HString mReferencedNamesValue;
+    bool mHasReferencedNames;
+    NumHopHelper *mpExpression; // The interpreted value expression, kept until the value changes
+
+private:
+    // The expression is owned by the evaluator, so it must not be copied (not implemented)
+    ParameterEvaluator(const ParameterEvaluator &rOther);
+    ParameterEvaluator &operator=(const ParameterEvaluator &rOther);
 };
 
 
@@ -112,15 +126,22 @@ public:
     bool evaluateParameters();
     bool evaluateInComponent(const HString &rName, HString &rEvaluatedParameterValue, const HString &rType);
     bool evaluateRecursivelyInSystemParents(const HString &rName, HString &rEvaluatedParameterValue, const HString &rType);
-    bool evaluateParameterExpression(const HString &rExpression, HString &rEvaluatedParameterValue);
 
     bool hasParameter(const HString &rName) const;
     bool checkParameters(HString &rErrParName);
 
+    bool hasChangedParameters() const;
+    const std::vector<HString> &getChangedParameterNames() const;
+    void resetChangedParameters();
+
     Component *getComponent() const;
 
 protected:
+    void addChangedParameterName(const HString &rName);
+
     Component* mComponent;
+    bool mHasChangedParameters;
+    std::vector<HString> mChangedParameterNames;
     std::vector<ParameterEvaluator*> mParameters;
     std::vector<ParameterEvaluator*> mParametersNeedEvaluation; //! @todo Use this vector to ensure parameters are valid at simulation time e.g. if a used system parameter is deleted before simulation
 };
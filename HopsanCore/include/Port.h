@@ -74,7 +74,7 @@ namespace hopsan {
         //! @return The data value
         inline double readNode(const size_t idx) const
         {
-            return mpNode->mDataValues[idx];
+            return mpNode->mpDataValues[idx];
         }
 
         //! @brief Reads a value from the connected node
@@ -85,7 +85,7 @@ namespace hopsan {
         virtual inline double readNode(const size_t idx, const size_t subPortIdx) const
         {
             HOPSAN_UNUSED(subPortIdx)
-            return mpNode->mDataValues[idx];
+            return mpNode->mpDataValues[idx];
         }
 
         //! @brief Writes a value to the connected node
@@ -94,7 +94,7 @@ namespace hopsan {
         //! @param [in] value The value to write
         inline void writeNode(const size_t idx, const double value)
         {
-            mpNode->mDataValues[idx] = value;
+            mpNode->mpDataValues[idx] = value;
         }
 
         //! @brief Writes a value to the connected node
@@ -105,11 +105,44 @@ namespace hopsan {
         virtual inline void writeNode(const size_t idx, const double value, const size_t subPortIdx)
         {
             HOPSAN_UNUSED(subPortIdx)
-            mpNode->mDataValues[idx] = value;
+            mpNode->mpDataValues[idx] = value;
         }
 
+        ///@{
+        //! @brief Returns a pointer to the Node data values in the port
+        //! @details Prefer this over getNodeDataVector(), it is also valid when the node data is stored in a system node data arena
+        //! @returns A pointer to the first node data value
+        inline double *getNodeDataValuesPtr()
+        {
+            return mpNode->mpDataValues;
+        }
+
+        inline const double *getNodeDataValuesPtr() const
+        {
+            return mpNode->mpDataValues;
+        }
+        ///@}
+
+        ///@{
+        //! @brief Returns a pointer to the Node data values in the port
+        //! @param[in] subPortIdx The index of a multiport subport to access
+        //! @returns A pointer to the first node data value
+        virtual inline double *getNodeDataValuesPtr(const size_t subPortIdx)
+        {
+            HOPSAN_UNUSED(subPortIdx);
+            return getNodeDataValuesPtr();
+        }
+
+        virtual inline const double *getNodeDataValuesPtr(const size_t subPortIdx) const
+        {
+            HOPSAN_UNUSED(subPortIdx);
+            return getNodeDataValuesPtr();
+        }
+        ///@}
+
         ///@{
         //! @brief Returns a reference to the Node data in the port
+        //! @note If the owning system uses a node data arena, the vector is only updated when the simulation is finalized
         //! @returns A reference to the node data vector
         inline std::vector<double> &getNodeDataVector()
         {
@@ -162,9 +195,13 @@ namespace hopsan {
 
         virtual bool haveLogData(const size_t subPortIdx=0);
         virtual std::vector<double> *getLogTimeVectorPtr(const size_t subPortIdx=0);
-        virtual std::vector<std::vector<double> > *getLogDataVectorPtr(const size_t subPortIdx=0);
+        virtual LogDataStorage *getLogDataVectorPtr(const size_t subPortIdx=0);
+        virtual LogDataStorage *getLogDataMinVectorPtr(const size_t subPortIdx=0);
+        virtual LogDataStorage *getLogDataMaxVectorPtr(const size_t subPortIdx=0);
         virtual void setEnableLogging(const bool enableLog);
         bool isLoggingEnabled() const;
+        void setEnableVariableLogging(const size_t dataId, const bool enableLog);
+        bool isVariableLoggingEnabled(const size_t dataId) const;
 
         virtual bool isConnected() const;
         virtual bool isConnectedTo(Port *pOtherPort);
@@ -202,6 +239,7 @@ namespace hopsan {
         Component* mpComponent;
         Port* mpParentPort;
         bool mEnableLogging;
+        std::vector<bool> mDisabledLogVariables;
 
         std::vector<Port*> mConnectedPorts;
 
@@ -289,6 +327,21 @@ namespace hopsan {
             return mSubPortsVector[subPortIdx]->writeNode(idx,value);
         }
 
+        ///@{
+        //! @brief Returns a pointer to the Node data values in the port
+        //! @param[in] subPortIdx The index of a multiport subport to access
+        //! @returns A pointer to the first node data value
+        inline double *getNodeDataValuesPtr(const size_t subPortIdx)
+        {
+            return mSubPortsVector[subPortIdx]->getNodeDataValuesPtr();
+        }
+
+        inline const double *getNodeDataValuesPtr(const size_t subPortIdx) const
+        {
+            return mSubPortsVector[subPortIdx]->getNodeDataValuesPtr();
+        }
+        ///@}
+
         ///@{
         //! @brief Returns a reference to the Node data in the port
         //! @param[in] subPortIdx The index of a multiport subport to access
@@ -314,7 +367,9 @@ namespace hopsan {
 
         bool haveLogData(const size_t subPortIdx=0);
         std::vector<double> *getLogTimeVectorPtr(const size_t subPortIdx=0);
-        std::vector<std::vector<double> > *getLogDataVectorPtr(const size_t subPortIdx=0);
+        LogDataStorage *getLogDataVectorPtr(const size_t subPortIdx=0);
+        LogDataStorage *getLogDataMinVectorPtr(const size_t subPortIdx=0);
+        LogDataStorage *getLogDataMaxVectorPtr(const size_t subPortIdx=0);
         virtual void setEnableLogging(const bool enableLog);
 
         double getStartValue(const size_t idx, const size_t subPortIdx=0);
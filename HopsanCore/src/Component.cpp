@@ -154,6 +154,23 @@ bool Component::checkParameters(HString &errParName)
     return mpParameters->checkParameters(errParName);
 }
 
+//! @brief Check if any parameter (or start value) has changed since the last successful initialization
+bool Component::hasChangedParameters() const
+{
+    return mpParameters->hasChangedParameters();
+}
+
+//! @brief Returns the names of the parameters that have changed since the last successful initialization
+const std::vector<HString> &Component::getChangedParameterNames() const
+{
+    return mpParameters->getChangedParameterNames();
+}
+
+void Component::resetChangedParameters()
+{
+    mpParameters->resetChangedParameters();
+}
+
 const std::vector<VariameterDescription>* Component::getVariameters()
 {
     //! @todo don't rebuild this every time, question is should this be in the nodes and or ports maybe, or should it only be in the components
@@ -295,6 +312,11 @@ void Component::simulate(const double stopT)
 
 void Component::setDisabled(bool value)
 {
+    // Enabling or disabling a component changes the model the same way as removing or adding it
+    if ((value != mIsDisabled) && mpSystemParent)
+    {
+        mpSystemParent->markTopologyChanged();
+    }
     mIsDisabled = value;
 }
 
@@ -1820,3 +1842,35 @@ double Component::getStateVariableSecondDerivative(int)
     return 0;
 }
 
+//! @brief Save the internal simulation state of the component (values that are not stored in nodes)
+//! @details The base version saves nothing. Components with internal state, such as integrators, filters or delay buffers,
+//! should override this function and restoreSimulationState() to support simulation snapshots.
+//! @param[in] rWriter The writer to append the state to
+//! @ingroup ComponentSimulationFunctions
+void Component::saveSimulationState(SimulationStateWriter &rWriter)
+{
+    HOPSAN_UNUSED(rWriter)
+}
+
+//! @brief Restore the internal simulation state of the component, saved by saveSimulationState()
+//! @details This is called after initialize(), so any state set by initialize() will be overwritten
+//! @param[in] rReader The reader to read the state from
+//! @returns False if the state could not be restored
+//! @ingroup ComponentSimulationFunctions
+bool Component::restoreSimulationState(SimulationStateReader &rReader)
+{
+    HOPSAN_UNUSED(rReader)
+    return true;
+}
+
+//! @brief Tells if the node data and the state saved by saveSimulationState() is the complete state of the component after initialize()
+//! @details Return true only if initialize() does nothing else than computing that state from parameters and node values, and if
+//! finalize() does not release anything that initialize() sets up. On warm start the system may then restore the state from the
+//! previous initialization instead of calling initialize() again, when neither the parameters nor the inputs of the component have changed.
+//! The base version returns false.
+//! @ingroup ComponentSimulationFunctions
+bool Component::hasCompleteSimulationState() const
+{
+    return false;
+}
+
@@ -37,6 +37,8 @@
 #include <iostream>
 #include <algorithm>
 #include <map>
+#include <memory>
+#include <set>
 
 #include "ComponentSystem.h"
 #include "HopsanEssentials.h"
@@ -45,6 +47,7 @@
 #include "CoreUtilities/StringUtilities.h"
 #include "CoreUtilities/MultiThreadingUtilities.h"
 #include "CoreUtilities/HmfLoader.h"
+#include "CoreUtilities/LogSink.h"
 #include "CoreUtilities/NumHopHelper.h"
 #include "CoreUtilities/ConnectionAssistant.h"
 #include "ComponentUtilities/num2string.hpp"
@@ -102,12 +105,78 @@ bool vectorContains(const std::vector<T> &rVector, const T &rObj)
     }
     return false;
 }
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+//! @brief Calculates the relative load imbalance (max/mean - 1) of components distributed over threads
+double calcLoadImbalance(const std::vector< std::vector<hopsan::Component*> > &rSplitVector)
+{
+    double maxTime=0, totTime=0;
+    for(size_t t=0; t<rSplitVector.size(); ++t)
+    {
+        double threadTime=0;
+        for(size_t i=0; i<rSplitVector[t].size(); ++i)
+        {
+            threadTime += rSplitVector[t][i]->getMeasuredTime();
+        }
+        maxTime = std::max(maxTime, threadTime);
+        totTime += threadTime;
+    }
+    if(totTime <= 0)
+    {
+        return 0;
+    }
+    return maxTime/(totTime/double(rSplitVector.size())) - 1.0;
+}
+
+//! @brief Greedily assigns components (sorted from largest to smallest measured time) to the thread with the smallest total time
+//! @details Same algorithm as ComponentSystem::distributeCcomponents() but without debug messages, so it can be used during simulation
+void distributeByMeasuredTime(const std::vector<hopsan::Component*> &rComponents, std::vector< std::vector<hopsan::Component*> > &rSplitVector)
+{
+    std::vector<double> timeVector(rSplitVector.size(), 0.0);
+    for(size_t c=0; c<rComponents.size(); ++c)
+    {
+        const size_t smallestIndex = std::min_element(timeVector.begin(), timeVector.end()) - timeVector.begin();
+        rSplitVector[smallestIndex].push_back(rComponents[c]);
+        timeVector[smallestIndex] += rComponents[c]->getMeasuredTime();
+    }
+}
+#endif // multithreading
+
 } // anon namespace
 
 namespace hopsan {
 
 class ComponentSystemMultiThreadPrivates {
 public:
+    ComponentSystemMultiThreadPrivates()
+    {
+        mBarrierAlgorithm = BusyWaitBarrierAlgorithm;
+        mBarrierSpinCount = 2000;
+        mAdaptiveRescheduling = false;
+        mImbalanceThreshold = 0.2;
+        mSampleInterval = 1000;
+        mnAdaptiveReschedules = 0;
+        mUseGraphPartitioning = false;
+        mSignalWavefront = false;
+        mWavefrontMinLevelSize = HOPSAN_DEFAULT_WAVEFRONT_MIN_LEVEL_SIZE;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        mpWorkerPool = 0;
+#endif
+    }
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    ~ComponentSystemMultiThreadPrivates() { delete mpWorkerPool; }
+#endif
+
+    BarrierAlgorithmT mBarrierAlgorithm;
+    size_t mBarrierSpinCount;
+    bool mAdaptiveRescheduling;
+    double mImbalanceThreshold;
+    size_t mSampleInterval;
+    size_t mnAdaptiveReschedules;
+    bool mUseGraphPartitioning;
+    bool mSignalWavefront;
+    size_t mWavefrontMinLevelSize;
     std::vector<double *> mvTimePtrs;
     std::vector< std::vector<Component*> > mSplitCVector;
     std::vector< std::vector<Component*> > mSplitQVector;
@@ -115,6 +184,11 @@ public:
     std::vector< std::vector<Node*> > mSplitNodeVector;
 #if defined(HOPSANCORE_USEMULTITHREADING)
     std::mutex mStopMutex;
+    //! @brief The master simulation thread of the ongoing offline scheduled simulation, the only thread allowed to reschedule during simulation
+    std::thread::id mMasterThreadId;
+    //! @brief Worker threads used by the parallel for-loop algorithms, only exists during a simulateMultiThreaded call
+    WorkerThreadPool *mpWorkerPool;
+    SignalWavefront mSignalWavefrontSchedule;
 #endif
 
 };
@@ -130,6 +204,15 @@ ComponentSystem::ComponentSystem() : Component(), mAliasHandler(this)
     mDesiredTimestep = 0.001;
     mInheritTimestep = true;
     mKeepValuesAsStartValues = false;
+    mUseNodeDataArena = false;
+    mWarmStart = false;
+    mTopologyChanged = true;
+    mTopologyChecked = false;
+    mForceFullInitialize = false;
+    mWarmStartStartT = 0;
+    mWarmStartStopT = 0;
+    mNumWarmStartedComponents = 0;
+    mParameterDependentsValid = false;
     mRequestedNumLogSamples = 0; //This has to be 0 since we want logging to be disabled by default
     mRequestedLogStartTime = 0;
     mpMultiThreadPrivates = new ComponentSystemMultiThreadPrivates;
@@ -140,6 +223,15 @@ ComponentSystem::ComponentSystem() : Component(), mAliasHandler(this)
     reserveUniqueName("self", UniqueReservedNameType);
 
     // Set default (disabled) values for log data
+    mpLogSink = 0;
+    mLogSinkIsOpen = false;
+    mLogSinkNumSummed = 0;
+    mLogMode = SampleLogMode;
+    mLogEnvelope = false;
+    mLogAccumulate = false;
+    mnTriggeredLogSlots = 0;
+    mnTriggeredLogSamples = 0;
+    mLogCaptureStepsLeft = 0;
     disableLog();
 }
 
@@ -196,6 +288,202 @@ size_t ComponentSystem::getNumActuallyLoggedSamples() const
     return mLogCtr;
 }
 
+//! @brief Enable or disable logging of one variable (or all variables) in a sub component port
+//! @details The setting is applied to all ports connected to the same node, since the node is logged if any of them wants the variable.
+//! The change takes effect the next time the system is initialized.
+//! @param[in] rComponentName The name of the sub component
+//! @param[in] rPortName The name of the port
+//! @param[in] rVariableName The name of the node data variable, or empty to enable or disable logging of the entire port
+//! @param[in] enableLog True to log, false to exclude from the log
+//! @returns True if the port and variable were found, else false
+bool ComponentSystem::setEnableVariableLogging(const HString &rComponentName, const HString &rPortName, const HString &rVariableName, const bool enableLog)
+{
+    Component *pComp = getSubComponent(rComponentName);
+    Port *pPort = pComp ? pComp->getPort(rPortName) : 0;
+    if (!pPort)
+    {
+        addErrorMessage("Could not find port: "+rComponentName+"#"+rPortName+" when setting log mask");
+        return false;
+    }
+
+    int dataId = -1;
+    if (!rVariableName.empty())
+    {
+        dataId = pPort->getNodeDataIdFromName(rVariableName);
+        if (dataId < 0)
+        {
+            addErrorMessage("Could not find variable: "+rComponentName+"#"+rPortName+"#"+rVariableName+" when setting log mask");
+            return false;
+        }
+    }
+
+    vector<Port*> ports = pPort->getConnectedPorts();
+    ports.push_back(pPort);
+    for (size_t p=0; p<ports.size(); ++p)
+    {
+        if (dataId < 0)
+        {
+            ports[p]->setEnableLogging(enableLog);
+        }
+        else
+        {
+            // Enabling a variable in a port that is not logged, should only log that variable
+            const vector<NodeDataDescription> *pDescs = ports[p]->getNodeDataDescriptions();
+            if (enableLog && !ports[p]->isLoggingEnabled() && pDescs)
+            {
+                for (size_t v=0; v<pDescs->size(); ++v)
+                {
+                    ports[p]->setEnableVariableLogging(v, false);
+                }
+                ports[p]->setEnableLogging(true);
+            }
+            ports[p]->setEnableVariableLogging(size_t(dataId), enableLog);
+        }
+    }
+    return true;
+}
+
+//! @brief Returns the total number of node data variables that are stored in the log, in this system (not subsystems)
+//! @details The memory and time used for logging in each log sample is proportional to this number. Valid after initialize.
+size_t ComponentSystem::getNumLoggedVariables() const
+{
+    size_t n=0;
+    for (size_t i=0; i<mLoggedSubNodePtrs.size(); ++i)
+    {
+        n += mLoggedSubNodePtrs[i]->mDataStorage.getNumStoredVariables();
+    }
+    return n + mLogSinkNodePtrs.size();
+}
+
+//! @brief Stream the log data of this system (not subsystems) to a log sink instead of storing it in the nodes
+//! @details The sink is opened in initialize() and closed in finalize(). While a sink is set, the nodes and the time
+//! vector in this system will not contain any log data, each logged node variable is sent to the sink once.
+//! @param [in] pLogSink The sink, it is not owned by the system and must remain valid until it is replaced or the system is finalized. Use 0 to store the log data in the nodes again.
+void ComponentSystem::setLogSink(LogSink *pLogSink)
+{
+    if (mpLogSink && mLogSinkIsOpen)
+    {
+        mpLogSink->close();
+    }
+    mpLogSink = pLogSink;
+    mLogSinkIsOpen = false;
+    mLogSinkNodePtrs.clear();
+    mLogSinkDataIds.clear();
+    mLogSinkValues.clear();
+}
+
+//! @brief Returns the log sink used by this system, or 0 if log data is stored in the nodes
+LogSink *ComponentSystem::getLogSink() const
+{
+    return mpLogSink;
+}
+
+//! @brief Select what each log sample contains, the setting is applied to all subsystems as well
+//! @details In MeanLogMode each sample is the mean of all simulation steps since the previous sample (including the
+//! step of the sample), the logged time is the time of the last step in the interval.
+//! @param [in] mode The log mode
+void ComponentSystem::setLogMode(const LogModeEnumT mode)
+{
+    mLogMode = mode;
+    SubComponentMapT::iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
+        {
+            static_cast<ComponentSystem*>(it->second)->setLogMode(mode);
+        }
+    }
+}
+
+ComponentSystem::LogModeEnumT ComponentSystem::getLogMode() const
+{
+    return mLogMode;
+}
+
+//! @brief Enable or disable logging of the min and max values in each log interval, the setting is applied to all subsystems as well
+//! @details The envelopes are available through Port::getLogDataMinVectorPtr() and Port::getLogDataMaxVectorPtr(). This makes it
+//! possible to log long simulations with few samples without missing short peaks. Envelopes are not sent to log sinks.
+//! @param [in] logEnvelope True to log envelopes
+void ComponentSystem::setLogEnvelope(const bool logEnvelope)
+{
+    mLogEnvelope = logEnvelope;
+    SubComponentMapT::iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
+        {
+            static_cast<ComponentSystem*>(it->second)->setLogEnvelope(logEnvelope);
+        }
+    }
+}
+
+bool ComponentSystem::isLogEnvelopeEnabled() const
+{
+    return mLogEnvelope;
+}
+
+//! @brief Add a log trigger, every simulation step is logged for a while after the variable crosses the threshold (in either direction)
+//! @details The extra samples are taken from the budget set by setNumTriggeredLogSamples(), when the budget is used up only the
+//! regular samples are logged. The extra samples only apply to the log of this system, not to subsystems.
+//! @param [in] rComponentName The component name
+//! @param [in] rPortName The port name
+//! @param [in] rVariableName The node data variable name
+//! @param [in] threshold The threshold value
+//! @param [in] numCaptureSteps The number of simulation steps to log after each crossing
+//! @returns True if the variable was found
+bool ComponentSystem::addLogTrigger(const HString &rComponentName, const HString &rPortName, const HString &rVariableName, const double threshold, const size_t numCaptureSteps)
+{
+    Component *pComp = getSubComponent(rComponentName);
+    Port *pPort = pComp ? pComp->getPort(rPortName) : 0;
+    if (!pPort)
+    {
+        addErrorMessage("Could not find port: "+rComponentName+"#"+rPortName+" when adding log trigger");
+        return false;
+    }
+    if (pPort->getNodeDataIdFromName(rVariableName) < 0)
+    {
+        addErrorMessage("Could not find variable: "+rComponentName+"#"+rPortName+"#"+rVariableName+" when adding log trigger");
+        return false;
+    }
+
+    LogTrigger trigger;
+    trigger.mComponentName = rComponentName;
+    trigger.mPortName = rPortName;
+    trigger.mVariableName = rVariableName;
+    trigger.mThreshold = threshold;
+    trigger.mNumCaptureSteps = numCaptureSteps;
+    trigger.mpNode = 0;
+    trigger.mDataId = 0;
+    trigger.mPreviousValue = 0;
+    mLogTriggers.push_back(trigger);
+    return true;
+}
+
+//! @brief Remove all log triggers
+void ComponentSystem::clearLogTriggers()
+{
+    mLogTriggers.clear();
+}
+
+size_t ComponentSystem::getNumLogTriggers() const
+{
+    return mLogTriggers.size();
+}
+
+//! @brief Set the number of extra log samples that log triggers may use, in addition to the regular log samples
+//! @details The log storage is allocated for the regular and extra samples, unused extra samples are removed in finalize()
+//! @param [in] nSamples The number of extra samples
+void ComponentSystem::setNumTriggeredLogSamples(const size_t nSamples)
+{
+    mnTriggeredLogSlots = nSamples;
+}
+
+//! @brief Returns the number of extra log samples that log triggers may use
+size_t ComponentSystem::getNumTriggeredLogSamples() const
+{
+    return mnTriggeredLogSlots;
+}
+
 
 //! @brief Set the stop simulation flag to abort the initialization or simulation loops
 //! @param[in] rReason An optional HString describing the reason for the stop
@@ -350,6 +638,7 @@ void ComponentSystem::addComponent(Component *pComponent)
 
         // Add to the cqs component vectors
         addSubComponentPtrToStorage(pComponent);
+        markTopologyChanged();
 
         // Set system parent and model system depth hierarchy
         pComponent->setSystemParent(this);
@@ -387,6 +676,259 @@ void ComponentSystem::addComponent(Component *pComponent)
 }
 
 
+//! @brief Copy the user modifiable port settings (signal quantity and logging) from one port to another
+static void copyPortSettings(Port *pSource, Port *pCopy)
+{
+    if (pSource->getSignalNodeQuantityModifyable() && !pSource->getSignalNodeQuantity().empty())
+    {
+        pCopy->setSignalNodeQuantityOrUnit(pSource->getSignalNodeQuantity());
+    }
+    pCopy->setEnableLogging(pSource->isLoggingEnabled());
+    if (!pSource->isMultiPort())
+    {
+        for (size_t i=0; i<pSource->getNumDataVariables(); ++i)
+        {
+            if (!pSource->isVariableLoggingEnabled(i))
+            {
+                pCopy->setEnableVariableLogging(i, false);
+            }
+        }
+    }
+}
+
+//! @brief Find the port in a copied system that corresponds to a port in the original system
+//! @param[in] pPort The original port, if it is a multiport subport the multiport is used
+//! @param[in] pSystem The original system
+//! @param[in] pCopy The copied system
+//! @returns The corresponding port in the copy or 0 if not found
+static Port *findCopiedPort(Port *pPort, ComponentSystem *pSystem, ComponentSystem *pCopy)
+{
+    if (pPort->getParentPort())
+    {
+        pPort = pPort->getParentPort();
+    }
+    Component *pComp = pPort->getComponent();
+    if (pComp == pSystem)
+    {
+        return pCopy->getPort(pPort->getName());
+    }
+    Component *pCopiedComp = pCopy->getSubComponent(pComp->getName());
+    return pCopiedComp ? pCopiedComp->getPort(pPort->getName()) : 0;
+}
+
+//! @brief Create a deep copy of this system
+//! @details The copy is created directly from the loaded model without parsing any model file. It contains copies of all
+//! sub components and subsystems, parameter values (as expressions, not evaluated), system ports, connections, aliases,
+//! NumHop script, time step and log settings. The copy is completely independent of this system and is ready to be initialized.
+//! Simulation results, log sinks and multi-threading settings are not copied.
+//! @returns A pointer to the new system, or 0 if the copy failed. The caller takes ownership.
+ComponentSystem *ComponentSystem::clone()
+{
+    ComponentSystem *pCopy = dynamic_cast<ComponentSystem*>(mpHopsanEssentials->createComponent(getTypeName()));
+    if (!pCopy)
+    {
+        addErrorMessage("Could not create a copy of system: "+getName());
+        return 0;
+    }
+    pCopy->setName(getName());
+    if (!copyContentsTo(pCopy))
+    {
+        mpHopsanEssentials->removeComponent(pCopy);
+        return 0;
+    }
+    return pCopy;
+}
+
+//! @brief Copy the contents of this system into an newly created and empty system
+//! @param[in] pCopy The system to copy into
+//! @returns False if a sub component could not be created or connected
+bool ComponentSystem::copyContentsTo(ComponentSystem *pCopy)
+{
+    pCopy->setSubTypeName(getSubTypeName());
+    pCopy->setDisabled(isDisabled());
+    pCopy->setDesiredTimestep(mDesiredTimestep);
+    pCopy->setInheritTimestep(mInheritTimestep);
+    pCopy->setLogStartTime(mRequestedLogStartTime);
+    pCopy->setNumLogSamples(mRequestedNumLogSamples);
+    pCopy->mEnableLogData = mEnableLogData;
+    pCopy->setLogMode(mLogMode);
+    pCopy->setLogEnvelope(mLogEnvelope);
+    pCopy->setNumTriggeredLogSamples(getNumTriggeredLogSamples());
+    pCopy->mKeepValuesAsStartValues = mKeepValuesAsStartValues;
+    pCopy->setExternalModelFilePath(mExternalModelFilePath);
+    for (size_t i=0; i<mSearchPaths.size(); ++i)
+    {
+        pCopy->addSearchPath(mSearchPaths[i]);
+    }
+
+    // System parameters must exist before sub components that use them
+    // Force is used since the parameters are not evaluated until initialization, just as when loading a model
+    const std::vector<ParameterEvaluator*> *pParameters = mpParameters->getParametersVectorPtr();
+    for (size_t i=0; i<pParameters->size(); ++i)
+    {
+        const ParameterEvaluator *pParameter = pParameters->at(i);
+        bool ok;
+        if (pCopy->hasParameter(pParameter->getName()))
+        {
+            ok = pCopy->setParameterValue(pParameter->getName(), pParameter->getValue(), true);
+        }
+        else
+        {
+            const HString &rUnitOrQuantity = pParameter->getQuantity().empty() ? pParameter->getUnit() : pParameter->getQuantity();
+            ok = pCopy->setOrAddSystemParameter(pParameter->getName(), pParameter->getValue(), pParameter->getType(),
+                                                pParameter->getDescription(), rUnitOrQuantity, true);
+        }
+        if (!ok)
+        {
+            pCopy->addWarningMessage("Failed to copy parameter: "+pParameter->getName()+"="+pParameter->getValue());
+        }
+    }
+    pCopy->setNumHopScript(mNumHopScript);
+
+    // System ports
+    std::vector<Port*> ports = getPortPtrVector();
+    for (size_t i=0; i<ports.size(); ++i)
+    {
+        if (ports[i]->getPortType() == SystemPortType && !pCopy->getPort(ports[i]->getName()))
+        {
+            pCopy->addSystemPort(ports[i]->getName(), ports[i]->getDescription());
+        }
+        Port *pCopiedPort = pCopy->getPort(ports[i]->getName());
+        if (pCopiedPort)
+        {
+            copyPortSettings(ports[i], pCopiedPort);
+        }
+    }
+
+    // Sub components, added in the same order as in this system to get the same simulation order
+    std::vector<Component*> components;
+    components.insert(components.end(), mComponentSignalptrs.begin(), mComponentSignalptrs.end());
+    components.insert(components.end(), mDisabledSptrs.begin(), mDisabledSptrs.end());
+    components.insert(components.end(), mComponentCptrs.begin(), mComponentCptrs.end());
+    components.insert(components.end(), mDisabledCptrs.begin(), mDisabledCptrs.end());
+    components.insert(components.end(), mComponentQptrs.begin(), mComponentQptrs.end());
+    components.insert(components.end(), mDisabledQptrs.begin(), mDisabledQptrs.end());
+    components.insert(components.end(), mComponentUndefinedptrs.begin(), mComponentUndefinedptrs.end());
+    for (size_t c=0; c<components.size(); ++c)
+    {
+        Component *pComp = components[c];
+        Component *pCopiedComp = mpHopsanEssentials->createComponent(pComp->getTypeName());
+        if (!pCopiedComp)
+        {
+            addErrorMessage("Could not create a copy of component: "+pComp->getName()+" of type: "+pComp->getTypeName());
+            return false;
+        }
+        pCopiedComp->setName(pComp->getName());
+        pCopiedComp->setSubTypeName(pComp->getSubTypeName());
+        pCopiedComp->setDisabled(pComp->isDisabled());
+        pCopy->addComponent(pCopiedComp);
+
+        if (pComp->isComponentSystem())
+        {
+            if (!static_cast<ComponentSystem*>(pComp)->copyContentsTo(static_cast<ComponentSystem*>(pCopiedComp)))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            const std::vector<ParameterEvaluator*> *pCompParameters = pComp->getParametersVectorPtr();
+            for (size_t i=0; i<pCompParameters->size(); ++i)
+            {
+                const ParameterEvaluator *pParameter = pCompParameters->at(i);
+                if (!pCopiedComp->setParameterValue(pParameter->getName(), pParameter->getValue(), true))
+                {
+                    pCopiedComp->addWarningMessage("Failed to copy parameter: "+pParameter->getName()+"="+pParameter->getValue());
+                }
+            }
+            std::vector<Port*> compPorts = pComp->getPortPtrVector();
+            for (size_t i=0; i<compPorts.size(); ++i)
+            {
+                Port *pCopiedPort = pCopiedComp->getPort(compPorts[i]->getName());
+                if (pCopiedPort)
+                {
+                    copyPortSettings(compPorts[i], pCopiedPort);
+                }
+            }
+        }
+    }
+
+    // Connections, each connection is seen from both ends, so remember which ones have been made
+    // Multiports are handled first so that their sub ports are created in the same order as in this system
+    std::vector<Port*> allPorts = ports;
+    std::vector<Port*> multiPorts, otherPorts;
+    for (size_t c=0; c<components.size(); ++c)
+    {
+        std::vector<Port*> compPorts = components[c]->getPortPtrVector();
+        allPorts.insert(allPorts.end(), compPorts.begin(), compPorts.end());
+    }
+    for (size_t i=0; i<allPorts.size(); ++i)
+    {
+        if (allPorts[i]->isMultiPort())
+        {
+            multiPorts.push_back(allPorts[i]);
+        }
+        else
+        {
+            otherPorts.push_back(allPorts[i]);
+        }
+    }
+    multiPorts.insert(multiPorts.end(), otherPorts.begin(), otherPorts.end());
+
+    std::set< std::pair<Port*, Port*> > madeConnections;
+    for (size_t i=0; i<multiPorts.size(); ++i)
+    {
+        Port *pPort = multiPorts[i];
+        std::vector<Port*> connectedPorts = pPort->getConnectedPorts();
+        for (size_t j=0; j<connectedPorts.size(); ++j)
+        {
+            Port *pOther = connectedPorts[j]->getParentPort() ? connectedPorts[j]->getParentPort() : connectedPorts[j];
+            // Only connections inside this system, system ports are also connected to ports outside and inside subsystems
+            Component *pOtherComp = pOther->getComponent();
+            if (pOtherComp != this && pOtherComp->getSystemParent() != this)
+            {
+                continue;
+            }
+            std::pair<Port*, Port*> connection = std::make_pair(std::min(pPort, pOther), std::max(pPort, pOther));
+            if (!madeConnections.insert(connection).second)
+            {
+                continue;
+            }
+
+            Port *pCopiedPort = findCopiedPort(pPort, this, pCopy);
+            Port *pCopiedOther = findCopiedPort(pOther, this, pCopy);
+            if (!pCopiedPort || !pCopiedOther || !pCopy->connect(pCopiedPort, pCopiedOther))
+            {
+                addErrorMessage("Could not copy connection: "+pPort->getComponentName()+"::"+pPort->getName()+" -> "+
+                                pOtherComp->getName()+"::"+pOther->getName());
+                return false;
+            }
+        }
+    }
+
+    // Aliases (only variable aliases are supported by the alias handler)
+    std::vector<HString> aliases = mAliasHandler.getAliases();
+    for (size_t i=0; i<aliases.size(); ++i)
+    {
+        HString compName, portName, varName;
+        mAliasHandler.getVariableFromAlias(aliases[i], compName, portName, varName);
+        if (!compName.empty())
+        {
+            pCopy->getAliasHandler().setVariableAlias(aliases[i], compName, portName, varName);
+        }
+    }
+
+    // Log triggers refer to variables by name, they are resolved at initialization
+    pCopy->mLogTriggers = mLogTriggers;
+    for (size_t i=0; i<pCopy->mLogTriggers.size(); ++i)
+    {
+        pCopy->mLogTriggers[i].mpNode = 0;
+    }
+
+    return true;
+}
+
+
 //! @brief Rename a sub component and automatically fix unique names
 void ComponentSystem::renameSubComponent(const HString &rOldName, const HString &rNewName)
 {
@@ -452,6 +994,7 @@ void ComponentSystem::removeSubComponent(Component* pComponent, bool doDelete)
 
     // Remove from storage
     removeSubComponentPtrFromStorage(pComponent);
+    markTopologyChanged();
 
     // Remove any dummy node ptrs
     //! @todo (shouldn't we remove ownership of all port nodes by default) Not sure!! especially difficult with system border nodes
@@ -556,6 +1099,7 @@ void ComponentSystem::removeSubComponentPtrFromStorage(Component* pComponent)
                 if ( *cit == pComponent )
                 {
                     mComponentSignalptrs.erase(cit);
+                    mSignalLevelOffsets.clear();
                     break;
                 }
             }
@@ -598,172 +1142,125 @@ void ComponentSystem::clear()
     }
 }
 
-#define USENEWSORTCODE
-//! @brief Sorts a component vector
-//! Components are sorted so that they are always simulated after the components they receive signals from. Algebraic loops can be detected, in that case this function does nothing.
-bool ComponentSystem::sortComponentVector(std::vector<Component*> &rComponentVector)
-{
-    std::vector<Component*> newComponentVector;
-
-#ifndef USENEWSORTCODE
-    bool didSomething = true;
-    while(didSomething)
-    {
-        didSomething = false;
-        std::vector<Component*>::iterator it;
-        //Loop through the unsorted signal component vector
-        for(it=rComponentVector.begin(); it!=rComponentVector.end(); ++it)
-        {
-            // A pointer to an unsorted component
-            Component* pUnsrtComp = (*it);
-            //Ignore components that are already added to the new vector
-            if(!vectorContains<Component*>(newComponentVector, pUnsrtComp))
-            {
-                bool readyToAdd=true;
-                std::vector<Port*>::iterator itp;
-                std::vector<Port*> portVector = (*it)->getPortPtrVector();
-                // Ask each read port for its node, then ask the node for its write port component
-                for(itp=portVector.begin(); itp!=portVector.end(); ++itp)
-                {
-                    // Take the port pointer (To make code easier to read)
-                    Port *pPort = (*itp);
-                    Component* pRequiredComponent=0;
-
-                    bool isReadPort = pPort->getPortType() == ReadPortType || pPort->getPortType() == ReadMultiportType ||
-                            ( (pUnsrtComp->getTypeName() == SUBSYSTEMTYPENAME) && (pPort->getInternalPortType() == ReadPortType)) ||
-                            ( (pUnsrtComp->getTypeName() == CONDITIONALTYPENAME) && (pPort->getInternalPortType() == ReadPortType));
-                    if ( isReadPort && pPort->isConnected() )
-                    {
-                        pRequiredComponent = pPort->getNodePtr()->getWritePortComponentPtr();
-                    }
-                    if(pRequiredComponent && (pRequiredComponent->getTypeName() != "SignalUnitDelay"))
-                    {
-                        if(pRequiredComponent->mpSystemParent == this)
-                        {
-                            if(!vectorContains<Component*>(newComponentVector, pRequiredComponent) &&
-                                    vectorContains<Component*>(rComponentVector, pRequiredComponent)
-                                    /*requiredComponent->getTypeCQS() == pPort->getComponent()->getTypeCQS()*//*Component::S*/)
-                            {
-                                readyToAdd = false;     //Depending on normal component which has not yet been added
-                            }
-                        }
-                        else
-                        {
-                            if(!vectorContains<Component*>(newComponentVector, pRequiredComponent->mpSystemParent) &&
-                                    (pRequiredComponent->mpSystemParent->getTypeCQS() == pPort->getComponent()->getTypeCQS()) &&
-                                    vectorContains<Component*>(rComponentVector,pRequiredComponent->mpSystemParent))
-                            {
-                                readyToAdd = false;     //Depending on subsystem component which has not yet been added
-                            }
-                        }
-                    }
-                }
-                // Add the component if all required write port components was already added
-                if(readyToAdd)
-                {
-                    newComponentVector.push_back(pUnsrtComp);
-                    didSomething = true;
-                }
+//! @brief Find the component in the sort input that a component depends on through one of its ports
+//! @param[in] pPort The port to check
+//! @param[in] pComponent The component owning the port
+//! @returns The component that must be simulated before pComponent (not necessarily in the sort input), or 0 if there is none
+static Component *findSortDependency(Port *pPort, Component *pComponent, const ComponentSystem *pSystem)
+{
+    SortHintEnumT sortHint = pPort->getSortHint();
+    if ((pComponent->getTypeName() == HOPSAN_BUILTIN_TYPENAME_SUBSYSTEM) ||
+        (pComponent->getTypeName() == HOPSAN_BUILTIN_TYPENAME_CONDITIONALSUBSYSTEM))
+    {
+        sortHint = pPort->getInternalSortHint();
+    }
+
+    if ( (sortHint == Destination) && pPort->isConnected() )
+    {
+        Port *pSourcePort = pPort->getNodePtr()->getSortOrderSourcePort();
+        if (pSourcePort && pSourcePort->getComponent())
+        {
+            Component *pRequiredComponent = pSourcePort->getComponent();
+            if (pRequiredComponent->getSystemParent() == pSystem)
+            {
+                return pRequiredComponent;
+            }
+            // Depending on a component inside a subsystem, then the subsystem itself must be simulated first
+            ComponentSystem *pRequiredSystem = pRequiredComponent->getSystemParent();
+            if (pRequiredSystem && (pRequiredSystem->getTypeCQS() == pPort->getComponent()->getTypeCQS()))
+            {
+                return pRequiredSystem;
             }
         }
     }
+    return 0;
+}
+
+//! @brief Sorts a component vector
+//! @details Components are sorted so that they are always simulated after the components they receive signals from.
+//! A topological sort (Kahn's algorithm) is used, so the time is linear in the number of components and connections.
+//! The components are grouped by dependency level, components in the same level do not depend on each other.
+//! Within a level the original order is kept. Algebraic loops are detected, in that case the vector is not changed
+//! and one of the loops is reported.
+//! @param[in,out] rComponentVector The components to sort
+//! @param[out] pLevelOffsets If given, receives the index of the first component in each level followed by the vector size
+//! @returns False if an algebraic loop was found, else true
+bool ComponentSystem::sortComponentVector(std::vector<Component*> &rComponentVector, std::vector<size_t> *pLevelOffsets)
+{
+    const size_t nComponents = rComponentVector.size();
+
+    // Lookup table from component pointer to index in the input vector, sorted on the pointer
+    std::vector< std::pair<Component*, size_t> > indexLookup(nComponents);
+    for(size_t c=0; c<nComponents; ++c)
+    {
+        indexLookup[c] = std::make_pair(rComponentVector[c], c);
+    }
+    std::sort(indexLookup.begin(), indexLookup.end());
 
-    if(newComponentVector.size() == rComponentVector.size())   //All components moved to new vector = success!
+    // Build the dependency graph, one edge from each required component to the component depending on it
+    std::vector< std::vector<size_t> > dependentComponents(nComponents);
+    std::vector< std::vector<size_t> > requiredComponents(nComponents);
+    for(size_t c=0; c<nComponents; ++c)
     {
-        rComponentVector = newComponentVector;
-        if(newComponentVector.size() > 0 && newComponentVector[0]->getTypeCQS() == SType)
+        Component *pComponent = rComponentVector[c];
+        const std::vector<Port*> portVector = pComponent->getPortPtrVector();
+        for(size_t p=0; p<portVector.size(); ++p)
         {
-            HString ss;
-            std::vector<Component*>::iterator it;
-            for(it=newComponentVector.begin(); it!=newComponentVector.end(); ++it)
+            Component *pRequiredComponent = findSortDependency(portVector[p], pComponent, this);
+            if (pRequiredComponent)
             {
-                ss += (*it)->getName()+"\n";                                                                                               //DEBUG
+                std::vector< std::pair<Component*, size_t> >::const_iterator it =
+                        std::lower_bound(indexLookup.begin(), indexLookup.end(), std::make_pair(pRequiredComponent, size_t(0)));
+                if ((it != indexLookup.end()) && (it->first == pRequiredComponent))
+                {
+                    dependentComponents[it->second].push_back(c);
+                    requiredComponents[c].push_back(it->second);
+                }
             }
-            addDebugMessage("Sorted components successfully!\nSignal components will be simulated in the following order:\n" + ss);
         }
     }
-    else    //Something went wrong, all components were not moved. This is likely due to an algebraic loop.
+
+    // Kahn's algorithm, one level at a time, the next level is sorted to keep the original order within the level
+    std::vector<size_t> numUnsorted(nComponents);
+    std::vector<size_t> sorted;
+    sorted.reserve(nComponents);
+    std::vector<size_t> levelOffsets;
+    for(size_t c=0; c<nComponents; ++c)
     {
-        addErrorMessage("Initialize: Algebraic loops was found, signal components could not be sorted.");
-        if(!newComponentVector.empty())
+        numUnsorted[c] = requiredComponents[c].size();
+        if (numUnsorted[c] == 0)
         {
-            addInfoMessage("Last component that was successfully sorted: " + newComponentVector.back()->getName());
+            sorted.push_back(c);
         }
-        addInfoMessage("Initialize: Hint: Use unit delay components to resolve loops.");
-        return false;
     }
-#else
-    bool didSomething = true;
-    while(didSomething)
+    size_t levelBegin = 0;
+    while (levelBegin < sorted.size())
     {
-        didSomething = false;
-
-        // Loop through the unsorted component vector
-        for(size_t c=0; c<rComponentVector.size(); ++c)
+        levelOffsets.push_back(levelBegin);
+        const size_t levelEnd = sorted.size();
+        for(size_t s=levelBegin; s<levelEnd; ++s)
         {
-            // A pointer to an unsorted component
-            Component* pUnsrtComp = rComponentVector[c];
-            //Ignore components that are already added to the new vector
-            if(!vectorContains<Component*>(newComponentVector, pUnsrtComp))
+            const std::vector<size_t> &rDependents = dependentComponents[sorted[s]];
+            for(size_t d=0; d<rDependents.size(); ++d)
             {
-                bool readyToAdd=true;
-                std::vector<Port*> portVector = pUnsrtComp->getPortPtrVector();
-                // Ask each read port for its node, then ask the node for its write port component
-                for(size_t p=0; p<portVector.size(); ++p)
+                if (--numUnsorted[rDependents[d]] == 0)
                 {
-                    // Take the port pointer (To make code easier to read)
-                    Port *pPort = portVector[p];
-                    Component* pRequiredComponent=0;
-
-                    SortHintEnumT sortHint = pPort->getSortHint();
-                    if ((pUnsrtComp->getTypeName() == HOPSAN_BUILTIN_TYPENAME_SUBSYSTEM) ||
-                        (pUnsrtComp->getTypeName() == HOPSAN_BUILTIN_TYPENAME_CONDITIONALSUBSYSTEM))
-                    {
-                        sortHint = pPort->getInternalSortHint();
-                    }
+                    sorted.push_back(rDependents[d]);
+                }
+            }
+        }
+        std::sort(sorted.begin()+levelEnd, sorted.end());
+        levelBegin = levelEnd;
+    }
 
-                    if ( (sortHint == Destination) && pPort->isConnected() )
-                    {
-                        Port *pSourcePort = pPort->getNodePtr()->getSortOrderSourcePort();
-                        if (pSourcePort && pSourcePort->getComponent())
-                        {
-                            pRequiredComponent = pSourcePort->getComponent();
-                        }
-                    }
-                    if(pRequiredComponent /*&& (pRequiredComponent->getTypeName() != "SignalUnitDelay")*/)
-                    {
-                        if(pRequiredComponent->mpSystemParent == this)
-                        {
-                            if(!vectorContains<Component*>(newComponentVector, pRequiredComponent) &&
-                                    vectorContains<Component*>(rComponentVector, pRequiredComponent))
-                            {
-                                readyToAdd = false;     //Depending on normal component which has not yet been added
-                            }
-                        }
-                        else
-                        {
-                            if(!vectorContains<Component*>(newComponentVector, pRequiredComponent->mpSystemParent) &&
-                                    (pRequiredComponent->mpSystemParent->getTypeCQS() == pPort->getComponent()->getTypeCQS()) &&
-                                    vectorContains<Component*>(rComponentVector,pRequiredComponent->mpSystemParent))
-                            {
-                                readyToAdd = false;     //Depending on subsystem component which has not yet been added
-                            }
-                        }
-                    }
-                }
-                // Add the component if all required write port components was already added
-                if(readyToAdd)
-                {
-                    newComponentVector.push_back(pUnsrtComp);
-                    didSomething = true;
-                }
-            }
-        }
-    }
-
-    if(newComponentVector.size() == rComponentVector.size())   //All components moved to new vector = success!
+    if(sorted.size() == nComponents)   //All components sorted = success!
     {
-        if(newComponentVector.size() > 0 && newComponentVector[0]->getTypeCQS() == SType)
+        std::vector<Component*> newComponentVector(nComponents);
+        for(size_t s=0; s<nComponents; ++s)
+        {
+            newComponentVector[s] = rComponentVector[sorted[s]];
+        }
+        if(nComponents > 0 && newComponentVector[0]->getTypeCQS() == SType)
         {
             HString names;
             for(size_t c=0; c<newComponentVector.size(); ++c)
@@ -773,22 +1270,78 @@ bool ComponentSystem::sortComponentVector(std::vector<Component*> &rComponentVec
             addDebugMessage("Sorted components successfully!\nSignal components will be simulated in the following order:\n" + names);
         }
         rComponentVector.swap(newComponentVector);
+        if (pLevelOffsets)
+        {
+            levelOffsets.push_back(nComponents);
+            pLevelOffsets->swap(levelOffsets);
+        }
     }
-    else    //Something went wrong, all components were not moved. This is likely due to an algebraic loop.
+    else    //Some components could not be sorted, this is due to an algebraic loop.
     {
-        addErrorMessage("Initialize: Algebraic loops was found, signal components could not be sorted.");
-        if(!newComponentVector.empty())
+        // Every unsorted component requires at least one other unsorted component, so following those
+        // requirements backwards from any unsorted component must eventually reach a component a second time
+        const size_t notVisited = std::numeric_limits<size_t>::max();
+        std::vector<size_t> visitOrder(nComponents, notVisited);
+        std::vector<size_t> path;
+        size_t c=0;
+        while (numUnsorted[c] == 0)
         {
-            addInfoMessage("Last component that was successfully sorted: " + newComponentVector.back()->getName());
+            ++c;
         }
+        while (visitOrder[c] == notVisited)
+        {
+            visitOrder[c] = path.size();
+            path.push_back(c);
+            for(size_t r=0; r<requiredComponents[c].size(); ++r)
+            {
+                if (numUnsorted[requiredComponents[c][r]] > 0)
+                {
+                    c = requiredComponents[c][r];
+                    break;
+                }
+            }
+        }
+
+        // The loop is the end of the path, starting where it was first reached, print it in signal flow order
+        HString loop = rComponentVector[c]->getName();
+        for(size_t p=path.size(); p>visitOrder[c]; --p)
+        {
+            loop += " -> " + rComponentVector[path[p-1]]->getName();
+        }
+
+        addErrorMessage("Initialize: Algebraic loops was found, signal components could not be sorted.");
+        addInfoMessage("Initialize: Algebraic loop: " + loop);
+        addInfoMessage("Initialize: "+to_hstring(nComponents-sorted.size())+" components are in or depend on algebraic loops.");
         addInfoMessage("Initialize: Hint: Use unit delay components to resolve loops.");
+        if (pLevelOffsets)
+        {
+            pLevelOffsets->clear();
+        }
         return false;
     }
-#endif
 
     return true;
 }
 
+//! @brief Returns the number of signal component dependency levels, determined during initialize
+size_t ComponentSystem::getNumSignalLevels() const
+{
+    return mSignalLevelOffsets.empty() ? 0 : mSignalLevelOffsets.size()-1;
+}
+
+//! @brief Returns the signal components in one dependency level, determined during initialize
+//! @details The components in a level only depend on components in earlier levels, so they can be simulated in any order
+//! @param[in] level The level index
+//! @returns The components in the level, or an empty vector if the level does not exist
+std::vector<Component*> ComponentSystem::getSignalLevel(const size_t level) const
+{
+    if (level < getNumSignalLevels())
+    {
+        return std::vector<Component*>(mComponentSignalptrs.begin()+mSignalLevelOffsets[level], mComponentSignalptrs.begin()+mSignalLevelOffsets[level+1]);
+    }
+    return std::vector<Component*>();
+}
+
 
 //! @brief Overloaded function that behaves slightly different when determining unique port names
 //! In systemcomponents we must make sure that systemports and subcomponents have unique names, this simplifies things in the GUI later on
@@ -906,43 +1459,615 @@ bool ComponentSystem::haveSubComponent(const HString &rName) const
     return (mSubComponentMap.count(rName) > 0);
 }
 
-//! @brief Checks if a system is empty (if there are no components or systemports)
-bool ComponentSystem::isEmpty() const
-{
-    return ((mSubComponentMap.size() + mPortPtrMap.size()) == 0);
-}
+//! @brief Checks if a system is empty (if there are no components or systemports)
+bool ComponentSystem::isEmpty() const
+{
+    return ((mSubComponentMap.size() + mPortPtrMap.size()) == 0);
+}
+
+AliasHandler &ComponentSystem::getAliasHandler()
+{
+    return mAliasHandler;
+}
+
+
+//! @brief Add a node as subnode in the system, if the node is already owned by someone else, transfer ownership to this system
+void ComponentSystem::addSubNode(Node* pNode)
+{
+    if (pNode->getOwnerSystem() != 0)
+    {
+        pNode->getOwnerSystem()->removeSubNode(pNode);
+    }
+    mSubNodePtrs.push_back(pNode);
+    pNode->mpOwnerSystem = this;
+}
+
+
+//! @brief Removes a previously added node
+void ComponentSystem::removeSubNode(Node* pNode)
+{
+    // Move all node data back to the nodes before the arena layout becomes invalid
+    if (vectorContains(mNodeDataArenaNodes, pNode))
+    {
+        releaseNodeDataArena();
+    }
+
+    vector<Node*>::iterator it;
+    for (it=mSubNodePtrs.begin(); it!=mSubNodePtrs.end(); ++it)
+    {
+        if (*it == pNode)
+        {
+            pNode->mpOwnerSystem = 0;
+            mSubNodePtrs.erase(it);
+            break;
+        }
+    }
+
+    vector<Node*>::iterator lit = std::find(mLoggedSubNodePtrs.begin(), mLoggedSubNodePtrs.end(), pNode);
+    if (lit != mLoggedSubNodePtrs.end())
+    {
+        mLoggedSubNodePtrs.erase(lit);
+    }
+
+    // The columns of an open sink can not change, so the variables of the removed node are kept but marked as unused.
+    // They are not read from the node any more and are written as NaN for the rest of the simulation.
+    for (size_t i=0; i<mLogSinkNodePtrs.size(); ++i)
+    {
+        if (mLogSinkNodePtrs[i] == pNode)
+        {
+            mLogSinkNodePtrs[i] = 0;
+            if (i < mLogSinkValues.size())
+            {
+                mLogSinkValues[i] = std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+    }
+}
+
+
+//! @brief Enable or disable storing the data values of all sub nodes in one contiguous arena
+//! @details The arena is built in initialize() and is grouped by the thread that simulates the nodes (if scheduled for
+//! multi-threading) and by node type, each group starts on a new cache line. Node data pointers fetched in initialize()
+//! remain valid as long as the system is not changed. The setting is applied to all subsystems as well.
+//! @param [in] useArena True to use the arena, false to move the data back to the nodes
+void ComponentSystem::setUseNodeDataArena(const bool useArena)
+{
+    mUseNodeDataArena = useArena;
+    if (!useArena)
+    {
+        releaseNodeDataArena();
+    }
+
+    SubComponentMapT::iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
+        {
+            static_cast<ComponentSystem*>(it->second)->setUseNodeDataArena(useArena);
+        }
+    }
+}
+
+
+//! @brief Check if the node data of sub nodes is stored in a contiguous arena
+bool ComponentSystem::usesNodeDataArena() const
+{
+    return mUseNodeDataArena;
+}
+
+
+//! @brief Enable or disable warm start, incremental re-initialization when only some parameters have changed
+//! @details With warm start, changes to parameters and to the model are tracked between simulations. If the model and the simulation
+//! time span are unchanged, checkModelBeforeSimulation() only checks and initialize() only evaluates the changed parameters and the
+//! components that refer to changed system parameters. Components that implement Component::hasCompleteSimulationState() and that are not affected by a changed parameter get
+//! back the state they had after the previous initialization, instead of being initialized again. A component is affected if its own
+//! parameters have changed, if it refers to a changed system parameter, or if it shares a node with an affected component that
+//! writes to it. The setting is applied to all subsystems as well.
+//! @param [in] warmStart True to enable warm start
+void ComponentSystem::setWarmStart(const bool warmStart)
+{
+    mWarmStart = warmStart;
+    if (!warmStart)
+    {
+        mWarmStartOffsets.clear();
+        std::vector<char>().swap(mWarmStartStates);
+    }
+
+    SubComponentMapT::iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
+        {
+            static_cast<ComponentSystem*>(it->second)->setWarmStart(warmStart);
+        }
+    }
+}
+
+
+//! @brief Check if warm start is enabled
+bool ComponentSystem::isWarmStartEnabled() const
+{
+    return mWarmStart;
+}
+
+
+//! @brief Returns the number of components that were restored instead of initialized by the last initialize(), including subsystems
+size_t ComponentSystem::getNumWarmStartedComponents() const
+{
+    size_t n = mNumWarmStartedComponents;
+    SubComponentMapT::const_iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
+        {
+            n += static_cast<ComponentSystem*>(it->second)->getNumWarmStartedComponents();
+        }
+    }
+    return n;
+}
+
+
+//! @brief Tell the system that components, connections or system ports have changed, the next initialization can not be a warm start
+void ComponentSystem::markTopologyChanged()
+{
+    mTopologyChanged = true;
+    mTopologyChecked = false;
+    mParameterDependentsValid = false;
+}
+
+
+//! @brief Check if the model or any parameter in this system or in any subsystem has changed since the last initialization
+bool ComponentSystem::hasChangesRecursively() const
+{
+    if (mTopologyChanged || hasChangedParameters())
+    {
+        return true;
+    }
+    SubComponentMapT::const_iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem() ? static_cast<ComponentSystem*>(it->second)->hasChangesRecursively() : it->second->hasChangedParameters())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//! @brief Check the parameters that have changed since the last initialization, used by checkModelBeforeSimulation() on warm start
+//! @details Only sub components with changed parameters, and sub components that refer to changed system parameters, are checked
+//! @returns True if all changed parameters could be evaluated
+bool ComponentSystem::checkChangedParameters()
+{
+    HString errParName;
+    if (hasChangedParameters() && !checkParameters(errParName))
+    {
+        addErrorMessage("The system parameter:  "+errParName+"  in System:  "+getName()+"  can not be evaluated, it maybe depend on a deleted system parameter.");
+        return false;
+    }
+
+    std::set<HString> changedNames;
+    std::set<Component*> dependents;
+    getChangedParameterScope(changedNames);
+    findParameterDependents(changedNames, dependents);
+
+    SubComponentMapT::iterator scmit;
+    for (scmit=mSubComponentMap.begin(); scmit!=mSubComponentMap.end(); ++scmit)
+    {
+        Component* pComp = scmit->second;
+        if (pComp->isDisabled())
+        {
+            continue;
+        }
+
+        if (pComp->isComponentSystem())
+        {
+            if (!pComp->checkModelBeforeSimulation())
+            {
+                return false;
+            }
+        }
+        else if (pComp->hasChangedParameters() || (dependents.count(pComp) > 0))
+        {
+            if (!pComp->checkParameters(errParName))
+            {
+                HString val;
+                pComp->getParameterValue(errParName, val);
+                addErrorMessage("The parameter:  "+errParName+"  in System:  "+getName()+"  and Component:  "+pComp->getName()+" with value:  "+val+"  could not be evaluated!");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+//! @brief Recurse through the model system hierarchy and evaluate the parameters that have changed since the last initialization
+//! @details Sub components with changed parameters are evaluated, and so are the sub components that refer to a changed system
+//! parameter in this system or in a parent system. The evaluated sub components are remembered for findAffectedComponents().
+//! @returns True if any parameter in this system or in any subsystem was evaluated
+bool ComponentSystem::evaluateChangedParametersRecursively()
+{
+    bool evaluated = hasChangedParameters();
+    if (evaluated)
+    {
+        evaluateParameters();
+    }
+
+    std::set<HString> changedNames;
+    getChangedParameterScope(changedNames);
+    mParameterDependentComponents.clear();
+    findParameterDependents(changedNames, mParameterDependentComponents);
+
+    const std::vector<Component*> *componentVectors[3] = {&mComponentSignalptrs, &mComponentCptrs, &mComponentQptrs};
+    for (size_t v=0; v<3; ++v)
+    {
+        const std::vector<Component*> &rComponents = *componentVectors[v];
+        for (size_t c=0; c<rComponents.size(); ++c)
+        {
+            Component *pComp = rComponents[c];
+            if (pComp->isComponentSystem())
+            {
+                if (static_cast<ComponentSystem*>(pComp)->evaluateChangedParametersRecursively())
+                {
+                    mParameterDependentComponents.insert(pComp);
+                    evaluated = true;
+                }
+            }
+            else if (pComp->hasChangedParameters() || (mParameterDependentComponents.count(pComp) > 0))
+            {
+                pComp->evaluateParameters();
+                evaluated = true;
+            }
+        }
+    }
+    return evaluated;
+}
+
+
+//! @brief Find the names of the system parameters, visible in this system, that may have a new value since the last initialization
+//! @details This includes changed parameters in this system and in parent systems, and system parameters that refer to a changed name.
+//! Names are not resolved to a specific system, a changed name in a parent system is included even if this system has a parameter with the same name.
+//! @param[out] rChangedNames The changed names are added here
+void ComponentSystem::getChangedParameterScope(std::set<HString> &rChangedNames)
+{
+    if (mpSystemParent)
+    {
+        mpSystemParent->getChangedParameterScope(rChangedNames);
+    }
+    const std::vector<HString> &rOwnChangedNames = getChangedParameterNames();
+    rChangedNames.insert(rOwnChangedNames.begin(), rOwnChangedNames.end());
+
+    // System parameters may refer to other changed system parameters, repeat until no more are found
+    const std::vector<ParameterEvaluator*> *pParameters = getParametersVectorPtr();
+    bool foundMore = !rChangedNames.empty();
+    while (foundMore)
+    {
+        foundMore = false;
+        for (size_t p=0; p<pParameters->size(); ++p)
+        {
+            ParameterEvaluator *pParameter = pParameters->at(p);
+            if (rChangedNames.count(pParameter->getName()) > 0)
+            {
+                continue;
+            }
+            const std::vector<HString> &rReferencedNames = pParameter->getReferencedNames();
+            for (size_t n=0; n<rReferencedNames.size(); ++n)
+            {
+                const HString &rName = rReferencedNames[n];
+                if ((rChangedNames.count(rName) > 0) || (rName.startsWith("self.") && (rChangedNames.count(rName.substr(5)) > 0)))
+                {
+                    rChangedNames.insert(pParameter->getName());
+                    foundMore = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+
+//! @brief Find the sub components with parameters that refer to any of the given system parameter names
+//! @details The dependencies are cached and only rebuilt when sub components are added or removed or when a sub component parameter has changed.
+//! Subsystems are not included, they find their own dependents.
+//! @param[in] rChangedNames The system parameter names
+//! @param[out] rDependents The dependent sub components are added here
+void ComponentSystem::findParameterDependents(const std::set<HString> &rChangedNames, std::set<Component*> &rDependents)
+{
+    if (rChangedNames.empty())
+    {
+        return;
+    }
+
+    // Changed sub component parameters may refer to other names than before
+    bool upToDate = mParameterDependentsValid;
+    SubComponentMapT::iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end() && upToDate; ++it)
+    {
+        upToDate = it->second->isComponentSystem() || !it->second->hasChangedParameters();
+    }
+    if (!upToDate)
+    {
+        updateParameterDependents();
+    }
+
+    std::set<HString>::const_iterator nit;
+    for (nit=rChangedNames.begin(); nit!=rChangedNames.end(); ++nit)
+    {
+        std::map<HString, std::vector<Component*> >::const_iterator dit = mParameterDependents.find(*nit);
+        if (dit != mParameterDependents.end())
+        {
+            rDependents.insert(dit->second.begin(), dit->second.end());
+        }
+    }
+}
+
+
+//! @brief Rebuild the map from system parameter names to the sub components that refer to them
+void ComponentSystem::updateParameterDependents()
+{
+    mParameterDependents.clear();
+    SubComponentMapT::iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        Component *pComp = it->second;
+        if (pComp->isComponentSystem())
+        {
+            continue;
+        }
+        const std::vector<ParameterEvaluator*> *pParameters = pComp->getParametersVectorPtr();
+        for (size_t p=0; p<pParameters->size(); ++p)
+        {
+            const std::vector<HString> &rReferencedNames = pParameters->at(p)->getReferencedNames();
+            for (size_t n=0; n<rReferencedNames.size(); ++n)
+            {
+                // Names beginning with self. refer to the component itself, all its parameters are evaluated together
+                if (rReferencedNames[n].startsWith("self."))
+                {
+                    continue;
+                }
+                std::vector<Component*> &rDependents = mParameterDependents[rReferencedNames[n]];
+                if (rDependents.empty() || (rDependents.back() != pComp))
+                {
+                    rDependents.push_back(pComp);
+                }
+            }
+        }
+    }
+    mParameterDependentsValid = true;
+}
+
+
+//! @brief Find the sub components that must be initialized again on warm start
+//! @details Components with changed or re-evaluated parameters and subsystems with any change are affected. So is every component on a node that an
+//! affected component writes to, since its initialization may depend on the values written there. Read ports do not affect other ports.
+//! @param[out] rAffected The affected components
+void ComponentSystem::findAffectedComponents(std::set<Component*> &rAffected) const
+{
+    std::vector<Component*> queue;
+    const std::vector<Component*> *componentVectors[3] = {&mComponentSignalptrs, &mComponentCptrs, &mComponentQptrs};
+    for (size_t v=0; v<3; ++v)
+    {
+        const std::vector<Component*> &rComponents = *componentVectors[v];
+        for (size_t c=0; c<rComponents.size(); ++c)
+        {
+            Component *pComp = rComponents[c];
+            const bool changed = (mParameterDependentComponents.count(pComp) > 0) ||
+                                 (pComp->isComponentSystem() ? static_cast<ComponentSystem*>(pComp)->hasChangesRecursively() : pComp->hasChangedParameters());
+            if (changed && rAffected.insert(pComp).second)
+            {
+                queue.push_back(pComp);
+            }
+        }
+    }
+
+    while (!queue.empty())
+    {
+        Component *pComp = queue.back();
+        queue.pop_back();
+        const std::vector<Port*> ports = pComp->getPortPtrVector();
+        for (size_t p=0; p<ports.size(); ++p)
+        {
+            if ((ports[p]->getPortType() == ReadPortType) || (ports[p]->getPortType() == ReadMultiportType))
+            {
+                continue;
+            }
+            for (size_t s=0; s<ports[p]->getNumPorts(); ++s)
+            {
+                const Node *pNode = ports[p]->getNodePtr(s);
+                if (!pNode)
+                {
+                    continue;
+                }
+                for (size_t i=0; i<pNode->mConnectedPorts.size(); ++i)
+                {
+                    // Components outside of this system are handled by the parent system
+                    Component *pOtherComp = pNode->mConnectedPorts[i]->getComponent();
+                    if ((pOtherComp->getSystemParent() == this) && rAffected.insert(pOtherComp).second)
+                    {
+                        queue.push_back(pOtherComp);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+//! @brief Restore the state from the previous initialization to all sub components that are not affected by any change
+//! @param[in] rAffected The components that must be initialized again
+//! @param[out] rRestored The components that were restored, these shall not be initialized
+void ComponentSystem::restoreWarmStartStates(const std::set<Component*> &rAffected, std::set<Component*> &rRestored)
+{
+    const std::vector<Component*> *componentVectors[3] = {&mComponentSignalptrs, &mComponentCptrs, &mComponentQptrs};
+    for (size_t v=0; v<3; ++v)
+    {
+        const std::vector<Component*> &rComponents = *componentVectors[v];
+        for (size_t c=0; c<rComponents.size(); ++c)
+        {
+            Component *pComp = rComponents[c];
+            std::map<Component*, size_t>::const_iterator it = mWarmStartOffsets.find(pComp);
+            if ((it == mWarmStartOffsets.end()) || (rAffected.count(pComp) > 0) || !pComp->hasCompleteSimulationState())
+            {
+                continue;
+            }
+
+            // The state depends on the time step, which may have been changed without changing the model
+            SimulationStateReader reader(&mWarmStartStates[it->second], mWarmStartStates.size()-it->second);
+            double timestep;
+            if (!reader.read(timestep) || (timestep != pComp->getTimestep()))
+            {
+                continue;
+            }
+
+            bool success = true;
+            const std::vector<Port*> ports = pComp->getPortPtrVector();
+            for (size_t p=0; p<ports.size() && success; ++p)
+            {
+                for (size_t s=0; s<ports[p]->getNumPorts() && success; ++s)
+                {
+                    const Node *pNode = ports[p]->getNodePtr(s);
+                    size_t nValues;
+                    success = reader.read(nValues) && pNode && (nValues == pNode->getNumDataVariables()) &&
+                              reader.read(ports[p]->getNodeDataValuesPtr(s), nValues);
+                }
+            }
+            success = success && pComp->restoreSimulationState(reader) && reader.isOk();
+
+            // If the restore fails the component is initialized, which overwrites anything that was restored
+            if (success)
+            {
+                pComp->mTime = mTime;
+                rRestored.insert(pComp);
+            }
+        }
+    }
+}
+
+
+//! @brief Save the state of all sub components that support it, to be restored on the next warm start
+void ComponentSystem::saveWarmStartStates()
+{
+    mWarmStartOffsets.clear();
+    mWarmStartStates.clear();
+    SimulationStateWriter writer(mWarmStartStates);
+    const std::vector<Component*> *componentVectors[3] = {&mComponentSignalptrs, &mComponentCptrs, &mComponentQptrs};
+    for (size_t v=0; v<3; ++v)
+    {
+        const std::vector<Component*> &rComponents = *componentVectors[v];
+        for (size_t c=0; c<rComponents.size(); ++c)
+        {
+            Component *pComp = rComponents[c];
+            if (pComp->isComponentSystem() || !pComp->hasCompleteSimulationState())
+            {
+                continue;
+            }
+
+            mWarmStartOffsets[pComp] = mWarmStartStates.size();
+            writer.write(pComp->getTimestep());
+            const std::vector<Port*> ports = pComp->getPortPtrVector();
+            for (size_t p=0; p<ports.size(); ++p)
+            {
+                for (size_t s=0; s<ports[p]->getNumPorts(); ++s)
+                {
+                    const Node *pNode = ports[p]->getNodePtr(s);
+                    const size_t nValues = pNode ? pNode->getNumDataVariables() : 0;
+                    writer.write(nValues);
+                    writer.write(ports[p]->getNodeDataValuesPtr(s), nValues);
+                }
+            }
+            pComp->saveSimulationState(writer);
+        }
+    }
+}
+
 
-AliasHandler &ComponentSystem::getAliasHandler()
+//! @brief Moves the data values of all sub nodes into one contiguous cache line aligned arena
+//! @details If the nodes and the layout are unchanged since the last call, the existing arena is kept so that node data
+//! pointers stay valid
+void ComponentSystem::buildNodeDataArena()
 {
-    return mAliasHandler;
-}
+    const size_t valuesPerCacheLine = HOPSAN_CACHE_LINE_SIZE/sizeof(double);
 
+    // Group the nodes by thread (if they have been distributed over threads) and by node type
+    vector< vector<Node*> > nodeGroups;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    size_t nDistributedNodes = 0;
+    for (size_t t=0; t<mpMultiThreadPrivates->mSplitNodeVector.size(); ++t)
+    {
+        nDistributedNodes += mpMultiThreadPrivates->mSplitNodeVector[t].size();
+    }
+    if (nDistributedNodes == mSubNodePtrs.size())
+    {
+        nodeGroups = mpMultiThreadPrivates->mSplitNodeVector;
+    }
+#endif
+    if (nodeGroups.empty())
+    {
+        nodeGroups.push_back(mSubNodePtrs);
+    }
 
-//! @brief Add a node as subnode in the system, if the node is already owned by someone else, transfer ownership to this system
-void ComponentSystem::addSubNode(Node* pNode)
-{
-    if (pNode->getOwnerSystem() != 0)
+    vector<Node*> nodes;
+    vector<size_t> offsets;
+    size_t nValues = 0;
+    for (size_t g=0; g<nodeGroups.size(); ++g)
     {
-        pNode->getOwnerSystem()->removeSubNode(pNode);
+        std::stable_sort(nodeGroups[g].begin(), nodeGroups[g].end(), [](const Node *pA, const Node *pB)
+                         { return pA->getNodeType() < pB->getNodeType(); });
+        for (size_t n=0; n<nodeGroups[g].size(); ++n)
+        {
+            // Start each thread group and each node type on a new cache line
+            if (n == 0 || nodeGroups[g][n]->getNodeType() != nodeGroups[g][n-1]->getNodeType())
+            {
+                nValues = (nValues+valuesPerCacheLine-1)/valuesPerCacheLine*valuesPerCacheLine;
+            }
+            nodes.push_back(nodeGroups[g][n]);
+            offsets.push_back(nValues);
+            nValues += nodeGroups[g][n]->getNumDataVariables();
+        }
     }
-    mSubNodePtrs.push_back(pNode);
-    pNode->mpOwnerSystem = this;
+
+    // Keep the current arena if the layout is unchanged
+    if (!mNodeDataArenaStorage.empty() && nodes == mNodeDataArenaNodes)
+    {
+        void *pArena = mNodeDataArenaStorage.data();
+        size_t space = mNodeDataArenaStorage.size()*sizeof(double);
+        double *pBase = static_cast<double*>(std::align(HOPSAN_CACHE_LINE_SIZE, nValues*sizeof(double), pArena, space));
+        bool unchanged = (pBase != 0);
+        for (size_t n=0; unchanged && n<nodes.size(); ++n)
+        {
+            unchanged = (nodes[n]->mpDataValues == pBase+offsets[n]);
+        }
+        if (unchanged)
+        {
+            return;
+        }
+    }
+
+    releaseNodeDataArena();
+    mNodeDataArenaStorage.resize(nValues+valuesPerCacheLine, 0.0);
+    void *pArena = mNodeDataArenaStorage.data();
+    size_t space = mNodeDataArenaStorage.size()*sizeof(double);
+    double *pBase = static_cast<double*>(std::align(HOPSAN_CACHE_LINE_SIZE, nValues*sizeof(double), pArena, space));
+    for (size_t n=0; n<nodes.size(); ++n)
+    {
+        nodes[n]->setDataStorage(pBase+offsets[n]);
+    }
+    mNodeDataArenaNodes.swap(nodes);
+    addDebugMessage("Node data arena with "+to_hstring(mNodeDataArenaNodes.size())+" nodes, "+to_hstring(nValues*sizeof(double))+" bytes");
 }
 
 
-//! @brief Removes a previously added node
-void ComponentSystem::removeSubNode(Node* pNode)
+//! @brief Moves the data values of all nodes in the arena back to the nodes and frees the arena
+void ComponentSystem::releaseNodeDataArena()
 {
-    vector<Node*>::iterator it;
-    for (it=mSubNodePtrs.begin(); it!=mSubNodePtrs.end(); ++it)
+    for (size_t n=0; n<mNodeDataArenaNodes.size(); ++n)
     {
-        if (*it == pNode)
-        {
-            pNode->mpOwnerSystem = 0;
-            mSubNodePtrs.erase(it);
-            break;
-        }
+        mNodeDataArenaNodes[n]->setDataStorage(0);
     }
+    mNodeDataArenaNodes.clear();
+    vector<double>().swap(mNodeDataArenaStorage);
 }
 
 
@@ -954,14 +2079,35 @@ void ComponentSystem::preAllocateLogSpace()
     //    this->setLogSettingsNSamples(nSamples, startT, stopT, mTimestep);
     //! @todo Fix /Peter
     mLogCtr = 0;
-    if (mEnableLogData)
+    mLogStepCtr = 0;
+    if (mpLogSink && mLogSinkIsOpen)
+    {
+        mpLogSink->close();
+        mLogSinkIsOpen = false;
+    }
+    mLogSinkNodePtrs.clear();
+    mLogSinkDataIds.clear();
+    mLogSinkValues.clear();
+
+    // Interval mean and envelopes require the node values of every simulation step
+    mLogAccumulate = (mLogMode == MeanLogMode) || mLogEnvelope;
+
+    // Room for the regular log samples and the extra samples that triggers may take
+    setupLogTriggers();
+    const size_t nLogSlots = mnLogSlots + (mLogTriggers.empty() ? 0 : mnTriggeredLogSlots);
+
+    if (mEnableLogData && mpLogSink)
+    {
+        openLogSink(nLogSlots);
+    }
+    else if (mEnableLogData)
     {
         try
         {
-            mTimeStorage.resize(mnLogSlots, 0);
+            mTimeStorage.resize(nLogSlots, 0);
 
-            // Allocate log data memory for subnodes
-            //! @todo we should have an other vector with those nodes that should be logged, if we make individual nodes possible to disable logging
+            // Allocate log data memory for subnodes, and remember which nodes actually log something
+            mLoggedSubNodePtrs.clear();
             vector<Node*>::iterator it;
             for (it=mSubNodePtrs.begin(); it!=mSubNodePtrs.end(); ++it)
             {
@@ -984,7 +2130,11 @@ void ComponentSystem::preAllocateLogSpace()
                     else
                     {
                         (*it)->setDoLogIfEnabled(true);
-                        (*it)->preAllocateLogSpace(mnLogSlots);
+                        (*it)->preAllocateLogSpace(nLogSlots, mLogEnvelope);
+                        if ((*it)->mDoLog)
+                        {
+                            mLoggedSubNodePtrs.push_back(*it);
+                        }
                     }
                     success = true;
                 }
@@ -1013,19 +2163,222 @@ void ComponentSystem::preAllocateLogSpace()
 }
 
 
+//! @brief Resolve the nodes of the log triggers and reset the trigger state
+void ComponentSystem::setupLogTriggers()
+{
+    mnTriggeredLogSamples = 0;
+    mLogCaptureStepsLeft = 0;
+    for (size_t t=0; t<mLogTriggers.size(); ++t)
+    {
+        LogTrigger &rTrigger = mLogTriggers[t];
+        Component *pComp = getSubComponent(rTrigger.mComponentName);
+        Port *pPort = pComp ? pComp->getPort(rTrigger.mPortName) : 0;
+        const int dataId = pPort ? pPort->getNodeDataIdFromName(rTrigger.mVariableName) : -1;
+        if (dataId >= 0)
+        {
+            rTrigger.mpNode = pPort->getNodePtr();
+            rTrigger.mDataId = size_t(dataId);
+        }
+        else
+        {
+            addWarningMessage("Log trigger variable: "+rTrigger.mComponentName+"#"+rTrigger.mPortName+"#"+rTrigger.mVariableName+" no longer exists, ignoring trigger");
+            rTrigger.mpNode = 0;
+        }
+        // The first value can not be a crossing
+        rTrigger.mPreviousValue = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+//! @brief Check if any trigger variable has crossed its threshold since the previous step, and if so start a capture
+void ComponentSystem::updateLogTriggers()
+{
+    for (size_t t=0; t<mLogTriggers.size(); ++t)
+    {
+        LogTrigger &rTrigger = mLogTriggers[t];
+        if (rTrigger.mpNode)
+        {
+            const double value = rTrigger.mpNode->mpDataValues[rTrigger.mDataId];
+            const double prev = rTrigger.mPreviousValue;
+            if ((prev < rTrigger.mThreshold && value >= rTrigger.mThreshold) || (prev > rTrigger.mThreshold && value <= rTrigger.mThreshold))
+            {
+                mLogCaptureStepsLeft = std::max(mLogCaptureStepsLeft, rTrigger.mNumCaptureSteps);
+            }
+            rTrigger.mPreviousValue = value;
+        }
+    }
+}
+
+//! @brief Collect the logged node variables and open the log sink, node log storage is released
+//! @param [in] nLogSlots The maximum number of samples that will be written
+void ComponentSystem::openLogSink(const size_t nLogSlots)
+{
+    mTimeStorage.clear();
+    mLoggedSubNodePtrs.clear();
+
+    std::vector<LogSinkVariable> variables;
+    for (size_t n=0; n<mSubNodePtrs.size(); ++n)
+    {
+        Node *pNode = mSubNodePtrs[n];
+        // Same rule as for node storage, unconnected read port nodes are not logged
+        const bool isUnconnectedReadNode = (pNode->getNumConnectedPorts() < 2) && (pNode->getNumberOfPortsByType(ReadPortType) == 1);
+        pNode->setDoLogIfEnabled(!isUnconnectedReadNode);
+        if (pNode->mDoLog)
+        {
+            for (size_t v=0; v<pNode->mLogMask.size(); ++v)
+            {
+                if (!pNode->mLogMask[v])
+                {
+                    continue;
+                }
+                // Name the variable after the first port that wants to log it, prefer ports that are not multiport sub ports
+                Port *pNamePort = 0;
+                for (size_t p=0; p<pNode->mConnectedPorts.size(); ++p)
+                {
+                    Port *pPort = pNode->mConnectedPorts[p];
+                    if (pPort->isVariableLoggingEnabled(v) && (!pNamePort || (pNamePort->getParentPort() && !pPort->getParentPort())))
+                    {
+                        pNamePort = pPort;
+                    }
+                }
+                if (pNamePort)
+                {
+                    const NodeDataDescription *pDesc = pNode->getDataDescription(v);
+                    LogSinkVariable var;
+                    var.mComponent = pNamePort->getComponentName();
+                    var.mPort = pNamePort->getParentPort() ? pNamePort->getParentPort()->getName() : pNamePort->getName();
+                    var.mName = pDesc->name;
+                    var.mAlias = pNamePort->getVariableAlias(v);
+                    var.mUnit = pDesc->unit;
+                    var.mQuantity = pDesc->quantity;
+                    variables.push_back(var);
+                    mLogSinkNodePtrs.push_back(pNode);
+                    mLogSinkDataIds.push_back(v);
+                }
+            }
+        }
+        // Release any node log storage, the sink receives the data instead
+        pNode->setDoLogIfEnabled(false);
+    }
+    mLogSinkValues.assign(mLogSinkNodePtrs.size(), 0.0);
+    mLogSinkSums.assign(mLogSinkNodePtrs.size(), 0.0);
+    mLogSinkNumSummed = 0;
+    if (mLogEnvelope)
+    {
+        addWarningMessage("Log envelopes are not written to log sinks");
+    }
+
+    if (mpLogSink->open(variables, nLogSlots))
+    {
+        mLogSinkIsOpen = true;
+    }
+    else
+    {
+        addErrorMessage("Failed to open log sink: "+mpLogSink->getErrorMessage());
+        stopSimulation("Failed to open log sink");
+    }
+}
+
+
 void ComponentSystem::logTimeAndNodes(const size_t simStep)
 {
-    if (mEnableLogData)
+    if (!mEnableLogData)
+    {
+        return;
+    }
+
+    // Regular log samples are taken at the precalculated time steps
+    bool doLog = (mLogStepCtr < mLogTheseTimeSteps.size()) && (mLogTheseTimeSteps[mLogStepCtr] == simStep);
+    if (doLog)
+    {
+        ++mLogStepCtr;
+    }
+
+    // Nothing is logged before the first regular sample (the log start time)
+    if (mLogStepCtr == 0)
+    {
+        return;
+    }
+
+    // After a trigger, extra samples are taken at every step until the capture or the extra sample budget ends
+    if (!mLogTriggers.empty())
+    {
+        updateLogTriggers();
+        if (mLogCaptureStepsLeft > 0)
+        {
+            --mLogCaptureStepsLeft;
+            if (!doLog && (mnTriggeredLogSamples < mnTriggeredLogSlots))
+            {
+                ++mnTriggeredLogSamples;
+                doLog = true;
+            }
+        }
+    }
+
+    if (mLogSinkIsOpen)
+    {
+        if (mLogMode == MeanLogMode)
+        {
+            for (size_t i=0; i<mLogSinkNodePtrs.size(); ++i)
+            {
+                if (mLogSinkNodePtrs[i])
+                {
+                    mLogSinkSums[i] += mLogSinkNodePtrs[i]->mpDataValues[mLogSinkDataIds[i]];
+                }
+            }
+            ++mLogSinkNumSummed;
+        }
+        if (doLog)
+        {
+            for (size_t i=0; i<mLogSinkNodePtrs.size(); ++i)
+            {
+                if (!mLogSinkNodePtrs[i])
+                {
+                    // Unused, the node was removed during the simulation
+                    continue;
+                }
+                if (mLogMode == MeanLogMode)
+                {
+                    mLogSinkValues[i] = mLogSinkSums[i]/double(mLogSinkNumSummed);
+                    mLogSinkSums[i] = 0;
+                }
+                else
+                {
+                    mLogSinkValues[i] = mLogSinkNodePtrs[i]->mpDataValues[mLogSinkDataIds[i]];
+                }
+            }
+            mLogSinkNumSummed = 0;
+            mpLogSink->write(mTime, mLogSinkValues.data());
+            ++mLogCtr;
+        }
+    }
+    else
     {
-        if (mLogTheseTimeSteps[mLogCtr] ==  simStep)
+        vector<Node*>::iterator it;
+        if (mLogAccumulate)
+        {
+            for (it=mLoggedSubNodePtrs.begin(); it!=mLoggedSubNodePtrs.end(); ++it)
+            {
+                (*it)->accumulateLogData();
+            }
+        }
+        if (doLog)
         {
             mTimeStorage[mLogCtr] = mTime;   //We log the "real"  simulation time for the sample
 
-            //! @todo we should have an other vector with those nodes that should be logged, if we make individual nodes possible to disable logging
-            vector<Node*>::iterator it;
-            for (it=mSubNodePtrs.begin(); it!=mSubNodePtrs.end(); ++it)
+            if (mLogAccumulate)
+            {
+                const bool logMean = (mLogMode == MeanLogMode);
+                for (it=mLoggedSubNodePtrs.begin(); it!=mLoggedSubNodePtrs.end(); ++it)
+                {
+                    (*it)->logAccumulatedData(mLogCtr, logMean);
+                }
+            }
+            else
             {
-                (*it)->logData(mLogCtr);
+                for (it=mLoggedSubNodePtrs.begin(); it!=mLoggedSubNodePtrs.end(); ++it)
+                {
+                    (*it)->logData(mLogCtr);
+                }
             }
             ++mLogCtr;
         }
@@ -1095,6 +2448,7 @@ Port* ComponentSystem::addSystemPort(HString portName, const HString &rDescripti
         portName = "p";
     }
 
+    markTopologyChanged();
     return addPort(portName, SystemPortType, "NodeEmpty", rDescription, Port::Required);
 }
 
@@ -1117,6 +2471,7 @@ void ComponentSystem::deleteSystemPort(const HString &rName)
 {
     deletePort(rName);
     unReserveUniqueName(rName);
+    markTopologyChanged();
 }
 
 
@@ -1448,6 +2803,17 @@ bool ComponentSystem::connect(Port *pPort1, Port *pPort2)
         return false;
     }
 
+    // Subsystems check their own system port connections, so they must be told as well
+    markTopologyChanged();
+    if (pComp1->isComponentSystem())
+    {
+        static_cast<ComponentSystem*>(pComp1)->markTopologyChanged();
+    }
+    if (pComp2->isComponentSystem())
+    {
+        static_cast<ComponentSystem*>(pComp2)->markTopologyChanged();
+    }
+
     // Update the CQS type, we need to run this always even if not directly connecting to a systemport
     // In some cases the port we are connecting to may be indirectly connected to the systemport
     this->determineCQSType();
@@ -1501,8 +2867,11 @@ bool ComponentSystem::disconnect(Port *pPort1, Port *pPort2)
     // First check if ports not null
     if (pPort1 && pPort2)
     {
-        HString msgName1 = pPort1->getComponent()->getName()+"::"+pPort1->getName();
-        HString msgName2 = pPort2->getComponent()->getName()+"::"+pPort2->getName();
+        // The port pointers may be cleared below if a subport in a multiport is removed
+        Component *pComp1 = pPort1->getComponent();
+        Component *pComp2 = pPort2->getComponent();
+        HString msgName1 = pComp1->getName()+"::"+pPort1->getName();
+        HString msgName2 = pComp2->getName()+"::"+pPort2->getName();
 
         ConnectionAssistant disconnAssistant(this);
         //! @todo some more advanced error handling
@@ -1542,6 +2911,16 @@ bool ComponentSystem::disconnect(Port *pPort1, Port *pPort2)
 
             disconnAssistant.clearSysPortNodeTypeIfEmpty(pPort1);
             disconnAssistant.clearSysPortNodeTypeIfEmpty(pPort2);
+
+            markTopologyChanged();
+            if (pComp1->isComponentSystem())
+            {
+                static_cast<ComponentSystem*>(pComp1)->markTopologyChanged();
+            }
+            if (pComp2->isComponentSystem())
+            {
+                static_cast<ComponentSystem*>(pComp2)->markTopologyChanged();
+            }
             //! @todo maybe incorporate the clear checks into delete node and unmerge
 
             // Update the CQS type, we need to run this always even if not directly connecting to a systemport
@@ -1791,6 +3170,12 @@ void ComponentSystem::setKeepValuesAsStartValues(bool tf)
 //! @returns true if everything is OK, else false (simulation not permitted)
 bool ComponentSystem::checkModelBeforeSimulation()
 {
+    // On warm start, only the changed parameters need to be checked if the model is unchanged since the last successful check
+    if (mWarmStart && mTopologyChecked)
+    {
+        return checkChangedParameters();
+    }
+
     // Make sure that there are no components or systems with an undefined cqs_type present
     if (mComponentUndefinedptrs.size() > 0)
     {
@@ -1926,9 +3311,10 @@ bool ComponentSystem::checkModelBeforeSimulation()
             return false;
         }
 
-        // Recurse testing into subsystems
+        // Recurse testing into subsystems, they must do a full check as well since parent system parameters may have changed
         if (pComp->isComponentSystem())
         {
+            static_cast<ComponentSystem*>(pComp)->mTopologyChecked = false;
             if (!pComp->checkModelBeforeSimulation())
             {
                 return false;
@@ -1950,6 +3336,7 @@ bool ComponentSystem::checkModelBeforeSimulation()
         addWarningMessage(ss.str().c_str());
     }
 
+    mTopologyChecked = true;
     return true;
 }
 
@@ -2272,7 +3659,7 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
     adjustTimestep(mComponentQptrs);
 
     // Sort signal components, if they can not be sorted (algebraic loop), return with failure
-    if(!sortComponentVector(mComponentSignalptrs))
+    if(!sortComponentVector(mComponentSignalptrs, &mSignalLevelOffsets))
     {
         return false;
     }
@@ -2280,6 +3667,12 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
     sortComponentVector(mComponentCptrs);
     sortComponentVector(mComponentQptrs);
 
+    // Move node data to the arena before start values are set and components fetch their node data pointers
+    if (mUseNodeDataArena)
+    {
+        buildNodeDataArena();
+    }
+
     // run top-level system initialization functions
     if (this->isTopLevelSystem())
     {
@@ -2291,7 +3684,15 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
 
         // If the numhop scripts have changed the values, we need to make sure that the parameters are reevaluated
         // This is also necessary because preInitialize may have done some changes
-        evaluateParametersRecursively();
+        // On warm start only the changed parameters are evaluated
+        if (mWarmStart)
+        {
+            evaluateChangedParametersRecursively();
+        }
+        else
+        {
+            evaluateParametersRecursively();
+        }
 
         // Now we set the actual node data variables to the values from the start nodes (copy node values)
         // thereby initializing the system hierarchy with the start values
@@ -2304,6 +3705,17 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
         }
     }
 
+    // On warm start, sub components that are not affected by any change since the previous initialization get back their state from
+    // that initialization instead of being initialized again. This requires that the model and the simulation time span are unchanged.
+    const bool warmStart = mWarmStart && !mForceFullInitialize && !mTopologyChanged && !mKeepValuesAsStartValues &&
+                           (startT == mWarmStartStartT) && (stopT == mWarmStartStopT);
+    std::set<Component*> affectedComponents, warmStartedComponents;
+    if (warmStart)
+    {
+        findAffectedComponents(affectedComponents);
+        restoreWarmStartStates(affectedComponents, warmStartedComponents);
+    }
+
     // Initialization of the system hierarchy
     // Initialize Signal components
     for (size_t s=0; s < mComponentSignalptrs.size(); ++s)
@@ -2321,6 +3733,12 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
             //! @todo should we use our own nSamples or the subsystems own ?
             static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setNumLogSamples(mRequestedNumLogSamples);
             static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setLogStartTime(mRequestedLogStartTime);
+            static_cast<ComponentSystem*>(mComponentSignalptrs[s])->mWarmStart = mWarmStart;
+            static_cast<ComponentSystem*>(mComponentSignalptrs[s])->mForceFullInitialize = !warmStart || (affectedComponents.count(mComponentSignalptrs[s]) > 0);
+        }
+        else if (warmStartedComponents.count(mComponentSignalptrs[s]) > 0)
+        {
+            continue;
         }
 
         addCoreLogMessage("ComponentSystem::initialize() Initializing component: "+mComponentSignalptrs[s]->getName());
@@ -2346,6 +3764,12 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
             //! @todo should we use our own nSamples ore the subsystems own ?
             static_cast<ComponentSystem*>(mComponentCptrs[c])->setNumLogSamples(mRequestedNumLogSamples);
             static_cast<ComponentSystem*>(mComponentCptrs[c])->setLogStartTime(mRequestedLogStartTime);
+            static_cast<ComponentSystem*>(mComponentCptrs[c])->mWarmStart = mWarmStart;
+            static_cast<ComponentSystem*>(mComponentCptrs[c])->mForceFullInitialize = !warmStart || (affectedComponents.count(mComponentCptrs[c]) > 0);
+        }
+        else if (warmStartedComponents.count(mComponentCptrs[c]) > 0)
+        {
+            continue;
         }
 
         addCoreLogMessage("ComponentSystem::initialize() Initializing component: "+mComponentCptrs[c]->getName());
@@ -2371,6 +3795,12 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
             //! @todo should we use our own nSamples ore the subsystems own ?
             static_cast<ComponentSystem*>(mComponentQptrs[q])->setNumLogSamples(mRequestedNumLogSamples);
             static_cast<ComponentSystem*>(mComponentQptrs[q])->setLogStartTime(mRequestedLogStartTime);
+            static_cast<ComponentSystem*>(mComponentQptrs[q])->mWarmStart = mWarmStart;
+            static_cast<ComponentSystem*>(mComponentQptrs[q])->mForceFullInitialize = !warmStart || (affectedComponents.count(mComponentQptrs[q]) > 0);
+        }
+        else if (warmStartedComponents.count(mComponentQptrs[q]) > 0)
+        {
+            continue;
         }
 
         addCoreLogMessage("ComponentSystem::initialize() Initializing component: "+mComponentQptrs[q]->getName());
@@ -2386,6 +3816,25 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
         return false;
     }
 
+    // Remember the state after initialization for the next warm start, and that everything is up to date
+    mNumWarmStartedComponents = warmStartedComponents.size();
+    if (mWarmStart)
+    {
+        saveWarmStartStates();
+    }
+    mWarmStartStartT = startT;
+    mWarmStartStopT = stopT;
+    mTopologyChanged = false;
+    resetChangedParameters();
+    const std::vector<Component*> *componentVectors[3] = {&mComponentSignalptrs, &mComponentCptrs, &mComponentQptrs};
+    for (size_t v=0; v<3; ++v)
+    {
+        for (size_t c=0; c<componentVectors[v]->size(); ++c)
+        {
+            componentVectors[v]->at(c)->resetChangedParameters();
+        }
+    }
+
     // Log the start values
     logTimeAndNodes(mTotalTakenSimulationSteps);
 
@@ -2428,12 +3877,26 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
                 addDebugMessage("Time for "+mComponentSignalptrs.at(s)->getName()+": "+to_hstring(mComponentSignalptrs.at(s)->getMeasuredTime()));
             }
 
-            distributeCcomponents(mpMultiThreadPrivates->mSplitCVector, nThreads);              //Distribute components and nodes
-            distributeQcomponents(mpMultiThreadPrivates->mSplitQVector, nThreads);
+            mpMultiThreadPrivates->mUseGraphPartitioning = (algorithm == GraphPartitioningAlgorithm);
+            if(mpMultiThreadPrivates->mUseGraphPartitioning)
+            {
+                distributeByGraphPartitioning(mpMultiThreadPrivates->mSplitCVector, mpMultiThreadPrivates->mSplitQVector,
+                                              mpMultiThreadPrivates->mSplitNodeVector, nThreads);
+                // The node data arena groups node data by thread by itself
+                if (!mUseNodeDataArena)
+                {
+                    relocateNodeData(mpMultiThreadPrivates->mSplitNodeVector);
+                }
+            }
+            else
+            {
+                distributeCcomponents(mpMultiThreadPrivates->mSplitCVector, nThreads);              //Distribute components and nodes
+                distributeQcomponents(mpMultiThreadPrivates->mSplitQVector, nThreads);
+                distributeNodePointers(mpMultiThreadPrivates->mSplitNodeVector, nThreads);
+            }
             distributeSignalcomponents(mpMultiThreadPrivates->mSplitSignalVector, nThreads);
-            distributeNodePointers(mpMultiThreadPrivates->mSplitNodeVector, nThreads);
 
-            // Re-initialize the system to reset values and timers
+            // Re-initialize the system to reset values, timers and node data pointers
             //! @note This only work for top level systems where the simulateMultiThreaded will not be called more than once
             this->initialize(startT, stopT);
         }
@@ -2476,10 +3939,98 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
 
     size_t nSteps = calcNumSimSteps(startT, stopT);
 
+    // Schedule the signal components by dependency level, the levels are determined in initialize
+    const bool wavefrontSupported = (algorithm == OfflineSchedulingAlgorithm || algorithm == GraphPartitioningAlgorithm ||
+                                     algorithm == ParallelForAlgorithm || algorithm == GroupedParallelForAlgorithm);
+    SignalWavefront *pWavefront = 0;
+    if(mpMultiThreadPrivates->mSignalWavefront && nThreads > 1)
+    {
+        if(wavefrontSupported)
+        {
+            std::vector< std::vector<Component*> > levels(getNumSignalLevels());
+            for(size_t l=0; l<levels.size(); ++l)
+            {
+                levels[l] = getSignalLevel(l);
+            }
+            pWavefront = &mpMultiThreadPrivates->mSignalWavefrontSchedule;
+            pWavefront->build(levels, nThreads, mpMultiThreadPrivates->mWavefrontMinLevelSize);
+            addInfoMessage("Simulating "+to_hstring(levels.size())+" signal component levels in "+to_hstring(pWavefront->getNumStages())+
+                           " wavefront stages, "+to_hstring(pWavefront->getNumParallelStages())+" of them in parallel.");
+        }
+        else
+        {
+            addWarningMessage("Signal wavefront scheduling is not supported by the selected algorithm, signal components are simulated as usual.");
+        }
+    }
+
+    // Online load sampling is only used by the offline scheduling algorithm, the other algorithms balance load dynamically
+    size_t sampleInterval = 0;
+    mpMultiThreadPrivates->mnAdaptiveReschedules = 0;
+    if(mpMultiThreadPrivates->mAdaptiveRescheduling && nThreads > 1)
+    {
+        sampleInterval = mpMultiThreadPrivates->mSampleInterval;
+    }
+
     //Execute simulation
-    if(algorithm == OfflineSchedulingAlgorithm)
+    const bool offlineScheduled = (algorithm == OfflineSchedulingAlgorithm || algorithm == GraphPartitioningAlgorithm);
+    const HString schedulingStr = (algorithm == GraphPartitioningAlgorithm) ? "graph partitioning" : "offline scheduling";
+    // The wavefront stages are synchronized by spin/futex barriers, regardless of the selected barrier algorithm
+    if(offlineScheduled && (mpMultiThreadPrivates->mBarrierAlgorithm == SpinFutexBarrierAlgorithm || pWavefront))
+    {
+        addInfoMessage("Using "+schedulingStr+" algorithm with "+threadStr+" threads and spin/futex barriers.");
+
+        mpMultiThreadPrivates->mvTimePtrs.push_back(&mTime);
+        SpinFutexBarrier *pBarrier = new SpinFutexBarrier(nThreads, mpMultiThreadPrivates->mBarrierSpinCount);
+
+        std::thread *tt = new std::thread[nThreads];
+
+        tt[0] = std::thread(simSpinFutexMaster,
+                            this,
+                            std::ref(mpMultiThreadPrivates->mSplitSignalVector[0]),
+                            std::ref(mpMultiThreadPrivates->mSplitCVector[0]),
+                            std::ref(mpMultiThreadPrivates->mSplitQVector[0]),             //Create master thread
+                            std::ref(mpMultiThreadPrivates->mvTimePtrs),
+                            mTime,
+                            mTimestep,
+                            nSteps,
+                            pBarrier,
+                            sampleInterval,
+                            pWavefront ? &pWavefront->getThreadStages(0) : 0);
+        // The slaves are created afterwards, so the master cannot pass its first barrier before this is set
+        mpMultiThreadPrivates->mMasterThreadId = tt[0].get_id();
+
+        for (size_t t=1; t<nThreads; ++t)
+        {
+            tt[t] = std::thread(simSpinFutexSlave,
+                                this,
+                                std::ref(mpMultiThreadPrivates->mSplitSignalVector[t]),
+                                std::ref(mpMultiThreadPrivates->mSplitCVector[t]),
+                                std::ref(mpMultiThreadPrivates->mSplitQVector[t]),          //Create slave threads
+                                mTime,
+                                mTimestep,
+                                nSteps,
+                                pBarrier,
+                                sampleInterval,
+                                pWavefront ? &pWavefront->getThreadStages(t) : 0);
+        }
+
+        for (size_t i = 0; i<nThreads; ++i)                 //Wait for all tasks to finish
+        {
+            tt[i].join();
+        }
+
+        mpMultiThreadPrivates->mMasterThreadId = std::thread::id();
+        delete[] tt;
+        delete pBarrier;
+
+        if(sampleInterval > 0)
+        {
+            addInfoMessage("Adaptive rescheduling was performed "+to_hstring(mpMultiThreadPrivates->mnAdaptiveReschedules)+" times.");
+        }
+    }
+    else if(offlineScheduled)
     {
-        addInfoMessage("Using offline scheduling algorithm with "+threadStr+" threads.");
+        addInfoMessage("Using "+schedulingStr+" algorithm with "+threadStr+" threads.");
 
         mpMultiThreadPrivates->mvTimePtrs.push_back(&mTime);
         BarrierLock *pBarrierLock_S = new BarrierLock(nThreads);    //Create synchronization barriers
@@ -2502,7 +4053,10 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
                             pBarrierLock_S,
                             pBarrierLock_C,
                             pBarrierLock_Q,
-                            pBarrierLock_N);
+                            pBarrierLock_N,
+                            sampleInterval);
+        // The slaves are created afterwards, so the master cannot pass its first barrier before this is set
+        mpMultiThreadPrivates->mMasterThreadId = tt[0].get_id();
 
         for (size_t t=1; t<nThreads; ++t)
         {
@@ -2518,7 +4072,8 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
                                 pBarrierLock_S,
                                 pBarrierLock_C,
                                 pBarrierLock_Q,
-                                pBarrierLock_N);
+                                pBarrierLock_N,
+                                sampleInterval);
         }
 
         for (size_t i = 0; i<nThreads; ++i)                 //Wait for all tasks to finish
@@ -2526,11 +4081,17 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
             tt[i].join();
         }
 
+        mpMultiThreadPrivates->mMasterThreadId = std::thread::id();
         delete[] tt;
         delete(pBarrierLock_S);
         delete(pBarrierLock_C);
         delete(pBarrierLock_Q);
         delete(pBarrierLock_N);
+
+        if(sampleInterval > 0)
+        {
+            addInfoMessage("Adaptive rescheduling was performed "+to_hstring(mpMultiThreadPrivates->mnAdaptiveReschedules)+" times.");
+        }
     }
     else if(algorithm == TaskPoolAlgorithm)
     {
@@ -2628,16 +4189,16 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
 
         size_t maxSize = mComponentCptrs.size()+mComponentQptrs.size()+mComponentSignalptrs.size();
 
-        std::vector<ThreadSafeVector *> *pVectorsC = new std::vector<ThreadSafeVector *>();
+        std::vector<WorkStealingDeque *> *pVectorsC = new std::vector<WorkStealingDeque *>();
         for(size_t i=0; i<mpMultiThreadPrivates->mSplitCVector.size(); ++i)
         {
-            pVectorsC->push_back(new ThreadSafeVector(mpMultiThreadPrivates->mSplitCVector[i], maxSize));
+            pVectorsC->push_back(new WorkStealingDeque(mpMultiThreadPrivates->mSplitCVector[i], maxSize));
         }
 
-        std::vector<ThreadSafeVector *> *pVectorsQ = new std::vector<ThreadSafeVector *>();
+        std::vector<WorkStealingDeque *> *pVectorsQ = new std::vector<WorkStealingDeque *>();
         for(size_t i=0; i<mpMultiThreadPrivates->mSplitQVector.size(); ++i)
         {
-            pVectorsQ->push_back(new ThreadSafeVector(mpMultiThreadPrivates->mSplitQVector[i], maxSize));
+            pVectorsQ->push_back(new WorkStealingDeque(mpMultiThreadPrivates->mSplitQVector[i], maxSize));
         }
 
         std::thread *tt = new std::thread[nThreads];
@@ -2688,77 +4249,36 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
         delete(pBarrierLock_C);
         delete(pBarrierLock_Q);
         delete(pBarrierLock_N);
+        for(size_t i=0; i<pVectorsC->size(); ++i)
+        {
+            delete pVectorsC->at(i);
+        }
+        for(size_t i=0; i<pVectorsQ->size(); ++i)
+        {
+            delete pVectorsQ->at(i);
+        }
         delete(pVectorsC);
         delete(pVectorsQ);
     }
-    else if(algorithm == ParallelForAlgorithm)
+    else if(algorithm == ParallelForAlgorithm || algorithm == GroupedParallelForAlgorithm)
     {
-        addInfoMessage("Using parallel for-loop algorithm 1 with unlimited number of threads.");
-
-        // Round to nearest, we may not get exactly the stop time that we want
-        size_t numSimulationSteps = calcNumSimSteps(mTime, stopT); //Here mTime is the last time step since it is not updated yet
-
-        std::thread *tt;
-
-        //Simulate
-        for (size_t i=0; i<numSimulationSteps; ++i)
+        const bool grouped = (algorithm == GroupedParallelForAlgorithm);
+        if(grouped)
         {
-            if (mStopSimulation)
-            {
-                break;
-            }
-
-            mTime += mTimestep; //mTime is updated here before the simulation,
-            //mTime is the current time during the simulateOneTimestep
-
-            //Signal components
-            for (size_t s=0; s < mComponentSignalptrs.size(); ++s)
-            {
-                mComponentSignalptrs[s]->simulate(mTime);
-            }
-
-            //C components
-            tt = new std::thread[mComponentCptrs.size()];
-            for (size_t c=0; c < mComponentCptrs.size(); ++c)
-            {
-                tt[c] = std::thread(simOneComponentOneStep,
-                                    mComponentCptrs[c],
-                                    mTime);
-            }
-            for(size_t c=0; c<mComponentCptrs.size(); ++c)
-            {
-                tt[c].join();
-            }
-            delete[] tt;
-
-            //Q components
-            tt = new std::thread[mComponentQptrs.size()];
-            for (size_t q=0; q < mComponentQptrs.size(); ++q)
-            {
-                tt[q] = std::thread(simOneComponentOneStep,
-                                    mComponentQptrs[q],
-                                    mTime);
-            }
-            for(size_t q=0; q<mComponentQptrs.size(); ++q)
-            {
-                tt[q].join();
-            }
-            delete[] tt;
-
-            ++mTotalTakenSimulationSteps;
-
-            logTimeAndNodes(mTotalTakenSimulationSteps);
+            addInfoMessage("Using grouped parallel for-loop algorithm with "+threadStr+" threads.");
         }
-    }
-    else if(algorithm == GroupedParallelForAlgorithm)
-    {
-        addInfoMessage("Using grouped parallel for loop algorithm with unlimited number of threads.");
+        else
+        {
+            addInfoMessage("Using parallel for-loop algorithm with "+threadStr+" threads.");
+        }
+
+        // The worker threads are created once and kept alive for the entire simulation
+        mpMultiThreadPrivates->mpWorkerPool = new WorkerThreadPool(nThreads, mpMultiThreadPrivates->mBarrierSpinCount);
+        WorkerThreadPool *pPool = mpMultiThreadPrivates->mpWorkerPool;
 
         // Round to nearest, we may not get exactly the stop time that we want
         size_t numSimulationSteps = calcNumSimSteps(mTime, stopT); //Here mTime is the last time step since it is not updated yet
 
-        std::thread *tt;
-
         //Simulate
         for (size_t i=0; i<numSimulationSteps; ++i)
         {
@@ -2770,44 +4290,52 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
             mTime += mTimestep; //mTime is updated here before the simulation,
             //mTime is the current time during the simulateOneTimestep
 
-            //Signal components
-            for (size_t s=0; s < mComponentSignalptrs.size(); ++s)
-            {
-                mComponentSignalptrs[s]->simulate(mTime);
-            }
-
-            //C components
-            tt = new std::thread[mComponentCptrs.size()];
-            for (size_t c=0; c < mComponentCptrs.size(); ++c)
+            //Signal components, one wavefront stage at a time if enabled
+            if(pWavefront)
             {
-                tt[c] = std::thread(simOneStep,
-                                    &mpMultiThreadPrivates->mSplitCVector[c],
-                                    mTime);
+                for (size_t k=0; k < pWavefront->getNumStages(); ++k)
+                {
+                    std::vector<Component*> &rStage = pWavefront->getStageComponents(k);
+                    if(pWavefront->isParallelStage(k))
+                    {
+                        pPool->simulateComponents(rStage, mTime);
+                    }
+                    else
+                    {
+                        for (size_t s=0; s < rStage.size(); ++s)
+                        {
+                            rStage[s]->simulate(mTime);
+                        }
+                    }
+                }
             }
-            for(size_t c=0; c<mComponentCptrs.size(); ++c)
+            else
             {
-                tt[c].join();
+                for (size_t s=0; s < mComponentSignalptrs.size(); ++s)
+                {
+                    mComponentSignalptrs[s]->simulate(mTime);
+                }
             }
-            delete[] tt;
 
-            //Q components
-            tt = new std::thread[mComponentQptrs.size()];
-            for (size_t q=0; q < mComponentQptrs.size(); ++q)
+            //C and Q components
+            if(grouped)
             {
-                tt[q] = std::thread(simOneStep,
-                                    &mpMultiThreadPrivates->mSplitQVector[q],
-                                    mTime);
+                pPool->simulateComponentGroups(mpMultiThreadPrivates->mSplitCVector, mTime);
+                pPool->simulateComponentGroups(mpMultiThreadPrivates->mSplitQVector, mTime);
             }
-            for(size_t q=0; q<mComponentQptrs.size(); ++q)
+            else
             {
-                tt[q].join();
+                pPool->simulateComponents(mComponentCptrs, mTime);
+                pPool->simulateComponents(mComponentQptrs, mTime);
             }
-            delete[] tt;
 
             ++mTotalTakenSimulationSteps;
 
             logTimeAndNodes(mTotalTakenSimulationSteps);
         }
+
+        delete mpMultiThreadPrivates->mpWorkerPool;
+        mpMultiThreadPrivates->mpWorkerPool = 0;
     }
 }
 
@@ -3094,6 +4622,245 @@ void ComponentSystem::distributeNodePointers(vector< vector<Node*> > &rSplitNode
     }
 }
 
+//! @brief Distributes C- and Q-components and nodes over threads by partitioning the component/node graph
+//! @details Components are vertices and nodes are edges between the components connected to them. Each thread is first
+//! grown from the heaviest unassigned component by adding the components with most connections to the thread, as long as
+//! its C- and Q-loads stay within the allowed imbalance from the mean load. A refinement pass then moves components to the thread they share most nodes with,
+//! as long as the load stays within the allowed imbalance. Each node is finally owned by the thread with most of its components.
+//! The components must be sorted by measured time before calling this function.
+//! @param rSplitCVector Reference to vector with vectors of C-components (one vector per thread)
+//! @param rSplitQVector Reference to vector with vectors of Q-components (one vector per thread)
+//! @param rSplitNodeVector Reference to vector with vectors of nodes (one vector per thread)
+//! @param nThreads Number of simulation threads
+void ComponentSystem::distributeByGraphPartitioning(vector< vector<Component*> > &rSplitCVector, vector< vector<Component*> > &rSplitQVector,
+                                                    vector< vector<Node*> > &rSplitNodeVector, size_t nThreads)
+{
+    const double allowedImbalance = 0.1;
+    const size_t nRefinementPasses = 4;
+    const size_t unassigned = nThreads;
+
+    // Vertices, C-components first then Q-components, type 0 = C and 1 = Q
+    vector<Component*> vertices(mComponentCptrs);
+    vertices.insert(vertices.end(), mComponentQptrs.begin(), mComponentQptrs.end());
+    const size_t nVertices = vertices.size();
+    map<Component*, size_t> vertexIdx;
+    vector<size_t> type(nVertices);
+    vector<double> weight(nVertices);
+    double totalWeight[2] = {0,0};
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        vertexIdx[vertices[v]] = v;
+        type[v] = (v < mComponentCptrs.size()) ? 0 : 1;
+        weight[v] = vertices[v]->getMeasuredTime();
+        totalWeight[type[v]] += weight[v];
+    }
+    // Without measurements, balance the number of components instead
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        if(totalWeight[type[v]] <= 0)
+        {
+            weight[v] = 1;
+        }
+    }
+    totalWeight[0] = totalWeight[1] = 0;
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        totalWeight[type[v]] += weight[v];
+    }
+
+    // Edges, one per pair of components sharing a node (nodes in Hopsan usually connect exactly two components)
+    vector< vector<size_t> > nodeVertices(mSubNodePtrs.size());
+    vector< vector<size_t> > neighbours(nVertices);
+    for(size_t n=0; n<mSubNodePtrs.size(); ++n)
+    {
+        vector<Port*> &rPorts = mSubNodePtrs[n]->mConnectedPorts;
+        for(size_t p=0; p<rPorts.size(); ++p)
+        {
+            map<Component*, size_t>::iterator it = vertexIdx.find(rPorts[p]->getComponent());
+            if(it != vertexIdx.end() && !vectorContains(nodeVertices[n], it->second))
+            {
+                nodeVertices[n].push_back(it->second);
+            }
+        }
+        for(size_t i=0; i<nodeVertices[n].size(); ++i)
+        {
+            for(size_t j=0; j<nodeVertices[n].size(); ++j)
+            {
+                if(i != j)
+                {
+                    neighbours[nodeVertices[n][i]].push_back(nodeVertices[n][j]);
+                }
+            }
+        }
+    }
+
+    vector<size_t> part(nVertices, unassigned);
+    vector< vector<double> > load(2, vector<double>(nThreads, 0));
+    const double target[2] = {totalWeight[0]/nThreads, totalWeight[1]/nThreads};
+    const double maxLoad[2] = {target[0]*(1+allowedImbalance), target[1]*(1+allowedImbalance)};
+
+    // Grow one region per thread
+    vector<size_t> connections(nVertices);
+    for(size_t t=0; t<nThreads; ++t)
+    {
+        std::fill(connections.begin(), connections.end(), 0);
+        while(true)
+        {
+            // Prefer the component with most connections to this thread, then the heaviest (vertices are sorted by time)
+            size_t best = unassigned;
+            for(size_t v=0; v<nVertices; ++v)
+            {
+                const double newLoad = load[type[v]][t]+weight[v];
+                const bool fits = (newLoad <= maxLoad[type[v]]) || (load[type[v]][t] == 0);
+                if(part[v] == unassigned && fits && (best == unassigned || connections[v] > connections[best]))
+                {
+                    best = v;
+                }
+            }
+            if(best == unassigned)
+            {
+                break;
+            }
+            part[best] = t;
+            load[type[best]][t] += weight[best];
+            for(size_t i=0; i<neighbours[best].size(); ++i)
+            {
+                ++connections[neighbours[best][i]];
+            }
+        }
+    }
+
+    // Remaining components go to the least loaded thread
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        if(part[v] == unassigned)
+        {
+            part[v] = std::min_element(load[type[v]].begin(), load[type[v]].end()) - load[type[v]].begin();
+            load[type[v]][part[v]] += weight[v];
+        }
+    }
+
+    // Refinement, move components to the thread they share most nodes with if the load allows it
+    vector<size_t> connectionsPerThread(nThreads);
+    for(size_t pass=0; pass<nRefinementPasses; ++pass)
+    {
+        bool moved = false;
+        for(size_t v=0; v<nVertices; ++v)
+        {
+            std::fill(connectionsPerThread.begin(), connectionsPerThread.end(), 0);
+            for(size_t i=0; i<neighbours[v].size(); ++i)
+            {
+                ++connectionsPerThread[part[neighbours[v][i]]];
+            }
+            const size_t from = part[v];
+            const size_t ty = type[v];
+            size_t to = from;
+            for(size_t t=0; t<nThreads; ++t)
+            {
+                if(connectionsPerThread[t] > connectionsPerThread[to] && load[ty][t]+weight[v] <= std::max(maxLoad[ty], load[ty][from]))
+                {
+                    to = t;
+                }
+            }
+            if(to != from)
+            {
+                load[ty][from] -= weight[v];
+                load[ty][to] += weight[v];
+                part[v] = to;
+                moved = true;
+            }
+        }
+        if(!moved)
+        {
+            break;
+        }
+    }
+
+    rSplitCVector.resize(nThreads);
+    rSplitQVector.resize(nThreads);
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        if(type[v] == 0)
+        {
+            rSplitCVector[part[v]].push_back(vertices[v]);
+        }
+        else
+        {
+            rSplitQVector[part[v]].push_back(vertices[v]);
+        }
+    }
+
+    // Each node is owned by the thread with most of its components, unconnected nodes are distributed evenly
+    rSplitNodeVector.clear();
+    rSplitNodeVector.resize(nThreads);
+    size_t nSharedNodes=0;
+    size_t nextThread=0;
+    for(size_t n=0; n<mSubNodePtrs.size(); ++n)
+    {
+        std::fill(connectionsPerThread.begin(), connectionsPerThread.end(), 0);
+        size_t owner = nextThread;
+        for(size_t i=0; i<nodeVertices[n].size(); ++i)
+        {
+            const size_t t = part[nodeVertices[n][i]];
+            ++connectionsPerThread[t];
+            if(i == 0 || connectionsPerThread[t] > connectionsPerThread[owner])
+            {
+                owner = t;
+            }
+        }
+        if(!nodeVertices[n].empty() && connectionsPerThread[owner] < nodeVertices[n].size())
+        {
+            ++nSharedNodes;
+        }
+        if(nodeVertices[n].empty())
+        {
+            nextThread = (nextThread+1)%nThreads;
+        }
+        rSplitNodeVector[owner].push_back(mSubNodePtrs[n]);
+    }
+
+    for(size_t t=0; t<nThreads; ++t)
+    {
+        addDebugMessage("Graph partition "+to_hstring(t)+", C-time = "+to_hstring(load[0][t]*1000)+" ms, Q-time = "+
+                        to_hstring(load[1][t]*1000)+" ms, nodes = "+to_hstring(rSplitNodeVector[t].size()));
+        sortComponentVector(rSplitCVector[t]);
+        sortComponentVector(rSplitQVector[t]);
+    }
+    addDebugMessage("Graph partitioning: "+to_hstring(nSharedNodes)+" of "+to_hstring(mSubNodePtrs.size())+" nodes are shared between threads");
+}
+
+
+//! @brief Reallocates the data of each node from the thread that owns it
+//! @details The memory is allocated and first written by the owning thread, so that it is placed in that thread's allocation
+//! arena (and NUMA node). Each node is allocated separately, so this does not guarantee that nodes owned by different threads
+//! are on different cache lines. Use the node data arena for that, it aligns the data of each thread to cache line boundaries.
+//! @note This invalidates all node data pointers, the system must be initialized again before simulating
+//! @param rSplitNodeVector Reference to vector with vectors of nodes (one vector per thread)
+void ComponentSystem::relocateNodeData(const vector< vector<Node*> > &rSplitNodeVector)
+{
+    std::vector<std::thread> threads;
+    for(size_t t=0; t<rSplitNodeVector.size(); ++t)
+    {
+        const vector<Node*> *pNodes = &rSplitNodeVector[t];
+        threads.push_back(std::thread([pNodes]()
+        {
+            for(size_t n=0; n<pNodes->size(); ++n)
+            {
+                Node *pNode = (*pNodes)[n];
+                pNode->setDataStorage(0);
+                std::vector<double> data(pNode->mDataValues);
+                pNode->mDataValues.swap(data);
+                pNode->mpDataValues = pNode->mDataValues.data();
+            }
+        }));
+    }
+    for(size_t t=0; t<threads.size(); ++t)
+    {
+        threads[t].join();
+    }
+}
+
+
 void ComponentSystem::reschedule(size_t nThreads)
 {
     mpMultiThreadPrivates->mSplitCVector.clear();
@@ -3110,8 +4877,153 @@ void ComponentSystem::reschedule(size_t nThreads)
     distributeNodePointers(mpMultiThreadPrivates->mSplitNodeVector, nThreads);
 }
 
+
+//! @brief Redistributes C- and Q-components over the simulation threads if the measured load is too imbalanced
+//! @details Called by the master simulation thread at sampling steps while all other threads wait at a barrier.
+//! Only the per-thread vectors are refilled, the outer vectors must keep their size since the threads hold references to them.
+//! @warning While a multi-threaded simulation is running this must only be called from the master simulation thread, when all
+//! slave threads are waiting at a barrier. Otherwise it may only be called when no simulation is running.
+//! @param [in] time The current simulation time (used in the info message)
+//! @returns True if the components were redistributed
+bool ComponentSystem::rescheduleIfImbalanced(const double time)
+{
+    std::vector< std::vector<Component*> > &rSplitC = mpMultiThreadPrivates->mSplitCVector;
+    std::vector< std::vector<Component*> > &rSplitQ = mpMultiThreadPrivates->mSplitQVector;
+    const size_t nThreads = rSplitC.size();
+    if(nThreads < 2 || rSplitQ.size() != nThreads)
+    {
+        return false;
+    }
+    assert(mpMultiThreadPrivates->mMasterThreadId == std::thread::id() || mpMultiThreadPrivates->mMasterThreadId == std::this_thread::get_id());
+
+    const double imbalanceBefore = std::max(calcLoadImbalance(rSplitC), calcLoadImbalance(rSplitQ));
+    if(imbalanceBefore <= mpMultiThreadPrivates->mImbalanceThreshold)
+    {
+        return false;
+    }
+
+    sortComponentVectorsByMeasuredTime();
+    for(size_t t=0; t<nThreads; ++t)
+    {
+        rSplitC[t].clear();
+        rSplitQ[t].clear();
+    }
+    if(mpMultiThreadPrivates->mUseGraphPartitioning)
+    {
+        // Node vectors are only used for bookkeeping during simulation, so they can be replaced
+        distributeByGraphPartitioning(rSplitC, rSplitQ, mpMultiThreadPrivates->mSplitNodeVector, nThreads);
+    }
+    else
+    {
+        distributeByMeasuredTime(mComponentCptrs, rSplitC);
+        distributeByMeasuredTime(mComponentQptrs, rSplitQ);
+        for(size_t t=0; t<nThreads; ++t)
+        {
+            sortComponentVector(rSplitC[t]);
+            sortComponentVector(rSplitQ[t]);
+        }
+    }
+
+    const double imbalanceAfter = std::max(calcLoadImbalance(rSplitC), calcLoadImbalance(rSplitQ));
+    ++mpMultiThreadPrivates->mnAdaptiveReschedules;
+    addInfoMessage("Rescheduled components at time "+to_hstring(time)+", load imbalance "+to_hstring(imbalanceBefore*100)+
+                   " % -> "+to_hstring(imbalanceAfter*100)+" %");
+    return true;
+}
+
 #endif
 
+
+//! @brief Enable or disable online adaptive rescheduling in multi-threaded simulations with the offline scheduling algorithm
+//! @details When enabled, the simulation threads measure the time of their components every sampleInterval step. If the
+//! most loaded thread then exceeds the mean load by more than imbalanceThreshold, the components are redistributed.
+//! @param [in] enabled Enable or disable adaptive rescheduling
+//! @param [in] imbalanceThreshold Allowed relative imbalance (max/mean - 1) before rescheduling
+//! @param [in] sampleInterval Number of simulation steps between each load measurement
+void ComponentSystem::setAdaptiveRescheduling(const bool enabled, const double imbalanceThreshold, const size_t sampleInterval)
+{
+    mpMultiThreadPrivates->mAdaptiveRescheduling = enabled;
+    mpMultiThreadPrivates->mImbalanceThreshold = imbalanceThreshold;
+    mpMultiThreadPrivates->mSampleInterval = std::max(sampleInterval, size_t(1));
+}
+
+//! @brief Returns whether online adaptive rescheduling is enabled
+bool ComponentSystem::isAdaptiveReschedulingEnabled() const
+{
+    return mpMultiThreadPrivates->mAdaptiveRescheduling;
+}
+
+//! @brief Enable or disable wavefront scheduling of signal components in multi-threaded simulations
+//! @details When enabled, the signal components are simulated one dependency level at a time, and the components in each level are
+//! distributed over all simulation threads with one barrier between the levels. Levels with fewer than minLevelSize components are
+//! simulated serially by the master thread. Used by the offline scheduling, graph partitioning and parallel for-loop algorithms.
+//! @param [in] enabled Enable or disable wavefront scheduling
+//! @param [in] minLevelSize Minimum number of components in a level for it to be simulated in parallel
+void ComponentSystem::setSignalWavefront(const bool enabled, const size_t minLevelSize)
+{
+    mpMultiThreadPrivates->mSignalWavefront = enabled;
+    mpMultiThreadPrivates->mWavefrontMinLevelSize = minLevelSize;
+}
+
+//! @brief Returns whether wavefront scheduling of signal components is enabled
+bool ComponentSystem::isSignalWavefrontEnabled() const
+{
+    return mpMultiThreadPrivates->mSignalWavefront;
+}
+
+//! @brief Returns the minimum number of components in a signal level for it to be simulated in parallel
+size_t ComponentSystem::getSignalWavefrontMinLevelSize() const
+{
+    return mpMultiThreadPrivates->mWavefrontMinLevelSize;
+}
+
+//! @brief Returns how many times the components were rescheduled during the last multi-threaded simulation
+size_t ComponentSystem::getNumAdaptiveReschedules() const
+{
+    return mpMultiThreadPrivates->mnAdaptiveReschedules;
+}
+
+//! @brief Returns the C- or Q-type components that are scheduled on a simulation thread by the offline scheduling algorithms
+//! @param [in] thread Index of the simulation thread
+//! @param [in] type CType or QType
+//! @returns The components of the thread, or an empty vector if no such thread exists
+std::vector<Component*> ComponentSystem::getThreadComponents(const size_t thread, const CQSEnumT type) const
+{
+    if(type != CType && type != QType)
+    {
+        return std::vector<Component*>();
+    }
+    const std::vector< std::vector<Component*> > &rSplitVector = (type == CType) ? mpMultiThreadPrivates->mSplitCVector : mpMultiThreadPrivates->mSplitQVector;
+    if(thread >= rSplitVector.size())
+    {
+        return std::vector<Component*>();
+    }
+    return rSplitVector[thread];
+}
+
+
+//! @brief Select which barrier type the offline scheduling algorithm shall use to synchronize threads
+//! @param [in] algorithm BusyWaitBarrierAlgorithm (master driven lock flags) or SpinFutexBarrierAlgorithm (sense-reversing, sleeps after spinning)
+//! @param [in] spinCount Number of spin iterations before a waiting thread goes to sleep (only used by SpinFutexBarrierAlgorithm)
+void ComponentSystem::setBarrierAlgorithm(const BarrierAlgorithmT algorithm, const size_t spinCount)
+{
+    mpMultiThreadPrivates->mBarrierAlgorithm = algorithm;
+    mpMultiThreadPrivates->mBarrierSpinCount = spinCount;
+}
+
+//! @brief Returns the barrier type used to synchronize threads in multi-threaded simulations
+BarrierAlgorithmT ComponentSystem::getBarrierAlgorithm() const
+{
+    return mpMultiThreadPrivates->mBarrierAlgorithm;
+}
+
+//! @brief Returns the number of spin iterations before a waiting thread goes to sleep in a spin/futex barrier
+size_t ComponentSystem::getBarrierSpinCount() const
+{
+    return mpMultiThreadPrivates->mBarrierSpinCount;
+}
+
+
 //! @brief Helper function that simulates all components and measure their average time requirements.
 //! @param steps How many steps to simulate
 bool ComponentSystem::simulateAndMeasureTime(const size_t nSteps)
@@ -3229,44 +5141,14 @@ double ComponentSystem::getTotalMeasuredTime()
 
 
 //! @brief Helper function that sorts C- and Q- component vectors by simulation time for each component.
-//! @todo This function uses bubblesort. Maybe change to something faster.
+//! @details Stable sort, so that components with equal time keep their relative order between reschedules
 void ComponentSystem::sortComponentVectorsByMeasuredTime()
 {
 #if (__cplusplus >= 201103L)
     //Sort the components from longest to shortest time requirement
-    size_t i, j;
-    bool flag = true;
-    Component *tempC;
-    for(i = 1; (i < mComponentCptrs.size()) && flag; ++i)
-    {
-        flag = false;
-        for (j=0; j < (mComponentCptrs.size()-1); ++j)
-        {
-            if (mComponentCptrs[j+1]->getMeasuredTime() > mComponentCptrs[j]->getMeasuredTime())
-            {
-                tempC = mComponentCptrs[j];             //Swap elements
-                mComponentCptrs[j] = mComponentCptrs[j+1];
-                mComponentCptrs[j+1] = tempC;
-                flag = true;               //Indicates that a swap occurred
-            }
-        }
-    }
-    flag = true;
-    Component *tempQ;
-    for(i = 1; (i < mComponentQptrs.size()) && flag; ++i)
-    {
-        flag = false;
-        for (j=0; j < (mComponentQptrs.size()-1); ++j)
-        {
-            if (mComponentQptrs[j+1]->getMeasuredTime() > mComponentQptrs[j]->getMeasuredTime())
-            {
-                tempQ = mComponentQptrs[j];             //Swap elements
-                mComponentQptrs[j] = mComponentQptrs[j+1];
-                mComponentQptrs[j+1] = tempQ;
-                flag = true;               //Indicates that a swap occurred
-            }
-        }
-    }
+    auto longerTime = [](const Component *pA, const Component *pB) { return pA->getMeasuredTime() > pB->getMeasuredTime(); };
+    std::stable_sort(mComponentCptrs.begin(), mComponentCptrs.end(), longerTime);
+    std::stable_sort(mComponentQptrs.begin(), mComponentQptrs.end(), longerTime);
 #else
     this->addErrorMessage("Cannot sort! Measuring simulation time requires C++11 support.");
 #endif
@@ -3306,6 +5188,26 @@ void ComponentSystem::distributeNodePointers(vector< vector<Node*> > &/*rSplitNo
     addWarningMessage("Called distributeNodePointers(), but multi-threading is not avaialble.");
 }
 
+
+void ComponentSystem::distributeByGraphPartitioning(vector< vector<Component*> > &/*rSplitCVector*/, vector< vector<Component*> > &/*rSplitQVector*/,
+                                                    vector< vector<Node*> > &/*rSplitNodeVector*/, size_t /*nThreads*/)
+{
+    addWarningMessage("Called distributeByGraphPartitioning(), but multi-threading is not avaialble.");
+}
+
+
+void ComponentSystem::relocateNodeData(const vector< vector<Node*> > &/*rSplitNodeVector*/)
+{
+    addWarningMessage("Called relocateNodeData(), but multi-threading is not avaialble.");
+}
+
+
+bool ComponentSystem::rescheduleIfImbalanced(const double /*time*/)
+{
+    addWarningMessage("Called rescheduleIfImbalanced(), but multi-threading is not avaialble.");
+    return false;
+}
+
 #endif
 
 
@@ -3393,6 +5295,12 @@ void ComponentSystem::simulate(const double stopT)
 //! @brief Finalizes a system component and all its contained components after a simulation.
 void ComponentSystem::finalize()
 {
+    // Make the node data vectors up to date
+    for (size_t n=0; n<mNodeDataArenaNodes.size(); ++n)
+    {
+        mNodeDataArenaNodes[n]->copyDataValuesToDataVector();
+    }
+
     //Finalize
     //Signal components
     for (size_t s=0; s < mComponentSignalptrs.size(); ++s)
@@ -3430,6 +5338,27 @@ void ComponentSystem::finalize()
         mComponentSignalptrs.push_back(mDisabledSptrs.at(i));
     }
     mDisabledSptrs.clear();
+
+    // Remove the extra log samples that were reserved for log triggers but never used
+    const size_t nUsedLogSlots = mnLogSlots + mnTriggeredLogSamples;
+    if (!mLogSinkIsOpen && (mTimeStorage.size() > nUsedLogSlots))
+    {
+        mTimeStorage.resize(nUsedLogSlots);
+        for (size_t n=0; n<mLoggedSubNodePtrs.size(); ++n)
+        {
+            mLoggedSubNodePtrs[n]->truncateLogData(nUsedLogSlots);
+        }
+    }
+
+    // Write the remaining samples to the log sink
+    if (mpLogSink && mLogSinkIsOpen)
+    {
+        mLogSinkIsOpen = false;
+        if (!mpLogSink->close())
+        {
+            addErrorMessage("Failed to write log data to log sink: "+mpLogSink->getErrorMessage());
+        }
+    }
 }
 
 ////! @brief This function will set the number of log data slots for preallocation and logDt based on a skip factor to the sample time
@@ -3488,12 +5417,14 @@ void ComponentSystem::disableLog()
 
     // If log disabled, then free memory if something has been previously allocated
     mTimeStorage.clear();
+    mLoggedSubNodePtrs.clear();
     mLogTheseTimeSteps.clear();
 
     mLogTimeDt = -1.0;
     //mLastLogTime = 0.0; //Initial value should not matter, will be overwritten when selecting log amount
     mnLogSlots = 0;
     mLogCtr = 0;
+    mLogStepCtr = 0;
 }
 
 vector<double> *ComponentSystem::getLogTimeVector()
@@ -104,3 +104,29 @@ double DoubleIntegratorWithDamping::valueSecond()
 {
     return mDelayY;
 }
+
+
+//! Save the integrator state (including the undo backup) to a simulation state
+void DoubleIntegratorWithDamping::saveState(SimulationStateWriter &rWriter) const
+{
+    const double values[6] = {mDelayU, mDelayY, mDelaySY, mDelayUbackup, mDelayYbackup, mDelaySYbackup};
+    rWriter.write(values, 6);
+}
+
+
+//! Restore the integrator state from a simulation state, returns false if the state could not be read
+bool DoubleIntegratorWithDamping::restoreState(SimulationStateReader &rReader)
+{
+    double values[6];
+    if (!rReader.read(values, 6))
+    {
+        return false;
+    }
+    mDelayU = values[0];
+    mDelayY = values[1];
+    mDelaySY = values[2];
+    mDelayUbackup = values[3];
+    mDelayYbackup = values[4];
+    mDelaySYbackup = values[5];
+    return true;
+}
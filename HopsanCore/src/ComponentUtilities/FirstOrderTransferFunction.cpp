@@ -221,6 +221,29 @@ bool FirstOrderTransferFunction::isSaturated() const
     return mIsSaturated;
 }
 
+//! @brief Save the transfer function state (current and delayed values and backups) to a simulation state
+//! @note The coefficients are not saved, they are set up by initialize()
+void FirstOrderTransferFunction::saveState(SimulationStateWriter &rWriter) const
+{
+    rWriter.write(mValue);
+    rWriter.write(mDelayedU);
+    rWriter.write(mDelayedY);
+    rWriter.write(mIsSaturated);
+    mBackupU.saveState(rWriter);
+    mBackupY.saveState(rWriter);
+}
+
+//! @brief Restore the transfer function state from a simulation state
+//! @returns False if the state could not be read
+bool FirstOrderTransferFunction::restoreState(SimulationStateReader &rReader)
+{
+    rReader.read(mValue);
+    rReader.read(mDelayedU);
+    rReader.read(mDelayedY);
+    rReader.read(mIsSaturated);
+    return mBackupU.restoreState(rReader) && mBackupY.restoreState(rReader);
+}
+
 
 
 
@@ -126,3 +126,18 @@ double IntegratorLimited::value()
 {
     return mDelayY;
 }
+
+//! @brief Save the integrator state to a simulation state
+void IntegratorLimited::saveState(SimulationStateWriter &rWriter) const
+{
+    rWriter.write(mDelayU);
+    rWriter.write(mDelayY);
+}
+
+//! @brief Restore the integrator state from a simulation state
+//! @returns False if the state could not be read
+bool IntegratorLimited::restoreState(SimulationStateReader &rReader)
+{
+    rReader.read(mDelayU);
+    return rReader.read(mDelayY);
+}
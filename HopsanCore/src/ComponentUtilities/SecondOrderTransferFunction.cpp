@@ -244,6 +244,33 @@ bool SecondOrderTransferFunction::isSaturated() const
     return mIsSaturated;
 }
 
+//! @brief Save the transfer function state (current and delayed values and backups) to a simulation state
+//! @note The coefficients are not saved, they are set up by initialize()
+void SecondOrderTransferFunction::saveState(SimulationStateWriter &rWriter) const
+{
+    rWriter.write(mValue);
+    rWriter.write(mDelayedU);
+    rWriter.write(mDelayed2U);
+    rWriter.write(mDelayedY);
+    rWriter.write(mDelayed2Y);
+    rWriter.write(mIsSaturated);
+    mBackupU.saveState(rWriter);
+    mBackupY.saveState(rWriter);
+}
+
+//! @brief Restore the transfer function state from a simulation state
+//! @returns False if the state could not be read
+bool SecondOrderTransferFunction::restoreState(SimulationStateReader &rReader)
+{
+    rReader.read(mValue);
+    rReader.read(mDelayedU);
+    rReader.read(mDelayed2U);
+    rReader.read(mDelayedY);
+    rReader.read(mDelayed2Y);
+    rReader.read(mIsSaturated);
+    return mBackupU.restoreState(rReader) && mBackupY.restoreState(rReader);
+}
+
 
 
 
@@ -0,0 +1,621 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   CompiledNumHopScript.cpp
+//! @date   2026-10-18
+//!
+//! @brief Contains a compiled form of numhop scripts, for fast repeated evaluation
+//!
+//$Id$
+
+#include "CoreUtilities/CompiledNumHopScript.h"
+#include <cctype>
+#include <cmath>
+
+using namespace hopsan;
+
+namespace {
+
+inline bool isDigit(const char c)
+{
+    return isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+inline bool isNameStart(const char c)
+{
+    return (isalpha(static_cast<unsigned char>(c)) != 0) || (c == '_');
+}
+
+inline bool isNameChar(const char c)
+{
+    return (isalnum(static_cast<unsigned char>(c)) != 0) || (c == '_') || (c == '.');
+}
+
+}
+
+CompiledNumHopScript::CompiledNumHopScript()
+{
+    mpResolver = 0;
+    mPos = 0;
+    mpResult = 0;
+}
+
+//! @brief Compile a script
+//! @details Nothing is evaluated while compiling, but the resolver is asked for data pointers and constant values. The value of
+//! the script is the value of the last expression, as when the script is interpreted.
+//! @param[in] rExpressions The expressions (rows) of the script, without comments
+//! @param[in] rResolver Resolves the names used in the script
+//! @param[out] rError Describes why the script could not be compiled
+//! @returns True if the script was compiled, false if it is not valid or uses something that is not supported
+bool CompiledNumHopScript::compile(const std::vector<HString> &rExpressions, Resolver &rResolver, HString &rError)
+{
+    clear();
+    mpResolver = &rResolver;
+
+    Operand result;
+    bool success = true;
+    for (size_t e=0; e<rExpressions.size() && success; ++e)
+    {
+        mExpression = rExpressions[e];
+        mPos = 0;
+        skipSpace();
+        if (mPos < mExpression.size())
+        {
+            success = compileExpression(rExpressions[e], result);
+        }
+    }
+    if (success && (result.kind == NoOperand))
+    {
+        success = fail("The script is empty");
+    }
+
+    if (!success)
+    {
+        rError = mError;
+        clear();
+        return false;
+    }
+
+    // All storage has been allocated, now the operands can be resolved to pointers
+    mInstructions.resize(mCompileInstructions.size());
+    for (size_t i=0; i<mCompileInstructions.size(); ++i)
+    {
+        const CompileInstruction &rCompileInstruction = mCompileInstructions[i];
+        mInstructions[i].op = rCompileInstruction.op;
+        mInstructions[i].pDst = storagePtr(rCompileInstruction.dst);
+        mInstructions[i].pA = storagePtr(rCompileInstruction.a);
+        mInstructions[i].pB = storagePtr(rCompileInstruction.b);
+    }
+    mpResult = storagePtr(result);
+
+    mpResolver = 0;
+    mExpression.clear();
+    mCompileInstructions.clear();
+    mVariableNames.clear();
+    mDataPtrNames.clear();
+    return true;
+}
+
+//! @brief Remove the compiled script
+void CompiledNumHopScript::clear()
+{
+    mpResolver = 0;
+    mExpression.clear();
+    mPos = 0;
+    mError.clear();
+    mCompileInstructions.clear();
+    mVariableNames.clear();
+    mDataPtrs.clear();
+    mDataPtrNames.clear();
+    mInstructions.clear();
+    mConstants.clear();
+    mRegisters.clear();
+    mVariables.clear();
+    mpResult = 0;
+}
+
+//! @brief Check if a script has been compiled
+bool CompiledNumHopScript::isCompiled() const
+{
+    return (mpResult != 0);
+}
+
+//! @brief Returns the number of instructions in the compiled script, parts with only constants are computed when compiling
+size_t CompiledNumHopScript::getNumInstructions() const
+{
+    return mInstructions.size();
+}
+
+//! @brief Evaluate the compiled script
+//! @returns The value of the last expression
+//! @warning The script must have been compiled
+double CompiledNumHopScript::evaluate()
+{
+    const Instruction *pInstruction = mInstructions.data();
+    const Instruction *pEnd = pInstruction + mInstructions.size();
+    for ( ; pInstruction!=pEnd; ++pInstruction)
+    {
+        switch (pInstruction->op)
+        {
+        case Copy :
+            *pInstruction->pDst = *pInstruction->pA;
+            break;
+        case Add :
+            *pInstruction->pDst = *pInstruction->pA + *pInstruction->pB;
+            break;
+        case Subtract :
+            *pInstruction->pDst = *pInstruction->pA - *pInstruction->pB;
+            break;
+        case Multiply :
+            *pInstruction->pDst = *pInstruction->pA * *pInstruction->pB;
+            break;
+        case Divide :
+            *pInstruction->pDst = *pInstruction->pA / *pInstruction->pB;
+            break;
+        case Power :
+            *pInstruction->pDst = std::pow(*pInstruction->pA, *pInstruction->pB);
+            break;
+        case Negate :
+            *pInstruction->pDst = -*pInstruction->pA;
+            break;
+        }
+    }
+    return *mpResult;
+}
+
+//! @brief Compile one expression, either "name = value" or just a value
+bool CompiledNumHopScript::compileExpression(const HString &rExpression, Operand &rResult)
+{
+    const size_t eqPos = rExpression.find('=');
+    if (eqPos == HString::npos)
+    {
+        mExpression = rExpression;
+        mPos = 0;
+        if (!parseSum(rResult))
+        {
+            return false;
+        }
+        skipSpace();
+        if (mPos < mExpression.size())
+        {
+            return fail(HString("Unexpected character: ")+mExpression[mPos]+" in: "+rExpression);
+        }
+        return true;
+    }
+
+    if (rExpression.find('=', eqPos+1) != HString::npos)
+    {
+        return fail("Only one assignment per expression is supported: "+rExpression);
+    }
+
+    // The target name
+    HString name;
+    mExpression = rExpression.substr(0, eqPos);
+    mPos = 0;
+    skipSpace();
+    if (!parseName(name))
+    {
+        return fail("Only assignment to a name is supported: "+rExpression);
+    }
+    skipSpace();
+    if (mPos < mExpression.size())
+    {
+        return fail("Only assignment to a name is supported: "+rExpression);
+    }
+
+    // The value, it must be parsed before the target is created, a new variable can not be used in its own assignment
+    Operand value;
+    mExpression = rExpression.substr(eqPos+1);
+    mPos = 0;
+    if (!parseSum(value))
+    {
+        return false;
+    }
+    skipSpace();
+    if (mPos < mExpression.size())
+    {
+        return fail(HString("Unexpected character: ")+mExpression[mPos]+" in: "+rExpression);
+    }
+
+    Operand target;
+    if (!writeName(name, target))
+    {
+        return false;
+    }
+
+    // Write the result of the last instruction directly to the target if possible, otherwise copy it
+    if ((value.kind == RegisterOperand) && !mCompileInstructions.empty() &&
+        (mCompileInstructions.back().dst.kind == RegisterOperand) && (mCompileInstructions.back().dst.index == value.index))
+    {
+        mCompileInstructions.back().dst = target;
+    }
+    else
+    {
+        CompileInstruction copy;
+        copy.op = Copy;
+        copy.dst = target;
+        copy.a = value;
+        mCompileInstructions.push_back(copy);
+    }
+    rResult = target;
+    return true;
+}
+
+//! @brief Parse terms separated by + and -
+bool CompiledNumHopScript::parseSum(Operand &rResult)
+{
+    if (!parseProduct(rResult))
+    {
+        return false;
+    }
+    skipSpace();
+    while ((mPos < mExpression.size()) && ((mExpression[mPos] == '+') || (mExpression[mPos] == '-')))
+    {
+        const OperatorT op = (mExpression[mPos] == '+') ? Add : Subtract;
+        ++mPos;
+        Operand rhs;
+        if (!parseProduct(rhs))
+        {
+            return false;
+        }
+        rResult = emit(op, rResult, rhs);
+        skipSpace();
+    }
+    return true;
+}
+
+//! @brief Parse factors separated by * and /
+bool CompiledNumHopScript::parseProduct(Operand &rResult)
+{
+    if (!parseSigned(rResult))
+    {
+        return false;
+    }
+    skipSpace();
+    while ((mPos < mExpression.size()) && ((mExpression[mPos] == '*') || (mExpression[mPos] == '/')))
+    {
+        const OperatorT op = (mExpression[mPos] == '*') ? Multiply : Divide;
+        ++mPos;
+        Operand rhs;
+        if (!parseSigned(rhs))
+        {
+            return false;
+        }
+        rResult = emit(op, rResult, rhs);
+        skipSpace();
+    }
+    return true;
+}
+
+//! @brief Parse a value with any number of leading signs
+bool CompiledNumHopScript::parseSigned(Operand &rResult)
+{
+    bool hasSign = false;
+    bool negate = false;
+    skipSpace();
+    while ((mPos < mExpression.size()) && ((mExpression[mPos] == '+') || (mExpression[mPos] == '-')))
+    {
+        negate = (negate != (mExpression[mPos] == '-'));
+        hasSign = true;
+        ++mPos;
+        skipSpace();
+    }
+
+    bool hadPower;
+    if (!parsePower(rResult, hadPower))
+    {
+        return false;
+    }
+    if (hasSign && hadPower)
+    {
+        return fail("A sign before a power is ambiguous, use parentheses: "+mExpression);
+    }
+    if (negate)
+    {
+        rResult = emit(Negate, rResult, Operand());
+    }
+    return true;
+}
+
+//! @brief Parse a value, possibly raised to a power
+bool CompiledNumHopScript::parsePower(Operand &rResult, bool &rHadPower)
+{
+    rHadPower = false;
+    if (!parsePrimary(rResult))
+    {
+        return false;
+    }
+    skipSpace();
+    if ((mPos < mExpression.size()) && (mExpression[mPos] == '^'))
+    {
+        ++mPos;
+        // The exponent may have a sign, but can not be a power itself
+        bool negate = false;
+        skipSpace();
+        while ((mPos < mExpression.size()) && ((mExpression[mPos] == '+') || (mExpression[mPos] == '-')))
+        {
+            negate = (negate != (mExpression[mPos] == '-'));
+            ++mPos;
+            skipSpace();
+        }
+        Operand exponent;
+        if (!parsePrimary(exponent))
+        {
+            return false;
+        }
+        skipSpace();
+        if ((mPos < mExpression.size()) && (mExpression[mPos] == '^'))
+        {
+            return fail("Chained powers are ambiguous, use parentheses: "+mExpression);
+        }
+        if (negate)
+        {
+            exponent = emit(Negate, exponent, Operand());
+        }
+        rResult = emit(Power, rResult, exponent);
+        rHadPower = true;
+    }
+    return true;
+}
+
+//! @brief Parse a number, a name or an expression within parentheses
+bool CompiledNumHopScript::parsePrimary(Operand &rResult)
+{
+    skipSpace();
+    if (mPos >= mExpression.size())
+    {
+        return fail("Unexpected end of expression: "+mExpression);
+    }
+
+    const char c = mExpression[mPos];
+    if (c == '(')
+    {
+        ++mPos;
+        if (!parseSum(rResult))
+        {
+            return false;
+        }
+        skipSpace();
+        if ((mPos >= mExpression.size()) || (mExpression[mPos] != ')'))
+        {
+            return fail("Missing ) in: "+mExpression);
+        }
+        ++mPos;
+        return true;
+    }
+    else if (isDigit(c) || (c == '.'))
+    {
+        const size_t start = mPos;
+        while ((mPos < mExpression.size()) && (isDigit(mExpression[mPos]) || (mExpression[mPos] == '.')))
+        {
+            ++mPos;
+        }
+        if ((mPos < mExpression.size()) && ((mExpression[mPos] == 'e') || (mExpression[mPos] == 'E')))
+        {
+            ++mPos;
+            if ((mPos < mExpression.size()) && ((mExpression[mPos] == '+') || (mExpression[mPos] == '-')))
+            {
+                ++mPos;
+            }
+            while ((mPos < mExpression.size()) && isDigit(mExpression[mPos]))
+            {
+                ++mPos;
+            }
+        }
+        bool isOK;
+        const double value = mExpression.substr(start, mPos-start).toDouble(&isOK);
+        if (!isOK)
+        {
+            return fail("Invalid number: "+mExpression.substr(start, mPos-start));
+        }
+        rResult = addConstant(value);
+        return true;
+    }
+    else if (isNameStart(c))
+    {
+        HString name;
+        parseName(name);
+        return readName(name, rResult);
+    }
+    return fail(HString("Unexpected character: ")+c+" in: "+mExpression);
+}
+
+//! @brief Parse a name, letters, digits, underscore and dot, beginning with a letter or underscore
+bool CompiledNumHopScript::parseName(HString &rName)
+{
+    const size_t start = mPos;
+    if ((mPos < mExpression.size()) && isNameStart(mExpression[mPos]))
+    {
+        ++mPos;
+        while ((mPos < mExpression.size()) && isNameChar(mExpression[mPos]))
+        {
+            ++mPos;
+        }
+    }
+    rName = mExpression.substr(start, mPos-start);
+    return !rName.empty();
+}
+
+//! @brief Resolve a name that is read
+bool CompiledNumHopScript::readName(const HString &rName, Operand &rResult)
+{
+    std::map<HString, size_t>::const_iterator it = mVariableNames.find(rName);
+    if (it != mVariableNames.end())
+    {
+        rResult = Operand(VariableOperand, it->second);
+        return true;
+    }
+
+    if (findDataPtr(rName, rResult))
+    {
+        return true;
+    }
+
+    double value;
+    if (mpResolver->getConstantValue(rName, value))
+    {
+        rResult = addConstant(value);
+        return true;
+    }
+    return fail("Unknown name: "+rName);
+}
+
+//! @brief Resolve a name that is assigned, a new internal variable is created if the name is not a data pointer
+bool CompiledNumHopScript::writeName(const HString &rName, Operand &rTarget)
+{
+    std::map<HString, size_t>::const_iterator it = mVariableNames.find(rName);
+    if (it != mVariableNames.end())
+    {
+        rTarget = Operand(VariableOperand, it->second);
+        return true;
+    }
+
+    double value;
+    if (findDataPtr(rName, rTarget))
+    {
+        return true;
+    }
+    else if (mpResolver->getConstantValue(rName, value))
+    {
+        return fail("Assignment to a parameter is not supported: "+rName);
+    }
+    else if (rName.containes('.'))
+    {
+        return fail("Internal variable names can not contain a dot: "+rName);
+    }
+
+    mVariableNames.insert(std::pair<HString, size_t>(rName, mVariables.size()));
+    rTarget = Operand(VariableOperand, mVariables.size());
+    mVariables.push_back(0.0);
+    return true;
+}
+
+//! @brief Find the data pointer for a name, the resolver is only asked the first time
+bool CompiledNumHopScript::findDataPtr(const HString &rName, Operand &rResult)
+{
+    std::map<HString, size_t>::const_iterator it = mDataPtrNames.find(rName);
+    if (it != mDataPtrNames.end())
+    {
+        rResult = Operand(DataPtrOperand, it->second);
+        return true;
+    }
+
+    double *pData = mpResolver->getDataPtr(rName);
+    if (pData)
+    {
+        mDataPtrNames.insert(std::pair<HString, size_t>(rName, mDataPtrs.size()));
+        rResult = Operand(DataPtrOperand, mDataPtrs.size());
+        mDataPtrs.push_back(pData);
+        return true;
+    }
+    return false;
+}
+
+//! @brief Add an instruction, or compute the value directly if all operands are constants
+//! @returns The operand that holds the result
+CompiledNumHopScript::Operand CompiledNumHopScript::emit(const OperatorT op, const Operand &rA, const Operand &rB)
+{
+    if ((rA.kind == ConstantOperand) && ((rB.kind == ConstantOperand) || (rB.kind == NoOperand)))
+    {
+        return addConstant(apply(op, constantValue(rA), constantValue(rB)));
+    }
+
+    CompileInstruction instruction;
+    instruction.op = op;
+    instruction.dst = Operand(RegisterOperand, mRegisters.size());
+    instruction.a = rA;
+    instruction.b = rB;
+    mRegisters.push_back(0.0);
+    mCompileInstructions.push_back(instruction);
+    return instruction.dst;
+}
+
+CompiledNumHopScript::Operand CompiledNumHopScript::addConstant(const double value)
+{
+    mConstants.push_back(value);
+    return Operand(ConstantOperand, mConstants.size()-1);
+}
+
+double CompiledNumHopScript::constantValue(const Operand &rOperand) const
+{
+    return (rOperand.kind == ConstantOperand) ? mConstants[rOperand.index] : 0.0;
+}
+
+void CompiledNumHopScript::skipSpace()
+{
+    while ((mPos < mExpression.size()) && isspace(static_cast<unsigned char>(mExpression[mPos])))
+    {
+        ++mPos;
+    }
+}
+
+bool CompiledNumHopScript::fail(const HString &rError)
+{
+    if (mError.empty())
+    {
+        mError = rError;
+    }
+    return false;
+}
+
+double CompiledNumHopScript::apply(const OperatorT op, const double a, const double b)
+{
+    switch (op)
+    {
+    case Copy :
+        return a;
+    case Add :
+        return a + b;
+    case Subtract :
+        return a - b;
+    case Multiply :
+        return a * b;
+    case Divide :
+        return a / b;
+    case Power :
+        return std::pow(a, b);
+    case Negate :
+        return -a;
+    }
+    return 0.0;
+}
+
+double *CompiledNumHopScript::storagePtr(const Operand &rOperand)
+{
+    switch (rOperand.kind)
+    {
+    case ConstantOperand :
+        return &mConstants[rOperand.index];
+    case RegisterOperand :
+        return &mRegisters[rOperand.index];
+    case VariableOperand :
+        return &mVariables[rOperand.index];
+    case DataPtrOperand :
+        return mDataPtrs[rOperand.index];
+    case NoOperand :
+        return 0;
+    }
+    return 0;
+}
@@ -611,21 +611,35 @@ void loadComponent(rapidxml::xml_node<> *pComponentNode, ComponentSystem* pSyste
             }
         }
 
-        // Load modifyable signal quantities
+        // Load modifyable signal quantities and log masks
         rapidxml::xml_node<> *pXmlPorts = pComponentNode->first_node("ports");
         if (pXmlPorts)
         {
             rapidxml::xml_node<> *pXmlPort = pXmlPorts->first_node("port");
             while (pXmlPort != 0)
             {
+                HString portName = readStringAttribute(pXmlPort, "name", "").c_str();
+                Port *pPort = pComp->getPort(portName);
                 HString quantity = readStringAttribute(pXmlPort, "signalquantity", "").c_str();
-                if (!quantity.empty())
+                if (!quantity.empty() && pPort)
                 {
-                    HString portName = readStringAttribute(pXmlPort, "name", "").c_str();
-                    Port *pPort = pComp->getPort(portName);
-                    if (pPort)
+                    pPort->setSignalNodeQuantityOrUnit(quantity);
+                }
+                if (pPort)
+                {
+                    pPort->setEnableLogging(readBoolAttribute(pXmlPort, "logging", pPort->isLoggingEnabled()));
+                    HVector<HString> nologVars = HString(readStringAttribute(pXmlPort, "nologvariables", "").c_str()).split(',');
+                    for (size_t i=0; i<nologVars.size(); ++i)
                     {
-                        pPort->setSignalNodeQuantityOrUnit(quantity);
+                        const int dataId = pPort->getNodeDataIdFromName(nologVars[i]);
+                        if (dataId >= 0)
+                        {
+                            pPort->setEnableVariableLogging(size_t(dataId), false);
+                        }
+                        else if (!nologVars[i].empty())
+                        {
+                            pComp->addWarningMessage("Failed to disable logging of unknown variable: "+portName+"#"+nologVars[i]);
+                        }
                     }
                 }
                 pXmlPort = pXmlPort->next_sibling("port");
@@ -0,0 +1,206 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   LogDataStorage.cpp
+//! @date   2026-10-18
+//!
+//! @brief Contains the columnar, chunked log data storage used by nodes
+//!
+//$Id$
+
+#include "CoreUtilities/LogDataStorage.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace hopsan;
+
+const size_t LogDataStorage::ChunkSize;
+const size_t LogDataStorage::NotStored;
+
+LogDataStorage::LogDataStorage()
+{
+    mNumSamples = 0;
+    mNumVariables = 0;
+}
+
+//! @brief Allocate storage for a given number of samples and variables
+//! @details Existing chunks are kept if the layout is unchanged, so repeated simulations do not reallocate
+//! @param[in] nSamples The number of samples (log slots)
+//! @param[in] nVariables The number of variables per sample
+//! @param[in] rLogMask Which variables to store, an empty mask means all variables. Variables beyond the mask size are stored.
+void LogDataStorage::resize(const size_t nSamples, const size_t nVariables, const std::vector<bool> &rLogMask)
+{
+    std::vector<size_t> storedVariables;
+    storedVariables.reserve(nVariables);
+    for (size_t v=0; v<nVariables; ++v)
+    {
+        if (v >= rLogMask.size() || rLogMask[v])
+        {
+            storedVariables.push_back(v);
+        }
+    }
+
+    if (nSamples == mNumSamples && nVariables == mNumVariables && storedVariables == mStoredVariables)
+    {
+        return;
+    }
+
+    mChunks.clear();
+    mNumSamples = nSamples;
+    mNumVariables = nVariables;
+    mStoredVariables.swap(storedVariables);
+    mColumns.assign(nVariables, NotStored);
+    for (size_t col=0; col<mStoredVariables.size(); ++col)
+    {
+        mColumns[mStoredVariables[col]] = col;
+    }
+
+    const size_t nChunks = (nSamples + ChunkSize - 1)/ChunkSize;
+    mChunks.resize(nChunks);
+    for (size_t c=0; c<nChunks; ++c)
+    {
+        mChunks[c].resize(chunkLength(c)*mStoredVariables.size(), 0.0);
+    }
+}
+
+//! @brief Reduce the number of samples, the first nSamples are kept
+//! @details Only the last remaining chunk is repacked, no memory is allocated
+//! @param[in] nSamples The new number of samples, nothing happens if it is not less than size()
+void LogDataStorage::truncate(const size_t nSamples)
+{
+    if (nSamples >= mNumSamples)
+    {
+        return;
+    }
+
+    const size_t nChunks = (nSamples + ChunkSize - 1)/ChunkSize;
+    mChunks.resize(nChunks);
+    if (nChunks > 0)
+    {
+        // Move the columns of the last chunk closer together, destinations are always before the sources
+        const size_t c = nChunks-1;
+        const size_t oldLength = std::min(ChunkSize, mNumSamples - c*ChunkSize);
+        const size_t newLength = nSamples - c*ChunkSize;
+        double *pData = mChunks[c].data();
+        for (size_t col=1; col<mStoredVariables.size(); ++col)
+        {
+            std::memmove(pData + col*newLength, pData + col*oldLength, newLength*sizeof(double));
+        }
+        mChunks[c].resize(newLength*mStoredVariables.size());
+    }
+    mNumSamples = nSamples;
+}
+
+//! @brief Remove all samples and release the memory
+void LogDataStorage::clear()
+{
+    std::vector< std::vector<double> >().swap(mChunks);
+    mStoredVariables.clear();
+    mColumns.clear();
+    mNumSamples = 0;
+    mNumVariables = 0;
+}
+
+//! @brief Returns a pointer to the contiguous samples of one variable in one chunk
+//! @param[in] variable The variable index
+//! @param[in] chunk The chunk index
+//! @param[out] rLength The number of samples in the chunk
+//! @returns Pointer to the first sample or 0 if out of range or not stored
+const double *LogDataStorage::getVariableChunk(const size_t variable, const size_t chunk, size_t &rLength) const
+{
+    if (isVariableStored(variable) && chunk < mChunks.size())
+    {
+        rLength = chunkLength(chunk);
+        return mChunks[chunk].data() + mColumns[variable]*rLength;
+    }
+    rLength = 0;
+    return 0;
+}
+
+//! @brief Copy all samples of one variable
+//! @param[in] variable The variable index
+//! @param[out] pDst Destination, must have room for size() values
+//! @warning No bounds check is done, the variable must be stored
+void LogDataStorage::copyVariable(const size_t variable, double *pDst) const
+{
+    const size_t col = mColumns[variable];
+    for (size_t c=0; c<mChunks.size(); ++c)
+    {
+        const size_t len = chunkLength(c);
+        std::memcpy(pDst, mChunks[c].data() + col*len, len*sizeof(double));
+        pDst += len;
+    }
+}
+
+//! @brief Returns all samples of one variable
+//! @param[in] variable The variable index
+//! @returns The samples, or an empty vector if the variable is not stored
+std::vector<double> LogDataStorage::getVariable(const size_t variable) const
+{
+    std::vector<double> data;
+    if (isVariableStored(variable))
+    {
+        data.resize(mNumSamples);
+        copyVariable(variable, data.data());
+    }
+    return data;
+}
+
+//! @brief Copy all variables of one sample
+//! @param[in] sample The sample index
+//! @param[out] pDst Destination, must have room for getNumVariables() values, variables that are not stored get NaN
+//! @warning No bounds check is done
+void LogDataStorage::copySample(const size_t sample, double *pDst) const
+{
+    const size_t c = sample/ChunkSize;
+    const size_t stride = chunkLength(c);
+    const double *pSrc = mChunks[c].data() + (sample - c*ChunkSize);
+    for (size_t v=0; v<mNumVariables; ++v)
+    {
+        const size_t col = mColumns[v];
+        pDst[v] = (col == NotStored) ? notStoredValue() : pSrc[col*stride];
+    }
+}
+
+//! @brief Returns all variables of one sample
+//! @param[in] sample The sample index
+//! @returns The values, variables that are not stored get NaN, or an empty vector if the sample does not exist
+std::vector<double> LogDataStorage::getSample(const size_t sample) const
+{
+    std::vector<double> data;
+    if (sample < mNumSamples)
+    {
+        data.resize(mNumVariables);
+        copySample(sample, data.data());
+    }
+    return data;
+}
+
+//! @brief The value returned for variables that are not stored
+double LogDataStorage::notStoredValue()
+{
+    return std::numeric_limits<double>::quiet_NaN();
+}
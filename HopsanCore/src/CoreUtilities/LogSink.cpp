@@ -0,0 +1,539 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   LogSink.cpp
+//! @date   2026-10-18
+//!
+//! @brief Contains the log sink interface used to stream log data out of a system during simulation
+//!
+//$Id$
+
+#include "CoreUtilities/LogSink.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
+#include "HopsanCoreMacros.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+#include <condition_variable>
+#endif
+
+#include <stdint.h>
+
+using namespace hopsan;
+
+namespace {
+
+const char gBinaryLogFileId[8] = {'H','O','P','S','L','O','G','1'};
+
+int seekFile(FILE *pFile, const long long offset)
+{
+#ifdef _WIN32
+    return _fseeki64(pFile, offset, SEEK_SET);
+#else
+    return fseeko(pFile, static_cast<off_t>(offset), SEEK_SET);
+#endif
+}
+
+long long tellFile(FILE *pFile)
+{
+#ifdef _WIN32
+    return _ftelli64(pFile);
+#else
+    return static_cast<long long>(ftello(pFile));
+#endif
+}
+
+bool writeString(FILE *pFile, const HString &rString)
+{
+    const uint32_t len = static_cast<uint32_t>(rString.size());
+    return (fwrite(&len, sizeof(len), 1, pFile) == 1) &&
+           (len == 0 || fwrite(rString.c_str(), 1, len, pFile) == len);
+}
+
+bool readString(FILE *pFile, HString &rString)
+{
+    uint32_t len;
+    if (fread(&len, sizeof(len), 1, pFile) != 1)
+    {
+        return false;
+    }
+    std::vector<char> buffer(len+1, '\0');
+    if (len > 0 && fread(buffer.data(), 1, len, pFile) != len)
+    {
+        return false;
+    }
+    rString = buffer.data();
+    return true;
+}
+
+}
+
+LogSink::~LogSink()
+{
+    // Nothing
+}
+
+//! @brief Returns a description of the last error
+HString LogSink::getErrorMessage() const
+{
+    return HString();
+}
+
+
+class hopsan::BufferedLogSinkPrivates
+{
+public:
+    std::vector< std::vector<double> > mBlocks;
+    std::vector<size_t> mBlockSamples;
+    std::deque<size_t> mFullBlocks;
+    std::deque<size_t> mFreeBlocks;
+    size_t mCurrentBlock;
+    size_t mNumWrittenSamples;
+    bool mIsOpen;
+    bool mFailed;
+    HString mErrorMessage;
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::thread mWriterThread;
+    bool mStopWriter;
+
+    //! @brief The background writer loop, writes full blocks until told to stop and all blocks are written
+    void writerLoop(BufferedLogSink *pSink)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true)
+        {
+            mCondition.wait(lock, [this](){return !mFullBlocks.empty() || mStopWriter;});
+            if (mFullBlocks.empty())
+            {
+                break;
+            }
+            const size_t block = mFullBlocks.front();
+            mFullBlocks.pop_front();
+            lock.unlock();
+            pSink->writeBlockChecked(block);
+            lock.lock();
+            mFreeBlocks.push_back(block);
+            mCondition.notify_all();
+        }
+    }
+#endif
+};
+
+
+//! @brief Constructor
+//! @param[in] blockSize The number of samples in each block
+//! @param[in] numBlocks The number of blocks in the ring buffer (at least 2)
+BufferedLogSink::BufferedLogSink(const size_t blockSize, const size_t numBlocks)
+{
+    mpPrivates = new BufferedLogSinkPrivates();
+    mpPrivates->mBlocks.resize(std::max<size_t>(numBlocks, 2));
+    mpPrivates->mBlockSamples.resize(mpPrivates->mBlocks.size(), 0);
+    mpPrivates->mCurrentBlock = 0;
+    mpPrivates->mNumWrittenSamples = 0;
+    mpPrivates->mIsOpen = false;
+    mpPrivates->mFailed = false;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    mpPrivates->mStopWriter = false;
+#endif
+    mpCurrentBlock = 0;
+    mCurrentSample = 0;
+    mBlockSize = std::max<size_t>(blockSize, 1);
+    mNumVariables = 0;
+}
+
+//! @brief Destructor
+//! @note Classes that inherit must call close() in their own destructor, since closeStorage() can not be called from here
+BufferedLogSink::~BufferedLogSink()
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    // Make sure the writer thread is stopped even if close() was never called
+    if (mpPrivates->mWriterThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mpPrivates->mMutex);
+            mpPrivates->mStopWriter = true;
+        }
+        mpPrivates->mCondition.notify_all();
+        mpPrivates->mWriterThread.join();
+    }
+#endif
+    delete mpPrivates;
+}
+
+//! @brief Allocate the ring buffer, open the storage and start the writer thread
+bool BufferedLogSink::open(const std::vector<LogSinkVariable> &rVariables, const size_t nExpectedSamples)
+{
+    if (mpPrivates->mIsOpen)
+    {
+        close();
+    }
+
+    mNumVariables = rVariables.size();
+    mpPrivates->mFailed = false;
+    mpPrivates->mErrorMessage.clear();
+    mpPrivates->mNumWrittenSamples = 0;
+    mpPrivates->mFullBlocks.clear();
+    mpPrivates->mFreeBlocks.clear();
+    for (size_t b=0; b<mpPrivates->mBlocks.size(); ++b)
+    {
+        mpPrivates->mBlocks[b].assign((mNumVariables+1)*mBlockSize, 0.0);
+        mpPrivates->mBlockSamples[b] = 0;
+        if (b > 0)
+        {
+            mpPrivates->mFreeBlocks.push_back(b);
+        }
+    }
+    mpPrivates->mCurrentBlock = 0;
+    mpCurrentBlock = mpPrivates->mBlocks[0].data();
+    mCurrentSample = 0;
+
+    if (!openStorage(rVariables, nExpectedSamples))
+    {
+        return false;
+    }
+    mpPrivates->mIsOpen = true;
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    mpPrivates->mStopWriter = false;
+    mpPrivates->mWriterThread = std::thread(&BufferedLogSinkPrivates::writerLoop, mpPrivates, this);
+#endif
+    return true;
+}
+
+//! @brief Copy one sample into the current block
+void BufferedLogSink::write(const double time, const double *pValues)
+{
+    double *pDst = mpCurrentBlock + mCurrentSample;
+    pDst[0] = time;
+    for (size_t v=0; v<mNumVariables; ++v)
+    {
+        pDst[(v+1)*mBlockSize] = pValues[v];
+    }
+    if (++mCurrentSample == mBlockSize)
+    {
+        submitBlock();
+    }
+}
+
+//! @brief Write any remaining samples, stop the writer thread and close the storage
+//! @returns True if all samples were written
+bool BufferedLogSink::close()
+{
+    if (!mpPrivates->mIsOpen)
+    {
+        return !mpPrivates->mFailed;
+    }
+
+    if (mCurrentSample > 0)
+    {
+        submitBlock();
+    }
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    {
+        std::lock_guard<std::mutex> lock(mpPrivates->mMutex);
+        mpPrivates->mStopWriter = true;
+    }
+    mpPrivates->mCondition.notify_all();
+    mpPrivates->mWriterThread.join();
+#endif
+
+    mpPrivates->mIsOpen = false;
+    if (!closeStorage() && !mpPrivates->mFailed)
+    {
+        setErrorMessage("Failed to close log storage");
+    }
+    return !mpPrivates->mFailed;
+}
+
+HString BufferedLogSink::getErrorMessage() const
+{
+    return mpPrivates->mErrorMessage;
+}
+
+//! @brief Returns the number of samples written to the storage, only valid after close()
+size_t BufferedLogSink::getNumWrittenSamples() const
+{
+    return mpPrivates->mNumWrittenSamples;
+}
+
+//! @brief Returns the number of variables in each sample
+size_t BufferedLogSink::getNumVariables() const
+{
+    return mNumVariables;
+}
+
+//! @brief Remember an error, the sink will report failure when closed
+void BufferedLogSink::setErrorMessage(const HString &rMessage)
+{
+    mpPrivates->mFailed = true;
+    mpPrivates->mErrorMessage = rMessage;
+}
+
+//! @brief Hand over the current block to the writer and continue with the next free block
+void BufferedLogSink::submitBlock()
+{
+    const size_t block = mpPrivates->mCurrentBlock;
+    mpPrivates->mBlockSamples[block] = mCurrentSample;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    std::unique_lock<std::mutex> lock(mpPrivates->mMutex);
+    mpPrivates->mFullBlocks.push_back(block);
+    mpPrivates->mCondition.notify_all();
+    // Only wait if the writer has not yet caught up with all blocks
+    mpPrivates->mCondition.wait(lock, [this](){return !mpPrivates->mFreeBlocks.empty();});
+    mpPrivates->mCurrentBlock = mpPrivates->mFreeBlocks.front();
+    mpPrivates->mFreeBlocks.pop_front();
+#else
+    writeBlockChecked(block);
+    mpPrivates->mCurrentBlock = (block+1) % mpPrivates->mBlocks.size();
+#endif
+    mpCurrentBlock = mpPrivates->mBlocks[mpPrivates->mCurrentBlock].data();
+    mCurrentSample = 0;
+}
+
+//! @brief Write one block and keep track of failures, after a failure further blocks are discarded
+void BufferedLogSink::writeBlockChecked(const size_t block)
+{
+    if (!mpPrivates->mFailed)
+    {
+        const size_t nSamples = mpPrivates->mBlockSamples[block];
+        if (writeBlock(mpPrivates->mBlocks[block].data(), nSamples, mBlockSize))
+        {
+            mpPrivates->mNumWrittenSamples += nSamples;
+        }
+        else
+        {
+            setErrorMessage("Failed to write log data block");
+        }
+    }
+}
+
+
+//! @brief Constructor
+//! @param[in] rFilePath The file to write, it is created (or truncated) when the sink is opened
+//! @param[in] blockSize The number of samples in each block
+//! @param[in] numBlocks The number of blocks in the ring buffer
+BinaryFileLogSink::BinaryFileLogSink(const HString &rFilePath, const size_t blockSize, const size_t numBlocks) :
+    BufferedLogSink(blockSize, numBlocks), mFilePath(rFilePath)
+{
+    mpFile = 0;
+}
+
+BinaryFileLogSink::~BinaryFileLogSink()
+{
+    close();
+}
+
+const HString &BinaryFileLogSink::getFilePath() const
+{
+    return mFilePath;
+}
+
+bool BinaryFileLogSink::openStorage(const std::vector<LogSinkVariable> &rVariables, const size_t nExpectedSamples)
+{
+    HOPSAN_UNUSED(nExpectedSamples)
+    mpFile = fopen(mFilePath.c_str(), "wb");
+    if (!mpFile)
+    {
+        setErrorMessage("Could not open: "+mFilePath+" for writing");
+        return false;
+    }
+
+    const uint64_t nVariables = rVariables.size();
+    bool ok = (fwrite(gBinaryLogFileId, 1, sizeof(gBinaryLogFileId), mpFile) == sizeof(gBinaryLogFileId)) &&
+              (fwrite(&nVariables, sizeof(nVariables), 1, mpFile) == 1);
+    for (size_t v=0; ok && v<rVariables.size(); ++v)
+    {
+        const LogSinkVariable &rVar = rVariables[v];
+        ok = writeString(mpFile, rVar.mComponent) && writeString(mpFile, rVar.mPort) && writeString(mpFile, rVar.mName) &&
+             writeString(mpFile, rVar.mAlias) && writeString(mpFile, rVar.mUnit) && writeString(mpFile, rVar.mQuantity);
+    }
+    if (!ok)
+    {
+        setErrorMessage("Failed to write log file header to: "+mFilePath);
+        fclose(mpFile);
+        mpFile = 0;
+    }
+    return ok;
+}
+
+bool BinaryFileLogSink::writeBlock(const double *pBlock, const size_t nSamples, const size_t stride)
+{
+    const uint64_t n = nSamples;
+    if (fwrite(&n, sizeof(n), 1, mpFile) != 1)
+    {
+        return false;
+    }
+    // The time column and one column per variable
+    const size_t nColumns = getNumVariables()+1;
+    for (size_t c=0; c<nColumns; ++c)
+    {
+        if (fwrite(pBlock+c*stride, sizeof(double), nSamples, mpFile) != nSamples)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BinaryFileLogSink::closeStorage()
+{
+    if (mpFile)
+    {
+        const bool ok = (fclose(mpFile) == 0);
+        mpFile = 0;
+        return ok;
+    }
+    return true;
+}
+
+
+BinaryLogFileReader::BinaryLogFileReader()
+{
+    mpFile = 0;
+    mNumSamples = 0;
+}
+
+BinaryLogFileReader::~BinaryLogFileReader()
+{
+    close();
+}
+
+//! @brief Open a log file and read the header and block index
+//! @returns True if the file could be opened and has a valid header
+bool BinaryLogFileReader::open(const HString &rFilePath)
+{
+    close();
+    mpFile = fopen(rFilePath.c_str(), "rb");
+    if (!mpFile)
+    {
+        return false;
+    }
+
+    char id[sizeof(gBinaryLogFileId)];
+    uint64_t nVariables;
+    if ((fread(id, 1, sizeof(id), mpFile) != sizeof(id)) || (memcmp(id, gBinaryLogFileId, sizeof(id)) != 0) ||
+        (fread(&nVariables, sizeof(nVariables), 1, mpFile) != 1))
+    {
+        close();
+        return false;
+    }
+
+    mVariables.resize(nVariables);
+    for (size_t v=0; v<mVariables.size(); ++v)
+    {
+        LogSinkVariable &rVar = mVariables[v];
+        if (!(readString(mpFile, rVar.mComponent) && readString(mpFile, rVar.mPort) && readString(mpFile, rVar.mName) &&
+              readString(mpFile, rVar.mAlias) && readString(mpFile, rVar.mUnit) && readString(mpFile, rVar.mQuantity)))
+        {
+            close();
+            return false;
+        }
+    }
+
+    // Index the blocks, a truncated last block is ignored
+    uint64_t n;
+    long long offset = tellFile(mpFile);
+    while (fread(&n, sizeof(n), 1, mpFile) == 1)
+    {
+        const long long blockBytes = static_cast<long long>(n*(mVariables.size()+1)*sizeof(double));
+        if (seekFile(mpFile, offset+static_cast<long long>(sizeof(n))+blockBytes-1) != 0 || fgetc(mpFile) == EOF)
+        {
+            break;
+        }
+        mBlockOffsets.push_back(offset+static_cast<long long>(sizeof(n)));
+        mBlockSamples.push_back(n);
+        mNumSamples += n;
+        offset = tellFile(mpFile);
+    }
+    return true;
+}
+
+void BinaryLogFileReader::close()
+{
+    if (mpFile)
+    {
+        fclose(mpFile);
+        mpFile = 0;
+    }
+    mVariables.clear();
+    mBlockOffsets.clear();
+    mBlockSamples.clear();
+    mNumSamples = 0;
+}
+
+const std::vector<LogSinkVariable> &BinaryLogFileReader::getVariables() const
+{
+    return mVariables;
+}
+
+size_t BinaryLogFileReader::getNumSamples() const
+{
+    return mNumSamples;
+}
+
+//! @brief Read the time values of all samples
+bool BinaryLogFileReader::readTime(std::vector<double> &rTime)
+{
+    return readColumn(0, rTime);
+}
+
+//! @brief Read all samples of one variable
+//! @param[in] variable The index of the variable in getVariables()
+//! @param[out] rValues The values
+bool BinaryLogFileReader::readVariable(const size_t variable, std::vector<double> &rValues)
+{
+    if (variable >= mVariables.size())
+    {
+        return false;
+    }
+    return readColumn(variable+1, rValues);
+}
+
+bool BinaryLogFileReader::readColumn(const size_t column, std::vector<double> &rValues)
+{
+    if (!mpFile)
+    {
+        return false;
+    }
+    rValues.resize(mNumSamples);
+    double *pDst = rValues.data();
+    for (size_t b=0; b<mBlockOffsets.size(); ++b)
+    {
+        const size_t n = mBlockSamples[b];
+        if ((seekFile(mpFile, mBlockOffsets[b]+static_cast<long long>(column*n*sizeof(double))) != 0) ||
+            (fread(pDst, sizeof(double), n, mpFile) != n))
+        {
+            return false;
+        }
+        pDst += n;
+    }
+    return true;
+}
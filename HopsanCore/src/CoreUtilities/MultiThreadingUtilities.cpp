@@ -31,11 +31,19 @@
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <climits>
+#include <algorithm>
+#include <chrono>
 
 #ifndef _WIN32
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
 #include "CoreUtilities/MultiThreadingUtilities.h"
 #include "ComponentSystem.h"
 
@@ -79,6 +87,131 @@ size_t determineActualNumberOfThreads(const size_t nDesiredThreads)
 
 #if defined(HOPSANCORE_USEMULTITHREADING)
 
+namespace {
+
+//! @brief Hint to the processor that we are in a spin-wait loop
+inline void cpuRelax()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#endif
+}
+
+//! @brief Sleeps until woken by futexWakeAll(), returns immediately if the value is no longer the expected one
+//! @details On platforms without futex the thread only yields, so the caller must check the value again in a loop
+inline void futexWait(std::atomic<int> *pValue, int expected)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<int*>(pValue), FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#else
+    if(pValue->load() == expected)
+    {
+        std::this_thread::yield();
+    }
+#endif
+}
+
+//! @brief Wakes all threads sleeping in futexWait() on the value
+inline void futexWakeAll(std::atomic<int> *pValue)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<int*>(pValue), FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+    (void)pValue;
+#endif
+}
+
+}
+
+//! @brief Constructor
+//! @param nThreads Number of threads to synchronize (all of them will call wait())
+//! @param spinCount Number of spin iterations before a waiting thread goes to sleep, 0 means sleep immediately
+//! @note If there are more threads than processor cores, spinning only steals time from the threads we wait for, so the spin count is set to 0
+SpinFutexBarrier::SpinFutexBarrier(size_t nThreads, size_t spinCount)
+{
+    mnThreads = int(nThreads);
+    mSpinCount = spinCount;
+    const size_t nCores = std::thread::hardware_concurrency();
+    if(nCores > 0 && nThreads > nCores)
+    {
+        mSpinCount = 0;
+    }
+    mCounter.store(mnThreads);
+    mState.store(0);
+    mnSleepers.store(0);
+    mStopRequested.store(false);
+}
+
+//! @brief Wait until all threads have arrived at the barrier
+//! @param [in,out] rLocalSense The calling threads local sense, must be initialized to 0 and then only be modified by this function
+//! @param [in] requestStop Set to true if this thread wants all threads to stop
+//! @returns false if any thread requested stop in this round, else true
+bool SpinFutexBarrier::wait(int &rLocalSense, bool requestStop)
+{
+    rLocalSense ^= 1;
+    if(requestStop)
+    {
+        mStopRequested.store(true);
+    }
+
+    int state;
+    if(mCounter.fetch_sub(1) == 1)
+    {
+        // Last thread to arrive, reset counter and flip the global sense to release the others
+        mCounter.store(mnThreads);
+        state = rLocalSense | (mStopRequested.exchange(false) ? 2 : 0);
+        mState.store(state);
+        if(mnSleepers.load() > 0)
+        {
+            wakeAll();
+        }
+    }
+    else
+    {
+        size_t spins=0;
+        state = mState.load();
+        while((state & 1) != rLocalSense)
+        {
+            if(spins < mSpinCount)
+            {
+                cpuRelax();
+                ++spins;
+            }
+            else
+            {
+                sleepWhileState(state);
+            }
+            state = mState.load();
+        }
+    }
+    return !(state & 2);
+}
+
+//! @brief Returns the number of threads synchronized by this barrier
+size_t SpinFutexBarrier::getNumThreads() const
+{
+    return size_t(mnThreads);
+}
+
+//! @brief Returns the number of spin iterations before a waiting thread goes to sleep
+size_t SpinFutexBarrier::getSpinCount() const
+{
+    return mSpinCount;
+}
+
+void SpinFutexBarrier::sleepWhileState(int state)
+{
+    mnSleepers.fetch_add(1);
+    futexWait(&mState, state);
+    mnSleepers.fetch_sub(1);
+}
+
+void SpinFutexBarrier::wakeAll()
+{
+    futexWakeAll(&mState);
+}
+
+
 //! @brief Constructor for slave simulation thread function.
 //! @param pSystem Pointer to top level component system
 //! @param sVector Vector with signal components executed from this thread
@@ -92,6 +225,7 @@ size_t determineActualNumberOfThreads(const size_t nDesiredThreads)
 //! @param *pBarrier_C Pointer to barrier before C-type components
 //! @param *pBarrier_Q Pointer to barrier before Q-type components
 //! @param *pBarrier_N Pointer to barrier before node logging
+//! @param sampleInterval Measure the time of each C- and Q-component every sampleInterval step (0 = never), used for adaptive rescheduling
 void simSlave(ComponentSystem *pSystem,
               std::vector<Component*> &sVector,
               std::vector<Component*> &cVector,
@@ -103,7 +237,8 @@ void simSlave(ComponentSystem *pSystem,
               BarrierLock *pBarrier_S,
               BarrierLock *pBarrier_C,
               BarrierLock *pBarrier_Q,
-              BarrierLock *pBarrier_N)
+              BarrierLock *pBarrier_N,
+              size_t sampleInterval)
 {
     (void)nVector;
 
@@ -112,6 +247,7 @@ void simSlave(ComponentSystem *pSystem,
     for(size_t i=0; i<numSimSteps; ++i)
     {
         time += timeStep;
+        const bool sample = (sampleInterval > 0) && ((i+1)%sampleInterval == 0);
 
         //! Signal Components !//
 
@@ -131,9 +267,16 @@ void simSlave(ComponentSystem *pSystem,
         while(pBarrier_C->isLocked()){}                         //Wait at C barrier
         if(pSystem->wasSimulationAborted()) break;
 
-        for(size_t i=0; i<cVector.size(); ++i)
+        if(sample)
         {
-            cVector[i]->simulate(time);
+            simulateAndSampleTime(cVector, time, (i+1) == sampleInterval);
+        }
+        else
+        {
+            for(size_t i=0; i<cVector.size(); ++i)
+            {
+                cVector[i]->simulate(time);
+            }
         }
 
 
@@ -143,9 +286,16 @@ void simSlave(ComponentSystem *pSystem,
         while(pBarrier_Q->isLocked()){}                         //Wait at Q barrier
         if(pSystem->wasSimulationAborted()) break;
 
-        for(size_t i=0; i<qVector.size(); ++i)
+        if(sample)
         {
-            qVector[i]->simulate(time);
+            simulateAndSampleTime(qVector, time, (i+1) == sampleInterval);
+        }
+        else
+        {
+            for(size_t i=0; i<qVector.size(); ++i)
+            {
+                qVector[i]->simulate(time);
+            }
         }
 
         //! Log Nodes !//
@@ -177,10 +327,11 @@ void simSlave(ComponentSystem *pSystem,
 //! @param *pBarrier_C Pointer to barrier before C-type components
 //! @param *pBarrier_Q Pointer to barrier before Q-type components
 //! @param *pBarrier_N Pointer to barrier before node logging
+//! @param sampleInterval Measure the time of each C- and Q-component every sampleInterval step (0 = never), and reschedule if the load is imbalanced
 void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std::vector<Component *> &cVector,
                std::vector<Component *> &qVector, std::vector<Node *> &nVector, std::vector<double *> &pSimTimes, double startTime, double timeStep,
                size_t numSimSteps, BarrierLock *pBarrier_S, BarrierLock *pBarrier_C,
-               BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N)
+               BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N, size_t sampleInterval)
 {
     (void)nVector;
 
@@ -189,6 +340,7 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
     for(size_t s=0; s<numSimSteps; ++s)
     {
         time += timeStep;
+        const bool sample = (sampleInterval > 0) && ((s+1)%sampleInterval == 0);
 
         //! Signal Components !//
         bool stop=false;
@@ -238,9 +390,16 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
         pBarrier_Q->lock();
         pBarrier_C->unlock();
 
-        for(size_t i=0; i<cVector.size(); ++i)
+        if(sample)
         {
-            cVector[i]->simulate(time);
+            simulateAndSampleTime(cVector, time, (s+1) == sampleInterval);
+        }
+        else
+        {
+            for(size_t i=0; i<cVector.size(); ++i)
+            {
+                cVector[i]->simulate(time);
+            }
         }
 
         //! Q Components !//
@@ -263,9 +422,16 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
         }
         pBarrier_N->lock();
         pBarrier_Q->unlock();
-        for(size_t i=0; i<qVector.size(); ++i)
+        if(sample)
+        {
+            simulateAndSampleTime(qVector, time, (s+1) == sampleInterval);
+        }
+        else
         {
-            qVector[i]->simulate(time);
+            for(size_t i=0; i<qVector.size(); ++i)
+            {
+                qVector[i]->simulate(time);
+            }
         }
 
         for(size_t i=0; i<pSimTimes.size(); ++i)
@@ -299,6 +465,218 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
         //                mVectorN[i]->logData(time);
         //            }
         pSystem->logTimeAndNodes(s+1); //s+1 since at s=0 one simulation has been performed /Björn
+
+        // All slaves are now waiting at the S barrier, so it is safe to repartition their components
+        if(sample)
+        {
+            pSystem->rescheduleIfImbalanced(time);
+        }
+    }
+}
+
+
+//! @brief Simulates the signal components of one thread one wavefront stage at a time, with a barrier between the stages
+//! @param pSystem Pointer to the top level component system
+//! @param rStages The components of each stage that are executed from this thread, all threads must have the same number of stages
+//! @param time Time to simulate to
+//! @param *pBarrier Pointer to the barrier shared by all simulation threads
+//! @param rSense The local sense of the calling thread
+//! @returns False if the simulation shall stop
+static bool simulateSignalStages(ComponentSystem *pSystem, std::vector<std::vector<Component *> > &rStages, double time,
+                                 SpinFutexBarrier *pBarrier, int &rSense)
+{
+    for(size_t k=0; k<rStages.size(); ++k)
+    {
+        if(k > 0 && !pBarrier->wait(rSense, pSystem->wasSimulationAborted()))
+        {
+            return false;
+        }
+        std::vector<Component *> &rComponents = rStages[k];
+        for(size_t i=0; i<rComponents.size(); ++i)
+        {
+            rComponents[i]->simulate(time);
+        }
+    }
+    return true;
+}
+
+
+//! @brief Master simulation thread function using a sense-reversing spin/futex barrier
+//! @param pSystem Pointer to the top level component system
+//! @param sVector Vector with signal components executed from this thread
+//! @param cVector Vector with C-type components executed from this thread
+//! @param qVector Vector with Q-type components executed from this thread
+//! @param *pSimTimes Pointer to the simulation time variables in the component systems
+//! @param startTime Start time of simulation
+//! @param timeStep Step time of simulation
+//! @param numSimSteps Number of steps to simulate
+//! @param *pBarrier Pointer to the barrier shared by all simulation threads
+//! @param sampleInterval Measure the time of each C- and Q-component every sampleInterval step (0 = never), and reschedule if the load is imbalanced
+//! @param pSignalStages Wavefront stages with signal components executed from this thread, replaces sVector if given
+void simSpinFutexMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std::vector<Component *> &cVector,
+                        std::vector<Component *> &qVector, std::vector<double *> &pSimTimes,
+                        double startTime, double timeStep, size_t numSimSteps, SpinFutexBarrier *pBarrier, size_t sampleInterval,
+                        std::vector<std::vector<Component *> > *pSignalStages)
+{
+    int sense=0;
+    double time = startTime;
+
+    for(size_t s=0; s<numSimSteps; ++s)
+    {
+        time += timeStep;
+        const bool sample = (sampleInterval > 0) && ((s+1)%sampleInterval == 0);
+
+        //! Signal Components !//
+        if(!pBarrier->wait(sense, pSystem->wasSimulationAborted())) break;
+        if(pSignalStages)
+        {
+            if(!simulateSignalStages(pSystem, *pSignalStages, time, pBarrier, sense)) break;
+        }
+        else
+        {
+            for(size_t i=0; i<sVector.size(); ++i)
+            {
+                sVector[i]->simulate(time);
+            }
+        }
+
+        //! C Components !//
+        if(!pBarrier->wait(sense, pSystem->wasSimulationAborted())) break;
+        if(sample)
+        {
+            simulateAndSampleTime(cVector, time, (s+1) == sampleInterval);
+        }
+        else
+        {
+            for(size_t i=0; i<cVector.size(); ++i)
+            {
+                cVector[i]->simulate(time);
+            }
+        }
+
+        //! Q Components !//
+        if(!pBarrier->wait(sense, pSystem->wasSimulationAborted())) break;
+        if(sample)
+        {
+            simulateAndSampleTime(qVector, time, (s+1) == sampleInterval);
+        }
+        else
+        {
+            for(size_t i=0; i<qVector.size(); ++i)
+            {
+                qVector[i]->simulate(time);
+            }
+        }
+
+        for(size_t i=0; i<pSimTimes.size(); ++i)
+            *pSimTimes[i] = time;     //Update time in component system, so that progress bar can use it
+
+        //! Log Nodes !//
+        if(!pBarrier->wait(sense, pSystem->wasSimulationAborted())) break;
+        pSystem->logTimeAndNodes(s+1);
+
+        // All slaves are now waiting at the next S barrier, so it is safe to repartition their components
+        if(sample)
+        {
+            pSystem->rescheduleIfImbalanced(time);
+        }
+    }
+}
+
+
+//! @brief Slave simulation thread function using a sense-reversing spin/futex barrier
+//! @param pSystem Pointer to top level component system
+//! @param sVector Vector with signal components executed from this thread
+//! @param cVector Vector with C-type components executed from this thread
+//! @param qVector Vector with Q-type components executed from this thread
+//! @param startTime Start time of simulation
+//! @param timeStep Step time of simulation
+//! @param numSimSteps Number of simulation steps to run
+//! @param *pBarrier Pointer to the barrier shared by all simulation threads
+//! @param sampleInterval Measure the time of each C- and Q-component every sampleInterval step (0 = never), used for adaptive rescheduling
+//! @param pSignalStages Wavefront stages with signal components executed from this thread, replaces sVector if given
+void simSpinFutexSlave(ComponentSystem *pSystem, std::vector<Component *> &sVector, std::vector<Component *> &cVector,
+                       std::vector<Component *> &qVector, double startTime, double timeStep, size_t numSimSteps,
+                       SpinFutexBarrier *pBarrier, size_t sampleInterval, std::vector<std::vector<Component *> > *pSignalStages)
+{
+    int sense=0;
+    double time = startTime;
+
+    for(size_t s=0; s<numSimSteps; ++s)
+    {
+        time += timeStep;
+        const bool sample = (sampleInterval > 0) && ((s+1)%sampleInterval == 0);
+
+        //! Signal Components !//
+        if(!pBarrier->wait(sense, pSystem->wasSimulationAborted())) break;
+        if(pSignalStages)
+        {
+            if(!simulateSignalStages(pSystem, *pSignalStages, time, pBarrier, sense)) break;
+        }
+        else
+        {
+            for(size_t i=0; i<sVector.size(); ++i)
+            {
+                sVector[i]->simulate(time);
+            }
+        }
+
+        //! C Components !//
+        if(!pBarrier->wait(sense, pSystem->wasSimulationAborted())) break;
+        if(sample)
+        {
+            simulateAndSampleTime(cVector, time, (s+1) == sampleInterval);
+        }
+        else
+        {
+            for(size_t i=0; i<cVector.size(); ++i)
+            {
+                cVector[i]->simulate(time);
+            }
+        }
+
+        //! Q Components !//
+        if(!pBarrier->wait(sense, pSystem->wasSimulationAborted())) break;
+        if(sample)
+        {
+            simulateAndSampleTime(qVector, time, (s+1) == sampleInterval);
+        }
+        else
+        {
+            for(size_t i=0; i<qVector.size(); ++i)
+            {
+                qVector[i]->simulate(time);
+            }
+        }
+
+        //! Log Nodes (done by master) !//
+        if(!pBarrier->wait(sense, pSystem->wasSimulationAborted())) break;
+    }
+}
+
+
+//! @brief Simulates components and measures the time of each one, used for online load sampling during multi-threaded simulations
+//! @details The measured time (in ms for one step) is filtered with the previous sample, except for the first sample that replaces the
+//! time from the pre-simulation measurement (which is for several steps)
+//! @param rComponents Vector with components to simulate
+//! @param stopTime Time to simulate to
+//! @param firstSample Replace the measured time instead of filtering it
+void simulateAndSampleTime(std::vector<Component *> &rComponents, double stopTime, bool firstSample)
+{
+    for(size_t i=0; i<rComponents.size(); ++i)
+    {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        rComponents[i]->simulate(stopTime);
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        const double dt = std::chrono::duration<double, std::milli>(t1-t0).count();
+        if(firstSample)
+        {
+            rComponents[i]->setMeasuredTime(dt);
+        }
+        else
+        {
+            rComponents[i]->setMeasuredTime(0.5*(rComponents[i]->getMeasuredTime()+dt));
+        }
     }
 }
 
@@ -338,11 +716,46 @@ void simPoolSlave(TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ, std::atomic<double
 }
 
 
+//! @brief Simulate all components in a thread's own deque, then try to steal one component from another thread
+//! @details Simulated (and stolen) components are pushed to the finished deque, which is used as the thread's own deque in the next time step
+//! @param pOwnVector The thread's own deque with unfinished components
+//! @param pFinishedVector Deque for finished components, owned by the calling thread
+//! @param rAllVectors All threads unfinished deques
+//! @param nThreads Number of threads
+//! @param threadID Id of the calling thread
+//! @param time Time to simulate to
+static void simulateOwnAndSteal(WorkStealingDeque *pOwnVector, WorkStealingDeque *pFinishedVector, std::vector<WorkStealingDeque*> &rAllVectors,
+                                size_t nThreads, size_t threadID, double time)
+{
+    //Simulate own components
+    Component *pComp = pOwnVector->popBottom();
+    while(pComp)
+    {
+        pComp->simulate(time);
+        pFinishedVector->pushBottom(pComp);
+        pComp = pOwnVector->popBottom();
+    }
+
+    //Steal components
+    for(size_t i=0; i<nThreads-1; ++i)
+    {
+        size_t j = (threadID+1+i)%nThreads;
+        pComp = rAllVectors[j]->steal();
+        if(pComp)
+        {
+            pComp->simulate(time);
+            pFinishedVector->pushBottom(pComp);
+            break;
+        }
+    }
+}
+
+
 //! @brief Function for master simulation thread, that is responsible for synchronizing the simulation
 void simStealingMaster(ComponentSystem *pSystem,
                        std::vector<Component *> &sVector,
-                       std::vector<ThreadSafeVector *> *cVectors,
-                       std::vector<ThreadSafeVector *> *qVectors,
+                       std::vector<WorkStealingDeque *> *cVectors,
+                       std::vector<WorkStealingDeque *> *qVectors,
                        std::vector<double *> &pSimTimes,
                        double startTime,
                        double timeStep,
@@ -355,14 +768,13 @@ void simStealingMaster(ComponentSystem *pSystem,
                        BarrierLock *pBarrier_N,
                        size_t maxSize)
 {
-    ThreadSafeVector *pTemp;
-    Component *pComp;
+    WorkStealingDeque *pTemp;
 
     double time = startTime;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsC = cVectors;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsQ = qVectors;
-    ThreadSafeVector *pFinishedVectorC = new ThreadSafeVector(std::vector<Component*>(), maxSize);
-    ThreadSafeVector *pFinishedVectorQ = new ThreadSafeVector(std::vector<Component*>(), maxSize);
+    std::vector<WorkStealingDeque*> *pUnFinishedVectorsC = cVectors;
+    std::vector<WorkStealingDeque*> *pUnFinishedVectorsQ = qVectors;
+    WorkStealingDeque *pFinishedVectorC = new WorkStealingDeque(std::vector<Component*>(), maxSize);
+    WorkStealingDeque *pFinishedVectorQ = new WorkStealingDeque(std::vector<Component*>(), maxSize);
 
     for(size_t s=0; s<numSimSteps; ++s)
     {
@@ -390,35 +802,12 @@ void simStealingMaster(ComponentSystem *pSystem,
 
         //SIMULATE C
 
-        //Switch Q vectors
+        //Switch Q vectors (no one steals Q components during the C phase)
         pTemp = pUnFinishedVectorsQ->at(threadID);
         pUnFinishedVectorsQ->at(threadID) = pFinishedVectorQ;
         pFinishedVectorQ = pTemp;
 
-        //Simulate own components
-        pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        while(pComp)
-        {
-            pComp->simulate(time);
-            pFinishedVectorC->insertFirst(pComp);
-            pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        }
-
-        //Steal components
-        //if(int(time/timeStep/5+threadID)%nThreads == 0)
-        {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsC->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorC->insertLast(pComp);
-                    break;
-                }
-            }
-        }
+        simulateOwnAndSteal(pUnFinishedVectorsC->at(threadID), pFinishedVectorC, *pUnFinishedVectorsC, nThreads, threadID, time);
 
         //! Q Components !//
 
@@ -428,35 +817,12 @@ void simStealingMaster(ComponentSystem *pSystem,
 
         //SIMULATE Q
 
-        //Switch C vectors
+        //Switch C vectors (no one steals C components during the Q phase)
         pTemp = pUnFinishedVectorsC->at(threadID);
         pUnFinishedVectorsC->at(threadID) = pFinishedVectorC;
         pFinishedVectorC = pTemp;
 
-        //Simulate own components
-        pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        while(pComp)
-        {
-            pComp->simulate(time);
-            pFinishedVectorQ->insertFirst(pComp);
-            pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        }
-
-        //Steal components
-        //if(int(time/timeStep/5+mThreadID)%nThreads == 0)
-        {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsQ->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorQ->insertLast(pComp);
-                    break;
-                }
-            }
-        }
+        simulateOwnAndSteal(pUnFinishedVectorsQ->at(threadID), pFinishedVectorQ, *pUnFinishedVectorsQ, nThreads, threadID, time);
 
         for(size_t i=0; i<pSimTimes.size(); ++i)
             *pSimTimes[i] = time;
@@ -469,11 +835,15 @@ void simStealingMaster(ComponentSystem *pSystem,
 
         pSystem->logTimeAndNodes(s+1);
     }
+
+    // Only delete the deques that are local to this thread, the ones in the shared vectors are deleted by the caller
+    delete pFinishedVectorC;
+    delete pFinishedVectorQ;
 }
 
 void simStealingSlave(ComponentSystem *pSystem,
-                      std::vector<ThreadSafeVector *> *cVectors,
-                      std::vector<ThreadSafeVector *> *qVectors,
+                      std::vector<WorkStealingDeque *> *cVectors,
+                      std::vector<WorkStealingDeque *> *qVectors,
                       double startTime,
                       double timeStep,
                       size_t numSimSteps,
@@ -487,15 +857,12 @@ void simStealingSlave(ComponentSystem *pSystem,
 
 {
     double time = startTime;;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsC = cVectors;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsQ = qVectors;
-    //! @todo memory leak, never deleted, however, dont delete in destructor, that will cause double free corruption since this object is copied when new tasks are created
-    ThreadSafeVector *pFinishedVectorC = new ThreadSafeVector(std::vector<Component*>(), maxSize);
-    ThreadSafeVector *pFinishedVectorQ = new ThreadSafeVector(std::vector<Component*>(), maxSize);
+    std::vector<WorkStealingDeque*> *pUnFinishedVectorsC = cVectors;
+    std::vector<WorkStealingDeque*> *pUnFinishedVectorsQ = qVectors;
+    WorkStealingDeque *pFinishedVectorC = new WorkStealingDeque(std::vector<Component*>(), maxSize);
+    WorkStealingDeque *pFinishedVectorQ = new WorkStealingDeque(std::vector<Component*>(), maxSize);
 
-
-    ThreadSafeVector *pTemp;
-    Component *pComp;
+    WorkStealingDeque *pTemp;
 
     for(size_t i=0; i<numSimSteps; ++i)
     {
@@ -515,35 +882,12 @@ void simStealingSlave(ComponentSystem *pSystem,
 
         //C-COMPONENTS
 
-        //Switch Q vectors
+        //Switch Q vectors (no one steals Q components during the C phase)
         pTemp = pUnFinishedVectorsQ->at(threadID);
         pUnFinishedVectorsQ->at(threadID) = pFinishedVectorQ;
         pFinishedVectorQ = pTemp;
 
-        //Simulate own components
-        pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        while(pComp)
-        {
-            pComp->simulate(time);
-            pFinishedVectorC->insertFirst(pComp);
-            pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        }
-
-        //Steal components
-        //if(int(time/timeStep/5+mThreadID)%mnThreads == 0)
-        {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsC->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorC->insertLast(pComp);
-                    break;
-                }
-            }
-        }
+        simulateOwnAndSteal(pUnFinishedVectorsC->at(threadID), pFinishedVectorC, *pUnFinishedVectorsC, nThreads, threadID, time);
 
         //! Q Components !//
 
@@ -552,41 +896,22 @@ void simStealingSlave(ComponentSystem *pSystem,
 
         //Q-COMPONENTS
 
-        //Switch C vectors
+        //Switch C vectors (no one steals C components during the Q phase)
         pTemp = pUnFinishedVectorsC->at(threadID);
         pUnFinishedVectorsC->at(threadID) = pFinishedVectorC;
         pFinishedVectorC = pTemp;
 
-        //Simulate own components
-        pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        while(pComp)
-        {
-            pComp->simulate(time);
-            pFinishedVectorQ->insertFirst(pComp);
-            pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        }
-
-        //Steal components
-        //if(int(time/timeStep/5+mThreadID)%mnThreads == 0)
-        {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsQ->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorQ->insertLast(pComp);
-                    break;
-                }
-            }
-        }
+        simulateOwnAndSteal(pUnFinishedVectorsQ->at(threadID), pFinishedVectorQ, *pUnFinishedVectorsQ, nThreads, threadID, time);
 
         //! Log Nodes !//
 
         pBarrier_N->increment();
         while(pBarrier_N->isLocked()){}                         //Wait at N barrier
     }
+
+    // Only delete the deques that are local to this thread, the ones in the shared vectors are deleted by the caller
+    delete pFinishedVectorC;
+    delete pFinishedVectorQ;
 }
 
 void simOneComponentOneStep(Component *pComp, double stopTime)
@@ -606,6 +931,272 @@ void simOneStep(std::vector<Component *> *pComponentPtrs, double stopTime)
 }
 
 
+//! @brief Constructor, starts the worker threads
+//! @param nThreads Total number of threads, including the master thread that will dispatch work to the pool
+//! @param spinCount Number of spin iterations before an idle worker thread goes to sleep, 0 means sleep immediately
+//! @note If there are more threads than processor cores, spinning only steals time from the other threads, so the spin count is set to 0
+WorkerThreadPool::WorkerThreadPool(size_t nThreads, size_t spinCount)
+{
+    mpComponentPtrs = 0;
+    mpComponentGroups = 0;
+    mnTasks = 0;
+    mStopTime = 0;
+    mSpinCount = spinCount;
+    const size_t nCores = std::thread::hardware_concurrency();
+    if(nCores > 0 && nThreads > nCores)
+    {
+        mSpinCount = 0;
+    }
+    mGeneration.store(0);
+    mnSleepers.store(0);
+    mNextTask.store(0);
+    mnFinishedWorkers.store(0);
+    mStop.store(false);
+
+    for(size_t t=1; t<nThreads; ++t)
+    {
+        mWorkers.push_back(std::thread(&WorkerThreadPool::workerLoop, this));
+    }
+}
+
+
+//! @brief Destructor, stops and joins the worker threads
+WorkerThreadPool::~WorkerThreadPool()
+{
+    mStop.store(true);
+    mGeneration.fetch_add(1);
+    futexWakeAll(&mGeneration);
+    for(size_t t=0; t<mWorkers.size(); ++t)
+    {
+        mWorkers[t].join();
+    }
+}
+
+
+//! @brief Returns the total number of threads, including the master thread
+size_t WorkerThreadPool::getNumThreads() const
+{
+    return mWorkers.size()+1;
+}
+
+
+//! @brief Simulates each component in a vector as one task, returns when all components have been simulated
+//! @param rComponentPtrs Vector with components to simulate
+//! @param stopTime Time to simulate to
+void WorkerThreadPool::simulateComponents(std::vector<Component *> &rComponentPtrs, double stopTime)
+{
+    dispatch(&rComponentPtrs, 0, rComponentPtrs.size(), stopTime);
+}
+
+
+//! @brief Simulates each group of components as one task, returns when all groups have been simulated
+//! @param rComponentGroups Vector with groups of components, the components in each group are simulated in order
+//! @param stopTime Time to simulate to
+void WorkerThreadPool::simulateComponentGroups(std::vector<std::vector<Component *> > &rComponentGroups, double stopTime)
+{
+    dispatch(0, &rComponentGroups, rComponentGroups.size(), stopTime);
+}
+
+
+void WorkerThreadPool::dispatch(std::vector<Component *> *pComponentPtrs, std::vector<std::vector<Component *> > *pComponentGroups, size_t nTasks, double stopTime)
+{
+    if(mWorkers.empty() || nTasks < 2)
+    {
+        // Nothing to gain from waking the workers
+        for(size_t i=0; i<nTasks; ++i)
+        {
+            if(pComponentPtrs)
+                simOneComponentOneStep((*pComponentPtrs)[i], stopTime);
+            else
+                simOneStep(&(*pComponentGroups)[i], stopTime);
+        }
+        return;
+    }
+
+    mpComponentPtrs = pComponentPtrs;
+    mpComponentGroups = pComponentGroups;
+    mnTasks = nTasks;
+    mStopTime = stopTime;
+    mNextTask.store(0);
+    mnFinishedWorkers.store(0);
+    mGeneration.fetch_add(1);       //Release the workers
+    if(mnSleepers.load() > 0)
+    {
+        futexWakeAll(&mGeneration);
+    }
+
+    runTasks();
+
+    // Wait for all workers to finish, they must not touch the job data after this point
+    while(mnFinishedWorkers.load() < mWorkers.size())
+    {
+        std::this_thread::yield();
+    }
+}
+
+
+void WorkerThreadPool::runTasks()
+{
+    for(size_t i=mNextTask.fetch_add(1); i<mnTasks; i=mNextTask.fetch_add(1))
+    {
+        if(mpComponentPtrs)
+            simOneComponentOneStep((*mpComponentPtrs)[i], mStopTime);
+        else
+            simOneStep(&(*mpComponentGroups)[i], mStopTime);
+    }
+}
+
+
+//! @brief Waits for the master to dispatch a step, by spinning for a while and then sleeping, and runs tasks until the pool is destroyed
+void WorkerThreadPool::workerLoop()
+{
+    int seenGeneration = 0;
+    while(true)
+    {
+        size_t spins=0;
+        int generation = mGeneration.load();
+        while(generation == seenGeneration)
+        {
+            if(spins < mSpinCount)
+            {
+                cpuRelax();
+                ++spins;
+            }
+            else
+            {
+                mnSleepers.fetch_add(1);
+                futexWait(&mGeneration, generation);
+                mnSleepers.fetch_sub(1);
+            }
+            generation = mGeneration.load();
+        }
+        seenGeneration = generation;
+        if(mStop.load())
+        {
+            return;
+        }
+
+        runTasks();
+        mnFinishedWorkers.fetch_add(1);
+    }
+}
+
+
+//! @brief Builds the schedule from the signal component dependency levels
+//! @details The components in a parallel level are distributed over the threads by their measured time (longest first,
+//! to the least loaded thread), components that have not been measured are distributed evenly by count.
+//! @param rLevels The signal components in each dependency level, in simulation order
+//! @param nThreads Number of simulation threads, including the master thread
+//! @param minLevelSize Levels with fewer components than this are simulated serially by the master thread
+void SignalWavefront::build(const std::vector<std::vector<Component *> > &rLevels, const size_t nThreads, const size_t minLevelSize)
+{
+    clear();
+    mThreadStages.resize(std::max(nThreads, size_t(1)));
+
+    for(size_t l=0; l<rLevels.size(); ++l)
+    {
+        const std::vector<Component*> &rLevel = rLevels[l];
+        const bool parallel = (mThreadStages.size() > 1) && (rLevel.size() >= std::max(minLevelSize, size_t(2)));
+
+        // Consecutive serial levels are simulated in order by the master thread without any barriers in between
+        if(!parallel && !mStages.empty() && !mParallelStages.back())
+        {
+            mStages.back().insert(mStages.back().end(), rLevel.begin(), rLevel.end());
+            mThreadStages[0].back().insert(mThreadStages[0].back().end(), rLevel.begin(), rLevel.end());
+            continue;
+        }
+
+        mStages.push_back(rLevel);
+        mParallelStages.push_back(parallel);
+        for(size_t t=0; t<mThreadStages.size(); ++t)
+        {
+            mThreadStages[t].push_back(std::vector<Component*>());
+        }
+
+        if(!parallel)
+        {
+            mThreadStages[0].back() = rLevel;
+            continue;
+        }
+
+        // Longest processing time first, ties (unmeasured components) go to the thread with the fewest components
+        std::vector< std::pair<double, size_t> > order(rLevel.size());
+        for(size_t i=0; i<rLevel.size(); ++i)
+        {
+            order[i] = std::make_pair(-rLevel[i]->getMeasuredTime(), i);
+        }
+        std::sort(order.begin(), order.end());
+        std::vector<double> threadTimes(mThreadStages.size(), 0.0);
+        std::vector<size_t> threadCounts(mThreadStages.size(), 0);
+        std::vector<size_t> owner(rLevel.size(), 0);
+        for(size_t o=0; o<order.size(); ++o)
+        {
+            size_t best=0;
+            for(size_t t=1; t<mThreadStages.size(); ++t)
+            {
+                if((threadTimes[t] < threadTimes[best]) || ((threadTimes[t] == threadTimes[best]) && (threadCounts[t] < threadCounts[best])))
+                {
+                    best = t;
+                }
+            }
+            owner[order[o].second] = best;
+            threadTimes[best] -= order[o].first;
+            ++threadCounts[best];
+        }
+
+        // Keep the level order within each thread
+        for(size_t i=0; i<rLevel.size(); ++i)
+        {
+            mThreadStages[owner[i]].back().push_back(rLevel[i]);
+        }
+    }
+}
+
+
+//! @brief Removes all stages
+void SignalWavefront::clear()
+{
+    mStages.clear();
+    mParallelStages.clear();
+    mThreadStages.clear();
+}
+
+
+//! @brief Returns the number of stages, the threads synchronize between each stage
+size_t SignalWavefront::getNumStages() const
+{
+    return mStages.size();
+}
+
+
+//! @brief Returns the number of stages that are simulated in parallel
+size_t SignalWavefront::getNumParallelStages() const
+{
+    return size_t(std::count(mParallelStages.begin(), mParallelStages.end(), true));
+}
+
+
+//! @brief Check if a stage is simulated in parallel, otherwise it is simulated by the master thread
+bool SignalWavefront::isParallelStage(const size_t stage) const
+{
+    return mParallelStages[stage];
+}
+
+
+//! @brief Returns all components in a stage, in simulation order
+std::vector<Component *> &SignalWavefront::getStageComponents(const size_t stage)
+{
+    return mStages[stage];
+}
+
+
+//! @brief Returns the components of each stage that are simulated by one thread (thread 0 is the master)
+std::vector<std::vector<Component *> > &SignalWavefront::getThreadStages(const size_t thread)
+{
+    return mThreadStages[thread];
+}
+
+
 //! @brief Function for simulating whole systems multi-threaded
 //! @param systemPtrs Vector with pointers to the systems to simulate
 //! @param stopTime Stop time of simulation
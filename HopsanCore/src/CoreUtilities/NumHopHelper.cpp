@@ -27,6 +27,7 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include "CoreUtilities/NumHopHelper.h"
+#include "CoreUtilities/CompiledNumHopScript.h"
 #include "ComponentSystem.h"
 #include "CoreUtilities/StringUtilities.h"
 #include "ComponentUtilities/num2string.hpp"
@@ -79,6 +80,16 @@ public:
         mRegisteredDataPtrs.insert(std::pair<HString,double*>(name, pData));
     }
 
+    double *getRegisteredDataPtr(const HString &name) const
+    {
+        std::map<HString, double*>::const_iterator it = mRegisteredDataPtrs.find(name);
+        if (it != mRegisteredDataPtrs.end())
+        {
+            return it->second;
+        }
+        return 0;
+    }
+
 protected:
     std::map<HString, double*> mRegisteredDataPtrs;
 };
@@ -309,6 +320,39 @@ private:
     Component *mpComponent;
 };
 
+//! @brief Resolves names when compiling, registered data pointers are used directly and other values are read once
+class HopsanCompileResolver : public CompiledNumHopScript::Resolver
+{
+public:
+    HopsanCompileResolver(HopsanParameterAccessBase *pHopsanAccess)
+    {
+        mpHopsanAccess = pHopsanAccess;
+    }
+
+    double *getDataPtr(const HString &rName)
+    {
+        return mpHopsanAccess ? mpHopsanAccess->getRegisteredDataPtr(rName) : 0;
+    }
+
+    bool getConstantValue(const HString &rName, double &rValue)
+    {
+        if (rName == "pi")
+        {
+            rValue = M_PI;
+            return true;
+        }
+        bool found = false;
+        if (mpHopsanAccess)
+        {
+            rValue = mpHopsanAccess->externalValue(rName.c_str(), found);
+        }
+        return found;
+    }
+
+private:
+    HopsanParameterAccessBase *mpHopsanAccess;
+};
+
 namespace hopsan {
 
 class NumHopHelperPrivate
@@ -318,6 +362,8 @@ public:
     numhop::VariableStorage mVarStorage;
     HopsanParameterAccessBase *mpHopsanAccess;
     std::list<numhop::Expression> mExpressions;
+    std::vector<HString> mExpressionRows;
+    CompiledNumHopScript mCompiledScript;
 };
 
 }
@@ -345,6 +391,7 @@ NumHopHelper::~NumHopHelper()
 void NumHopHelper::setSystem(ComponentSystem *pSystem)
 {
     mpSystem = pSystem;
+    mpPrivate->mCompiledScript.clear();
 
     if (mpPrivate->mpHopsanAccess)
     {
@@ -358,6 +405,7 @@ void NumHopHelper::setSystem(ComponentSystem *pSystem)
 void NumHopHelper::setComponent(Component *pComponent)
 {
     mpComponent = pComponent;
+    mpPrivate->mCompiledScript.clear();
 
     if (mpPrivate->mpHopsanAccess)
     {
@@ -374,6 +422,8 @@ void NumHopHelper::registerDataPtr(const HString &name, double *pData)
     {
         mpPrivate->mpHopsanAccess->registerDataPointer(name, pData);
     }
+    // The compiled script may use the old meaning of the name
+    mpPrivate->mCompiledScript.clear();
 }
 
 bool NumHopHelper::evalNumHopScript(const HString &script, double &rValue, bool doPrintOutput, HString &rOutput)
@@ -397,10 +447,13 @@ bool NumHopHelper::interpretNumHopScript(const HString &script, bool doPrintOutp
 
     mpPrivate->mVarStorage.clearInternalVariables();
     mpPrivate->mExpressions.clear();
+    mpPrivate->mExpressionRows.clear();
+    mpPrivate->mCompiledScript.clear();
 
     bool allOK=true;
     for (list<string>::iterator it = expressions.begin(); it!=expressions.end(); ++it)
     {
+        mpPrivate->mExpressionRows.push_back(it->c_str());
         mpPrivate->mExpressions.push_back(numhop::Expression());
         bool interpretOK = numhop::interpretExpressionStringRecursive(*it, mpPrivate->mExpressions.back());
         if (!interpretOK)
@@ -421,8 +474,33 @@ bool NumHopHelper::interpretNumHopScript(const HString &script, bool doPrintOutp
     return allOK;
 }
 
+//! @brief Compile the interpreted script, so that eval() can run it without name lookups
+//! @details Registered data pointers are read and written on every evaluation, parameters and system parameters are read once when compiling.
+//! The script must be compiled again if parameters change. Scripts that use operators or functions that the compiler does not support,
+//! or that assign parameters, are not compiled. They are still interpreted by eval().
+//! @param[out] rError Describes why the script could not be compiled
+//! @returns True if the script was compiled
+bool NumHopHelper::compile(HString &rError)
+{
+    HopsanCompileResolver resolver(mpPrivate->mpHopsanAccess);
+    return mpPrivate->mCompiledScript.compile(mpPrivate->mExpressionRows, resolver, rError);
+}
+
+//! @brief Check if the interpreted script has been compiled
+bool NumHopHelper::isCompiled() const
+{
+    return mpPrivate->mCompiledScript.isCompiled();
+}
+
 bool NumHopHelper::eval(double &rValue, bool doPrintOutput, HString &rOutput)
 {
+    // The compiled script can not print the evaluated expressions
+    if (!doPrintOutput && mpPrivate->mCompiledScript.isCompiled())
+    {
+        rValue = mpPrivate->mCompiledScript.evaluate();
+        return true;
+    }
+
     bool allOK=!mpPrivate->mExpressions.empty();
     double value=-1;
     for (list<numhop::Expression>::iterator it = mpPrivate->mExpressions.begin(); it!=mpPrivate->mExpressions.end(); ++it)
@@ -27,10 +27,12 @@
 #include "CoreUtilities/SaveRestoreSimulationPoint.h"
 #include "ComponentSystem.h"
 #include "Component.h"
+#include "CoreUtilities/SimulationState.h"
 
 #include <vector>
 #include <fstream>
 #include <cstring>
+#include <stdint.h>
 
 using namespace hopsan;
 
@@ -63,7 +65,8 @@ void writePortData(Port *pPort, const HString &namePrefix, std::ofstream &rFile)
         size_t datalen = pDataVector->size();
         rFile.write(reinterpret_cast<char*>(&datalen), 2);
         rFile.write(fullName.c_str(), namelen);
-        rFile.write(reinterpret_cast<char*>(pDataVector->data()), datalen*sizeof(double));
+        // Use the node data values, the data vector is not up to date if a node data arena is used
+        rFile.write(reinterpret_cast<const char*>(pPort->getNodeDataValuesPtr(0)), datalen*sizeof(double));
     }
 }
 
@@ -119,9 +122,10 @@ void readPortData(std::ifstream &rFile, ComponentSystem *pRootSystem)
                 if (pPort)
                 {
                     std::vector<double> *pData = pPort->getDataVectorPtr();
+                    double *pValues = pPort->getNodeDataValuesPtr(0);
                     for (size_t d=0; d<std::min(datalength, pData->size()); ++d)
                     {
-                        pData->at(d) = pDataBuffer[d];
+                        pValues[d] = pDataBuffer[d];
                     }
                 }
             }
@@ -216,3 +220,293 @@ void hopsan::restoreSimulationPoint(HString fileName, ComponentSystem *pRootSyst
     }
     file.close();
 }
+
+
+/*
+ * Binary simulation snapshot
+ *
+ * Header
+ * Magic      Version  ByteOrderMark  SizeOfSizeT  Time
+ * 8-byte     4-byte   4-byte         4-byte       double
+ *
+ * Followed by one component record for the root system, records are nested for subsystems
+ *
+ * Component record
+ * NameLength  Name  NumPorts  PortRecords...  StateSize  State  NumSubComponents  ComponentRecords...
+ * 4-byte            4-byte                    8-byte                4-byte
+ *
+ * Port record
+ * NameLength  Name  NumSubPorts  (NumValues  Values (double))...
+ * 4-byte            4-byte        4-byte
+ *
+ * All values are written in native byte order, so a snapshot can only be restored on the same kind of machine
+ * */
+
+static const char gSnapshotMagic[8] = {'H','S','N','A','P','S','H','T'};
+static const uint32_t gSnapshotVersion = 1;
+static const uint32_t gSnapshotByteOrderMark = 0x01020304;
+
+static void writeSnapshotName(const HString &rName, SimulationStateWriter &rWriter)
+{
+    const uint32_t len = static_cast<uint32_t>(rName.size());
+    rWriter.write(len);
+    rWriter.write(rName.c_str(), len);
+}
+
+static bool readSnapshotName(SimulationStateReader &rReader, HString &rName)
+{
+    uint32_t len=0;
+    if (!rReader.read(len) || len > rReader.remaining())
+    {
+        return false;
+    }
+    rName = HString(rReader.data(), len);
+    return rReader.skip(len);
+}
+
+static void writeSnapshotComponent(Component *pComponent, std::vector<char> &rBuffer, SimulationStateWriter &rWriter)
+{
+    writeSnapshotName(pComponent->getName(), rWriter);
+
+    // Node data values of all ports, the node data values are used since the data vector is not up to date if a node data arena is used
+    const std::vector<Port*> ports = pComponent->getPortPtrVector();
+    rWriter.write(static_cast<uint32_t>(ports.size()));
+    for (size_t p=0; p<ports.size(); ++p)
+    {
+        writeSnapshotName(ports[p]->getName(), rWriter);
+        const uint32_t nSubPorts = static_cast<uint32_t>(ports[p]->getNumPorts());
+        rWriter.write(nSubPorts);
+        for (size_t s=0; s<nSubPorts; ++s)
+        {
+            const Node *pNode = ports[p]->getNodePtr(s);
+            const uint32_t nValues = pNode ? static_cast<uint32_t>(pNode->getNumDataVariables()) : 0;
+            rWriter.write(nValues);
+            if (nValues > 0)
+            {
+                rWriter.write(ports[p]->getNodeDataValuesPtr(s), nValues);
+            }
+        }
+    }
+
+    // Internal component state, the size is written first so that it can be skipped when restoring
+    const size_t sizePos = rBuffer.size();
+    rWriter.write(uint64_t(0));
+    pComponent->saveSimulationState(rWriter);
+    const uint64_t stateSize = rBuffer.size() - sizePos - sizeof(uint64_t);
+    std::memcpy(&rBuffer[sizePos], &stateSize, sizeof(uint64_t));
+
+    // Sub components
+    if (pComponent->isComponentSystem())
+    {
+        const std::vector<Component*> subComponents = static_cast<ComponentSystem*>(pComponent)->getSubComponents();
+        rWriter.write(static_cast<uint32_t>(subComponents.size()));
+        for (size_t c=0; c<subComponents.size(); ++c)
+        {
+            writeSnapshotComponent(subComponents[c], rBuffer, rWriter);
+        }
+    }
+    else
+    {
+        rWriter.write(uint32_t(0));
+    }
+}
+
+//! @brief Restore one component record, pComponent may be 0 in which case the record is skipped
+static bool readSnapshotComponent(SimulationStateReader &rReader, Component *pComponent, ComponentSystem *pRootSystem, const HString &rFullName)
+{
+    uint32_t nPorts=0;
+    if (!rReader.read(nPorts))
+    {
+        return false;
+    }
+    for (uint32_t p=0; p<nPorts; ++p)
+    {
+        HString portName;
+        uint32_t nSubPorts=0;
+        if (!readSnapshotName(rReader, portName) || !rReader.read(nSubPorts))
+        {
+            return false;
+        }
+        Port *pPort = pComponent ? pComponent->getPort(portName) : 0;
+        if (pComponent && !pPort)
+        {
+            pRootSystem->addWarningMessage("Simulation snapshot contains unknown port: "+rFullName+"#"+portName);
+        }
+        for (uint32_t s=0; s<nSubPorts; ++s)
+        {
+            uint32_t nValues=0;
+            if (!rReader.read(nValues) || nValues*sizeof(double) > rReader.remaining())
+            {
+                return false;
+            }
+            const Node *pNode = (pPort && s < pPort->getNumPorts()) ? pPort->getNodePtr(s) : 0;
+            if (pNode && pNode->getNumDataVariables() == nValues)
+            {
+                rReader.read(pPort->getNodeDataValuesPtr(s), nValues);
+            }
+            else
+            {
+                if (pPort)
+                {
+                    pRootSystem->addWarningMessage("Simulation snapshot data does not match port: "+rFullName+"#"+portName);
+                }
+                rReader.skip(nValues*sizeof(double));
+            }
+        }
+    }
+
+    uint64_t stateSize=0;
+    if (!rReader.read(stateSize) || stateSize > rReader.remaining())
+    {
+        return false;
+    }
+    if (pComponent)
+    {
+        SimulationStateReader stateReader(rReader.data(), size_t(stateSize));
+        if (!pComponent->restoreSimulationState(stateReader) || !stateReader.isOk() || (stateReader.remaining() != 0))
+        {
+            pRootSystem->addWarningMessage("Could not restore the internal simulation state of: "+rFullName);
+        }
+    }
+    rReader.skip(size_t(stateSize));
+
+    uint32_t nSubComponents=0;
+    if (!rReader.read(nSubComponents))
+    {
+        return false;
+    }
+    ComponentSystem *pSystem = (pComponent && pComponent->isComponentSystem()) ? static_cast<ComponentSystem*>(pComponent) : 0;
+    for (uint32_t c=0; c<nSubComponents; ++c)
+    {
+        HString name;
+        if (!readSnapshotName(rReader, name))
+        {
+            return false;
+        }
+        Component *pSubComponent = pSystem ? pSystem->getSubComponent(name) : 0;
+        if (pSystem && !pSubComponent)
+        {
+            pRootSystem->addWarningMessage("Simulation snapshot contains unknown component: "+rFullName+"/"+name);
+        }
+        if (!readSnapshotComponent(rReader, pSubComponent, pRootSystem, rFullName+"/"+name))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readSnapshotHeader(SimulationStateReader &rReader, double &rTime)
+{
+    char magic[8];
+    uint32_t version=0, byteOrderMark=0, sizeOfSizeT=0;
+    rReader.read(magic, 8);
+    rReader.read(version);
+    rReader.read(byteOrderMark);
+    rReader.read(sizeOfSizeT);
+    rReader.read(rTime);
+    return rReader.isOk() && (std::memcmp(magic, gSnapshotMagic, 8) == 0) && (version == gSnapshotVersion) &&
+           (byteOrderMark == gSnapshotByteOrderMark) && (sizeOfSizeT == sizeof(size_t));
+}
+
+//! @brief Save a binary snapshot of the simulation state of a system to memory
+//! @details The snapshot contains the current time, the node data values of all ports and the internal state of all components
+//! that implement Component::saveSimulationState(), for the system and all subsystems
+//! @param[in] pRootSystem The system to save
+//! @param[out] rBuffer The buffer to write the snapshot to, any previous contents are replaced but the memory is reused
+//! @returns True if successful
+bool hopsan::saveSimulationSnapshot(ComponentSystem *pRootSystem, std::vector<char> &rBuffer)
+{
+    if (!pRootSystem)
+    {
+        return false;
+    }
+    rBuffer.clear();
+    SimulationStateWriter writer(rBuffer);
+    writer.write(gSnapshotMagic, 8);
+    writer.write(gSnapshotVersion);
+    writer.write(gSnapshotByteOrderMark);
+    writer.write(static_cast<uint32_t>(sizeof(size_t)));
+    writer.write(pRootSystem->getTime());
+    writeSnapshotComponent(pRootSystem, rBuffer, writer);
+    return true;
+}
+
+//! @brief Restore a binary snapshot of the simulation state to a system
+//! @details The system must contain the same model as the system that was saved, and it must have been initialized (the restored state
+//! would otherwise be overwritten by initialize). Components, ports and states are matched by name, unknown ones give a warning and
+//! are skipped. The time is not restored, use getSimulationSnapshotTime() to get the start time to initialize with. Note that the log
+//! sample taken by initialize() holds the values from before the restore.
+//! @param[in] rBuffer The snapshot
+//! @param[in] pRootSystem The system to restore into
+//! @returns False if the snapshot is invalid or truncated
+bool hopsan::restoreSimulationSnapshot(const std::vector<char> &rBuffer, ComponentSystem *pRootSystem)
+{
+    if (!pRootSystem)
+    {
+        return false;
+    }
+    SimulationStateReader reader(rBuffer.data(), rBuffer.size());
+    double time;
+    HString rootName;
+    if (!readSnapshotHeader(reader, time) || !readSnapshotName(reader, rootName))
+    {
+        pRootSystem->addErrorMessage("Invalid simulation snapshot");
+        return false;
+    }
+    if (!readSnapshotComponent(reader, pRootSystem, pRootSystem, pRootSystem->getName()) || (reader.remaining() != 0))
+    {
+        pRootSystem->addErrorMessage("The simulation snapshot is truncated or corrupt");
+        return false;
+    }
+    return true;
+}
+
+//! @brief Read the simulation time when a binary snapshot was saved
+//! @param[in] rBuffer The snapshot
+//! @param[out] rTime The time
+//! @returns False if the snapshot is invalid
+bool hopsan::getSimulationSnapshotTime(const std::vector<char> &rBuffer, double &rTime)
+{
+    SimulationStateReader reader(rBuffer.data(), rBuffer.size());
+    return readSnapshotHeader(reader, rTime);
+}
+
+//! @brief Save a binary snapshot of the simulation state of a system to file
+//! @see saveSimulationSnapshot(ComponentSystem*, std::vector<char>&)
+bool hopsan::saveSimulationSnapshot(const HString &rFileName, ComponentSystem *pRootSystem)
+{
+    std::vector<char> buffer;
+    if (!saveSimulationSnapshot(pRootSystem, buffer))
+    {
+        return false;
+    }
+    std::ofstream file(rFileName.c_str(), std::ios::binary);
+    if (!file.is_open())
+    {
+        pRootSystem->addErrorMessage("Could not open simulation snapshot file: "+rFileName);
+        return false;
+    }
+    file.write(buffer.data(), buffer.size());
+    return file.good();
+}
+
+//! @brief Load a binary snapshot from file, to be restored with restoreSimulationSnapshot()
+//! @param[in] rFileName The file to read
+//! @param[out] rBuffer The snapshot
+//! @returns False if the file could not be read or is not a snapshot
+bool hopsan::loadSimulationSnapshot(const HString &rFileName, std::vector<char> &rBuffer)
+{
+    std::ifstream file(rFileName.c_str(), std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    const std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    rBuffer.resize(size_t(size));
+    file.read(rBuffer.data(), size);
+    double time;
+    return file.good() && getSimulationSnapshotTime(rBuffer, time);
+}
@@ -0,0 +1,478 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   SimulationEnsemble.cpp
+//! @date   2026-10-18
+//!
+//! @brief Contains the simulation ensemble class, used to simulate many parameter variants of one model together
+//!
+//$Id$
+
+#include "CoreUtilities/SimulationEnsemble.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
+#include "CoreUtilities/HopsanCoreMessageHandler.h"
+#include "ComponentSystem.h"
+#include "HopsanEssentials.h"
+#include "ComponentUtilities/num2string.hpp"
+#include <algorithm>
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+#include <thread>
+#endif
+
+using namespace hopsan;
+
+//! @brief Constructor
+//! @param[in] pHopsanEssentials The HopsanEssentials instance used to load the variants
+SimulationEnsemble::SimulationEnsemble(HopsanEssentials *pHopsanEssentials)
+{
+    mpHopsanEssentials = pHopsanEssentials;
+    mModelStartTime = 0;
+    mModelStopTime = 0;
+    mnThreads = 1;
+    mLockstep = false;
+}
+
+SimulationEnsemble::~SimulationEnsemble()
+{
+    clear();
+}
+
+//! @brief Loads the variants of the ensemble from a model, any existing variants are removed
+//! @details The model is only parsed once, the other variants are copies of the first one
+//! @param[in] xmlString The model xml string
+//! @param[in] nVariants The number of variants to create
+//! @returns True if all variants were loaded successfully
+bool SimulationEnsemble::loadModel(const char *xmlString, const size_t nVariants)
+{
+    clear();
+    for (size_t v=0; v<nVariants; ++v)
+    {
+        ComponentSystem *pVariant;
+        if (v == 0)
+        {
+            pVariant = mpHopsanEssentials->loadHMFModel(xmlString, mModelStartTime, mModelStopTime);
+        }
+        else
+        {
+            pVariant = mVariants.front()->clone();
+        }
+        if (!pVariant)
+        {
+            mpHopsanEssentials->getCoreMessageHandler()->addErrorMessage("Could not load variant "+to_hstring(v)+" of the simulation ensemble");
+            clear();
+            return false;
+        }
+        mVariants.push_back(pVariant);
+    }
+    return true;
+}
+
+//! @brief Removes and deletes all variants
+void SimulationEnsemble::clear()
+{
+    releaseNodeDataLayout();
+    for (size_t v=0; v<mVariants.size(); ++v)
+    {
+        mpHopsanEssentials->removeComponent(mVariants[v]);
+    }
+    mVariants.clear();
+    mThreadFirstVariants.clear();
+    mLockstep = false;
+}
+
+//! @brief Returns the number of variants in the ensemble
+size_t SimulationEnsemble::getNumVariants() const
+{
+    return mVariants.size();
+}
+
+//! @brief Returns one variant, use it to set parameters before initialize and to read its results after the simulation
+//! @param[in] variant The variant index
+//! @returns The root system of the variant, or 0 if the index is out of range
+ComponentSystem *SimulationEnsemble::getVariant(const size_t variant) const
+{
+    if (variant < mVariants.size())
+    {
+        return mVariants[variant];
+    }
+    return 0;
+}
+
+//! @brief Returns the start time stored in the loaded model
+double SimulationEnsemble::getModelStartTime() const
+{
+    return mModelStartTime;
+}
+
+//! @brief Returns the stop time stored in the loaded model
+double SimulationEnsemble::getModelStopTime() const
+{
+    return mModelStopTime;
+}
+
+//! @brief Sets a parameter value in one variant
+//! @param[in] variant The variant index
+//! @param[in] rComponentName The name of a component in the root system, or an empty string for a system parameter
+//! @param[in] rParameterName The parameter name
+//! @param[in] rValue The new value
+//! @returns True if the parameter was set
+bool SimulationEnsemble::setParameterValue(const size_t variant, const HString &rComponentName, const HString &rParameterName, const HString &rValue)
+{
+    ComponentSystem *pVariant = getVariant(variant);
+    if (!pVariant)
+    {
+        return false;
+    }
+    Component *pComponent = rComponentName.empty() ? pVariant : pVariant->getSubComponent(rComponentName);
+    if (!pComponent)
+    {
+        pVariant->addErrorMessage("No component named "+rComponentName+" in ensemble variant "+to_hstring(variant));
+        return false;
+    }
+    return pComponent->setParameterValue(rParameterName, rValue);
+}
+
+//! @brief Set the number of threads that simulate the variants, each thread simulates a range of variants
+//! @param[in] nDesiredThreads The desired number of threads, limited by the number of cores and variants, 0 = one per core
+void SimulationEnsemble::setNumThreads(const size_t nDesiredThreads)
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    mnThreads = determineActualNumberOfThreads(nDesiredThreads);
+#else
+    HOPSAN_UNUSED(nDesiredThreads)
+    mnThreads = 1;
+#endif
+}
+
+//! @brief Returns the number of threads that simulate the variants
+size_t SimulationEnsemble::getNumThreads() const
+{
+    return mnThreads;
+}
+
+//! @brief Initializes all variants
+//! @details The node data of the variants is moved to the ensemble before the variants are initialized, the node data arena
+//! setting of the variants is therefore not used
+//! @param[in] startT The start time
+//! @param[in] stopT The stop time
+//! @returns True if all variants were initialized successfully
+bool SimulationEnsemble::initialize(const double startT, const double stopT)
+{
+    if (mVariants.empty())
+    {
+        return false;
+    }
+
+    // Split the variants in ranges, one per thread
+    const size_t nThreads = std::max(size_t(1), std::min(mnThreads, mVariants.size()));
+    mThreadFirstVariants.clear();
+    for (size_t t=0; t<=nThreads; ++t)
+    {
+        mThreadFirstVariants.push_back(t*mVariants.size()/nThreads);
+    }
+
+    for (size_t v=0; v<mVariants.size(); ++v)
+    {
+        mVariants[v]->setUseNodeDataArena(false);
+    }
+    buildNodeDataLayout();
+
+    for (size_t v=0; v<mVariants.size(); ++v)
+    {
+        if (!mVariants[v]->checkModelBeforeSimulation() || !mVariants[v]->initialize(startT, stopT))
+        {
+            mVariants[v]->addErrorMessage("Could not initialize ensemble variant "+to_hstring(v));
+            return false;
+        }
+    }
+
+    mLockstep = determineLockstep();
+    if (!mLockstep)
+    {
+        mVariants[0]->addWarningMessage("The ensemble variants differ in structure or time step, they are simulated one by one");
+    }
+    return true;
+}
+
+//! @brief Simulates all variants until the given stop time
+//! @param[in] stopT The stop time
+//! @returns False if any of the variants was aborted, else true
+bool SimulationEnsemble::simulate(const double stopT)
+{
+    const size_t nThreads = (mThreadFirstVariants.empty()) ? 0 : mThreadFirstVariants.size()-1;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    if (nThreads > 1)
+    {
+        std::vector<std::thread> threads;
+        for (size_t t=1; t<nThreads; ++t)
+        {
+            threads.push_back(std::thread(&SimulationEnsemble::simulateVariants, this, mThreadFirstVariants[t], mThreadFirstVariants[t+1], stopT));
+        }
+        simulateVariants(mThreadFirstVariants[0], mThreadFirstVariants[1], stopT);
+        for (size_t t=0; t<threads.size(); ++t)
+        {
+            threads[t].join();
+        }
+    }
+    else
+#endif
+    if (nThreads > 0)
+    {
+        simulateVariants(0, mVariants.size(), stopT);
+    }
+
+    bool ok = true;
+    for (size_t v=0; v<mVariants.size(); ++v)
+    {
+        ok = ok && !mVariants[v]->wasSimulationAborted();
+    }
+    return ok;
+}
+
+//! @brief Finalizes all variants, the node data of each variant is copied back to its nodes
+void SimulationEnsemble::finalize()
+{
+    for (size_t n=0; n<mNodeDataNodes.size(); ++n)
+    {
+        mNodeDataNodes[n]->copyDataValuesToDataVector();
+    }
+    for (size_t v=0; v<mVariants.size(); ++v)
+    {
+        mVariants[v]->finalize();
+    }
+}
+
+//! @brief Check if the variants are simulated in lockstep, this is determined in initialize
+bool SimulationEnsemble::isLockstep() const
+{
+    return mLockstep;
+}
+
+//! @brief Collects the nodes of a system and all its subsystems, in a deterministic order
+void SimulationEnsemble::collectNodes(ComponentSystem *pSystem, std::vector<Node*> &rNodes)
+{
+    rNodes.insert(rNodes.end(), pSystem->mSubNodePtrs.begin(), pSystem->mSubNodePtrs.end());
+    ComponentSystem::SubComponentMapT::iterator it;
+    for (it=pSystem->mSubComponentMap.begin(); it!=pSystem->mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
+        {
+            collectNodes(static_cast<ComponentSystem*>(it->second), rNodes);
+        }
+    }
+}
+
+//! @brief Moves the node data of all variants into one block
+//! @details Within each thread range, the data of a node is followed by the data of the same node in the next variant.
+//! Each thread range starts on a new cache line. If the variants do not have the same nodes, the node data is left in the nodes.
+void SimulationEnsemble::buildNodeDataLayout()
+{
+    releaseNodeDataLayout();
+
+    std::vector< std::vector<Node*> > variantNodes(mVariants.size());
+    for (size_t v=0; v<mVariants.size(); ++v)
+    {
+        collectNodes(mVariants[v], variantNodes[v]);
+        if (variantNodes[v].size() != variantNodes[0].size())
+        {
+            return;
+        }
+        for (size_t n=0; n<variantNodes[v].size(); ++n)
+        {
+            if (variantNodes[v][n]->getNumDataVariables() != variantNodes[0][n]->getNumDataVariables())
+            {
+                return;
+            }
+        }
+    }
+
+    const size_t valuesPerCacheLine = HOPSAN_CACHE_LINE_SIZE/sizeof(double);
+    std::vector<size_t> offsets;
+    size_t nValues = 0;
+    for (size_t t=0; t+1<mThreadFirstVariants.size(); ++t)
+    {
+        nValues = (nValues+valuesPerCacheLine-1)/valuesPerCacheLine*valuesPerCacheLine;
+        for (size_t n=0; n<variantNodes[0].size(); ++n)
+        {
+            for (size_t v=mThreadFirstVariants[t]; v<mThreadFirstVariants[t+1]; ++v)
+            {
+                mNodeDataNodes.push_back(variantNodes[v][n]);
+                offsets.push_back(nValues);
+                nValues += variantNodes[v][n]->getNumDataVariables();
+            }
+        }
+    }
+
+    // Over-allocate by one cache line so that the data can be aligned
+    mNodeDataStorage.resize(nValues+valuesPerCacheLine, 0.0);
+    double *pBase = mNodeDataStorage.data();
+    const size_t misalignment = (reinterpret_cast<size_t>(pBase)/sizeof(double))%valuesPerCacheLine;
+    if (misalignment != 0)
+    {
+        pBase += valuesPerCacheLine-misalignment;
+    }
+    for (size_t n=0; n<mNodeDataNodes.size(); ++n)
+    {
+        mNodeDataNodes[n]->setDataStorage(pBase+offsets[n]);
+    }
+}
+
+//! @brief Moves the node data back to the nodes and frees the ensemble node data block
+void SimulationEnsemble::releaseNodeDataLayout()
+{
+    for (size_t n=0; n<mNodeDataNodes.size(); ++n)
+    {
+        mNodeDataNodes[n]->setDataStorage(0);
+    }
+    mNodeDataNodes.clear();
+    std::vector<double>().swap(mNodeDataStorage);
+}
+
+//! @brief Check if all variants have the same components (by type) in the same simulation order and the same time step
+bool SimulationEnsemble::determineLockstep() const
+{
+    const ComponentSystem *pFirst = mVariants[0];
+    for (size_t v=1; v<mVariants.size(); ++v)
+    {
+        const ComponentSystem *pVariant = mVariants[v];
+        if ((pVariant->mTimestep != pFirst->mTimestep) || (pVariant->mTime != pFirst->mTime) ||
+            (pVariant->mComponentSignalptrs.size() != pFirst->mComponentSignalptrs.size()) ||
+            (pVariant->mComponentCptrs.size() != pFirst->mComponentCptrs.size()) ||
+            (pVariant->mComponentQptrs.size() != pFirst->mComponentQptrs.size()))
+        {
+            return false;
+        }
+        for (size_t s=0; s<pFirst->mComponentSignalptrs.size(); ++s)
+        {
+            if (pVariant->mComponentSignalptrs[s]->getTypeName() != pFirst->mComponentSignalptrs[s]->getTypeName())
+            {
+                return false;
+            }
+        }
+        for (size_t c=0; c<pFirst->mComponentCptrs.size(); ++c)
+        {
+            if (pVariant->mComponentCptrs[c]->getTypeName() != pFirst->mComponentCptrs[c]->getTypeName())
+            {
+                return false;
+            }
+        }
+        for (size_t q=0; q<pFirst->mComponentQptrs.size(); ++q)
+        {
+            if (pVariant->mComponentQptrs[q]->getTypeName() != pFirst->mComponentQptrs[q]->getTypeName())
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//! @brief Simulates a range of variants until the given stop time
+//! @details In lockstep each component is simulated in all variants before the next component. A variant that is aborted
+//! is left at its current time while the others continue.
+//! @param[in] firstVariant The first variant in the range
+//! @param[in] endVariant One past the last variant in the range
+//! @param[in] stopT The stop time
+void SimulationEnsemble::simulateVariants(const size_t firstVariant, const size_t endVariant, const double stopT)
+{
+    if (!mLockstep)
+    {
+        for (size_t v=firstVariant; v<endVariant; ++v)
+        {
+            mVariants[v]->simulate(stopT);
+        }
+        return;
+    }
+
+    std::vector<ComponentSystem*> active(mVariants.begin()+firstVariant, mVariants.begin()+endVariant);
+    if (active.empty())
+    {
+        return;
+    }
+    const size_t nSteps = active[0]->calcNumSimSteps(active[0]->mTime, stopT);
+    const size_t nS = active[0]->mComponentSignalptrs.size();
+    const size_t nC = active[0]->mComponentCptrs.size();
+    const size_t nQ = active[0]->mComponentQptrs.size();
+
+    for (size_t i=0; i<nSteps; ++i)
+    {
+        // Stop stepping variants that have been aborted
+        for (size_t v=0; v<active.size();)
+        {
+            if (active[v]->mStopSimulation)
+            {
+                active.erase(active.begin()+v);
+            }
+            else
+            {
+                ++v;
+            }
+        }
+        const size_t nActive = active.size();
+        if (nActive == 0)
+        {
+            break;
+        }
+
+        for (size_t v=0; v<nActive; ++v)
+        {
+            active[v]->mTime += active[v]->mTimestep;
+        }
+
+        //Signal components
+        for (size_t s=0; s<nS; ++s)
+        {
+            for (size_t v=0; v<nActive; ++v)
+            {
+                active[v]->mComponentSignalptrs[s]->simulate(active[v]->mTime);
+            }
+        }
+
+        //C components
+        for (size_t c=0; c<nC; ++c)
+        {
+            for (size_t v=0; v<nActive; ++v)
+            {
+                active[v]->mComponentCptrs[c]->simulate(active[v]->mTime);
+            }
+        }
+
+        //Q components
+        for (size_t q=0; q<nQ; ++q)
+        {
+            for (size_t v=0; v<nActive; ++v)
+            {
+                active[v]->mComponentQptrs[q]->simulate(active[v]->mTime);
+            }
+        }
+
+        for (size_t v=0; v<nActive; ++v)
+        {
+            ++active[v]->mTotalTakenSimulationSteps;
+            active[v]->logTimeAndNodes(active[v]->mTotalTakenSimulationSteps);
+        }
+    }
+}
@@ -38,6 +38,7 @@
 #include <fstream>
 #include <cassert>
 #include <iostream>
+#include <algorithm>
 #include <sstream>
 #include "Node.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
@@ -46,16 +47,27 @@
 #include "Quantities.h"
 
 namespace {
-bool anyPortWantsLogging(std::vector<hopsan::Port*>& ports)
+//! @brief Determine which node data variables any of the ports wants to log
+//! @returns True if at least one variable should be logged
+bool anyPortWantsLogging(std::vector<hopsan::Port*>& ports, const size_t nVariables, std::vector<bool> &rLogMask)
 {
+    rLogMask.assign(nVariables, false);
+    bool any = false;
     for (size_t p=0; p<ports.size(); ++p)
     {
         if (ports[p]->isLoggingEnabled())
         {
-            return true;
+            for (size_t v=0; v<nVariables; ++v)
+            {
+                if (!rLogMask[v] && ports[p]->isVariableLoggingEnabled(v))
+                {
+                    rLogMask[v] = true;
+                    any = true;
+                }
+            }
         }
     }
-    return false;
+    return any;
 }
 }
 
@@ -80,8 +92,10 @@ Node::Node(const size_t datalength)
     // Resize
     mDataDescriptions.resize(datalength);
     mDataValues.resize(datalength,0.0);
+    mpDataValues = mDataValues.data();
 
     // Default disabled logging
+    mLogIntervalCount = 0;
     setDoLogIfEnabled(false);
 }
 
@@ -114,7 +128,42 @@ size_t Node::getNumDataVariables() const
 
 double *Node::getDataPtr(const size_t data_type)
 {
-    return &mDataValues[data_type];
+    return &mpDataValues[data_type];
+}
+
+
+//! @brief Moves the data values to external storage, or back to the node's own data vector
+//! @details The current values are copied to the new location. Pointers to the old location are no longer updated.
+//! @param [in] pStorage Pointer to storage for getNumDataVariables() values, or 0 to use the node's own data vector
+void Node::setDataStorage(double *pStorage)
+{
+    if (pStorage == 0)
+    {
+        copyDataValuesToDataVector();
+        mpDataValues = mDataValues.data();
+    }
+    else if (pStorage != mpDataValues)
+    {
+        std::copy(mpDataValues, mpDataValues+mDataValues.size(), pStorage);
+        mpDataValues = pStorage;
+    }
+}
+
+
+//! @brief Check if the data values are stored outside of the node's own data vector
+bool Node::hasExternalDataStorage() const
+{
+    return (mpDataValues != mDataValues.data());
+}
+
+
+//! @brief Copies the data values from external storage to the node's own data vector (so that data vector accessors are up to date)
+void Node::copyDataValuesToDataVector()
+{
+    if (hasExternalDataStorage())
+    {
+        std::copy(mpDataValues, mpDataValues+mDataValues.size(), mDataValues.begin());
+    }
 }
 
 
@@ -234,7 +283,7 @@ void Node::copyNodeDataValuesTo(Node *pOtherNode) const
         for(size_t i=0; i<pOtherNode->getNumDataVariables(); ++i)
         {
             //! @todo look over if all vector positions should be set or not.
-            pOtherNode->mDataValues[i] = mDataValues[i];
+            pOtherNode->mpDataValues[i] = mpDataValues[i];
         }
         setTLMNodeDataValuesTo(pOtherNode); //Handles Wave, imp variables and similar
     }
@@ -259,15 +308,96 @@ void Node::setTLMNodeDataValuesTo(Node* /*pOtherNode*/) const
 
 
 //! @brief Pre allocate memory for the needed amount of log data
-void Node::preAllocateLogSpace(const size_t nLogSlots)
+//! @param [in] nLogSlots The number of log samples
+//! @param [in] logEnvelope Also allocate storage for the min and max values in each log interval
+void Node::preAllocateLogSpace(const size_t nLogSlots, const bool logEnvelope)
 {
     // Don't try to allocate if we are not going to log
     if (mDoLog)
     {
-        mDataStorage.resize(nLogSlots, vector<double>(mDataValues.size()));
+        mDataStorage.resize(nLogSlots, mDataValues.size(), mLogMask);
+        if (logEnvelope)
+        {
+            mMinDataStorage.resize(nLogSlots, mDataValues.size(), mLogMask);
+            mMaxDataStorage.resize(nLogSlots, mDataValues.size(), mLogMask);
+        }
+        else
+        {
+            mMinDataStorage.clear();
+            mMaxDataStorage.clear();
+        }
+        mLogIntervalMin.resize(mDataValues.size());
+        mLogIntervalMax.resize(mDataValues.size());
+        mLogIntervalSum.resize(mDataValues.size());
+        mLogIntervalCount = 0;
     }
 }
 
+//! @brief Accumulate the current data values into the min, max and sum of the current log interval
+void Node::accumulateLogData()
+{
+    if (mDoLog)
+    {
+        const size_t n = mDataValues.size();
+        if (mLogIntervalCount == 0)
+        {
+            for (size_t i=0; i<n; ++i)
+            {
+                mLogIntervalMin[i] = mLogIntervalMax[i] = mLogIntervalSum[i] = mpDataValues[i];
+            }
+        }
+        else
+        {
+            for (size_t i=0; i<n; ++i)
+            {
+                const double value = mpDataValues[i];
+                mLogIntervalMin[i] = std::min(mLogIntervalMin[i], value);
+                mLogIntervalMax[i] = std::max(mLogIntervalMax[i], value);
+                mLogIntervalSum[i] += value;
+            }
+        }
+        ++mLogIntervalCount;
+    }
+}
+
+//! @brief Write the accumulated log interval into log storage at given logslot and start a new interval
+//! @param [in] logSlot The log slot
+//! @param [in] logMean Log the interval mean instead of the current value
+//! @warning No bounds check is done
+void Node::logAccumulatedData(const size_t logSlot, const bool logMean)
+{
+    if (mDoLog)
+    {
+        if (logMean && mLogIntervalCount > 0)
+        {
+            for (size_t i=0; i<mLogIntervalSum.size(); ++i)
+            {
+                mLogIntervalSum[i] /= double(mLogIntervalCount);
+            }
+            mDataStorage.write(logSlot, mLogIntervalSum.data());
+        }
+        else
+        {
+            mDataStorage.write(logSlot, mpDataValues);
+        }
+
+        if (!mMinDataStorage.empty())
+        {
+            mMinDataStorage.write(logSlot, (mLogIntervalCount > 0) ? mLogIntervalMin.data() : mpDataValues);
+            mMaxDataStorage.write(logSlot, (mLogIntervalCount > 0) ? mLogIntervalMax.data() : mpDataValues);
+        }
+        mLogIntervalCount = 0;
+    }
+}
+
+//! @brief Reduce the log storage to the given number of log slots
+void Node::truncateLogData(const size_t nLogSlots)
+{
+    mDataStorage.truncate(nLogSlots);
+    mMinDataStorage.truncate(nLogSlots);
+    mMaxDataStorage.truncate(nLogSlots);
+}
+
 
 //! @brief Copy current data vector into log storage at given logslot
 //! @warning No bounds check is done
@@ -275,7 +405,7 @@ void Node::logData(const size_t logSlot)
 {
     if (mDoLog)
     {
-        mDataStorage[logSlot] = mDataValues;
+        mDataStorage.write(logSlot, mpDataValues);
     }
 }
 
@@ -370,7 +500,7 @@ Port *Node::getSortOrderSourcePort() const
 //! @param[in] doLog Flag that tags the node for logging or not
 void Node::setDoLogIfEnabled(bool doLog)
 {
-    if(doLog && anyPortWantsLogging(mConnectedPorts))
+    if(doLog && anyPortWantsLogging(mConnectedPorts, mDataValues.size(), mLogMask))
     {
         mDoLog = true;
     }
@@ -378,6 +508,8 @@ void Node::setDoLogIfEnabled(bool doLog)
     {
         mDoLog = false;
         mDataStorage.clear();
+        mMinDataStorage.clear();
+        mMaxDataStorage.clear();
     }
 }
 
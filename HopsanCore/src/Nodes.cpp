@@ -93,7 +93,9 @@ void NodeSignalND::setSignalNumDimensions(size_t numDims)
 {
     // Resize
     mDataDescriptions.resize(numDims);
+    setDataStorage(0);
     mDataValues.resize(numDims,0.0);
+    mpDataValues = mDataValues.data();
 
     // Set name
     HString nicename = "signal"+to_hstring(numDims)+"d";
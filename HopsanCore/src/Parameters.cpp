@@ -66,6 +66,8 @@ ParameterEvaluator::ParameterEvaluator(const HString &rName, const HString &rVal
                                        const HString &rType, void* pDataPtr, ParameterEvaluatorHandler* pParameterEvalHandler)
 {
     mDepthCounter=0;
+    mHasReferencedNames=false;
+    mpExpression=0;
     mParameterName = rName;
     mParameterValue = rValue;
     mDescription = rDescription;
@@ -78,6 +80,11 @@ ParameterEvaluator::ParameterEvaluator(const HString &rName, const HString &rVal
     evaluate();
 }
 
+ParameterEvaluator::~ParameterEvaluator()
+{
+    clearExpression();
+}
+
 
 //! @brief Returns a pointer directly to the parameter data variable
 //! @warning Don't use this function unless YOU REALLY KNOW WHAT YOU ARE DOING
@@ -115,10 +122,12 @@ bool ParameterEvaluator::setParameter(const HString &rValue, const HString &rDes
     {
         *pNeedEvaluation = this;
         mParameterValue = rValue;
+        clearExpression();
     }
     else if(!success)
     {
         mParameterValue = oldValue;
+        clearExpression();
         mDescription = oldDescription;
         mQuantity = oldQuantity;
         mUnit = oldUnit;
@@ -139,11 +148,13 @@ bool ParameterEvaluator::setParameterValue(const HString &rValue, ParameterEvalu
 
     HString oldValue = mParameterValue;
     mParameterValue = rValue;
+    clearExpression();
     HString evalResult = rValue;
     success = evaluate(evalResult);
     if(!success && !force)
     {
         mParameterValue = oldValue;
+        clearExpression();
     }
 
     if (ppNeedEvaluation) {
@@ -216,6 +227,7 @@ bool ParameterEvaluator::refreshParameterValueText()
             return false;
         }
         mParameterValue = ss.str().c_str();
+        clearExpression();
         return true;
     }
     return false;
@@ -315,7 +327,7 @@ bool ParameterEvaluator::evaluate(HString &rResult)
     // Use numhop expression evaluation for doubles
     else if (doCheckOthers)
     {
-        if (mpParameterEvaluatorHandler->evaluateParameterExpression(mParameterValue, evaluatedParameterValue)) {
+        if (evaluateExpression(evaluatedParameterValue)) {
             //evaluatedParameterValue = evaluatedParameterValue;  No point is self assignment, but comment left here for clarity
         }
         else {
@@ -460,6 +472,85 @@ const std::vector<HString> &ParameterEvaluator::getConditions() const
     return mConditions;
 }
 
+//! @brief Returns the names of other parameters that the parameter value refers to
+//! @details The value is parsed once, the names are kept until the value changes. Names beginning with "self." refer to
+//! parameters in the same component, other names refer to system parameters in parent systems. The names are the same
+//! as the ones evaluate() would look up, but unused alternatives may be included.
+//! @returns The referenced names, empty if the value is a plain number or boolean
+const std::vector<HString> &ParameterEvaluator::getReferencedNames()
+{
+    if (!mHasReferencedNames || (mReferencedNamesValue != mParameterValue))
+    {
+        mReferencedNames.clear();
+        if ((mType=="double") && !mParameterValue.isNummeric())
+        {
+            HVector<HString> names = NumHopHelper::extractNamedValues(mParameterValue);
+            for (size_t i=0; i<names.size(); ++i)
+            {
+                mReferencedNames.push_back(names[i]);
+            }
+        }
+        else if ((mType=="integer") && !mParameterValue.isNummeric())
+        {
+            HString signPrefix, name;
+            splitSignPrefix(mParameterValue, signPrefix, name);
+            mReferencedNames.push_back(name);
+        }
+        else if (((mType=="bool") && !mParameterValue.isBool()) || (mType=="string") || (mType=="textblock"))
+        {
+            mReferencedNames.push_back(mParameterValue);
+        }
+        mReferencedNamesValue = mParameterValue;
+        mHasReferencedNames = true;
+    }
+    return mReferencedNames;
+}
+
+//! @brief Evaluates the parameter value as a numhop expression
+//! @details The expression is interpreted on the first evaluation and kept until the value changes, so that repeated
+//! evaluations (e.g. when system parameters change) do not parse it again.
+//! @param [out] rEvaluatedParameterValue The value of the expression
+//! @returns true if the expression could be evaluated
+bool ParameterEvaluator::evaluateExpression(HString &rEvaluatedParameterValue)
+{
+    HString dummy;
+    double value;
+    bool evalOK;
+    if (mDepthCounter > 1)
+    {
+        // The kept expression is already being evaluated further up the stack (the parameter refers to itself)
+        NumHopHelper nh;
+        nh.setComponent(mpParameterEvaluatorHandler->getComponent());
+        evalOK = nh.evalNumHopScript(mParameterValue, value, false, dummy);
+    }
+    else
+    {
+        if (!mpExpression)
+        {
+            mpExpression = new NumHopHelper();
+            mpExpression->setComponent(mpParameterEvaluatorHandler->getComponent());
+            if (!mpExpression->interpretNumHopScript(mParameterValue, false, dummy))
+            {
+                clearExpression();
+                return false;
+            }
+        }
+        evalOK = mpExpression->eval(value, false, dummy);
+    }
+    if (evalOK)
+    {
+        rEvaluatedParameterValue = to_hstring(value);
+    }
+    return evalOK;
+}
+
+//! @brief Drops the interpreted value expression, it must be called whenever the value changes
+void ParameterEvaluator::clearExpression()
+{
+    delete mpExpression;
+    mpExpression = 0;
+}
+
 void ParameterEvaluator::resolveSignPrefix(HString &rSignPrefix) const
 {
     // Resolve prefix, check num -, ignore +
@@ -513,6 +604,7 @@ void ParameterEvaluator::splitSignPrefix(const HString &rString, HString &rPrefi
 ParameterEvaluatorHandler::ParameterEvaluatorHandler(Component* pComponent)
 {
     mComponent = pComponent;
+    mHasChangedParameters = true;
 }
 
 //! @brief Destructor
@@ -554,6 +646,7 @@ bool ParameterEvaluatorHandler::addParameter(const HString &rName, const HString
             if(success || force)
             {
                 mParameters.push_back(newParameter);
+                addChangedParameterName(rName);
                 success = true;
             }
             else
@@ -590,6 +683,7 @@ void ParameterEvaluatorHandler::deleteParameter(const HString &rName)
 
             delete *parIt;
             mParameters.erase(parIt);
+            addChangedParameterName(rName);
 
             // We can return now, since there should never be multiple parameters with same name
             return;
@@ -609,6 +703,8 @@ bool ParameterEvaluatorHandler::renameParameter(const HString &rOldName, const H
             if( rOldName == (*parIt)->getName() )
             {
                 (*parIt)->mParameterName = rNewName;
+                addChangedParameterName(rOldName);
+                addChangedParameterName(rNewName);
                 return true;
             }
         }
@@ -688,7 +784,13 @@ bool ParameterEvaluatorHandler::setParameter(const HString &rName, const HString
         if( (rName == mParameters[i]->getName()) )//&& (value != mParameters[i]->getName()) ) //By commenting this a parameter can be set to a systems parameter with same name as component parameter e.g. mass m = m (system parameter) related to issue #783
         {
             ParameterEvaluator *needEvaluation=0;
+            const HString oldValue = mParameters[i]->getValue();
+            const HString oldType = mParameters[i]->getType();
             success = mParameters[i]->setParameter(rValue, rDescription, rQuantity, rUnit, rType, &needEvaluation, force); //Sets the new value, if the parameter is of the type to need evaluation e.g. if it is a system parameter needEvaluation points to the parameter
+            if ((mParameters[i]->getValue() != oldValue) || (mParameters[i]->getType() != oldType))
+            {
+                addChangedParameterName(rName);
+            }
             if(needEvaluation)
             {
                 if(mParametersNeedEvaluation.end() == find(mParametersNeedEvaluation.begin(), mParametersNeedEvaluation.end(), needEvaluation))
@@ -740,7 +842,9 @@ bool ParameterEvaluatorHandler::evaluateInComponent(const HString &rName, HStrin
     {
         if ( (mParameters[i]->getName() == rName) && (mParameters[i]->getType() == rType) )
         {
+            // Names are unique, no need to look further
             success = mParameters[i]->evaluate(rEvaluatedParameterValue);
+            break;
         }
     }
     return success;
@@ -785,21 +889,6 @@ bool ParameterEvaluatorHandler::evaluateRecursivelyInSystemParents(const HString
     return evalOK;
 }
 
-bool ParameterEvaluatorHandler::evaluateParameterExpression(const HString &rExpression, HString &rEvaluatedParameterValue)
-{
-    //! @todo waste of time recreating the helper every time, should reuse one that always exists
-    NumHopHelper nh;
-    nh.setComponent(mComponent);
-    HString dummy;
-    double value;
-    bool evalOK = nh.evalNumHopScript(rExpression.c_str(), value, false,dummy);
-    if (evalOK)
-    {
-        rEvaluatedParameterValue = to_hstring(value);
-    }
-    return evalOK;
-}
-
 //! @brief Check if a parameter with given name exist among the parameters
 //! @param [in] rName The name of the parameter to check for
 //! @returns true if found else false
@@ -840,6 +929,39 @@ bool ParameterEvaluatorHandler::checkParameters(HString &rErrParName)
 }
 
 
+//! @brief Check if any parameter has been added, removed or given a new value since resetChangedParameters() was called
+//! @details All parameters are considered changed when the handler is created
+bool ParameterEvaluatorHandler::hasChangedParameters() const
+{
+    return mHasChangedParameters;
+}
+
+//! @brief Returns the names of the parameters that have been added, removed, renamed or given a new value since resetChangedParameters() was called
+//! @details A renamed parameter is listed with both the old and the new name
+const std::vector<HString> &ParameterEvaluatorHandler::getChangedParameterNames() const
+{
+    return mChangedParameterNames;
+}
+
+//! @brief Mark all parameters as unchanged, the system does this after a successful initialization
+void ParameterEvaluatorHandler::resetChangedParameters()
+{
+    mHasChangedParameters = false;
+    mChangedParameterNames.clear();
+}
+
+//! @brief Mark a parameter as changed
+//! @param [in] rName The name of the parameter
+void ParameterEvaluatorHandler::addChangedParameterName(const HString &rName)
+{
+    mHasChangedParameters = true;
+    if (std::find(mChangedParameterNames.begin(), mChangedParameterNames.end(), rName) == mChangedParameterNames.end())
+    {
+        mChangedParameterNames.push_back(rName);
+    }
+}
+
+
 Component *ParameterEvaluatorHandler::getComponent() const
 {
     return mComponent;
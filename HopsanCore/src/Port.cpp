@@ -199,7 +199,7 @@ double Port::readNodeSafe(const size_t idx, const size_t subPortIdx) const
 
     if (idx < mpNode->getNumDataVariables())
     {
-        return mpNode->mDataValues[idx];
+        return mpNode->mpDataValues[idx];
     }
     getComponent()->addErrorMessage("data idx out of range in Port::readNodeSafe()");
     return -1;
@@ -217,7 +217,7 @@ void Port::writeNodeSafe(const size_t idx, const double value, const size_t subP
     HOPSAN_UNUSED(subPortIdx)
     if (idx < mpNode->getNumDataVariables())
     {
-        mpNode->mDataValues[idx] = value;
+        mpNode->mpDataValues[idx] = value;
     }
     else
     {
@@ -439,6 +439,36 @@ bool Port::isLoggingEnabled() const
     return mEnableLogging;
 }
 
+//! @brief Enable or disable logging of one node data variable in this port
+//! @details A variable is logged if logging is enabled for at least one of the ports connected to the node, and the
+//! variable has not been disabled in that port. Disabled variables take no log memory and are not copied during simulation.
+//! @param [in] dataId The node data id of the variable
+//! @param [in] enableLog True to log the variable, false to exclude it from the log
+void Port::setEnableVariableLogging(const size_t dataId, const bool enableLog)
+{
+    if (dataId >= mDisabledLogVariables.size())
+    {
+        if (enableLog)
+        {
+            return;
+        }
+        mDisabledLogVariables.resize(dataId+1, false);
+    }
+    mDisabledLogVariables[dataId] = !enableLog;
+}
+
+//! @brief Check if a node data variable should be logged by this port
+//! @param [in] dataId The node data id of the variable
+//! @returns True if port logging is enabled and the variable has not been disabled
+bool Port::isVariableLoggingEnabled(const size_t dataId) const
+{
+    if (dataId < mDisabledLogVariables.size())
+    {
+        return mEnableLogging && !mDisabledLogVariables[dataId];
+    }
+    return mEnableLogging;
+}
+
 //! @brief Get all node data descriptions
 //! @param [in] subPortIdx Ignored on non multi ports
 //! @returns A const pointer to the internal node vector with node data descriptions
@@ -570,7 +600,7 @@ vector<double> *Port::getLogTimeVectorPtr(const size_t subPortIdx)
 }
 
 //! @param [in] subPortIdx Ignored on non multi ports
-vector<vector<double> > *Port::getLogDataVectorPtr(const size_t subPortIdx)
+LogDataStorage *Port::getLogDataVectorPtr(const size_t subPortIdx)
 {
     HOPSAN_UNUSED(subPortIdx)
     if (mpNode != 0)
@@ -583,12 +613,43 @@ vector<vector<double> > *Port::getLogDataVectorPtr(const size_t subPortIdx)
     }
 }
 
+//! @brief Returns the minimum value in each log interval, the storage is empty unless the system logs envelopes
+//! @param [in] subPortIdx Ignored on non multi ports
+LogDataStorage *Port::getLogDataMinVectorPtr(const size_t subPortIdx)
+{
+    HOPSAN_UNUSED(subPortIdx)
+    if (mpNode != 0)
+    {
+        return &(mpNode->mMinDataStorage);
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+//! @brief Returns the maximum value in each log interval, the storage is empty unless the system logs envelopes
+//! @param [in] subPortIdx Ignored on non multi ports
+LogDataStorage *Port::getLogDataMaxVectorPtr(const size_t subPortIdx)
+{
+    HOPSAN_UNUSED(subPortIdx)
+    if (mpNode != 0)
+    {
+        return &(mpNode->mMaxDataStorage);
+    }
+    else
+    {
+        return 0;
+    }
+}
+
 bool Port::isInterfacePort() const
 {
     return getComponent()->isComponentSystem();
 }
 
 //! @param [in] subPortIdx Ignored on non multi ports
+//! @note If the owning system uses a node data arena, the vector is only updated when the simulation is finalized, use getNodeDataValuesPtr() for current values
 vector<double> *Port::getDataVectorPtr(const size_t subPortIdx)
 {
     HOPSAN_UNUSED(subPortIdx)
@@ -1129,7 +1190,7 @@ std::vector<double> *MultiPort::getLogTimeVectorPtr(const size_t subPortIdx)
     return 0;
 }
 
-std::vector<std::vector<double> > *MultiPort::getLogDataVectorPtr(const size_t subPortIdx)
+LogDataStorage *MultiPort::getLogDataVectorPtr(const size_t subPortIdx)
 {
     if (isConnected())
     {
@@ -1138,6 +1199,24 @@ std::vector<std::vector<double> > *MultiPort::getLogDataVectorPtr(const size_t s
     return 0;
 }
 
+LogDataStorage *MultiPort::getLogDataMinVectorPtr(const size_t subPortIdx)
+{
+    if (isConnected())
+    {
+        return mSubPortsVector[subPortIdx]->getLogDataMinVectorPtr();
+    }
+    return 0;
+}
+
+LogDataStorage *MultiPort::getLogDataMaxVectorPtr(const size_t subPortIdx)
+{
+    if (isConnected())
+    {
+        return mSubPortsVector[subPortIdx]->getLogDataMaxVectorPtr();
+    }
+    return 0;
+}
+
 void MultiPort::setEnableLogging(const bool enableLog)
 {
     HOPSAN_UNUSED(enableLog);
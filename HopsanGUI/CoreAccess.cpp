@@ -887,9 +887,16 @@ void CoreSystemAccess::getPlotData(const QString compname, const QString portnam
         dataId = pPort->getNodeDataIdFromName(dataname.toStdString().c_str());
         if (dataId > -1)
         {
-            std::vector< std::vector<double> > *pData = pPort->getLogDataVectorPtr();
+            hopsan::LogDataStorage *pData = pPort->getLogDataVectorPtr();
             rpTimeVector = pPort->getLogTimeVectorPtr();
 
+            // Variables that have been excluded from logging have no data
+            if (!pData->isVariableStored(size_t(dataId)))
+            {
+                rData.clear();
+                return;
+            }
+
             // Instead of pData.size() lets ask for latest logsample, this way we can avoid coping log slots that have not bee written and contains junk
             // This is useful when a simulation has been aborted
             size_t nElements;
@@ -909,7 +916,7 @@ void CoreSystemAccess::getPlotData(const QString compname, const QString portnam
             rData.resize(nElements); //Allocate memory for data
             for (size_t i=0; i<nElements; ++i)
             {
-                rData[i] = pData->at(i).at(dataId);
+                rData[i] = pData->value(i, dataId);
             }
         }
     }
@@ -957,8 +964,7 @@ bool CoreSystemAccess::getLastNodeData(const QString compname, const QString por
 
         if (dataId >= 0)
         {
-            std::vector<double> *pData = pPort->getDataVectorPtr();
-            rData = pData->at(dataId);
+            rData = pPort->readNodeSafe(dataId);
             return true;
         }
     }
@@ -1043,6 +1049,41 @@ bool CoreSystemAccess::isLoggingEnabled(const QString &componentName, const QStr
     }
 }
 
+void CoreSystemAccess::setVariableLoggingEnabled(const QString &componentName, const QString &portName, const QString &variableName, bool enable)
+{
+    hopsan::Port* pPort = this->getCorePortPtr(componentName, portName);
+    if(pPort)
+    {
+        int dataId = pPort->getNodeDataIdFromName(variableName.toStdString().c_str());
+        if (dataId >= 0)
+        {
+            pPort->setEnableVariableLogging(size_t(dataId), enable);
+        }
+    }
+}
+
+//! @brief Returns the names of the variables in a port that have been excluded from logging
+QStringList CoreSystemAccess::getDisabledLogVariables(const QString &componentName, const QString &portName)
+{
+    QStringList names;
+    hopsan::Port *pPort = this->getCorePortPtr(componentName, portName);
+    if(pPort)
+    {
+        const std::vector<hopsan::NodeDataDescription> *pDescs = pPort->getNodeDataDescriptions();
+        if (pDescs)
+        {
+            for (size_t i=0; i<pDescs->size(); ++i)
+            {
+                if (!pPort->isVariableLoggingEnabled(pDescs->at(i).id))
+                {
+                    names.append(pDescs->at(i).name.c_str());
+                }
+            }
+        }
+    }
+    return names;
+}
+
 
 bool CoreSystemAccess::writeNodeData(const QString compname, const QString portname, const QString dataname, double data)
 {
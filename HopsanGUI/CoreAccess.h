@@ -225,6 +225,8 @@ public:
     bool isPortConnected(QString componentName, QString portName);
     void setLoggingEnabled(const QString &componentName, const QString &portName, bool enable);
     bool isLoggingEnabled(const QString &componentName, const QString &portName);
+    void setVariableLoggingEnabled(const QString &componentName, const QString &portName, const QString &variableName, bool enable);
+    QStringList getDisabledLogVariables(const QString &componentName, const QString &portName);
 
     // Component creation and removal
     QString createComponent(QString type, QString name="");
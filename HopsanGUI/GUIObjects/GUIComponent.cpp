@@ -309,6 +309,23 @@ void Component::saveCoreDataToDomElement(QDomElement &rDomElement, SaveContentsE
                         xmlPort.setAttribute("signalquantity", q);
                     }
                 }
+                // Only save log settings that differ from the default (everything logged), multiports are never logged
+                CoreSystemAccess *pCoreAccess = mpParentContainerObject->getCoreSystemAccessPtr();
+                if (!pCoreAccess->getPortType(this->getName(), desc.mPortName).contains("Multiport"))
+                {
+                    if (!pCoreAccess->isLoggingEnabled(this->getName(), desc.mPortName))
+                    {
+                        xmlPort.setAttribute("logging", "false");
+                    }
+                    else
+                    {
+                        QStringList nologVars = pCoreAccess->getDisabledLogVariables(this->getName(), desc.mPortName);
+                        if (!nologVars.isEmpty())
+                        {
+                            xmlPort.setAttribute("nologvariables", nologVars.join(","));
+                        }
+                    }
+                }
             }
         }
     }
@@ -4132,6 +4132,9 @@ void HcomHandler::executeGetCommand(const QString cmd)
         case hopsan::ParallelForAlgorithm :
             output.append("fork-join scheduling");
             break;
+        case hopsan::GraphPartitioningAlgorithm :
+            output.append("graph partitioning scheduling");
+            break;
         default :
             output.append("unknown ("+QString::number(getConfigPtr()->getParallelAlgorithm())+")");
             break;
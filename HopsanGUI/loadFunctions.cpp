@@ -412,6 +412,19 @@ ModelObject* loadModelObject(QDomElement &rDomElement, ContainerObject* pContain
                 {
                     pObj->setModifyableSignalQuantity(portTag.attribute("name")+"#Value", q);
                 }
+
+                // Load log masks
+                CoreSystemAccess *pCoreAccess = pContainer->getCoreSystemAccessPtr();
+                const QString portName = portTag.attribute("name");
+                if (portTag.attribute("logging") == "false")
+                {
+                    pCoreAccess->setLoggingEnabled(pObj->getName(), portName, false);
+                }
+                const QStringList nologVars = portTag.attribute("nologvariables").split(",");
+                for (const QString &var : nologVars)
+                {
+                    pCoreAccess->setVariableLoggingEnabled(pObj->getName(), portName, var, false);
+                }
                 portTag = portTag.nextSiblingElement(HMF_PORTTAG);
             }
 
@@ -147,17 +147,17 @@ void saveResults(ComponentSystem *pSys, const string &rFileName, const SaveResul
                             {
                                 // Only write something if data has been logged (skip ports that are not logged)
                                 // We assume that the data vector has been cleared
-                                if (pPort->getLogDataVectorPtr()->size() > 0)
+                                if (pPort->getLogDataVectorPtr()->size() > 0 && pPort->getLogDataVectorPtr()->isVariableStored(v))
                                 {
                                     *pFile << fullname.c_str();
                                     if(descriptions == NameAliasUnit) {
                                         *pFile << "," << pPort->getVariableAlias(v).c_str() << "," << pVars->at(v).unit.c_str();
                                     }
                                     //! @todo what about time vector
-                                    vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
+                                    LogDataStorage *pLogData = pPort->getLogDataVectorPtr();
                                     for (size_t t=0; t<pSys->getNumActuallyLoggedSamples(); ++t)
                                     {
-                                        *pFile << "," << std::scientific << (*pLogData)[t][v];
+                                        *pFile << "," << std::scientific << pLogData->value(t, v);
                                     }
                                     *pFile << endl;
                                 }
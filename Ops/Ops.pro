@@ -55,7 +55,9 @@ SOURCES += \
     src/OpsWorkerDifferentialEvolution.cpp \
     src/OpsWorkerControlledRandomSearch.cpp \
     src/OpsWorkerComplexBurmen.cpp \
-    src/OpsWorkerGenetic.cpp
+    src/OpsWorkerGenetic.cpp \
+    src/OpsEvaluationCache.cpp \
+    src/OpsWorkerSurrogate.cpp
 
 HEADERS += \
     include/OpsWorker.h \
@@ -63,6 +65,7 @@ HEADERS += \
     include/OpsWorkerComplexRF.h \
     include/OpsWorkerNelderMead.h \
     include/OpsEvaluator.h \
+    include/OpsEvaluationCache.h \
     include/OpsWorkerParticleSwarm.h \
     include/OpsWorkerComplexRFP.h \
     include/OpsWorkerParameterSweep.h \
@@ -70,6 +73,7 @@ HEADERS += \
     include/OpsWorkerControlledRandomSearch.h \
     include/OpsWorkerComplexBurmen.h \
     include/OpsWorkerGenetic.h \
+    include/OpsWorkerSurrogate.h \
     include/OpsMessageHandler.h \
     include/OpsWin32DLL.h
 
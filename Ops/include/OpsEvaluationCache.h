@@ -0,0 +1,87 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   OpsEvaluationCache.h
+//! @date   2026-10-18
+//!
+//! @brief Contains a cache for objective values of evaluated points
+//!
+//$Id$
+
+#ifndef OPSEVALUATIONCACHE_H
+#define OPSEVALUATIONCACHE_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "OpsWin32DLL.h"
+
+namespace Ops {
+
+//! @brief Cache of objective values, keyed on quantized parameter vectors
+//! @details Each parameter is rounded to a multiple of the resolution times its parameter range, so that points that
+//! differ less than that share objective value. With resolution zero only identical points match. The cache can be
+//! backed by a file, which makes it possible to resume an optimization without simulating the same points again.
+class OPS_DLLAPI EvaluationCache
+{
+public:
+    EvaluationCache();
+
+    void setResolution(double value);
+    double getResolution() const;
+    void setParameterLimits(const std::vector<double> &rMin, const std::vector<double> &rMax);
+
+    bool setFile(const std::string &rFilePath);
+    void clear();
+
+    bool lookup(const std::vector<double> &rPoint, double &rObjective);
+    void insert(const std::vector<double> &rPoint, double objective);
+
+    size_t getNumberOfEntries() const;
+    size_t getNumberOfLookups() const;
+    size_t getNumberOfHits() const;
+
+private:
+    typedef std::vector<long long> KeyT;
+
+    KeyT quantize(const std::vector<double> &rPoint) const;
+    void rebuildKeys();
+    bool insertEntry(const std::vector<double> &rPoint, double objective);
+
+    double mResolution;
+    std::vector<double> mParameterMin, mParameterMax;
+    std::vector<std::vector<double> > mPoints;
+    std::vector<double> mObjectives;
+    std::map<KeyT, size_t> mEntryIds;
+    std::ofstream mFile;
+    size_t mNumLookups, mNumHits;
+};
+
+}
+
+#endif // OPSEVALUATIONCACHE_H
@@ -35,8 +35,11 @@
 #define OPSEVALUATOR_H
 
 #include <stdlib.h>
+#include <deque>
+#include <vector>
 
 #include "OpsWin32DLL.h"
+#include "OpsEvaluationCache.h"
 
 namespace Ops {
 
@@ -46,6 +49,7 @@ class OPS_DLLAPI Evaluator
 {
 public:
     Evaluator();
+    virtual ~Evaluator();
 
     void setWorker(Worker *pWorker);
 
@@ -53,8 +57,26 @@ public:
     virtual void evaluateCandidate(size_t idx);        //Must be re-implemented
     virtual void evaluateAllCandidates();           //Can be re-implemented
 
+    // Asynchronous evaluation, can be re-implemented to evaluate several candidates at the same time
+    virtual size_t getMaxNumberOfPendingCandidates();
+    virtual void submitCandidate(size_t idx);
+    virtual bool waitForCandidate(size_t &rIdx);
+
+    // Objective value cache, used by implementations that call findCachedObjective() and addCachedObjective()
+    void setCacheEnabled(bool value);
+    bool isCacheEnabled() const;
+    EvaluationCache *getCache();
+
 protected:
+    bool findCachedObjective(const std::vector<double> &rPoint, double &rObjective);
+    void addCachedObjective(const std::vector<double> &rPoint, double objective);
+
     Worker *mpWorker;
+
+private:
+    std::deque<size_t> mFinishedCandidates;
+    bool mCacheEnabled;
+    EvaluationCache mCache;
 };
 
 }
@@ -34,6 +34,7 @@ class MessageHandler
 {
 public:
     MessageHandler() { mIsAborted = false;}
+    virtual ~MessageHandler() {}
 
     void printMessage(std::string msg)
     {
@@ -50,6 +51,7 @@ public:
     virtual void objectiveChanged(size_t) {}
     virtual void objectivesChanged() {}
     virtual void stepCompleted(size_t) {}
+    virtual void cacheStatisticsChanged(size_t /*nHits*/, size_t /*nLookups*/) {}
 
     bool aborted() { return mIsAborted; }
 
@@ -41,7 +41,7 @@
 
 namespace Ops {
 
-enum AlgorithmT {Undefined, NelderMead, ComplexRF, ComplexRFP,  ParticleSwarm, DifferentialEvolution, Genetic, ParameterSweep, ControlledRandomSearch, ComplexBurmen};
+enum AlgorithmT {Undefined, NelderMead, ComplexRF, ComplexRFP,  ParticleSwarm, DifferentialEvolution, Genetic, ParameterSweep, ControlledRandomSearch, ComplexBurmen, Surrogate};
 enum SamplingT {SamplingRandom, SamplingLatinHypercube};
 
 class Evaluator;
@@ -116,12 +116,14 @@ public:
     void setMaxNumberOfIterations(size_t value);
     void setTolerance(double value);
     void setSamplingMethod(SamplingT dist);
+    void setSteadyState(bool value);
 
     size_t getNumberOfCandidates();
     size_t getNumberOfPoints();
     size_t getNumberOfParameters();
     size_t getMaxNumberOfIterations();
     size_t getCurrentNumberOfIterations();
+    bool isSteadyState() const;
 
     double opsRand();
 
@@ -142,6 +144,7 @@ protected:
     size_t mWorstId, mBestId, mLastWorstId, mSecondBestId;
     double mTolerance;
     SamplingT mDistribution;
+    bool mSteadyState;
     Evaluator *mpEvaluator;
     MessageHandler *mpMessageHandler;
     std::vector<std::pair<size_t,size_t>> mIgnoredWhenSampling;
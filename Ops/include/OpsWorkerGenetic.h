@@ -25,9 +25,12 @@ public:
   void setMutationProbability(double value);
 
 private:
+  void runSteadyState();
   void selectParents();
   void crossOver();
+  void createChildren();
   void mutate();
+  void mutateCandidate(size_t i);
   double gaussian(double mean, double dev, double min, double max);
 
   size_t mParent1,mParent2;
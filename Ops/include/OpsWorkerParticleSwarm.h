@@ -76,6 +76,8 @@ protected:
 
 private:
     void moveParticle(int p);
+    void runSteadyState();
+    bool updateOmega();
 protected:
     double mRandomFactor;
 
@@ -0,0 +1,85 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   OpsWorkerSurrogate.h
+//! @date   2026-10-18
+//!
+//! @brief Contains the optimization worker class for the surrogate-assisted algorithm
+//!
+//$Id$
+
+#ifndef OPSWORKERSURROGATE_H
+#define OPSWORKERSURROGATE_H
+
+#include "OpsWorker.h"
+
+namespace Ops {
+
+//! @brief Surrogate-assisted optimization, using a radial basis function fit of all evaluated points
+//! @details The initial points are sampled with the sampling method of the worker. In each iteration a large number of
+//! trial points is generated, either near the best known point or uniformly within the parameter limits. The trial points
+//! are ranked by the surrogate and by the distance to already evaluated points, and only the best ranked ones become
+//! candidates that are evaluated. The points keep the best evaluated points, for the convergence check.
+class OPS_DLLAPI WorkerSurrogate : public Worker
+{
+public:
+    WorkerSurrogate(Evaluator *pEvaluator, MessageHandler *pMessageHandler);
+
+    AlgorithmT getAlgorithm();
+
+    virtual void initialize();
+    virtual void run();
+
+    void setNumberOfTrialPoints(size_t value);
+    void setPerturbation(double value);
+
+private:
+    std::vector<double> scale(const std::vector<double> &rPoint) const;
+    std::vector<double> unscale(const std::vector<double> &rPoint) const;
+    void addEvaluatedPoint(const std::vector<double> &rPoint, double objective);
+    bool fitSurrogate();
+    double evaluateSurrogate(const std::vector<double> &rPoint) const;
+    void generateTrialPoints(std::vector<std::vector<double> > &rTrialPoints);
+    void selectCandidates(const std::vector<std::vector<double> > &rTrialPoints, const double surrogateWeight);
+    double gaussianRand();
+
+    size_t mNumTrialPoints;
+    double mPerturbation, mMaxPerturbation;
+
+    // All evaluated points and objective values, parameters are scaled to [0,1]
+    std::vector<std::vector<double> > mEvaluatedPoints;
+    std::vector<double> mEvaluatedObjectives;
+    size_t mBestEvaluatedId;
+
+    // Cubic radial basis functions centered at the evaluated points, plus a linear polynomial
+    bool mHaveSurrogate;
+    std::vector<double> mRbfWeights;
+    std::vector<double> mPolynomialCoefficients;
+};
+
+}
+
+#endif // OPSWORKERSURROGATE_H
@@ -0,0 +1,224 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   OpsEvaluationCache.cpp
+//! @date   2026-10-18
+//!
+//! @brief Contains a cache for objective values of evaluated points
+//!
+//$Id$
+
+#include "OpsEvaluationCache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+using namespace Ops;
+
+EvaluationCache::EvaluationCache()
+{
+    mResolution = 1e-9;
+    mNumLookups = 0;
+    mNumHits = 0;
+}
+
+
+//! @brief Set the resolution used when comparing points, relative to the parameter ranges
+//! @param[in] value Resolution, zero means that only identical points match
+void EvaluationCache::setResolution(double value)
+{
+    mResolution = std::max(value, 0.0);
+    rebuildKeys();
+}
+
+
+double EvaluationCache::getResolution() const
+{
+    return mResolution;
+}
+
+
+//! @brief Set the parameter ranges that the resolution is relative to
+//! @details Parameters without a valid range use the resolution as an absolute value
+void EvaluationCache::setParameterLimits(const std::vector<double> &rMin, const std::vector<double> &rMax)
+{
+    if(rMin != mParameterMin || rMax != mParameterMax)
+    {
+        mParameterMin = rMin;
+        mParameterMax = rMax;
+        rebuildKeys();
+    }
+}
+
+
+//! @brief Back the cache by a file
+//! @details Entries already in the file are loaded, and entries inserted from now on are appended to it. Each line in the
+//! file contains the objective value followed by the parameter values, separated by space.
+//! @param[in] rFilePath Path to the file, it is created if it does not exist
+//! @returns False if the file could not be opened for writing
+bool EvaluationCache::setFile(const std::string &rFilePath)
+{
+    if(mFile.is_open())
+    {
+        mFile.close();
+    }
+
+    std::ifstream inFile(rFilePath.c_str());
+    std::string line;
+    while(std::getline(inFile, line))
+    {
+        std::istringstream ss(line);
+        double objective;
+        if(line.empty() || line[0] == '#' || !(ss >> objective))
+        {
+            continue;
+        }
+        std::vector<double> point;
+        double value;
+        while(ss >> value)
+        {
+            point.push_back(value);
+        }
+        insertEntry(point, objective);
+    }
+    inFile.close();
+
+    mFile.open(rFilePath.c_str(), std::ios_base::app);
+    mFile.precision(std::numeric_limits<double>::max_digits10);
+    return mFile.good();
+}
+
+
+//! @brief Removes all entries and resets the statistics, the file (if any) is left as it is
+void EvaluationCache::clear()
+{
+    mPoints.clear();
+    mObjectives.clear();
+    mEntryIds.clear();
+    mNumLookups = 0;
+    mNumHits = 0;
+}
+
+
+//! @brief Look up the objective value of a point
+//! @param[in] rPoint Parameter values of the point
+//! @param[out] rObjective Cached objective value, only set if the point was found
+//! @returns True if the point was found
+bool EvaluationCache::lookup(const std::vector<double> &rPoint, double &rObjective)
+{
+    ++mNumLookups;
+    std::map<KeyT, size_t>::const_iterator it = mEntryIds.find(quantize(rPoint));
+    if(it == mEntryIds.end())
+    {
+        return false;
+    }
+    ++mNumHits;
+    rObjective = mObjectives[it->second];
+    return true;
+}
+
+
+//! @brief Add the objective value of an evaluated point, points that are already cached are ignored
+void EvaluationCache::insert(const std::vector<double> &rPoint, double objective)
+{
+    if(insertEntry(rPoint, objective) && mFile.is_open())
+    {
+        mFile << objective;
+        for(size_t i=0; i<rPoint.size(); ++i)
+        {
+            mFile << " " << rPoint[i];
+        }
+        mFile << std::endl;
+    }
+}
+
+
+size_t EvaluationCache::getNumberOfEntries() const
+{
+    return mObjectives.size();
+}
+
+
+size_t EvaluationCache::getNumberOfLookups() const
+{
+    return mNumLookups;
+}
+
+
+size_t EvaluationCache::getNumberOfHits() const
+{
+    return mNumHits;
+}
+
+
+EvaluationCache::KeyT EvaluationCache::quantize(const std::vector<double> &rPoint) const
+{
+    KeyT key(rPoint.size());
+    for(size_t i=0; i<rPoint.size(); ++i)
+    {
+        if(mResolution > 0)
+        {
+            double min = 0, range = 1;
+            if(i < mParameterMin.size() && i < mParameterMax.size() && mParameterMax[i] > mParameterMin[i])
+            {
+                min = mParameterMin[i];
+                range = mParameterMax[i]-mParameterMin[i];
+            }
+            key[i] = std::llround((rPoint[i]-min)/(range*mResolution));
+        }
+        else
+        {
+            // Use the bit pattern, so that only identical values match
+            static_assert(sizeof(long long) == sizeof(double), "Unexpected size of long long");
+            std::memcpy(&key[i], &rPoint[i], sizeof(double));
+        }
+    }
+    return key;
+}
+
+
+void EvaluationCache::rebuildKeys()
+{
+    mEntryIds.clear();
+    for(size_t e=0; e<mPoints.size(); ++e)
+    {
+        mEntryIds.insert(std::make_pair(quantize(mPoints[e]), e));
+    }
+}
+
+
+bool EvaluationCache::insertEntry(const std::vector<double> &rPoint, double objective)
+{
+    if(!mEntryIds.insert(std::make_pair(quantize(rPoint), mPoints.size())).second)
+    {
+        return false;
+    }
+    mPoints.push_back(rPoint);
+    mObjectives.push_back(objective);
+    return true;
+}
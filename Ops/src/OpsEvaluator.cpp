@@ -35,11 +35,19 @@
 
 #include "OpsEvaluator.h"
 #include "OpsWorker.h"
+#include "OpsMessageHandler.h"
 
 using namespace Ops;
 
 Evaluator::Evaluator()
 {
+    mCacheEnabled = false;
+}
+
+
+Evaluator::~Evaluator()
+{
+    //Nothing to do
 }
 
 
@@ -84,3 +92,90 @@ void Evaluator::evaluateAllCandidates()
         evaluateCandidate(i);
     }
 }
+
+
+//! @brief Returns how many candidates can be submitted before waitForCandidate() must be called
+//! @details Workers keep at most this many candidates pending, the default implementation evaluates them one at a time
+size_t Evaluator::getMaxNumberOfPendingCandidates()
+{
+    return 1;
+}
+
+
+//! @brief Starts evaluation of a candidate, the result is obtained with waitForCandidate()
+//! @details The candidate point must not be changed until it has been returned by waitForCandidate(). The default
+//! implementation evaluates the candidate directly.
+//! @param[in] idx Index of the candidate to evaluate
+void Evaluator::submitCandidate(size_t idx)
+{
+    evaluateCandidate(idx);
+    mFinishedCandidates.push_back(idx);
+}
+
+
+//! @brief Waits until a submitted candidate has been evaluated
+//! @details When this returns, the objective value of the candidate has been set in the worker
+//! @param[out] rIdx Index of the evaluated candidate
+//! @returns False if there are no pending candidates
+bool Evaluator::waitForCandidate(size_t &rIdx)
+{
+    if(mFinishedCandidates.empty())
+    {
+        return false;
+    }
+    rIdx = mFinishedCandidates.front();
+    mFinishedCandidates.pop_front();
+    return true;
+}
+
+
+//! @brief Enables or disables the objective value cache
+//! @details The cache is only used by evaluator implementations that call findCachedObjective() before simulating a point
+//! and addCachedObjective() after.
+void Evaluator::setCacheEnabled(bool value)
+{
+    mCacheEnabled = value;
+}
+
+
+bool Evaluator::isCacheEnabled() const
+{
+    return mCacheEnabled;
+}
+
+
+//! @brief Returns the objective value cache, for setting resolution and file and for reading statistics
+EvaluationCache *Evaluator::getCache()
+{
+    return &mCache;
+}
+
+
+//! @brief Look up the objective value of a point in the cache, if the cache is enabled
+//! @details The hit rate is reported to the message handler of the worker. Must only be called from the thread running the worker.
+//! @param[in] rPoint Parameter values of the point
+//! @param[out] rObjective Cached objective value, only set if the point was found
+//! @returns True if the point was found, in which case it does not need to be evaluated
+bool Evaluator::findCachedObjective(const std::vector<double> &rPoint, double &rObjective)
+{
+    if(!mCacheEnabled)
+    {
+        return false;
+    }
+    mCache.setParameterLimits(mpWorker->mParameterMin, mpWorker->mParameterMax);
+    const bool found = mCache.lookup(rPoint, rObjective);
+    mpWorker->mpMessageHandler->cacheStatisticsChanged(mCache.getNumberOfHits(), mCache.getNumberOfLookups());
+    return found;
+}
+
+
+//! @brief Add the objective value of an evaluated point to the cache, if the cache is enabled
+//! @details Must only be called from the thread running the worker
+void Evaluator::addCachedObjective(const std::vector<double> &rPoint, double objective)
+{
+    if(mCacheEnabled)
+    {
+        mCache.setParameterLimits(mpWorker->mParameterMin, mpWorker->mParameterMax);
+        mCache.insert(rPoint, objective);
+    }
+}
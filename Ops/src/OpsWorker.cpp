@@ -64,6 +64,7 @@ Worker::Worker(Evaluator *pEvaluator, MessageHandler *pMessageHandler)
     mObjectives.resize(1);
     mPoints.resize(1);
     mDistribution = SamplingRandom;
+    mSteadyState = false;
 }
 
 Worker::~Worker()
@@ -337,6 +338,14 @@ void Worker::setSamplingMethod(SamplingT dist)
     mDistribution = dist;
 }
 
+//! @brief Use the steady-state variant of the algorithm, if it has one
+//! @details In steady-state mode, each candidate is folded into the population as soon as it has been evaluated and a new
+//! candidate is submitted in its place, using the asynchronous evaluation interface. There is no wait for a whole generation.
+void Worker::setSteadyState(bool value)
+{
+    mSteadyState = value;
+}
+
 size_t Worker::getNumberOfCandidates()
 {
     return mNumCandidates;
@@ -362,6 +371,11 @@ size_t Worker::getCurrentNumberOfIterations()
     return mIterationCounter;
 }
 
+bool Worker::isSteadyState() const
+{
+    return mSteadyState;
+}
+
 double Worker::opsRand()
 {
     return double(rand())/double(RAND_MAX);
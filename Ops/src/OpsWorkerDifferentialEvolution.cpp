@@ -60,6 +60,7 @@
 #include "OpsEvaluator.h"
 #include "OpsMessageHandler.h"
 #include <math.h>
+#include <algorithm>
 
 using namespace Ops;
 
@@ -84,6 +85,11 @@ void WorkerDifferentialEvolution::run()
         mpMessageHandler->printMessage("Error: Differential evolution algorithm requires same number of candidates and points.");
         return;
     }
+    if(mSteadyState)
+    {
+        runSteadyState();
+        return;
+    }
     mpMessageHandler->printMessage("Running optimization with differential evolution algorithm.");
 
     distributePoints();
@@ -97,26 +103,7 @@ void WorkerDifferentialEvolution::run()
     {
         for(size_t p=0; p<mNumPoints; ++p)
         {
-            bool feasible=false;
-            while(!feasible)
-            {
-                size_t a,b,c,R;
-                getRandomIds(p,a,b,c,R);
-
-                mCandidatePoints[p] = mPoints[p];
-                for(size_t i=0; i<mNumParameters; ++i)
-                {
-                    double r = opsRand();
-                    if(r < mCR || i == R)
-                    {
-                        double A = mPoints[a][i];
-                        double B = mPoints[b][i];
-                        double C = mPoints[c][i];
-                        mCandidatePoints[p][i] = A + mF * (B - C);
-                    }
-                }
-                feasible = isCandidateFeasible(p);
-            }
+            createTrialCandidate(p);
         }
 
         mpEvaluator->evaluateAllCandidates();
@@ -159,6 +146,119 @@ void WorkerDifferentialEvolution::run()
 }
 
 
+//! @brief Executes a steady-state differential evolution algorithm
+//! @details Each point has its own candidate. A new trial candidate for a point is created from the current population as
+//! soon as the previous one has been evaluated, so that fast evaluations do not wait for slow ones. One iteration corresponds
+//! to as many evaluations as there are points.
+void WorkerDifferentialEvolution::runSteadyState()
+{
+    mpMessageHandler->printMessage("Running optimization with steady-state differential evolution algorithm.");
+
+    distributePoints();
+
+    //Evaluate initial objective values
+    mpEvaluator->evaluateAllPoints();
+    mpMessageHandler->objectivesChanged();
+
+    const size_t maxPending = std::max(size_t(1), std::min(mpEvaluator->getMaxNumberOfPendingCandidates(), mNumPoints));
+    std::vector<bool> isPending(mNumPoints, false);
+    size_t nPending=0, nextPoint=0, nEvaluations=0;
+    bool converged=false;
+
+    mIterationCounter=0;
+    while(true)
+    {
+        //Keep the evaluator busy, with at most one pending candidate per point
+        while(!converged && mIterationCounter<mnMaxIterations && !mpMessageHandler->aborted() && nPending<maxPending)
+        {
+            while(isPending[nextPoint])
+            {
+                nextPoint = (nextPoint+1) % mNumPoints;
+            }
+            createTrialCandidate(nextPoint);
+            isPending[nextPoint] = true;
+            ++nPending;
+            mpEvaluator->submitCandidate(nextPoint);
+            mpMessageHandler->candidateChanged(nextPoint);
+            nextPoint = (nextPoint+1) % mNumPoints;
+        }
+
+        size_t p;
+        if(nPending == 0 || !mpEvaluator->waitForCandidate(p))
+        {
+            break;
+        }
+        isPending[p] = false;
+        --nPending;
+
+        if(mCandidateObjectives[p] < mObjectives[p])
+        {
+            mPoints[p] = mCandidatePoints[p];
+            mObjectives[p] = mCandidateObjectives[p];
+            mpMessageHandler->pointChanged(p);
+            mpMessageHandler->objectiveChanged(p);
+        }
+
+        ++nEvaluations;
+        if(nEvaluations % mNumPoints == 0 && !converged && mIterationCounter<mnMaxIterations)
+        {
+            //Check convergence
+            if(checkForConvergence())
+            {
+                converged = true;
+            }
+            else
+            {
+                mpMessageHandler->stepCompleted(mIterationCounter);
+                ++mIterationCounter;
+            }
+        }
+    }
+
+    if(mpMessageHandler->aborted())
+    {
+        mpMessageHandler->printMessage("Optimization was aborted after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+    else if(mIterationCounter == mnMaxIterations)
+    {
+        mpMessageHandler->printMessage("Optimization failed to converge after "+std::to_string(mIterationCounter)+" iterations");
+    }
+    else
+    {
+        mpMessageHandler->printMessage("Optimization converged in parameter values after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+
+    // Clean up
+    finalize();
+}
+
+
+//! @brief Creates a feasible trial candidate for a point, by mutation and crossover with three other random points
+void WorkerDifferentialEvolution::createTrialCandidate(size_t p)
+{
+    bool feasible=false;
+    while(!feasible)
+    {
+        size_t a,b,c,R;
+        getRandomIds(p,a,b,c,R);
+
+        mCandidatePoints[p] = mPoints[p];
+        for(size_t i=0; i<mNumParameters; ++i)
+        {
+            double r = opsRand();
+            if(r < mCR || i == R)
+            {
+                double A = mPoints[a][i];
+                double B = mPoints[b][i];
+                double C = mPoints[c][i];
+                mCandidatePoints[p][i] = A + mF * (B - C);
+            }
+        }
+        feasible = isCandidateFeasible(p);
+    }
+}
+
+
 void WorkerDifferentialEvolution::setCrossoverProbability(double value)
 {
     mCR = value;
@@ -35,6 +35,7 @@
 #include "OpsEvaluator.h"
 #include "OpsMessageHandler.h"
 #include <math.h>
+#include <algorithm>
 #include <random>
 
 using namespace Ops;
@@ -59,6 +60,12 @@ void WorkerGenetic::initialize()
 //! @brief Executes a genetic algorithm
 void WorkerGenetic::run()
 {
+    if(mSteadyState)
+    {
+        runSteadyState();
+        return;
+    }
+
     mpMessageHandler->printMessage("Running optimization with genetic algorithm.");
 
     distributePoints();
@@ -124,6 +131,101 @@ void WorkerGenetic::run()
 }
 
 
+//! @brief Executes a steady-state genetic algorithm
+//! @details Each candidate is a single child. As soon as a child has been evaluated it replaces the worst point if it is
+//! better, and a new child is bred from the current population in its place. One iteration corresponds to as many
+//! evaluations as there are candidates.
+void WorkerGenetic::runSteadyState()
+{
+    mpMessageHandler->printMessage("Running optimization with steady-state genetic algorithm.");
+
+    distributePoints();
+
+    //Evaluate initial objective values
+    mpEvaluator->evaluateAllPoints();
+    mpMessageHandler->objectivesChanged();
+
+    const size_t maxPending = std::max(size_t(1), std::min(mpEvaluator->getMaxNumberOfPendingCandidates(), mNumCandidates));
+    std::vector<bool> isPending(mNumCandidates, false);
+    size_t nPending=0, nextCandidate=0, nEvaluations=0;
+    bool converged=false;
+
+    mIterationCounter=0;
+    while(true)
+    {
+        //Keep the evaluator busy, with at most one pending child per candidate
+        while(!converged && mIterationCounter<mnMaxIterations && !mpMessageHandler->aborted() && nPending<maxPending)
+        {
+            while(isPending[nextCandidate])
+            {
+                nextCandidate = (nextCandidate+1) % mNumCandidates;
+            }
+            selectParents();
+            createChildren();
+            mCandidatePoints[nextCandidate] = mChild1;
+            mutateCandidate(nextCandidate);
+            isPending[nextCandidate] = true;
+            ++nPending;
+            mpEvaluator->submitCandidate(nextCandidate);
+            mpMessageHandler->candidateChanged(nextCandidate);
+            nextCandidate = (nextCandidate+1) % mNumCandidates;
+        }
+
+        size_t i;
+        if(nPending == 0 || !mpEvaluator->waitForCandidate(i))
+        {
+            break;
+        }
+        isPending[i] = false;
+        --nPending;
+
+        //Children that are copies of an existing point are discarded, to keep the population diverse
+        calculateBestAndWorstId();
+        int worst = getWorstId();
+        if(mCandidateObjectives[i] < mObjectives[worst] &&
+           std::find(mPoints.begin(), mPoints.end(), mCandidatePoints[i]) == mPoints.end())
+        {
+            mObjectives[worst] = mCandidateObjectives[i];
+            mPoints[worst] = mCandidatePoints[i];
+            mpMessageHandler->pointChanged(worst);
+            mpMessageHandler->objectiveChanged(worst);
+        }
+
+        ++nEvaluations;
+        if(nEvaluations % mNumCandidates == 0 && !converged && mIterationCounter<mnMaxIterations)
+        {
+            mpMessageHandler->stepCompleted(mIterationCounter);
+
+            //Check convergence
+            if(checkForConvergence())
+            {
+                converged = true;
+            }
+            else
+            {
+                ++mIterationCounter;
+            }
+        }
+    }
+
+    if(mpMessageHandler->aborted())
+    {
+        mpMessageHandler->printMessage("Optimization was aborted after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+    else if(mIterationCounter == mnMaxIterations)
+    {
+        mpMessageHandler->printMessage("Optimization failed to converge after "+std::to_string(mIterationCounter)+" iterations");
+    }
+    else
+    {
+        mpMessageHandler->printMessage("Optimization converged in parameter values after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+
+    // Clean up
+    finalize();
+}
+
+
 //! @brief Set number of optimization parameters
 void WorkerGenetic::setNumberOfParameters(size_t value)
 {
@@ -172,6 +274,15 @@ void WorkerGenetic::selectParents() {
 
 //! @brief Auxiliary function for perform crossover
 void WorkerGenetic::crossOver()
+{
+    createChildren();
+    mCandidatePoints[mParent1] = mChild1;
+    mCandidatePoints[mParent2] = mChild2;
+}
+
+
+//! @brief Auxiliary function for creating two children from the selected parents
+void WorkerGenetic::createChildren()
 {
     for(size_t i=0; i<mNumParameters; ++i)
     {
@@ -193,8 +304,6 @@ void WorkerGenetic::crossOver()
             mChild2[i] = gaussian(mean,dev,mParameterMin[i],mParameterMax[i]);
         }
     }
-    mCandidatePoints[mParent1] = mChild1;
-    mCandidatePoints[mParent2] = mChild2;
 }
 
 
@@ -202,13 +311,20 @@ void WorkerGenetic::crossOver()
 void WorkerGenetic::mutate()
 {
     for(size_t i=0; i<mNumPoints; ++i) {
-        for(size_t j=0; j<mNumParameters; ++j) {
-            double doMutation = opsRand();
-            if(doMutation < mMutationProbability) {
-                double mean = mCandidatePoints[i][j];
-                double dev = (mParameterMax[j]-mParameterMin[j])/2.0;
-                mCandidatePoints[i][j] = gaussian(mean,dev,mParameterMin[j],mParameterMax[j]);
-            }
+        mutateCandidate(i);
+    }
+}
+
+
+//! @brief Auxiliary function for mutating one child
+void WorkerGenetic::mutateCandidate(size_t i)
+{
+    for(size_t j=0; j<mNumParameters; ++j) {
+        double doMutation = opsRand();
+        if(doMutation < mMutationProbability) {
+            double mean = mCandidatePoints[i][j];
+            double dev = (mParameterMax[j]-mParameterMin[j])/2.0;
+            mCandidatePoints[i][j] = gaussian(mean,dev,mParameterMin[j],mParameterMax[j]);
         }
     }
 }
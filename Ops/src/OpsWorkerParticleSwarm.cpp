@@ -79,6 +79,11 @@ void WorkerParticleSwarm::run()
         mpMessageHandler->printMessage("Error: Differential evolution algorithm requires same number of candidates and points.");
         return;
     }
+    if(mSteadyState)
+    {
+        runSteadyState();
+        return;
+    }
 
     mpMessageHandler->printMessage("Running optimization with particle swarm algorithm.");
 
@@ -105,15 +110,7 @@ void WorkerParticleSwarm::run()
     for(; mIterationCounter<mnMaxIterations && !mpMessageHandler->aborted(); ++mIterationCounter)
     {
         //Update weight (linearly decreasing)
-        if(mInertiaStrategy == InertiaConstant)
-        {
-            mOmega = mOmega1;
-        }
-        else if(mInertiaStrategy == InertiaLinearDecreasing)
-        {
-            mOmega = mOmega1 + (mOmega2-mOmega1)*mIterationCounter/mnMaxIterations;
-        }
-        else
+        if(!updateOmega())
         {
             mpMessageHandler->printMessage("Unknown inertia strategy, aborting.");
             return;
@@ -171,6 +168,139 @@ void WorkerParticleSwarm::run()
 }
 
 
+//! @brief Executes a steady-state particle swarm algorithm
+//! @details Each particle is moved and submitted for evaluation again as soon as its previous position has been evaluated,
+//! using the best known global position at that time. One iteration corresponds to as many evaluations as there are particles.
+void WorkerParticleSwarm::runSteadyState()
+{
+    mpMessageHandler->printMessage("Running optimization with steady-state particle swarm algorithm.");
+
+    distributePoints();
+
+    //Evaluate initial objective values
+    mpEvaluator->evaluateAllPoints();
+    mpMessageHandler->objectivesChanged();
+
+    //Initialize best known point for each point
+    for(size_t i=0; i<mNumPoints; ++i)
+    {
+        mLocalBestPoints[i] = mPoints[i];
+        mLocalBestObjectives[i] = mObjectives[i];
+    }
+
+    //Calculate best known global position
+    calculateBestAndWorstId();
+    mBestObjective = mObjectives[mBestId];
+    mBestPoint = mPoints[mBestId];
+
+    mIterationCounter=0;
+    if(!updateOmega())
+    {
+        mpMessageHandler->printMessage("Unknown inertia strategy, aborting.");
+        return;
+    }
+
+    const size_t maxPending = std::max(size_t(1), std::min(mpEvaluator->getMaxNumberOfPendingCandidates(), mNumPoints));
+    std::vector<bool> isPending(mNumPoints, false);
+    size_t nPending=0, nextParticle=0, nEvaluations=0;
+    bool converged=false;
+
+    while(true)
+    {
+        //Keep the evaluator busy, with at most one pending position per particle
+        while(!converged && mIterationCounter<mnMaxIterations && !mpMessageHandler->aborted() && nPending<maxPending)
+        {
+            while(isPending[nextParticle])
+            {
+                nextParticle = (nextParticle+1) % mNumPoints;
+            }
+            updateOmega();
+            moveParticle(nextParticle);
+            isPending[nextParticle] = true;
+            ++nPending;
+            mpEvaluator->submitCandidate(nextParticle);
+            mpMessageHandler->candidateChanged(nextParticle);
+            nextParticle = (nextParticle+1) % mNumPoints;
+        }
+
+        size_t p;
+        if(nPending == 0 || !mpEvaluator->waitForCandidate(p))
+        {
+            break;
+        }
+        isPending[p] = false;
+        --nPending;
+
+        //Update best known position for the particle, and the best known global position
+        if(mCandidateObjectives[p] < mObjectives[p])
+        {
+            mPoints[p] = mCandidatePoints[p];
+            mObjectives[p] = mCandidateObjectives[p];
+            mpMessageHandler->pointChanged(p);
+            mpMessageHandler->objectiveChanged(p);
+            if(mObjectives[p] < mBestObjective)
+            {
+                mBestObjective = mObjectives[p];
+                mBestPoint = mPoints[p];
+            }
+        }
+
+        ++nEvaluations;
+        if(nEvaluations % mNumPoints == 0 && !converged && mIterationCounter<mnMaxIterations)
+        {
+            calculateBestAndWorstId();
+
+            //Check convergence
+            if(checkForConvergence())
+            {
+                converged = true;
+            }
+            else
+            {
+                mpMessageHandler->stepCompleted(mIterationCounter);
+                ++mIterationCounter;
+            }
+        }
+    }
+
+    if(mpMessageHandler->aborted())
+    {
+        mpMessageHandler->printMessage("Optimization was aborted after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+    else if(mIterationCounter == mnMaxIterations)
+    {
+        mpMessageHandler->printMessage("Optimization failed to converge after "+std::to_string(mIterationCounter)+" iterations");
+    }
+    else
+    {
+        mpMessageHandler->printMessage("Optimization converged in parameter values after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+
+    // Clean up
+    finalize();
+}
+
+
+//! @brief Updates the inertia weight according to the inertia strategy and the current iteration
+//! @returns False if the inertia strategy is unknown
+bool WorkerParticleSwarm::updateOmega()
+{
+    if(mInertiaStrategy == InertiaConstant)
+    {
+        mOmega = mOmega1;
+    }
+    else if(mInertiaStrategy == InertiaLinearDecreasing)
+    {
+        mOmega = mOmega1 + (mOmega2-mOmega1)*mIterationCounter/mnMaxIterations;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
 void WorkerParticleSwarm::setNumberOfPoints(size_t value)
 {
     Worker::setNumberOfPoints(value);
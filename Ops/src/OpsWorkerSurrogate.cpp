@@ -0,0 +1,491 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   OpsWorkerSurrogate.cpp
+//! @date   2026-10-18
+//!
+//! @brief Contains the optimization worker class for the surrogate-assisted algorithm
+//!
+//$Id$
+
+#include "OpsWorkerSurrogate.h"
+#include "OpsEvaluator.h"
+#include "OpsMessageHandler.h"
+#include <math.h>
+#include <algorithm>
+#include <limits>
+
+using namespace Ops;
+
+namespace {
+
+//! @brief Solves A*x = b with Gaussian elimination and partial pivoting, A and b are overwritten
+//! @returns False if the matrix is singular
+bool solveLinearSystem(std::vector<std::vector<double> > &rA, std::vector<double> &rB, std::vector<double> &rX)
+{
+    const size_t n = rB.size();
+    double maxAbs = 0;
+    for(size_t i=0; i<n; ++i)
+    {
+        for(size_t j=0; j<n; ++j)
+        {
+            maxAbs = std::max(maxAbs, fabs(rA[i][j]));
+        }
+    }
+
+    for(size_t k=0; k<n; ++k)
+    {
+        size_t pivot = k;
+        for(size_t i=k+1; i<n; ++i)
+        {
+            if(fabs(rA[i][k]) > fabs(rA[pivot][k]))
+            {
+                pivot = i;
+            }
+        }
+        if(fabs(rA[pivot][k]) <= 1e-14*maxAbs)
+        {
+            return false;
+        }
+        std::swap(rA[k], rA[pivot]);
+        std::swap(rB[k], rB[pivot]);
+
+        for(size_t i=k+1; i<n; ++i)
+        {
+            const double factor = rA[i][k]/rA[k][k];
+            for(size_t j=k; j<n; ++j)
+            {
+                rA[i][j] -= factor*rA[k][j];
+            }
+            rB[i] -= factor*rB[k];
+        }
+    }
+
+    rX.resize(n);
+    for(size_t k=n; k-->0;)
+    {
+        double sum = rB[k];
+        for(size_t j=k+1; j<n; ++j)
+        {
+            sum -= rA[k][j]*rX[j];
+        }
+        rX[k] = sum/rA[k][k];
+    }
+    return true;
+}
+
+double distance(const std::vector<double> &rA, const std::vector<double> &rB)
+{
+    double sum = 0;
+    for(size_t i=0; i<rA.size(); ++i)
+    {
+        sum += (rA[i]-rB[i])*(rA[i]-rB[i]);
+    }
+    return sqrt(sum);
+}
+
+//! @brief Scaled points closer than this are considered the same point, they would make the interpolation system singular
+const double gDuplicatePointDistance = 1e-9;
+
+}
+
+
+//! @brief Initializes a surrogate-assisted optimization
+WorkerSurrogate::WorkerSurrogate(Evaluator *pEvaluator, MessageHandler *pMessageHandler)
+    : Worker(pEvaluator, pMessageHandler)
+{
+    mNumTrialPoints = 500;
+    mMaxPerturbation = 0.2;
+    mPerturbation = mMaxPerturbation;
+    mBestEvaluatedId = 0;
+    mHaveSurrogate = false;
+}
+
+AlgorithmT WorkerSurrogate::getAlgorithm()
+{
+    return Surrogate;
+}
+
+
+void WorkerSurrogate::initialize()
+{
+    Worker::initialize();
+
+    mEvaluatedPoints.clear();
+    mEvaluatedObjectives.clear();
+    mBestEvaluatedId = 0;
+    mHaveSurrogate = false;
+}
+
+
+//! @brief Executes a surrogate-assisted optimization
+void WorkerSurrogate::run()
+{
+    if(mNumPoints < mNumParameters+1)
+    {
+        mpMessageHandler->printMessage("Error: Surrogate-assisted algorithm requires more points than parameters.");
+        return;
+    }
+
+    mpMessageHandler->printMessage("Running optimization with surrogate-assisted algorithm.");
+
+    distributePoints();
+
+    //Evaluate initial objective values
+    mpEvaluator->evaluateAllPoints();
+    mpMessageHandler->objectivesChanged();
+
+    for(size_t p=0; p<mNumPoints; ++p)
+    {
+        addEvaluatedPoint(mPoints[p], mObjectives[p]);
+    }
+    calculateBestAndWorstId();
+
+    //Alternate between trusting the surrogate and exploring far from evaluated points
+    const double surrogateWeights[] = {0.3, 0.5, 0.8, 0.95};
+    const size_t maxFailures = std::max(size_t(3), mNumParameters);
+    size_t nFailures=0, nSuccesses=0;
+    mPerturbation = mMaxPerturbation;
+
+    mIterationCounter=0;
+    for(; mIterationCounter<mnMaxIterations && !mpMessageHandler->aborted(); ++mIterationCounter)
+    {
+        //Check convergence
+        if(checkForConvergence()) break;
+
+        //Let the surrogate select which trial points to evaluate
+        mHaveSurrogate = fitSurrogate();
+        if(!mHaveSurrogate)
+        {
+            mpMessageHandler->printMessage("Warning: Could not fit the surrogate model, selecting candidates by distance only in iteration "+std::to_string(mIterationCounter)+".");
+        }
+        std::vector<std::vector<double> > trialPoints;
+        generateTrialPoints(trialPoints);
+        selectCandidates(trialPoints, surrogateWeights[mIterationCounter % 4]);
+        mpMessageHandler->candidatesChanged();
+
+        const double previousBest = mEvaluatedObjectives[mBestEvaluatedId];
+        mpEvaluator->evaluateAllCandidates();
+
+        //Keep the best evaluated points
+        for(size_t c=0; c<mNumCandidates; ++c)
+        {
+            addEvaluatedPoint(mCandidatePoints[c], mCandidateObjectives[c]);
+            calculateBestAndWorstId();
+            if(mCandidateObjectives[c] < mObjectives[mWorstId])
+            {
+                mPoints[mWorstId] = mCandidatePoints[c];
+                mObjectives[mWorstId] = mCandidateObjectives[c];
+                mpMessageHandler->pointChanged(mWorstId);
+                mpMessageHandler->objectiveChanged(mWorstId);
+            }
+        }
+        calculateBestAndWorstId();
+
+        //Search closer to the best point after repeated failures to improve it, and wider after repeated successes
+        if(mEvaluatedObjectives[mBestEvaluatedId] < previousBest-1e-3*fabs(previousBest))
+        {
+            ++nSuccesses;
+            nFailures = 0;
+        }
+        else
+        {
+            ++nFailures;
+            nSuccesses = 0;
+        }
+        if(nFailures >= maxFailures)
+        {
+            mPerturbation = std::max(mPerturbation/2.0, std::max(mTolerance, 1e-6));
+            nFailures = 0;
+        }
+        else if(nSuccesses >= 3)
+        {
+            mPerturbation = std::min(mPerturbation*2.0, mMaxPerturbation);
+            nSuccesses = 0;
+        }
+
+        mpMessageHandler->stepCompleted(mIterationCounter);
+    }
+
+    if(mpMessageHandler->aborted())
+    {
+        mpMessageHandler->printMessage("Optimization was aborted after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+    else if(mIterationCounter == mnMaxIterations)
+    {
+        mpMessageHandler->printMessage("Optimization failed to converge after "+std::to_string(mIterationCounter)+" iterations");
+    }
+    else
+    {
+        mpMessageHandler->printMessage("Optimization converged in parameter values after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+
+    // Clean up
+    finalize();
+
+    return;
+}
+
+
+//! @brief Set number of trial points that are ranked by the surrogate in each iteration
+void WorkerSurrogate::setNumberOfTrialPoints(size_t value)
+{
+    mNumTrialPoints = std::max(size_t(1), value);
+}
+
+
+//! @brief Set the initial standard deviation of trial points around the best point, relative to the parameter ranges
+void WorkerSurrogate::setPerturbation(double value)
+{
+    mMaxPerturbation = value;
+}
+
+
+//! @brief Scales a point to [0,1] for each parameter
+std::vector<double> WorkerSurrogate::scale(const std::vector<double> &rPoint) const
+{
+    std::vector<double> scaled(mNumParameters, 0.0);
+    for(size_t i=0; i<mNumParameters; ++i)
+    {
+        if(mParameterMax[i] > mParameterMin[i])
+        {
+            scaled[i] = (rPoint[i]-mParameterMin[i])/(mParameterMax[i]-mParameterMin[i]);
+        }
+    }
+    return scaled;
+}
+
+
+//! @brief Scales a point from [0,1] to the parameter limits
+std::vector<double> WorkerSurrogate::unscale(const std::vector<double> &rPoint) const
+{
+    std::vector<double> unscaled(mNumParameters);
+    for(size_t i=0; i<mNumParameters; ++i)
+    {
+        unscaled[i] = mParameterMin[i] + rPoint[i]*(mParameterMax[i]-mParameterMin[i]);
+    }
+    return unscaled;
+}
+
+
+//! @brief Adds an evaluated point to the data that the surrogate is fitted to
+//! @details A point that coincides with an already evaluated point is merged with it, keeping the lowest objective value
+void WorkerSurrogate::addEvaluatedPoint(const std::vector<double> &rPoint, double objective)
+{
+    const std::vector<double> scaled = scale(rPoint);
+    size_t id = mEvaluatedPoints.size();
+    for(size_t i=0; i<mEvaluatedPoints.size(); ++i)
+    {
+        if(distance(scaled, mEvaluatedPoints[i]) < gDuplicatePointDistance)
+        {
+            id = i;
+            break;
+        }
+    }
+    if(id == mEvaluatedPoints.size())
+    {
+        mEvaluatedPoints.push_back(scaled);
+        mEvaluatedObjectives.push_back(objective);
+    }
+    else
+    {
+        mEvaluatedObjectives[id] = std::min(mEvaluatedObjectives[id], objective);
+    }
+    if(mEvaluatedObjectives[id] < mEvaluatedObjectives[mBestEvaluatedId])
+    {
+        mBestEvaluatedId = id;
+    }
+}
+
+
+//! @brief Fits the surrogate to all evaluated points
+//! @details Objective values above the median are replaced by the median, so that bad points do not dominate the fit
+//! @returns False if the interpolation system is singular
+bool WorkerSurrogate::fitSurrogate()
+{
+    const size_t n = mEvaluatedPoints.size();
+    const size_t m = mNumParameters+1;
+
+    std::vector<double> sortedObjectives = mEvaluatedObjectives;
+    std::nth_element(sortedObjectives.begin(), sortedObjectives.begin()+n/2, sortedObjectives.end());
+    const double median = sortedObjectives[n/2];
+
+    std::vector<std::vector<double> > A(n+m, std::vector<double>(n+m, 0.0));
+    std::vector<double> b(n+m, 0.0);
+    for(size_t i=0; i<n; ++i)
+    {
+        for(size_t j=0; j<n; ++j)
+        {
+            const double r = distance(mEvaluatedPoints[i], mEvaluatedPoints[j]);
+            A[i][j] = r*r*r;
+        }
+        A[i][n] = A[n][i] = 1.0;
+        for(size_t k=0; k<mNumParameters; ++k)
+        {
+            A[i][n+1+k] = A[n+1+k][i] = mEvaluatedPoints[i][k];
+        }
+        b[i] = std::min(mEvaluatedObjectives[i], median);
+    }
+
+    std::vector<double> x;
+    if(!solveLinearSystem(A, b, x))
+    {
+        return false;
+    }
+    mRbfWeights.assign(x.begin(), x.begin()+n);
+    mPolynomialCoefficients.assign(x.begin()+n, x.end());
+    return true;
+}
+
+
+//! @brief Returns the surrogate value at a scaled point
+double WorkerSurrogate::evaluateSurrogate(const std::vector<double> &rPoint) const
+{
+    double value = mPolynomialCoefficients[0];
+    for(size_t k=0; k<mNumParameters; ++k)
+    {
+        value += mPolynomialCoefficients[1+k]*rPoint[k];
+    }
+    for(size_t i=0; i<mRbfWeights.size(); ++i)
+    {
+        const double r = distance(rPoint, mEvaluatedPoints[i]);
+        value += mRbfWeights[i]*r*r*r;
+    }
+    return value;
+}
+
+
+//! @brief Generates scaled trial points, half of them around the best evaluated point and half of them uniformly
+//! @details Around the best point, each parameter is perturbed with a probability that decreases with the number of
+//! parameters, so that the search stays local also for many parameters
+void WorkerSurrogate::generateTrialPoints(std::vector<std::vector<double> > &rTrialPoints)
+{
+    const std::vector<double> &rBest = mEvaluatedPoints[mBestEvaluatedId];
+    const double perturbationProbability = std::min(1.0, 20.0/double(mNumParameters));
+
+    rTrialPoints.resize(mNumTrialPoints);
+    for(size_t t=0; t<mNumTrialPoints; ++t)
+    {
+        std::vector<double> &rTrial = rTrialPoints[t];
+        rTrial.resize(mNumParameters);
+        if(t % 2 == 0)
+        {
+            rTrial = rBest;
+            bool perturbed = false;
+            while(!perturbed)
+            {
+                for(size_t i=0; i<mNumParameters; ++i)
+                {
+                    if(opsRand() < perturbationProbability)
+                    {
+                        rTrial[i] = std::max(0.0, std::min(1.0, rBest[i] + mPerturbation*gaussianRand()));
+                        perturbed = true;
+                    }
+                }
+            }
+        }
+        else
+        {
+            for(size_t i=0; i<mNumParameters; ++i)
+            {
+                rTrial[i] = opsRand();
+            }
+        }
+    }
+}
+
+
+//! @brief Selects candidates among the trial points, by a weighted sum of the surrogate value and the distance to evaluated points
+//! @param[in] rTrialPoints Scaled trial points
+//! @param[in] surrogateWeight Weight of the surrogate value, between 0 and 1, the rest of the weight is on a large distance
+void WorkerSurrogate::selectCandidates(const std::vector<std::vector<double> > &rTrialPoints, const double surrogateWeight)
+{
+    const size_t nTrials = rTrialPoints.size();
+    std::vector<double> surrogateValues(nTrials, 0.0);
+    std::vector<double> distances(nTrials, std::numeric_limits<double>::max());
+    for(size_t t=0; t<nTrials; ++t)
+    {
+        if(mHaveSurrogate)
+        {
+            surrogateValues[t] = evaluateSurrogate(rTrialPoints[t]);
+        }
+        for(size_t i=0; i<mEvaluatedPoints.size(); ++i)
+        {
+            distances[t] = std::min(distances[t], distance(rTrialPoints[t], mEvaluatedPoints[i]));
+        }
+    }
+
+    for(size_t c=0; c<mNumCandidates; ++c)
+    {
+        double minValue = std::numeric_limits<double>::max(), maxValue = -minValue;
+        double minDistance = minValue, maxDistance = 0;
+        for(size_t t=0; t<nTrials; ++t)
+        {
+            minValue = std::min(minValue, surrogateValues[t]);
+            maxValue = std::max(maxValue, surrogateValues[t]);
+            minDistance = std::min(minDistance, distances[t]);
+            maxDistance = std::max(maxDistance, distances[t]);
+        }
+
+        //Points that have already been evaluated or selected are never selected
+        size_t selected = 0;
+        double bestScore = std::numeric_limits<double>::max();
+        for(size_t t=0; t<nTrials; ++t)
+        {
+            if(distances[t] < gDuplicatePointDistance)
+            {
+                continue;
+            }
+            const double valueScore = (maxValue > minValue) ? (surrogateValues[t]-minValue)/(maxValue-minValue) : 1.0;
+            const double distanceScore = (maxDistance > minDistance) ? (maxDistance-distances[t])/(maxDistance-minDistance) : 1.0;
+            const double score = surrogateWeight*valueScore + (1.0-surrogateWeight)*distanceScore;
+            if(score < bestScore)
+            {
+                bestScore = score;
+                selected = t;
+            }
+        }
+
+        mCandidatePoints[c] = unscale(rTrialPoints[selected]);
+        mpMessageHandler->candidateChanged(c);
+
+        //Spread the candidates by including the selected point in the distances
+        for(size_t t=0; t<nTrials; ++t)
+        {
+            distances[t] = std::min(distances[t], distance(rTrialPoints[t], rTrialPoints[selected]));
+        }
+    }
+}
+
+
+//! @brief Returns a random number from the standard normal distribution (Box-Muller transform)
+double WorkerSurrogate::gaussianRand()
+{
+    const double u1 = std::max(opsRand(), std::numeric_limits<double>::min());
+    const double u2 = opsRand();
+    const double pi = 3.14159265358979323846;
+    return sqrt(-2.0*log(u1))*cos(2.0*pi*u2);
+}
@@ -15,6 +15,9 @@ class hopsan:
     def loadModel(self, path):
         self.hdll.loadModel(path.encode())
 
+    def resetModel(self):
+        self.hdll.resetModel()
+
     def simulate(self):
         self.hdll.simulate()
 
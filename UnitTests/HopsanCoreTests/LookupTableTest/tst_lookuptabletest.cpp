@@ -114,6 +114,8 @@ private Q_SLOTS:
     void lookup2D_data();
     void lookup3D();
     void lookup3D_data();
+    void findIndex();
+    void findIndex_data();
 };
 
 LookupTableTest::LookupTableTest()
@@ -194,6 +196,10 @@ void LookupTableTest::lookup2D()
         {
             const double val = lookup2d.interpolate(in.x(), in.y());
             QVERIFY2(fc(val, out, eps), QString("Interpolate returned the wrong result: %1!=%2").arg(val).arg(out).toLatin1());
+
+            QVERIFY2(lookup2d.calcCellCoefficients(), "Failed to calculate cell coefficients");
+            const double cval = lookup2d.interpolate(in.x(), in.y());
+            QVERIFY2(fc(cval, out, eps), QString("Interpolate with cell coefficients returned the wrong result: %1!=%2").arg(cval).arg(out).toLatin1());
         }
         else
         {
@@ -240,6 +246,10 @@ void LookupTableTest::lookup3D()
         {
             const double val = lookup3d.interpolate(in.r, in.c, in.p);
             QVERIFY2(fc(val, out, eps), QString("Interpolate returned the wrong result: %1!=%2, diff:%3").arg(val).arg(out).arg(val-out).toLatin1());
+
+            QVERIFY2(lookup3d.calcCellCoefficients(), "Failed to calculate cell coefficients");
+            const double cval = lookup3d.interpolate(in.r, in.c, in.p);
+            QVERIFY2(fc(cval, out, eps), QString("Interpolate with cell coefficients returned the wrong result: %1!=%2, diff:%3").arg(cval).arg(out).arg(cval-out).toLatin1());
         }
         else
         {
@@ -480,6 +490,62 @@ void LookupTableTest::lookup3D_data()
 
 }
 
+void LookupTableTest::findIndex()
+{
+    QFETCH(QVector<double>, indexData);
+    QFETCH(bool, isUniform);
+    QFETCH(QVector<double>, in);
+
+    LookupTable1D lookup1d;
+    lookup1d.getIndexDataRef() = indexData.toStdVector();
+    lookup1d.getValueDataRef() = indexData.toStdVector();
+    QVERIFY2(lookup1d.isDataOK(), "Failed: Data is NOT OK");
+    QVERIFY2(lookup1d.isIndexUniform(0) == isUniform, "Uniform index data was not correctly detected");
+
+    // The lookup must give the same interval as a linear search, regardless of where the previous lookup ended up
+    // A value exactly on an index point belongs to the lower interval
+    for (int i=0; i<in.size(); ++i)
+    {
+        size_t expected = 0;
+        while ( (int(expected) < indexData.size()-2) && (indexData[int(expected)+1] < in[i]) )
+        {
+            ++expected;
+        }
+        const size_t idx = lookup1d.findIndexAlongDim(0, in[i]);
+        QVERIFY2(idx == expected, QString("Wrong interval for %1: %2!=%3").arg(in[i]).arg(idx).arg(expected).toLatin1());
+    }
+}
+
+void LookupTableTest::findIndex_data()
+{
+    QTest::addColumn< QVector<double> >("indexData");
+    QTest::addColumn< bool >("isUniform");
+    QTest::addColumn< QVector<double> >("in");
+
+    QVector<double> uniform, nonUniform, sweep, jumps, nodes;
+    for (int i=0; i<11; ++i)
+    {
+        uniform << -1.0 + 0.2*i;
+        nonUniform << -1.0 + 0.02*i*i;
+    }
+    for (int i=0; i<=100; ++i)
+    {
+        sweep << -1.0 + 0.02*i;
+    }
+    for (int i=100; i>=0; --i)
+    {
+        sweep << -1.0 + 0.02*i;
+    }
+    jumps << 0.95 << -0.95 << 0.5 << -0.5 << 0.99 << -1.0 << 0.0 << 1.0 << -0.31 << 0.62;
+
+    QTest::newRow("uniform_sweep") << uniform << true << sweep;
+    QTest::newRow("uniform_jumps") << uniform << true << jumps;
+    QTest::newRow("uniform_nodes") << uniform << true << uniform;
+    QTest::newRow("nonuniform_sweep") << nonUniform << false << sweep;
+    QTest::newRow("nonuniform_jumps") << nonUniform << false << jumps;
+    QTest::newRow("nonuniform_nodes") << nonUniform << false << nonUniform;
+}
+
 QTEST_APPLESS_MAIN(LookupTableTest)
 
 #include "tst_lookuptabletest.moc"
@@ -0,0 +1,32 @@
+#-------------------------------------------------
+#
+# MultiThreadingTest
+#
+#-------------------------------------------------
+QT       += testlib
+QT       -= gui
+
+#Determine debug extension
+include( ../../../Common.prf )
+
+TARGET = tst_multithreadingtest$${DEBUG_EXT}
+CONFIG   += console
+CONFIG   -= app_bundle
+DESTDIR = $${PWD}/../../../bin
+
+TEMPLATE = app
+
+INCLUDEPATH += $${PWD}/../../../HopsanCore/include/
+LIBS += -L$${PWD}/../../../bin -lhopsancore$${DEBUG_EXT}
+DEFINES *= HOPSANCORE_DLLIMPORT
+
+unix{
+QMAKE_LFLAGS *= -Wl,-rpath,\'\$$ORIGIN/./\'
+
+}
+
+QMAKE_CXXFLAGS += -std=c++11
+
+SOURCES += \
+    tst_multithreadingtest.cpp
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
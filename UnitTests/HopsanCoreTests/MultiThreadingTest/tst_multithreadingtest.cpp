@@ -0,0 +1,480 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+#include <QString>
+#include <QtTest>
+
+#include "ComponentEssentials.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
+
+using namespace hopsan;
+
+namespace {
+
+//! @brief Minimal C-type component that only counts its time steps
+class CountingComponent : public ComponentC
+{
+public:
+    CountingComponent() : mnSteps(0) {}
+
+    void configure() {}
+    void initialize() { mnSteps = 0; }
+    void simulateOneTimestep() { ++mnSteps; }
+
+    size_t mnSteps;
+};
+
+std::vector<Component*> createCountingComponents(const size_t nComponents)
+{
+    std::vector<Component*> components;
+    for(size_t i=0; i<nComponents; ++i)
+    {
+        Component *pComp = new CountingComponent();
+        pComp->initialize(0, 1);
+        components.push_back(pComp);
+    }
+    return components;
+}
+
+void deleteCountingComponents(std::vector<Component*> &rComponents)
+{
+    for(size_t i=0; i<rComponents.size(); ++i)
+    {
+        delete static_cast<CountingComponent*>(rComponents[i]);
+    }
+    rComponents.clear();
+}
+
+// Overloads so that the same stealing worker can be used with both deque types
+inline Component *takeOwn(WorkStealingDeque *pDeque) { return pDeque->popBottom(); }
+inline Component *stealFrom(WorkStealingDeque *pDeque) { return pDeque->steal(); }
+inline void putFinished(WorkStealingDeque *pDeque, Component *pComp) { pDeque->pushBottom(pComp); }
+inline Component *takeOwn(ThreadSafeVector *pVector) { return pVector->tryAndTakeFirst(); }
+inline Component *stealFrom(ThreadSafeVector *pVector) { return pVector->tryAndTakeLast(); }
+inline void putFinished(ThreadSafeVector *pVector, Component *pComp) { pVector->insertLast(pComp); }
+
+//! @brief Stealing simulation thread, in each round it simulates its own components and then steals from the other threads until all components are done
+//! @details Finished components are swapped in as the threads own components in the next round, like in simStealingMaster/simStealingSlave
+template<typename DequeT>
+void stealingWorker(std::vector<DequeT*> *pOwnDeques, DequeT *pFinished, size_t threadID, size_t nRounds, double timestep,
+                    std::atomic<size_t> *pnDone, size_t nTotal, SpinFutexBarrier *pBarrier)
+{
+    int sense=0;
+    const size_t nThreads = pOwnDeques->size();
+    for(size_t r=0; r<nRounds; ++r)
+    {
+        const double time = (r+1)*timestep;
+        pBarrier->wait(sense);
+
+        DequeT *pOwn = pOwnDeques->at(threadID);
+        Component *pComp = takeOwn(pOwn);
+        while(pComp)
+        {
+            pComp->simulate(time);
+            putFinished(pFinished, pComp);
+            pnDone->fetch_add(1);
+            pComp = takeOwn(pOwn);
+        }
+        while(pnDone->load() < nTotal*(r+1))
+        {
+            for(size_t i=1; i<nThreads; ++i)
+            {
+                pComp = stealFrom(pOwnDeques->at((threadID+i)%nThreads));
+                if(pComp)
+                {
+                    pComp->simulate(time);
+                    putFinished(pFinished, pComp);
+                    pnDone->fetch_add(1);
+                }
+            }
+        }
+
+        // Everyone must be done stealing before the deques are swapped
+        pBarrier->wait(sense);
+        pOwnDeques->at(threadID) = pFinished;
+        pFinished = pOwn;
+    }
+    delete pFinished;
+}
+
+//! @brief Simulates all components nRounds times with nThreads stealing threads
+//! @details All components start in the first two threads, so that the other threads have to steal
+template<typename DequeT>
+void runStealingRounds(std::vector<Component*> &rComponents, size_t nThreads, size_t nRounds, double timestep)
+{
+    std::vector< std::vector<Component*> > split(nThreads);
+    for(size_t i=0; i<rComponents.size(); ++i)
+    {
+        split[(i*2/rComponents.size())%nThreads].push_back(rComponents[i]);
+    }
+    std::vector<DequeT*> deques;
+    for(size_t t=0; t<nThreads; ++t)
+    {
+        deques.push_back(new DequeT(split[t], rComponents.size()));
+    }
+
+    std::atomic<size_t> nDone(0);
+    SpinFutexBarrier barrier(nThreads);
+    std::vector<std::thread> threads;
+    for(size_t t=1; t<nThreads; ++t)
+    {
+        threads.push_back(std::thread(stealingWorker<DequeT>, &deques, new DequeT(std::vector<Component*>(), rComponents.size()),
+                                      t, nRounds, timestep, &nDone, rComponents.size(), &barrier));
+    }
+    stealingWorker<DequeT>(&deques, new DequeT(std::vector<Component*>(), rComponents.size()),
+                           0, nRounds, timestep, &nDone, rComponents.size(), &barrier);
+    for(size_t t=0; t<threads.size(); ++t)
+    {
+        threads[t].join();
+    }
+
+    for(size_t t=0; t<nThreads; ++t)
+    {
+        delete deques[t];
+    }
+}
+
+//! @brief Waits nRounds times at a spin/futex barrier, optionally requesting stop in round stopRound
+void waitAtSpinFutexBarrier(SpinFutexBarrier *pBarrier, size_t nRounds, size_t stopRound, size_t *pnPassedRounds)
+{
+    int sense=0;
+    size_t r=0;
+    for(; r<nRounds; ++r)
+    {
+        if(!pBarrier->wait(sense, r == stopRound))
+        {
+            break;
+        }
+    }
+    *pnPassedRounds = r;
+}
+
+//! @brief Slave side of a master driven BarrierLock round trip
+void waitAtBarrierLock(BarrierLock *pBarrierA, BarrierLock *pBarrierB, size_t nRounds)
+{
+    for(size_t r=0; r<nRounds; ++r)
+    {
+        pBarrierA->increment();
+        while(pBarrierA->isLocked()) {}
+        pBarrierB->increment();
+        while(pBarrierB->isLocked()) {}
+    }
+}
+
+//! @brief Master side of a master driven BarrierLock round trip
+void driveBarrierLock(BarrierLock *pBarrierA, BarrierLock *pBarrierB, size_t nRounds)
+{
+    for(size_t r=0; r<nRounds; ++r)
+    {
+        while(!pBarrierA->allArrived()) {}
+        pBarrierB->lock();
+        pBarrierA->unlock();
+        while(!pBarrierB->allArrived()) {}
+        pBarrierA->lock();
+        pBarrierB->unlock();
+    }
+}
+
+}
+
+class MultiThreadingTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void WorkerThreadPool_Simulate_All_Components()
+    {
+        QFETCH(int, nThreads);
+        const size_t nSteps = 100;
+        const double timestep = 0.001;
+
+        std::vector<Component*> components = createCountingComponents(37);
+        std::vector< std::vector<Component*> > groups(3);
+        std::vector<Component*> groupedComponents = createCountingComponents(11);
+        for(size_t i=0; i<groupedComponents.size(); ++i)
+        {
+            groups[i%groups.size()].push_back(groupedComponents[i]);
+        }
+
+        WorkerThreadPool pool(determineActualNumberOfThreads(nThreads));
+        for(size_t s=1; s<=nSteps; ++s)
+        {
+            pool.simulateComponents(components, s*timestep);
+            pool.simulateComponentGroups(groups, s*timestep);
+        }
+
+        for(size_t i=0; i<components.size(); ++i)
+        {
+            QCOMPARE(static_cast<CountingComponent*>(components[i])->mnSteps, nSteps);
+        }
+        for(size_t i=0; i<groupedComponents.size(); ++i)
+        {
+            QCOMPARE(static_cast<CountingComponent*>(groupedComponents[i])->mnSteps, nSteps);
+        }
+
+        deleteCountingComponents(components);
+        deleteCountingComponents(groupedComponents);
+    }
+
+    void WorkerThreadPool_Simulate_All_Components_data()
+    {
+        addThreadRows();
+    }
+
+    //! @brief Measures the dispatch overhead of the parallel for-loop worker pool, one iteration is 1000 steps of 64 empty components
+    void WorkerThreadPool_Step_Overhead_Benchmark()
+    {
+        QFETCH(int, nThreads);
+        const double timestep = 0.001;
+
+        std::vector<Component*> components = createCountingComponents(64);
+        WorkerThreadPool pool(determineActualNumberOfThreads(nThreads));
+        size_t step=0;
+        QBENCHMARK
+        {
+            for(size_t s=0; s<1000; ++s)
+            {
+                ++step;
+                pool.simulateComponents(components, step*timestep);
+            }
+        }
+        deleteCountingComponents(components);
+    }
+
+    void WorkerThreadPool_Step_Overhead_Benchmark_data()
+    {
+        addThreadRows();
+    }
+
+    void SpinFutexBarrier_Synchronize_And_Stop()
+    {
+        QFETCH(int, nThreads);
+        QFETCH(int, spinCount);
+        const size_t nRounds = 1000;
+        const size_t stopRound = 500;
+
+        SpinFutexBarrier barrier(nThreads, spinCount);
+        std::vector<size_t> passedRounds(nThreads, 0);
+        std::vector<std::thread> threads;
+        for(int t=1; t<nThreads; ++t)
+        {
+            threads.push_back(std::thread(waitAtSpinFutexBarrier, &barrier, nRounds, nRounds, &passedRounds[t]));
+        }
+        // The master requests stop, all threads must agree on the round where they stopped
+        waitAtSpinFutexBarrier(&barrier, nRounds, stopRound, &passedRounds[0]);
+        for(size_t t=0; t<threads.size(); ++t)
+        {
+            threads[t].join();
+        }
+
+        for(int t=0; t<nThreads; ++t)
+        {
+            QCOMPARE(passedRounds[t], stopRound);
+        }
+    }
+
+    void SpinFutexBarrier_Synchronize_And_Stop_data()
+    {
+        QTest::addColumn<int>("nThreads");
+        QTest::addColumn<int>("spinCount");
+        QTest::newRow("2 threads, spin") << 2 << HOPSAN_DEFAULT_BARRIER_SPIN_COUNT;
+        QTest::newRow("4 threads, spin") << 4 << HOPSAN_DEFAULT_BARRIER_SPIN_COUNT;
+        QTest::newRow("4 threads, sleep") << 4 << 0;
+        QTest::newRow("8 threads, spin") << 8 << HOPSAN_DEFAULT_BARRIER_SPIN_COUNT;
+    }
+
+    //! @brief Measures spin/futex barrier round trip time, one iteration is 1000 barrier rounds
+    //! @note Thread counts are not limited by the number of cores, to show behavior when oversubscribed
+    void SpinFutexBarrier_RoundTrip_Benchmark()
+    {
+        QFETCH(int, nThreads);
+        const size_t nRounds = 1000;
+
+        SpinFutexBarrier barrier(nThreads);
+        std::vector<size_t> passedRounds(nThreads, 0);
+        std::vector<std::thread> threads;
+        QBENCHMARK
+        {
+            for(int t=1; t<nThreads; ++t)
+            {
+                threads.push_back(std::thread(waitAtSpinFutexBarrier, &barrier, nRounds, nRounds, &passedRounds[t]));
+            }
+            waitAtSpinFutexBarrier(&barrier, nRounds, nRounds, &passedRounds[0]);
+            for(size_t t=0; t<threads.size(); ++t)
+            {
+                threads[t].join();
+            }
+            threads.clear();
+        }
+    }
+
+    void SpinFutexBarrier_RoundTrip_Benchmark_data()
+    {
+        QTest::addColumn<int>("nThreads");
+        QTest::newRow("2 threads") << 2;
+        QTest::newRow("4 threads") << 4;
+        QTest::newRow("8 threads") << 8;
+        QTest::newRow("16 threads") << 16;
+    }
+
+    //! @brief Measures busy-wait BarrierLock round trip time for comparison, one iteration is 1000 barrier rounds
+    //! @note Thread counts are limited by the number of cores, busy waiting stalls badly when oversubscribed
+    void BarrierLock_RoundTrip_Benchmark()
+    {
+        QFETCH(int, nThreads);
+        const size_t nRounds = 1000;
+        const size_t nActualThreads = determineActualNumberOfThreads(nThreads);
+
+        BarrierLock barrierA(nActualThreads), barrierB(nActualThreads);
+        std::vector<std::thread> threads;
+        QBENCHMARK
+        {
+            barrierA.lock();
+            barrierB.lock();
+            for(size_t t=1; t<nActualThreads; ++t)
+            {
+                threads.push_back(std::thread(waitAtBarrierLock, &barrierA, &barrierB, nRounds));
+            }
+            driveBarrierLock(&barrierA, &barrierB, nRounds);
+            for(size_t t=0; t<threads.size(); ++t)
+            {
+                threads[t].join();
+            }
+            threads.clear();
+        }
+    }
+
+    void BarrierLock_RoundTrip_Benchmark_data()
+    {
+        SpinFutexBarrier_RoundTrip_Benchmark_data();
+    }
+
+    void WorkStealingDeque_Single_Thread_Order()
+    {
+        std::vector<Component*> components = createCountingComponents(5);
+        WorkStealingDeque deque(components, 5);     // Capacity is rounded up to 8
+        QCOMPARE(deque.size(), size_t(5));
+        QVERIFY(deque.steal() == components[0]);    // Thieves take from the top
+        QVERIFY(deque.popBottom() == components[4]);// Owner takes from the bottom
+        deque.pushBottom(components[4]);
+        QVERIFY(deque.popBottom() == components[4]);
+        QVERIFY(deque.popBottom() == components[3]);
+        QVERIFY(deque.steal() == components[1]);
+        QVERIFY(deque.popBottom() == components[2]);
+        QVERIFY(deque.popBottom() == 0);
+        QVERIFY(deque.steal() == 0);
+        QCOMPARE(deque.size(), size_t(0));
+        deleteCountingComponents(components);
+    }
+
+    void WorkStealingDeque_Simulate_Each_Component_Once()
+    {
+        QFETCH(int, nThreads);
+        const size_t nRounds = 50;
+        const double timestep = 0.001;
+
+        std::vector<Component*> components = createCountingComponents(301);
+        runStealingRounds<WorkStealingDeque>(components, nThreads, nRounds, timestep);
+        for(size_t i=0; i<components.size(); ++i)
+        {
+            QCOMPARE(static_cast<CountingComponent*>(components[i])->mnSteps, nRounds);
+        }
+        deleteCountingComponents(components);
+    }
+
+    void WorkStealingDeque_Simulate_Each_Component_Once_data()
+    {
+        addThreadRows();
+    }
+
+    //! @brief Measures stealing throughput with lock-free deques, one iteration is 100 rounds over 512 components that all start in two of the threads
+    void WorkStealingDeque_Scaling_Benchmark()
+    {
+        QFETCH(int, nThreads);
+        const double timestep = 0.001;
+
+        std::vector<Component*> components = createCountingComponents(512);
+        QBENCHMARK
+        {
+            for(size_t i=0; i<components.size(); ++i)
+            {
+                components[i]->initialize(0, 1);
+            }
+            runStealingRounds<WorkStealingDeque>(components, nThreads, 100, timestep);
+        }
+        deleteCountingComponents(components);
+    }
+
+    void WorkStealingDeque_Scaling_Benchmark_data()
+    {
+        addScalingRows();
+    }
+
+    //! @brief Same as WorkStealingDeque_Scaling_Benchmark but with the mutex protected ThreadSafeVector, for comparison
+    void ThreadSafeVector_Scaling_Benchmark()
+    {
+        QFETCH(int, nThreads);
+        const double timestep = 0.001;
+
+        std::vector<Component*> components = createCountingComponents(512);
+        QBENCHMARK
+        {
+            for(size_t i=0; i<components.size(); ++i)
+            {
+                components[i]->initialize(0, 1);
+            }
+            runStealingRounds<ThreadSafeVector>(components, nThreads, 100, timestep);
+        }
+        deleteCountingComponents(components);
+    }
+
+    void ThreadSafeVector_Scaling_Benchmark_data()
+    {
+        addScalingRows();
+    }
+
+private:
+    void addScalingRows()
+    {
+        QTest::addColumn<int>("nThreads");
+        QTest::newRow("2 threads") << 2;
+        QTest::newRow("4 threads") << 4;
+        QTest::newRow("8 threads") << 8;
+        QTest::newRow("16 threads") << 16;
+        QTest::newRow("32 threads") << 32;
+    }
+
+    void addThreadRows()
+    {
+        QTest::addColumn<int>("nThreads");
+        QTest::newRow("1 thread") << 1;
+        QTest::newRow("2 threads") << 2;
+        QTest::newRow("4 threads") << 4;
+        QTest::newRow("8 threads") << 8;
+    }
+};
+
+QTEST_APPLESS_MAIN(MultiThreadingTest)
+
+#include "tst_multithreadingtest.moc"
@@ -23,11 +23,17 @@
 -----------------------------------------------------------------------------*/
 
 #include <QtTest>
+#include <QDir>
 
 #include "HopsanEssentials.h"
 #include "HopsanCoreVersion.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
 #include "CoreUtilities/HmfLoader.h"
+#include "CoreUtilities/LogSink.h"
+#include "CoreUtilities/SaveRestoreSimulationPoint.h"
+#include "CoreUtilities/SimulationEnsemble.h"
+#include "ComponentUtilities/num2string.hpp"
+#include "Nodes.h"
 
 #include <assert.h>
 #include <algorithm>
@@ -979,18 +985,646 @@ private slots:
         QVERIFY2(mpSystemFromFile->getLogTimeVector()->size() == 2048, "Failed to simulate system!");
         QVERIFY2(mpSystemFromFile->getNumActuallyLoggedSamples() == 2048, "Failed to simulate system!");
 
-        std::vector<double> multiResults1 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(0);
-        std::vector<double> multiResults2 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(511);
-        std::vector<double> multiResults3 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(1023);
+        std::vector<double> multiResults1 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->getSample(0);
+        std::vector<double> multiResults2 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->getSample(511);
+        std::vector<double> multiResults3 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->getSample(1023);
         mpSystemFromFile->simulate(10.0);
-        std::vector<double> singleResults1 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(0);
-        std::vector<double> singleResults2 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(511);
-        std::vector<double> singleResults3 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(1023);
+        std::vector<double> singleResults1 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->getSample(0);
+        std::vector<double> singleResults2 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->getSample(511);
+        std::vector<double> singleResults3 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->getSample(1023);
         QVERIFY2(multiResults1 == singleResults1, "Single-threaded and multi-threaded simulation gave different results!");
         QVERIFY2(multiResults2 == singleResults2, "Single-threaded and multi-threaded simulation gave different results!");
         QVERIFY2(multiResults3 == singleResults3, "Single-threaded and multi-threaded simulation gave different results!");
     }
 
+    void System_Simulate_Graph_Partitioning()
+    {
+        Port *pPort = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        const std::vector<double> singlePressure = pPort->getLogDataVectorPtr()->getVariable(NodeHydraulic::Pressure);
+        const std::vector<double> singleFlow = pPort->getLogDataVectorPtr()->getVariable(NodeHydraulic::Flow);
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulateMultiThreaded(0, 10.0, 2, false, GraphPartitioningAlgorithm);
+        mpSystemFromFile->finalize();
+        QVERIFY2(mpSystemFromFile->getNumActuallyLoggedSamples() == 2048, "Failed to simulate system!");
+        QVERIFY2(pPort->getLogDataVectorPtr()->getVariable(NodeHydraulic::Pressure) == singlePressure, "Single-threaded and graph partitioned simulation gave different results!");
+        QVERIFY2(pPort->getLogDataVectorPtr()->getVariable(NodeHydraulic::Flow) == singleFlow, "Single-threaded and graph partitioned simulation gave different results!");
+    }
+
+    void System_Adaptive_Rescheduling()
+    {
+        // Four independent source-orifice-tank chains, giving eight C-type and four Q-type components
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        for (size_t c=0; c<4; ++c)
+        {
+            const HString idx = to_hstring(c);
+            const char *types[] = {"HydraulicPressureSourceC", "HydraulicLaminarOrifice", "HydraulicTankC"};
+            const char *names[] = {"Source", "Orifice", "Tank"};
+            for (size_t i=0; i<3; ++i)
+            {
+                Component *pComp = mHopsanCore.createComponent(types[i]);
+                pComp->setName(names[i]+idx);
+                pSystem->addComponent(pComp);
+            }
+            QVERIFY(pSystem->connect("Source"+idx, "P1", "Orifice"+idx, "P1"));
+            QVERIFY(pSystem->connect("Orifice"+idx, "P2", "Tank"+idx, "P1"));
+        }
+        pSystem->setDesiredTimestep(0.001);
+        QVERIFY(pSystem->initialize(0, 1.0));
+        pSystem->setAdaptiveRescheduling(true, 0.2);
+        pSystem->reschedule(2);
+
+        const Component::CQSEnumT types[] = {Component::CType, Component::QType};
+        const size_t nComponents[] = {8, 4};
+        for (size_t t=0; t<2; ++t)
+        {
+            // Make all components on the first thread heavy and all components on the second thread free
+            for (size_t thread=0; thread<2; ++thread)
+            {
+                std::vector<Component*> components = pSystem->getThreadComponents(thread, types[t]);
+                for (size_t i=0; i<components.size(); ++i)
+                {
+                    components[i]->setMeasuredTime(thread == 0 ? 1.0 : 0.0);
+                }
+            }
+        }
+        const size_t nHeavyC = pSystem->getThreadComponents(0, Component::CType).size();
+        const size_t nHeavyQ = pSystem->getThreadComponents(0, Component::QType).size();
+        QVERIFY(nHeavyC > 0 && nHeavyQ > 0);
+
+        QVERIFY2(pSystem->rescheduleIfImbalanced(0.5), "Imbalanced load was not rescheduled!");
+        QCOMPARE(pSystem->getNumAdaptiveReschedules(), size_t(1));
+        const size_t nHeavy[] = {nHeavyC, nHeavyQ};
+        for (size_t t=0; t<2; ++t)
+        {
+            std::vector<Component*> thread0 = pSystem->getThreadComponents(0, types[t]);
+            std::vector<Component*> thread1 = pSystem->getThreadComponents(1, types[t]);
+            QCOMPARE(thread0.size()+thread1.size(), nComponents[t]);
+
+            // Each component must be scheduled exactly once, and the heavy components must be spread over both threads
+            size_t nHeavyOnThread[] = {0, 0};
+            std::vector<Component*> all = thread0;
+            all.insert(all.end(), thread1.begin(), thread1.end());
+            for (size_t i=0; i<all.size(); ++i)
+            {
+                QCOMPARE(size_t(std::count(all.begin(), all.end(), all[i])), size_t(1));
+                if (all[i]->getMeasuredTime() > 0)
+                {
+                    ++nHeavyOnThread[(i < thread0.size()) ? 0 : 1];
+                }
+            }
+            QCOMPARE(nHeavyOnThread[0]+nHeavyOnThread[1], nHeavy[t]);
+            QVERIFY2(std::max(nHeavyOnThread[0], nHeavyOnThread[1]) - std::min(nHeavyOnThread[0], nHeavyOnThread[1]) <= 1,
+                     "Heavy components were not distributed evenly!");
+        }
+
+        pSystem->finalize();
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Simulate_Signal_Wavefront()
+    {
+        // Eight independent chains of gains, so that each dependency level has eight components
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        for (size_t c=0; c<8; ++c)
+        {
+            Component *pSource = mHopsanCore.createComponent("SignalSineWave");
+            pSource->setName("Source"+to_hstring(c));
+            pSystem->addComponent(pSource);
+            QVERIFY(pSource->setParameterValue("f#Value", to_hstring(c+1)));
+            HString previous = pSource->getName();
+            for (size_t g=0; g<4; ++g)
+            {
+                Component *pGain = mHopsanCore.createComponent("SignalGain");
+                pGain->setName("Gain"+to_hstring(c)+"_"+to_hstring(g));
+                pSystem->addComponent(pGain);
+                pSystem->connect(previous, "out", pGain->getName(), "in");
+                previous = pGain->getName();
+            }
+        }
+        pSystem->setDesiredTimestep(0.001);
+        pSystem->setNumLogSamples(100);
+
+        Port *pPort = pSystem->getSubComponent("Gain7_3")->getPort("out");
+        QVERIFY(pSystem->initialize(0, 1.0));
+        pSystem->simulate(1.0);
+        pSystem->finalize();
+        QCOMPARE(pSystem->getNumSignalLevels(), size_t(5));
+        const std::vector<double> singleResults = pPort->getLogDataVectorPtr()->getVariable(0);
+
+        pSystem->setSignalWavefront(true, 2);
+        QVERIFY(pSystem->isSignalWavefrontEnabled());
+        const ParallelAlgorithmT algorithms[] = {OfflineSchedulingAlgorithm, ParallelForAlgorithm};
+        for (size_t a=0; a<2; ++a)
+        {
+            QVERIFY(pSystem->initialize(0, 1.0));
+            pSystem->simulateMultiThreaded(0, 1.0, 2, false, algorithms[a]);
+            pSystem->finalize();
+            QVERIFY2(pPort->getLogDataVectorPtr()->getVariable(0) == singleResults, "Single-threaded and wavefront simulation gave different results!");
+        }
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Simulate_Node_Data_Arena()
+    {
+        Port *pPort = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector<double> results1 = pPort->getLogDataVectorPtr()->getSample(511);
+        std::vector<double> results2 = pPort->getLogDataVectorPtr()->getSample(2047);
+
+        mpSystemFromFile->setUseNodeDataArena(true);
+        QVERIFY(mpSystemFromFile->usesNodeDataArena());
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        double *pPressure = pPort->getNodeDataPtr(NodeHydraulic::Pressure);
+        QVERIFY(pPressure != &pPort->getDataVectorPtr()->at(NodeHydraulic::Pressure));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        QVERIFY2(pPort->getLogDataVectorPtr()->getSample(511) == results1, "Simulation with node data arena gave different results!");
+        QVERIFY2(pPort->getLogDataVectorPtr()->getSample(2047) == results2, "Simulation with node data arena gave different results!");
+        QCOMPARE(pPort->getDataVectorPtr()->at(NodeHydraulic::Pressure), *pPressure);
+
+        // Node data pointers must remain valid when the system is initialized again without changes
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        QVERIFY(pPort->getNodeDataPtr(NodeHydraulic::Pressure) == pPressure);
+        mpSystemFromFile->finalize();
+
+        mpSystemFromFile->setUseNodeDataArena(false);
+        QVERIFY(pPort->getNodeDataPtr(NodeHydraulic::Pressure) == &pPort->getDataVectorPtr()->at(NodeHydraulic::Pressure));
+    }
+
+    void System_Signal_Sort_Levels()
+    {
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        const char *names[] = {"Gain3", "Gain1", "Gain4", "Gain2"};
+        for (size_t i=0; i<4; ++i)
+        {
+            Component *pComp = mHopsanCore.createComponent("SignalGain");
+            pComp->setName(names[i]);
+            pSystem->addComponent(pComp);
+        }
+        pSystem->connect("Gain1", "out", "Gain2", "in");
+        pSystem->connect("Gain2", "out", "Gain3", "in");
+        pSystem->connect("Gain1", "out", "Gain4", "in");
+        pSystem->setDesiredTimestep(0.001);
+
+        // Components in the same level keep their original order
+        QVERIFY(pSystem->initialize(0, 1));
+        QCOMPARE(pSystem->getNumSignalLevels(), size_t(3));
+        QCOMPARE(pSystem->getSignalLevel(0).size(), size_t(1));
+        QVERIFY(pSystem->getSignalLevel(0)[0]->getName() == HString("Gain1"));
+        QCOMPARE(pSystem->getSignalLevel(1).size(), size_t(2));
+        QVERIFY(pSystem->getSignalLevel(1)[0]->getName() == HString("Gain4"));
+        QVERIFY(pSystem->getSignalLevel(1)[1]->getName() == HString("Gain2"));
+        QVERIFY(pSystem->getSignalLevel(2)[0]->getName() == HString("Gain3"));
+        QVERIFY(pSystem->getSignalLevel(3).empty());
+        pSystem->finalize();
+
+        // Closing the chain gives an algebraic loop
+        pSystem->connect("Gain3", "out", "Gain1", "in");
+        QVERIFY2(!pSystem->initialize(0, 1), "Algebraic loop was not detected!");
+        QCOMPARE(pSystem->getNumSignalLevels(), size_t(0));
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Simulation_Ensemble()
+    {
+        QFile modelFile(TEST_DATA_ROOT "unittestmodel.hmf");
+        QVERIFY(modelFile.open(QIODevice::ReadOnly));
+        const QByteArray modelXml = modelFile.readAll();
+
+        SimulationEnsemble ensemble(&mHopsanCore);
+        QVERIFY(ensemble.loadModel(modelXml.constData(), 3));
+        QCOMPARE(ensemble.getNumVariants(), size_t(3));
+        for (size_t v=0; v<3; ++v)
+        {
+            QVERIFY(ensemble.setParameterValue(v, "TestGain", "k#Value", to_hstring(v+1)));
+        }
+        ensemble.setNumThreads(2);
+        QVERIFY(ensemble.initialize(0, 10.0));
+        QVERIFY(ensemble.isLockstep());
+        QVERIFY(ensemble.simulate(10.0));
+        ensemble.finalize();
+
+        // Each variant must give the same results as the same model simulated on its own
+        Port *pPort = mpSystemFromFile->getSubComponent("TestGain")->getPort("out");
+        for (size_t v=0; v<3; ++v)
+        {
+            QVERIFY(mpSystemFromFile->getSubComponent("TestGain")->setParameterValue("k#Value", to_hstring(v+1)));
+            QVERIFY(mpSystemFromFile->checkModelBeforeSimulation());
+            QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+            mpSystemFromFile->simulate(10.0);
+            mpSystemFromFile->finalize();
+            Port *pVariantPort = ensemble.getVariant(v)->getSubComponent("TestGain")->getPort("out");
+            QVERIFY2(pVariantPort->getLogDataVectorPtr()->getVariable(0) == pPort->getLogDataVectorPtr()->getVariable(0),
+                     "Ensemble variant gave different results than a single simulation!");
+            QVERIFY(*ensemble.getVariant(v)->getLogTimeVector() == *mpSystemFromFile->getLogTimeVector());
+        }
+    }
+
+    void System_Clone()
+    {
+        ComponentSystem *pClone = mpSystemFromFile->clone();
+        QVERIFY2(pClone, "Could not clone system");
+        QVERIFY(pClone->getSubComponentNames() == mpSystemFromFile->getSubComponentNames());
+        QVERIFY(pClone->getSubComponentSystem("Subsystem") != 0);
+        QVERIFY(pClone->getSubComponentSystem("Subsystem")->getSubComponentSystem("Subsubsystem") != 0);
+        QVERIFY(pClone->getSubComponent("TestGain")->getPort("in")->isConnected());
+
+        // The clone must be independent of the original
+        QVERIFY(pClone->getSubComponent("TestGain")->setParameterValue("k#Value", "3"));
+        HString originalGain;
+        mpSystemFromFile->getSubComponent("TestGain")->getParameterValue("k#Value", originalGain);
+        QVERIFY(originalGain != HString("3"));
+        QVERIFY(mpSystemFromFile->getSubComponent("TestGain")->setParameterValue("k#Value", "3"));
+
+        // The clone must give the same results as the original
+        ComponentSystem *systems[2] = {mpSystemFromFile, pClone};
+        for (size_t i=0; i<2; ++i)
+        {
+            QVERIFY(systems[i]->checkModelBeforeSimulation());
+            QVERIFY(systems[i]->initialize(0, 10.0));
+            systems[i]->simulate(10.0);
+            systems[i]->finalize();
+        }
+        const char *compNames[2] = {"TestGain", "TestOrifice1"};
+        const char *portNames[2] = {"out", "P1"};
+        for (size_t i=0; i<2; ++i)
+        {
+            LogDataStorage *pOriginalLog = mpSystemFromFile->getSubComponent(compNames[i])->getPort(portNames[i])->getLogDataVectorPtr();
+            LogDataStorage *pCloneLog = pClone->getSubComponent(compNames[i])->getPort(portNames[i])->getLogDataVectorPtr();
+            QVERIFY(!pCloneLog->empty());
+            QVERIFY2(pCloneLog->getVariable(0) == pOriginalLog->getVariable(0), "Cloned system gave different results than the original!");
+        }
+        mHopsanCore.removeComponent(pClone);
+    }
+
+    void System_Simulation_Snapshot()
+    {
+        // A chain of components that keep internal state, the integrator and the delay
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        const char *typeNames[] = {"SignalSineWave", "SignalIntegrator2", "SignalTimeDelay"};
+        const char *names[] = {"Source", "Integrator", "Delay"};
+        for (size_t i=0; i<3; ++i)
+        {
+            Component *pComp = mHopsanCore.createComponent(typeNames[i]);
+            pComp->setName(names[i]);
+            pSystem->addComponent(pComp);
+        }
+        QVERIFY(pSystem->getSubComponent("Delay")->setParameterValue("deltat", "1.5"));
+        pSystem->connect("Source", "out", "Integrator", "in");
+        pSystem->connect("Integrator", "out", "Delay", "in");
+        pSystem->setDesiredTimestep(0.001);
+        Port *pPort = pSystem->getSubComponent("Delay")->getPort("out");
+
+        QVERIFY(pSystem->initialize(0, 2.0));
+        pSystem->simulate(2.0);
+        pSystem->finalize();
+        const double continuousResult = *pPort->getNodeDataPtr(0);
+
+        // Simulate half way and save a snapshot
+        std::vector<char> snapshot;
+        QVERIFY(pSystem->initialize(0, 2.0));
+        pSystem->simulate(1.0);
+        QVERIFY(saveSimulationSnapshot(pSystem, snapshot));
+        pSystem->finalize();
+        double snapshotTime;
+        QVERIFY(getSimulationSnapshotTime(snapshot, snapshotTime));
+        QCOMPARE(snapshotTime, pSystem->getTime());
+
+        // Continue from the snapshot, the result must be the same as in the continuous simulation
+        QVERIFY(pSystem->initialize(snapshotTime, 2.0));
+        QVERIFY(restoreSimulationSnapshot(snapshot, pSystem));
+        pSystem->simulate(2.0);
+        pSystem->finalize();
+        QVERIFY2(*pPort->getNodeDataPtr(0) == continuousResult, "Simulation continued from snapshot gave different results!");
+
+        // Truncated snapshots must be rejected
+        snapshot.resize(snapshot.size()/2);
+        QVERIFY(pSystem->initialize(snapshotTime, 2.0));
+        QVERIFY(!restoreSimulationSnapshot(snapshot, pSystem));
+        pSystem->finalize();
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Warm_Start()
+    {
+        // Two independent chains with internal state, only the second chain is changed between the simulations
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        const char *typeNames[] = {"SignalSineWave", "SignalIntegrator2", "SignalTimeDelay"};
+        const char *names[] = {"Source", "Integrator", "Delay"};
+        const char *chains[] = {"A", "B"};
+        for (size_t c=0; c<2; ++c)
+        {
+            for (size_t i=0; i<3; ++i)
+            {
+                Component *pComp = mHopsanCore.createComponent(typeNames[i]);
+                pComp->setName(HString(names[i])+chains[c]);
+                pSystem->addComponent(pComp);
+            }
+            pSystem->connect(HString("Source")+chains[c], "out", HString("Integrator")+chains[c], "in");
+            pSystem->connect(HString("Integrator")+chains[c], "out", HString("Delay")+chains[c], "in");
+        }
+        pSystem->setDesiredTimestep(0.001);
+        pSystem->setWarmStart(true);
+        ComponentSystem *pReference = pSystem->clone();
+        QVERIFY(pReference);
+        QVERIFY(!pReference->isWarmStartEnabled());
+
+        for (size_t run=0; run<3; ++run)
+        {
+            const HString amplitude = (run == 2) ? "2.5" : "1.5";
+            QVERIFY(pSystem->getSubComponent("SourceB")->setParameterValue("y_A#Value", amplitude));
+            QVERIFY(pReference->getSubComponent("SourceB")->setParameterValue("y_A#Value", amplitude));
+            QVERIFY(pSystem->checkModelBeforeSimulation());
+            QVERIFY(pSystem->initialize(0, 2.0));
+            pSystem->simulate(2.0);
+            pSystem->finalize();
+            QVERIFY(pReference->checkModelBeforeSimulation());
+            QVERIFY(pReference->initialize(0, 2.0));
+            pReference->simulate(2.0);
+            pReference->finalize();
+
+            // The first simulation is a cold start, after that the unchanged chain is not initialized again
+            QCOMPARE(pSystem->getNumWarmStartedComponents(), size_t((run == 0) ? 0 : ((run == 1) ? 4 : 2)));
+            QCOMPARE(pReference->getNumWarmStartedComponents(), size_t(0));
+            for (size_t c=0; c<2; ++c)
+            {
+                const HString delayName = HString("Delay")+chains[c];
+                QVERIFY2(*pSystem->getSubComponent(delayName)->getPort("out")->getNodeDataPtr(0) ==
+                         *pReference->getSubComponent(delayName)->getPort("out")->getNodeDataPtr(0), "Warm started simulation gave different results!");
+            }
+        }
+
+        // A new start time must give a full initialization
+        QVERIFY(pSystem->checkModelBeforeSimulation());
+        QVERIFY(pSystem->initialize(0.5, 2.0));
+        pSystem->finalize();
+        QCOMPARE(pSystem->getNumWarmStartedComponents(), size_t(0));
+
+        mHopsanCore.removeComponent(pReference);
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Parameter_Dependencies()
+    {
+        // Three chains with internal state, each source amplitude refers to a system parameter, the third chain is in a subsystem
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        ComponentSystem *pSubsystem = mHopsanCore.createComponentSystem();
+        pSubsystem->setName("Subsystem");
+        pSystem->addComponent(pSubsystem);
+        QVERIFY(pSystem->setOrAddSystemParameter("ampA", "1.5", "double"));
+        QVERIFY(pSystem->setOrAddSystemParameter("ampB", "1.5", "double"));
+        QVERIFY(pSubsystem->setOrAddSystemParameter("ampC", "ampB", "double"));
+        const char *typeNames[] = {"SignalSineWave", "SignalIntegrator2", "SignalTimeDelay"};
+        const char *names[] = {"Source", "Integrator", "Delay"};
+        const char *chains[] = {"A", "B", "C"};
+        for (size_t c=0; c<3; ++c)
+        {
+            ComponentSystem *pParent = (c == 2) ? pSubsystem : pSystem;
+            for (size_t i=0; i<3; ++i)
+            {
+                Component *pComp = mHopsanCore.createComponent(typeNames[i]);
+                pComp->setName(HString(names[i])+chains[c]);
+                pParent->addComponent(pComp);
+            }
+            QVERIFY(pParent->getSubComponent(HString("Source")+chains[c])->setParameterValue("y_A#Value", HString("amp")+chains[c]));
+            pParent->connect(HString("Source")+chains[c], "out", HString("Integrator")+chains[c], "in");
+            pParent->connect(HString("Integrator")+chains[c], "out", HString("Delay")+chains[c], "in");
+        }
+        // The subsystem has no system ports, so the type can not be determined from the connections
+        pSubsystem->setTypeCQS(Component::SType);
+        pSystem->setDesiredTimestep(0.001);
+        pSystem->setWarmStart(true);
+        ComponentSystem *pReference = pSystem->clone();
+        QVERIFY(pReference);
+        pReference->getSubComponentSystem("Subsystem")->setTypeCQS(Component::SType);
+
+        // Changing ampA only affects chain A, changing ampB affects chain B and, through ampC, the chain in the subsystem
+        const char *changedParameters[] = {"ampA", "ampA", "ampB"};
+        const size_t expectedWarmStarted[] = {0, 4, 2};
+        for (size_t run=0; run<3; ++run)
+        {
+            const HString value = (run == 0) ? "1.5" : "2.5";
+            QVERIFY(pSystem->setSystemParameter(changedParameters[run], value, "double"));
+            QVERIFY(pReference->setSystemParameter(changedParameters[run], value, "double"));
+            QVERIFY(pSystem->checkModelBeforeSimulation());
+            QVERIFY(pSystem->initialize(0, 2.25));
+            pSystem->simulate(2.25);
+            pSystem->finalize();
+            QVERIFY(pReference->checkModelBeforeSimulation());
+            QVERIFY(pReference->initialize(0, 2.25));
+            pReference->simulate(2.25);
+            pReference->finalize();
+
+            QCOMPARE(pSystem->getNumWarmStartedComponents(), expectedWarmStarted[run]);
+            for (size_t c=0; c<3; ++c)
+            {
+                const HString delayName = HString("Delay")+chains[c];
+                Component *pDelay = (c == 2) ? pSystem->getSubComponentSystem("Subsystem")->getSubComponent(delayName) : pSystem->getSubComponent(delayName);
+                Component *pReferenceDelay = (c == 2) ? pReference->getSubComponentSystem("Subsystem")->getSubComponent(delayName) : pReference->getSubComponent(delayName);
+                QVERIFY2(*pDelay->getPort("out")->getNodeDataPtr(0) == *pReferenceDelay->getPort("out")->getNodeDataPtr(0),
+                         "Simulation with incremental parameter evaluation gave different results!");
+            }
+        }
+        mHopsanCore.removeComponent(pReference);
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void Log_Data_Storage()
+    {
+        // Use a sample count that does not fill the last chunk
+        const size_t nSamples = 2*LogDataStorage::ChunkSize+3;
+        LogDataStorage storage;
+        storage.resize(nSamples, 3);
+        QCOMPARE(storage.size(), nSamples);
+        QCOMPARE(storage.getNumVariables(), size_t(3));
+        QCOMPARE(storage.getNumChunks(), size_t(3));
+        for (size_t s=0; s<nSamples; ++s)
+        {
+            const double row[3] = {double(s), -double(s), 0.5*s};
+            storage.write(s, row);
+        }
+
+        QCOMPARE(storage.value(LogDataStorage::ChunkSize, 1), -double(LogDataStorage::ChunkSize));
+        QCOMPARE(storage.back().at(2), 0.5*(nSamples-1));
+        std::vector<double> column = storage.getVariable(0);
+        QCOMPARE(column.size(), nSamples);
+        for (size_t s=0; s<nSamples; ++s)
+        {
+            QCOMPARE(column[s], double(s));
+        }
+        size_t length;
+        const double *pChunk = storage.getVariableChunk(2, 2, length);
+        QCOMPARE(length, size_t(3));
+        QCOMPARE(pChunk[2], 0.5*(nSamples-1));
+
+        // Truncating into the second chunk must keep the remaining samples of all variables
+        storage.truncate(LogDataStorage::ChunkSize+5);
+        QCOMPARE(storage.size(), LogDataStorage::ChunkSize+5);
+        QCOMPARE(storage.getNumChunks(), size_t(2));
+        QCOMPARE(storage.value(LogDataStorage::ChunkSize+4, 0), double(LogDataStorage::ChunkSize+4));
+        QCOMPARE(storage.value(LogDataStorage::ChunkSize+4, 2), 0.5*(LogDataStorage::ChunkSize+4));
+
+        // The simulation log must be readable both by row and by variable
+        Port *pPort = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        LogDataStorage *pLogData = pPort->getLogDataVectorPtr();
+        QCOMPARE(pLogData->size(), mpSystemFromFile->getNumActuallyLoggedSamples());
+        QCOMPARE(pLogData->getSample(1500).at(NodeHydraulic::Pressure), pLogData->getVariable(NodeHydraulic::Pressure).at(1500));
+    }
+
+    void System_Variable_Log_Mask()
+    {
+        Port *pPort = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        const double pressure = pPort->getLogDataVectorPtr()->value(1500, NodeHydraulic::Pressure);
+        const size_t nLoggedVariables = mpSystemFromFile->getNumLoggedVariables();
+
+        QVERIFY(mpSystemFromFile->setEnableVariableLogging("TestVolume", "P1", "Flow", false));
+        QVERIFY(!mpSystemFromFile->setEnableVariableLogging("TestVolume", "P1", "NoSuchVariable", false));
+        QVERIFY(!pPort->isVariableLoggingEnabled(NodeHydraulic::Flow));
+        QVERIFY(pPort->isVariableLoggingEnabled(NodeHydraulic::Pressure));
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        QCOMPARE(mpSystemFromFile->getNumLoggedVariables(), nLoggedVariables-1);
+        LogDataStorage *pLogData = pPort->getLogDataVectorPtr();
+        QVERIFY(!pLogData->isVariableStored(NodeHydraulic::Flow));
+        QVERIFY(pLogData->getVariable(NodeHydraulic::Flow).empty());
+        QCOMPARE(pLogData->value(1500, NodeHydraulic::Pressure), pressure);
+
+        // Disabling the entire port removes the node from the log
+        QVERIFY(mpSystemFromFile->setEnableVariableLogging("TestVolume", "P1", "", false));
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        QVERIFY(mpSystemFromFile->getNumLoggedVariables() < nLoggedVariables-1);
+        mpSystemFromFile->finalize();
+    }
+
+    void System_Log_Modes()
+    {
+        // Log every simulation step as reference
+        Port *pPort = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+        const size_t nSteps = size_t(10.0/mpSystemFromFile->getDesiredTimeStep()+0.5)+1;
+        mpSystemFromFile->setNumLogSamples(nSteps);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        const std::vector<double> fullTime = *mpSystemFromFile->getLogTimeVector();
+        const std::vector<double> fullPressure = pPort->getLogDataVectorPtr()->getVariable(NodeHydraulic::Pressure);
+        QCOMPARE(fullTime.size(), nSteps);
+
+        // Each sample should hold the mean, min and max of all steps since the previous sample
+        mpSystemFromFile->setNumLogSamples(101);
+        mpSystemFromFile->setLogMode(ComponentSystem::MeanLogMode);
+        mpSystemFromFile->setLogEnvelope(true);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector<double> time = *mpSystemFromFile->getLogTimeVector();
+        QCOMPARE(pPort->getLogDataMinVectorPtr()->size(), time.size());
+        size_t step=0;
+        for (size_t s=0; s<time.size(); ++s)
+        {
+            double minValue=fullPressure[step], maxValue=fullPressure[step], sum=0;
+            size_t n=0;
+            for (; step<fullTime.size() && fullTime[step] <= time[s]; ++step, ++n)
+            {
+                minValue = std::min(minValue, fullPressure[step]);
+                maxValue = std::max(maxValue, fullPressure[step]);
+                sum += fullPressure[step];
+            }
+            QVERIFY(n > 0);
+            QCOMPARE(pPort->getLogDataMinVectorPtr()->value(s, NodeHydraulic::Pressure), minValue);
+            QCOMPARE(pPort->getLogDataMaxVectorPtr()->value(s, NodeHydraulic::Pressure), maxValue);
+            QCOMPARE(pPort->getLogDataVectorPtr()->value(s, NodeHydraulic::Pressure), sum/double(n));
+        }
+
+        // A trigger should add samples at every step after the crossing, up to the extra sample budget
+        mpSystemFromFile->setLogMode(ComponentSystem::SampleLogMode);
+        mpSystemFromFile->setLogEnvelope(false);
+        const double threshold = 0.5*(*std::max_element(fullPressure.begin(), fullPressure.end()) + *std::min_element(fullPressure.begin(), fullPressure.end()));
+        QVERIFY(!mpSystemFromFile->addLogTrigger("TestVolume", "P1", "NoSuchVariable", threshold, 20));
+        QVERIFY(mpSystemFromFile->addLogTrigger("TestVolume", "P1", "Pressure", threshold, 20));
+        mpSystemFromFile->setNumTriggeredLogSamples(nSteps);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        time = *mpSystemFromFile->getLogTimeVector();
+        QVERIFY(time.size() > 101);
+        QCOMPARE(pPort->getLogDataVectorPtr()->size(), time.size());
+        QCOMPARE(mpSystemFromFile->getNumActuallyLoggedSamples(), time.size());
+        step=0;
+        for (size_t s=0; s<time.size(); ++s)
+        {
+            while (fullTime[step] < time[s]-1e-9)
+            {
+                ++step;
+            }
+            QCOMPARE(pPort->getLogDataVectorPtr()->value(s, NodeHydraulic::Pressure), fullPressure[step]);
+        }
+        mpSystemFromFile->clearLogTriggers();
+    }
+
+    void System_Log_Sink()
+    {
+        Port *pPort = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        const std::vector<double> time = *mpSystemFromFile->getLogTimeVector();
+        const std::vector<double> pressure = pPort->getLogDataVectorPtr()->getVariable(NodeHydraulic::Pressure);
+        const size_t nLoggedVariables = mpSystemFromFile->getNumLoggedVariables();
+
+        // Stream to file, with small blocks to make sure several blocks are written
+        const QString filePath = QDir::temp().filePath("hopsan_log_sink_test.hlog");
+        {
+            BinaryFileLogSink sink(filePath.toStdString().c_str(), 100, 2);
+            mpSystemFromFile->setLogSink(&sink);
+            QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+            mpSystemFromFile->simulate(10.0);
+            mpSystemFromFile->finalize();
+            mpSystemFromFile->setLogSink(0);
+            QCOMPARE(sink.getNumWrittenSamples(), time.size());
+            QCOMPARE(mpSystemFromFile->getNumLoggedVariables(), size_t(0));
+            QVERIFY(mpSystemFromFile->getLogTimeVector()->empty());
+            QVERIFY(pPort->getLogDataVectorPtr()->empty());
+        }
+
+        BinaryLogFileReader reader;
+        QVERIFY(reader.open(filePath.toStdString().c_str()));
+        QCOMPARE(reader.getVariables().size(), nLoggedVariables);
+        QCOMPARE(reader.getNumSamples(), time.size());
+        std::vector<double> values;
+        QVERIFY(reader.readTime(values));
+        QVERIFY(values == time);
+        bool found=false;
+        for (size_t v=0; v<reader.getVariables().size(); ++v)
+        {
+            const LogSinkVariable &rVar = reader.getVariables()[v];
+            Port *pVarPort = mpSystemFromFile->getSubComponent(rVar.mComponent)->getPort(rVar.mPort);
+            if (pVarPort->getNodePtr() == pPort->getNodePtr() && rVar.mName == "Pressure")
+            {
+                QVERIFY(reader.readVariable(v, values));
+                QVERIFY2(values == pressure, "Streamed log data differs from stored log data!");
+                found = true;
+            }
+        }
+        QVERIFY(found);
+        reader.close();
+        QFile::remove(filePath);
+    }
+
     void Component_Set_Parameter()
     {
         QFETCH(QString, compName);
@@ -29,10 +29,74 @@
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
 #include "CoreUtilities/StringUtilities.h"
 #include "CoreUtilities/MultiThreadingUtilities.h"
+#include "CoreUtilities/CompiledNumHopScript.h"
+#include "ComponentUtilities/matrix.h"
+#include "ComponentUtilities/ludcmp.h"
+#include "ComponentUtilities/FixedSizeMatrix.h"
 
 using namespace hopsan;
 
+typedef FixedMatrix<3,3> FixedMatrix3x3;
+typedef FixedVec<3> FixedVec3;
+
 Q_DECLARE_METATYPE(HString)
+Q_DECLARE_METATYPE(FixedMatrix3x3)
+Q_DECLARE_METATYPE(FixedVec3)
+
+//! @brief Creates a 3x3 matrix from its elements given row by row
+static FixedMatrix3x3 fixedMatrix3x3(const double a00, const double a01, const double a02,
+                                     const double a10, const double a11, const double a12,
+                                     const double a20, const double a21, const double a22)
+{
+    const double values[3][3] = {{a00, a01, a02}, {a10, a11, a12}, {a20, a21, a22}};
+    FixedMatrix3x3 m;
+    for (int r=0; r<3; ++r)
+    {
+        for (int c=0; c<3; ++c)
+        {
+            m[r][c] = values[r][c];
+        }
+    }
+    return m;
+}
+
+//! @brief Creates a vector of length 3 from its elements
+static FixedVec3 fixedVec3(const double v0, const double v1, const double v2)
+{
+    FixedVec3 v;
+    v[0] = v0;
+    v[1] = v1;
+    v[2] = v2;
+    return v;
+}
+
+//! @brief Resolves "in" and "out" to data pointers and "k" to a constant
+class TestNumHopResolver : public CompiledNumHopScript::Resolver
+{
+public:
+    TestNumHopResolver() : in(2), out(0) {}
+
+    double *getDataPtr(const HString &rName)
+    {
+        if (rName == "in")
+        {
+            return &in;
+        }
+        else if (rName == "out")
+        {
+            return &out;
+        }
+        return 0;
+    }
+
+    bool getConstantValue(const HString &rName, double &rValue)
+    {
+        rValue = 3;
+        return (rName == "k");
+    }
+
+    double in, out;
+};
 
 class UtilitiesTestTest : public QObject
 {
@@ -222,6 +286,106 @@ private Q_SLOTS:
         QTest::newRow("7") << 8;
         QTest::newRow("8") << 9;
     }
+
+    void Compiled_NumHop_Script()
+    {
+        QFETCH(QString, script);
+        QFETCH(bool, expectCompiled);
+        QFETCH(double, expectedValue);
+        QFETCH(double, expectedOut);
+
+        std::vector<HString> expressions;
+        QStringList rows = script.split(";");
+        for (int i=0; i<rows.size(); ++i)
+        {
+            expressions.push_back(rows[i].toStdString().c_str());
+        }
+
+        TestNumHopResolver resolver;
+        CompiledNumHopScript compiled;
+        HString error;
+        QVERIFY2(compiled.compile(expressions, resolver, error) == expectCompiled, error.c_str());
+        QVERIFY(compiled.isCompiled() == expectCompiled);
+        if (expectCompiled)
+        {
+            QCOMPARE(compiled.evaluate(), expectedValue);
+            QCOMPARE(resolver.out, expectedOut);
+        }
+    }
+
+    void Compiled_NumHop_Script_data()
+    {
+        QTest::addColumn<QString>("script");
+        QTest::addColumn<bool>("expectCompiled");
+        QTest::addColumn<double>("expectedValue");
+        QTest::addColumn<double>("expectedOut");
+        // Rows are separated by ;, in = 2 and k = 3
+        QTest::newRow("0") << "out = 2*in+k" << true << 7.0 << 7.0;
+        QTest::newRow("1") << "x = in^2; out = -x + 1" << true << -3.0 << -3.0;
+        QTest::newRow("2") << "(in - 1)/(k - 1)*4" << true << 2.0 << 0.0;
+        QTest::newRow("3") << "out = in*1e-3*1000 - --k" << true << -1.0 << -1.0;
+        QTest::newRow("4") << "out = in^-1; out = out*out" << true << 0.25 << 0.25;
+        QTest::newRow("5") << "  ; out = 10-4-3; " << true << 3.0 << 3.0;
+        // Not supported or not valid, these are left to the interpreter
+        QTest::newRow("6") << "out = in < k" << false << 0.0 << 0.0;
+        QTest::newRow("7") << "k = in" << false << 0.0 << 0.0;
+        QTest::newRow("8") << "out = -in^2" << false << 0.0 << 0.0;
+        QTest::newRow("9") << "out = in^2^2" << false << 0.0 << 0.0;
+        QTest::newRow("10") << "out = y" << false << 0.0 << 0.0;
+        QTest::newRow("11") << "x = x + 1" << false << 0.0 << 0.0;
+        QTest::newRow("12") << "out = (in" << false << 0.0 << 0.0;
+        QTest::newRow("13") << " " << false << 0.0 << 0.0;
+    }
+
+    void Fixed_Size_LU_Decomposition()
+    {
+        QFETCH(FixedMatrix3x3, matrix);
+        QFETCH(FixedVec3, rhs);
+        QFETCH(bool, expectSingular);
+
+        Matrix a(3,3);
+        Vec b(3), x(3);
+        FixedMatrix3x3 fa = matrix;
+        FixedVec3 fb = rhs, fx;
+        for (int r=0; r<3; ++r)
+        {
+            for (int c=0; c<3; ++c)
+            {
+                a[r][c] = matrix[r][c];
+            }
+            b[r] = rhs[r];
+        }
+
+        // The fixed size path must give exactly the same result as the dynamic one
+        int order[3], fixedOrder[3];
+        const bool ok = ludcmp(a, order);
+        const bool fixedOk = ludcmp(fa, fixedOrder);
+        QCOMPARE(fixedOk, ok);
+        QCOMPARE(fixedOk, !expectSingular);
+        if (fixedOk)
+        {
+            solvlu(a, b, x, order);
+            solvlu(fa, fb, fx, fixedOrder);
+            const FixedVec3 residual = matrix*fx - rhs;
+            for (int i=0; i<3; ++i)
+            {
+                QCOMPARE(fx[i], x[i]);
+                QVERIFY2(fabs(residual[i]) < 1e-12, "Solution does not satisfy the equation system");
+            }
+        }
+    }
+
+    void Fixed_Size_LU_Decomposition_data()
+    {
+        QTest::addColumn<FixedMatrix3x3>("matrix");
+        QTest::addColumn<FixedVec3>("rhs");
+        QTest::addColumn<bool>("expectSingular");
+        QTest::newRow("0") << fixedMatrix3x3(4, 1, 0,  1, 4, 1,  0, 1, 4) << fixedVec3(1, 2, 3) << false;
+        QTest::newRow("1") << fixedMatrix3x3(0, 2, 1,  3, 0, 1,  1, 1, 0) << fixedVec3(1, 0, -1) << false;
+        QTest::newRow("2") << fixedMatrix3x3(1e-3, 1, 0,  1, 1e-3, 0,  0, 0, 1) << fixedVec3(2, -1, 0.5) << false;
+        QTest::newRow("3") << fixedMatrix3x3(1, 2, 3,  2, 4, 6,  0, 0, 1) << fixedVec3(1, 1, 1) << true;
+        QTest::newRow("4") << fixedMatrix3x3(0, 0, 0,  0, 1, 0,  0, 0, 1) << fixedVec3(1, 1, 1) << true;
+    }
 };
 QTEST_APPLESS_MAIN(UtilitiesTestTest)
 
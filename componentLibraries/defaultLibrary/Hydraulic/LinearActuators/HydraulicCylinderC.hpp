@@ -390,6 +390,20 @@ class HydraulicCylinderC : public ComponentC
             // Filtering of the characteristics
             CxLim = alfa * CxLim + (1.0 - alfa) * NewCxLim;
         }
+
+        void saveSimulationState(SimulationStateWriter &rWriter)
+        {
+            rWriter.write(ci1);
+            rWriter.write(cl1);
+            rWriter.write(ci2);
+            rWriter.write(cl2);
+        }
+
+
+        bool restoreSimulationState(SimulationStateReader &rReader)
+        {
+            return rReader.read(ci1) && rReader.read(cl1) && rReader.read(ci2) && rReader.read(cl2);
+        }
     };
 }
 
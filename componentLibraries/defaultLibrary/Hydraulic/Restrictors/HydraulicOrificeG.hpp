@@ -61,8 +61,8 @@ private:
      double delayParts1[9];
      double delayParts2[9];
      double delayParts3[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
+     FixedMatrix<3,3> jacobianMatrix;
+     FixedVec<3> systemEquations;
      Matrix delayedPart;
      int i;
      int iter;
@@ -122,7 +122,7 @@ private:
      double *mpDRL;
      double *mpCd;
      Delay mDelayedPart10;
-     EquationSystemSolver *mpSolver;
+     FixedEquationSystemSolver<3> *mpSolver;
 
 public:
      static Component *Creator()
@@ -135,8 +135,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(3,3);
-        systemEquations.create(3);
         delayedPart.create(4,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
@@ -171,7 +169,7 @@ public:
 
 //==This code has been autogenerated using Compgen==
         //Add constantParameters
-        mpSolver = new EquationSystemSolver(this,3);
+        mpSolver = new FixedEquationSystemSolver<3>(this);
      }
 
     void initialize()
@@ -239,9 +237,7 @@ public:
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(3);
-        Vec stateVark(3);
-        Vec deltaStateVar(3);
+        FixedVec<3> stateVark;
 
         //Read variables from nodes
         //Port P1
@@ -248,6 +248,17 @@ namespace hopsan {
             (*mpPB_q) = qb;
             (*mpXv) = xv;
         }
+
+        void saveSimulationState(SimulationStateWriter &rWriter)
+        {
+            mSpoolPosTF.saveState(rWriter);
+        }
+
+
+        bool restoreSimulationState(SimulationStateReader &rReader)
+        {
+            return mSpoolPosTF.restoreState(rReader);
+        }
     };
 }
 
@@ -240,6 +240,19 @@ namespace hopsan {
             (*mpP2_q) = q2;
             (*mpXv) = x0;
         }
+
+        void saveSimulationState(SimulationStateWriter &rWriter)
+        {
+            rWriter.write(mPrevX0);
+            mFilterLP.saveState(rWriter);
+        }
+
+
+        bool restoreSimulationState(SimulationStateReader &rReader)
+        {
+            rReader.read(mPrevX0);
+            return mFilterLP.restoreState(rReader);
+        }
     };
 }
 
@@ -189,6 +189,18 @@ namespace hopsan {
             (*mpP1_me) = mMass;
             (*mpP2_me) = mMass;
         }
+
+        void saveSimulationState(SimulationStateWriter &rWriter)
+        {
+            mFilterX.saveState(rWriter);
+            mFilterV.saveState(rWriter);
+        }
+
+
+        bool restoreSimulationState(SimulationStateReader &rReader)
+        {
+            return mFilterX.restoreState(rReader) && mFilterV.restoreState(rReader);
+        }
     };
 }
 
@@ -84,6 +84,23 @@ namespace hopsan {
         {
             (*mpOut) = mTF.update(*mpIn);
         }
+
+        void saveSimulationState(SimulationStateWriter &rWriter)
+        {
+            mTF.saveState(rWriter);
+        }
+
+
+        bool restoreSimulationState(SimulationStateReader &rReader)
+        {
+            return mTF.restoreState(rReader);
+        }
+
+
+        bool hasCompleteSimulationState() const
+        {
+            return true;
+        }
     };
 }
 
@@ -76,6 +76,23 @@ namespace hopsan {
             //Filter equation
            (*mpOut) = mIntegrator.update((*mpIn));
         }
+
+        void saveSimulationState(SimulationStateWriter &rWriter)
+        {
+            mIntegrator.saveState(rWriter);
+        }
+
+
+        bool restoreSimulationState(SimulationStateReader &rReader)
+        {
+            return mIntegrator.restoreState(rReader);
+        }
+
+
+        bool hasCompleteSimulationState() const
+        {
+            return true;
+        }
     };
 }
 
@@ -95,6 +95,23 @@ namespace hopsan {
         {
             (*mpOut) = mTF2.update(*mpIn);
         }
+
+        void saveSimulationState(SimulationStateWriter &rWriter)
+        {
+            mTF2.saveState(rWriter);
+        }
+
+
+        bool restoreSimulationState(SimulationStateReader &rReader)
+        {
+            return mTF2.restoreState(rReader);
+        }
+
+
+        bool hasCompleteSimulationState() const
+        {
+            return true;
+        }
     };
 }
 
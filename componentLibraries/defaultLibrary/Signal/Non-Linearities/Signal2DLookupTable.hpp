@@ -213,6 +213,11 @@ namespace hopsan {
                         }
                         stopSimulation();
                     }
+                    else
+                    {
+                        // Trade some memory for faster interpolation in every time step
+                        mLookupTable.calcCellCoefficients();
+                    }
                 }
             }
             simulateOneTimestep();
@@ -78,6 +78,23 @@ namespace hopsan {
         {
             (*mpND_out) =  mDelay.update(*mpND_in);
         }
+
+        void saveSimulationState(SimulationStateWriter &rWriter)
+        {
+            mDelay.saveState(rWriter);
+        }
+
+
+        bool restoreSimulationState(SimulationStateReader &rReader)
+        {
+            return mDelay.restoreState(rReader);
+        }
+
+
+        bool hasCompleteSimulationState() const
+        {
+            return true;
+        }
     };
 }
 
@@ -91,6 +91,15 @@ public:
             addErrorMessage("Error interpreting numhop script: "+output);
             stopSimulation();
         }
+        else
+        {
+            // Compile the script so that each time step runs without name lookups, if not possible the script is interpreted
+            HString compileError;
+            if (!mpNumHop->compile(compileError))
+            {
+                addDebugMessage("The numhop script is interpreted, it could not be compiled: "+compileError);
+            }
+        }
 
         simulateOneTimestep();
     }
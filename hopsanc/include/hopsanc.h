@@ -24,6 +24,7 @@ extern "C" {
     HOPSANC_DLLAPI int loadLibrary(const char* path);
     HOPSANC_DLLAPI int getMessage(char* buf, size_t bufSize);
     HOPSANC_DLLAPI int loadModel(const char* path);
+    HOPSANC_DLLAPI int resetModel();
     HOPSANC_DLLAPI int setParameter(const char* name, const char *value);
     HOPSANC_DLLAPI int setStartTime(double value);
     HOPSANC_DLLAPI int setTimeStep(double value);
@@ -9,9 +9,11 @@
 #include "ComponentUtilities/num2string.hpp"
 
 static hopsan::ComponentSystem *spCoreComponentSystem = nullptr;
+static hopsan::ComponentSystem *spLoadedComponentSystem = nullptr;
 static hopsan::HopsanEssentials gHopsanCore;
 
 static double startTime, stopTime;
+static double loadedStartTime, loadedStopTime;
 
 std::vector<hopsan::HString> msgVec;
 
@@ -69,6 +71,11 @@ int getMessage(char* buf, size_t bufSize) {
 int loadModel(const char* path) {
     if(spCoreComponentSystem) {
         delete spCoreComponentSystem;
+        spCoreComponentSystem = nullptr;
+    }
+    if(spLoadedComponentSystem) {
+        delete spLoadedComponentSystem;
+        spLoadedComponentSystem = nullptr;
     }
     spCoreComponentSystem = gHopsanCore.loadHMFModelFile(path, startTime, stopTime);
     if(!spCoreComponentSystem) {
@@ -78,12 +85,41 @@ int loadModel(const char* path) {
     }
     const hopsan::HString modelName = spCoreComponentSystem->getName();
     spCoreComponentSystem->addSearchPath(modelName+"-resources");
+
+    // Keep an unmodified copy for resetModel()
+    spLoadedComponentSystem = spCoreComponentSystem->clone();
+    loadedStartTime = startTime;
+    loadedStopTime = stopTime;
+
     printMessage("Loaded model: "+modelName);
     printWaitingMessages(gHopsanCore, false, false);
     return 0;
 }
 
 
+//! @brief Restores the loaded model to the state it had when it was loaded, without reading the model file again
+//! Parameter values, time step, number of log samples and simulation times are reset
+//! @returns Status (0 = success)
+int resetModel() {
+    if(!spLoadedComponentSystem) {
+        printMessage("Error: No model is loaded.");
+        return -1;
+    }
+    hopsan::ComponentSystem *pSystem = spLoadedComponentSystem->clone();
+    if(!pSystem) {
+        printMessage("Failed to copy model!");
+        printWaitingMessages(gHopsanCore, false, false);
+        return -1;
+    }
+    delete spCoreComponentSystem;
+    spCoreComponentSystem = pSystem;
+    startTime = loadedStartTime;
+    stopTime = loadedStopTime;
+    printWaitingMessages(gHopsanCore, false, false);
+    return 0;
+}
+
+
 //! @brief Provides specified data vector from last simulation
 //! @param [in] variable Variable name ("component.port.variable")
 //! @param [in,out] data Buffer where data vector is stored (must be preallocated to match number of log samples)
@@ -139,9 +175,9 @@ int getDataVector(const char* variable, double *data)
         return -1;
     }
 
-    std::vector< std::vector<double> > *pLogData = pPort->getLogDataVectorPtr();
+    hopsan::LogDataStorage *pLogData = pPort->getLogDataVectorPtr();
     for (size_t t=0; t<spCoreComponentSystem->getNumActuallyLoggedSamples(); ++t) {
-        data[t] = (*pLogData)[t][size_t(varId)];
+        data[t] = pLogData->value(t, size_t(varId));
     }
     return 0;
 }
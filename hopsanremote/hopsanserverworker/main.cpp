@@ -65,7 +65,7 @@ bool gHaveLoadedComponentLibraries=false;
 typedef struct
 {
     string fullName;
-    vector< vector<double> > *pData = 0;
+    LogDataStorage *pData = 0;
     vector< double > *pTimeData = 0;
     size_t dataLength = 0;
     size_t dataId = 0;
@@ -125,7 +125,7 @@ void collectAllModelVariables(ComponentSystem *pSys, vector<ModelVariableInfo_t>
                 }
 
                 //! @todo what about time vector
-                vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
+                LogDataStorage *pLogData = pPort->getLogDataVectorPtr();
 
                 const vector<NodeDataDescription> *pVars = pPort->getNodeDataDescriptions();
                 if (pVars)
@@ -135,7 +135,7 @@ void collectAllModelVariables(ComponentSystem *pSys, vector<ModelVariableInfo_t>
                         // Only write something if data has been logged (skip ports that are not logged)
                         // We assume that the data vector has been cleared
                         //! @todo check if log on
-                        if (pLogData->size() > 0)
+                        if (pLogData->size() > 0 && pLogData->isVariableStored(v))
                         {
                             const NodeDataDescription *pVarDesc = &(*pVars)[v];
                             ModelVariableInfo_t mvi;
@@ -269,6 +269,10 @@ string getParameter(ComponentSystem *pSystem, HString &fullname)
 
 ComponentSystem *gpRootSystem=nullptr;
 double gSimStartTime, gSimStopTime;
+// Unmodified copy of the last loaded model, so that the same model can be loaded again without parsing it
+ComponentSystem *gpLoadedRootSystem=nullptr;
+string gLoadedModel;
+double gLoadedStartTime, gLoadedStopTime;
 size_t gNumThreads = 1;
 SimulationHandler gSimulator;
 FileReceiver gModelAssets;
@@ -416,6 +420,20 @@ bool loadModel(string &rModel)
         gIsModelLoaded = false;
     }
 
+    if (gpLoadedRootSystem && !rModel.empty() && rModel == gLoadedModel)
+    {
+        // Same model as last time, copy it instead of parsing it again
+        gpRootSystem = gpLoadedRootSystem->clone();
+        gSimStartTime = gLoadedStartTime;
+        gSimStopTime = gLoadedStopTime;
+        if (gpRootSystem)
+        {
+            cout << PRINTWORKER << nowDateTime() << " Model was copied from the previously loaded model" << endl;
+            gIsModelLoaded = true;
+            return true;
+        }
+    }
+
     //! @todo loadHMFModel will hang (sometimes) if hmf empty
     if (!rModel.empty())
     {
@@ -427,6 +445,13 @@ bool loadModel(string &rModel)
     {
         cout << PRINTWORKER << nowDateTime() << " Model was loaded sucessfully" << endl;
         gIsModelLoaded = true;
+
+        // Keep an unmodified copy, the loaded system will be changed by parameter updates and simulation
+        delete gpLoadedRootSystem;
+        gpLoadedRootSystem = gpRootSystem->clone();
+        gLoadedModel = gpLoadedRootSystem ? rModel : string();
+        gLoadedStartTime = gSimStartTime;
+        gLoadedStopTime = gSimStopTime;
         return true;
     }
     else
@@ -909,7 +934,7 @@ int main(int argc, char* argv[])
                             {
                                 for (size_t t=0; t<rMvi.dataLength; ++t)
                                 {
-                                    vars.back().data.push_back((*rMvi.pData)[t][rMvi.dataId]);
+                                    vars.back().data.push_back(rMvi.pData->value(t, rMvi.dataId));
                                 }
                             }
                             // Copy if a time data variable
@@ -1061,6 +1086,8 @@ int main(int argc, char* argv[])
             gpRootSystem=nullptr;
             gIsModelLoaded = false;
         }
+        delete gpLoadedRootSystem;
+        gpLoadedRootSystem=nullptr;
     }
     catch(zmq::error_t e)
     {